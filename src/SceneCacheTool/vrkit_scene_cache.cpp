@@ -0,0 +1,124 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+ * Command line tool that fills a vrkit scene cache directory ahead of time
+ * so that the first launch of an application using the cache does not have
+ * to convert the scene files.
+ *
+ * Usage: vrkit_scene_cache --cache-dir <dir> [--force] <file> ...
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGBaseFunctions.h>
+
+#include <vpr/vpr.h>
+#include <vpr/Util/Interval.h>
+#include <vpr/Util/FileUtils.h>
+
+#include <vrkit/util/SceneCache.h>
+
+
+int main(int argc, char* argv[])
+{
+   namespace po = boost::program_options;
+   namespace fs = boost::filesystem;
+
+   const int EXIT_ERR_USAGE(1);
+   const int EXIT_ERR_CONVERSION(2);
+   const int EXIT_ERR_EXCEPTION(-1);
+
+   try
+   {
+      std::string cache_dir;
+      std::vector<std::string> files;
+
+      po::options_description options("Options");
+      options.add_options()
+         ("help,h", "produce help message")
+         ("cache-dir,c", po::value<std::string>(&cache_dir),
+          "Scene cache directory (the scene_cache_dir setting of the viewer)")
+         ("force,f", "Convert files that are already in the cache")
+         ("file", po::value< std::vector<std::string> >(&files),
+          "Scene file to convert")
+      ;
+
+      po::positional_options_description positional;
+      positional.add("file", -1);
+
+      po::variables_map vm;
+      store(po::command_line_parser(argc, argv).options(options)
+               .positional(positional).run(),
+            vm);
+      notify(vm);
+
+      if ( vm.count("help") > 0 || cache_dir.empty() || files.empty() )
+      {
+         std::cout << "Usage: " << argv[0]
+                   << " --cache-dir <dir> [--force] <file> ...\n\n"
+                   << options << std::endl;
+         return vm.count("help") > 0 ? EXIT_SUCCESS : EXIT_ERR_USAGE;
+      }
+
+      OSG::osgInit(argc, argv);
+
+      vrkit::util::SceneCachePtr cache =
+         vrkit::util::SceneCache::create(
+            fs::path(vpr::replaceEnvVars(cache_dir), fs::native)
+         );
+
+      const bool force(vm.count("force") > 0);
+      int status(EXIT_SUCCESS);
+
+      typedef std::vector<std::string>::iterator iter_type;
+      for ( iter_type f = files.begin(); f != files.end(); ++f )
+      {
+         const vpr::Interval start(vpr::Interval::now());
+
+         if ( cache->prewarm(*f, force) )
+         {
+            const vpr::Interval elapsed(vpr::Interval::now() - start);
+            std::cout << *f << " -> "
+                      << cache->getEntryPath(*f).native_file_string()
+                      << " [" << elapsed.msecf() << " ms]" << std::endl;
+         }
+         else
+         {
+            std::cerr << "Failed to convert " << *f << std::endl;
+            status = EXIT_ERR_CONVERSION;
+         }
+      }
+
+      cache = vrkit::util::SceneCachePtr();
+      OSG::osgExit();
+
+      return status;
+   }
+   catch (std::exception& ex)
+   {
+      std::cerr << ex.what() << std::endl;
+      return EXIT_ERR_EXCEPTION;
+   }
+}
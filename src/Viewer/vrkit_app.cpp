@@ -20,6 +20,7 @@
 #include <vector>
 #include <boost/program_options.hpp>
 #include <boost/bind.hpp>
+#include <boost/mpl/vector.hpp>
 
 #include <OpenSG/OSGNode.h>
 #include <OpenSG/OSGTransform.h>
@@ -30,6 +31,7 @@
 
 #include <vpr/vpr.h>
 #include <vpr/System.h>
+#include <vpr/Sync/Guard.h>
 #include <vpr/Util/FileUtils.h>
 #include <jccl/Config/ConfigElement.h>
 #include <vrj/vrjParam.h>
@@ -51,6 +53,10 @@
 #include <vrkit/util/EventSoundPlayer.h>
 #include <vrkit/util/DigitalCommand.h>
 #include <vrkit/util/CoreTypePredicate.h>
+#include <vrkit/util/SceneCache.h>
+#include <vrkit/util/SceneOptimizer.h>
+#include <vrkit/util/SceneFileLock.h>
+#include <vrkit/util/CoreTypeSeqPredicate.h>
 
 
 #if __VJ_version < 2003002
@@ -88,6 +94,7 @@ private:
    VrkitApp()
       : vrkit::Viewer()
       , mEnableGrab(true)
+      , mOptimizer(0)
    {
       /* Do nothing. */ ;
    }
@@ -140,6 +147,8 @@ private:
    bool mEnableGrab;
    std::vector<OSG::FieldContainerType*> mCoreTypes;
    //@}
+
+   vrkit::util::SceneOptimizer mOptimizer;
 };
 
 void VrkitApp::contextInit()
@@ -157,6 +166,7 @@ void VrkitApp::preFrame()
    if ( mSaveCmd() )
    {
       OSG::GroupNodePtr root = getSceneObj()->getSceneRoot();
+      vpr::Guard<vpr::Mutex> guard(vrkit::util::getSceneFileLock());
 #if OSG_MAJOR_VERSION < 2
       OSG::SceneFileHandler::the().write(root, "scene.osb");
 #else
@@ -214,18 +224,46 @@ void VrkitApp::init()
    if ( ! mFileName.empty() )
    {
       VRKIT_STATUS << "Loading scene: " << mFileName << std::endl;
-      model_root =
+
+      if ( getSceneCache() )
+      {
+         model_root = getSceneCache()->read(mFileName);
+      }
+      else
+      {
+         vpr::Guard<vpr::Mutex> guard(vrkit::util::getSceneFileLock());
+         model_root =
 #if OSG_MAJOR_VERSION < 2
-         OSG::SceneFileHandler::the().read(mFileName.c_str());
+            OSG::SceneFileHandler::the().read(mFileName.c_str());
 #else
-         OSG::SceneFileHandler::the()->read(mFileName.c_str());
+            OSG::SceneFileHandler::the()->read(mFileName.c_str());
 #endif
+      }
 
       if ( OSG::NullFC == model_root )
       {
          std::cerr << "FATAL ERROR: Failed to load " << mFileName << "!\n";
          std::exit(-2);
       }
+
+      // Preserve the nodes that will be registered for grabbing.
+      vrkit::util::SceneOptimizer::predicate_t keep;
+
+      if ( mEnableGrab )
+      {
+         if ( mCoreTypes.empty() )
+         {
+            keep = vrkit::util::CoreTypeSeqPredicate<
+                      boost::mpl::vector<OSG::Transform>
+                   >();
+         }
+         else
+         {
+            keep = vrkit::util::CoreTypePredicate(mCoreTypes);
+         }
+      }
+
+      mOptimizer.optimize(model_root, keep);
    }
 
    // Make the materials of the loaded model available in the material pool.
@@ -365,6 +403,7 @@ void VrkitApp::configure(jccl::ConfigElementPtr cfgElt)
    const std::string enable_grab_prop("enable_grabbing");
    const std::string core_type_prop("core_type");
    const std::string save_scene_exp_prop("save_scene_command_exp");
+   const std::string optimization_prop("optimization");
 
    mEnableGrab = cfgElt->getProperty<bool>(enable_grab_prop);
 
@@ -391,6 +430,30 @@ void VrkitApp::configure(jccl::ConfigElementPtr cfgElt)
       getUser()->getInterfaceTrader().getWandInterface();
    mSaveCmd.configure(cfgElt->getProperty<std::string>(save_scene_exp_prop),
                       wand_if);
+
+   // Scene optimization was added in version 3.
+   if ( cfgElt->getVersion() >= 3 )
+   {
+      unsigned int operations(0);
+      const unsigned int num_ops = cfgElt->getNum(optimization_prop);
+      for ( unsigned int i = 0; i < num_ops; ++i )
+      {
+         const std::string op_name =
+            cfgElt->getProperty<std::string>(optimization_prop, i);
+
+         try
+         {
+            operations |= vrkit::util::SceneOptimizer::getOperation(op_name);
+         }
+         catch (vrkit::Exception&)
+         {
+            VRKIT_STATUS << "Skipping unknown scene optimization '"
+                         << op_name << "'" << std::endl;
+         }
+      }
+
+      mOptimizer.setOperations(operations);
+   }
 }
 
 // This is a demonstration of how a slot for the objectsMoved signal might be
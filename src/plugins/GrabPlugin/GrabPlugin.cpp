@@ -191,38 +191,55 @@ void GrabPlugin::update(ViewerPtr viewer)
    {
       // Get the wand transformation in virtual platform coordinates.
       const gmtl::Matrix44f vp_M_wand_xform(
-         mWandInterface->getWandPos()->getData(viewer->getDrawScaleFactor())
+         mWandInterface->getSnapshot().getWandPos()
       );
 
-      const std::vector<SceneObjectPtr> objs =
-         mGrabStrategy->getGrabbedObjects();
+      const std::size_t count(mGrabbedObjs.size());
 
       // Move the grabbed objects.
-      if ( ! objs.empty() && ! mMoveStrategies.empty() )
+      if ( count > 0 && ! mMoveStrategies.empty() )
       {
-         std::vector< std::pair<SceneObjectPtr, gmtl::Matrix44f> > move_data;
-
-         std::vector<SceneObjectPtr>::const_iterator o;
-         for ( o = objs.begin(); o != objs.end(); ++o )
+         // Each move strategy starts from the result of the previous one,
+         // and the first starts from the transformations at grab time.
+         // The assignment reuses the storage of mMoveXforms.
+         mMoveXforms = mGrabbed_pobj_M_obj;
+
+         typedef std::vector<move::StrategyPtr>::iterator iter_type;
+         for ( iter_type s = mMoveStrategies.begin();
+               s != mMoveStrategies.end();
+               ++s )
          {
-            gmtl::Matrix44f new_obj_mat = mGrabbed_pobj_M_obj_map[*o];
+            // The computed transformations are guaranteed to place the
+            // objects into pobj space.
+            (*s)->computeMoves(viewer, &mGrabbedObjs[0], &mMoveXforms[0],
+                               count, vp_M_wand_xform);
+         }
 
-            typedef std::vector<move::StrategyPtr>::iterator iter_type;
-            for ( iter_type s = mMoveStrategies.begin();
-                  s != mMoveStrategies.end();
-                  ++s )
+         // Only objects whose transformation changed are moved. When the
+         // wand is stationary, this leaves nothing to post, so no signal is
+         // emitted and no transformation is written.
+         mMoveData.clear();
+         for ( std::size_t i = 0; i < count; ++i )
+         {
+            if ( mMoveXforms[i] != mPosted_pobj_M_obj[i] )
             {
-               // new_obj_mat is guaranteed to place the object into pobj
-               // space.
-               new_obj_mat = (*s)->computeMove(viewer, *o, vp_M_wand_xform,
-                                               new_obj_mat);
+               mPosted_pobj_M_obj[i] = mMoveXforms[i];
+               mMoveData.push_back(
+                  std::make_pair(mGrabbedObjs[i], mMoveXforms[i])
+               );
             }
+         }
 
-            move_data.push_back(std::make_pair(*o, new_obj_mat));
+         if ( mMoveData.size() < count )
+         {
+            mEventData->addSuppressedMoves(count - mMoveData.size());
          }
 
          // Send a move event.
-         mEventData->objectsMoved(move_data);
+         if ( ! mMoveData.empty() )
+         {
+            mEventData->postObjectsMoved(mMoveData);
+         }
       }
    }
 }
@@ -238,10 +255,11 @@ void GrabPlugin::focusChanged(ViewerPtr viewer)
 event::ResultType
 GrabPlugin::defaultObjectsMovedSlot(const EventData::moved_obj_list_t& objs)
 {
+   OSG::Matrix obj_mat_osg;
+
    EventData::moved_obj_list_t::const_iterator o;
    for ( o = objs.begin(); o != objs.end(); ++o )
    {
-      OSG::Matrix obj_mat_osg;
       gmtl::set(obj_mat_osg, (*o).second);
       (*o).first->moveTo(obj_mat_osg);
    }
@@ -368,15 +386,38 @@ void GrabPlugin::objectsGrabbed(ViewerPtr viewer,
                                 const std::vector<SceneObjectPtr>& objs,
                                 const gmtl::Point3f& isectPoint)
 {
+   mGrabbedObjs.reserve(mGrabbedObjs.size() + objs.size());
+   mGrabbed_pobj_M_obj.reserve(mGrabbed_pobj_M_obj.size() + objs.size());
+   mPosted_pobj_M_obj.reserve(mPosted_pobj_M_obj.size() + objs.size());
+
    std::vector<SceneObjectPtr>::const_iterator o;
    for ( o = objs.begin(); o != objs.end(); ++o )
    {
-      gmtl::set(mGrabbed_pobj_M_obj_map[*o], (*o)->getPos());
+      gmtl::Matrix44f pobj_M_obj;
+      gmtl::set(pobj_M_obj, (*o)->getPos());
+
+      const std::map<SceneObjectPtr, std::size_t>::iterator i =
+         mGrabbedIndex.find(*o);
+
+      // An object that is grabbed again starts over from its current
+      // transformation.
+      if ( i != mGrabbedIndex.end() )
+      {
+         mGrabbed_pobj_M_obj[(*i).second] = pobj_M_obj;
+         mPosted_pobj_M_obj[(*i).second]  = pobj_M_obj;
+      }
+      else
+      {
+         mGrabbedIndex[*o] = mGrabbedObjs.size();
+         mGrabbedObjs.push_back(*o);
+         mGrabbed_pobj_M_obj.push_back(pobj_M_obj);
+         mPosted_pobj_M_obj.push_back(pobj_M_obj);
+      }
    }
 
    // Get the wand transformation in virtual platform coordinates.
    const gmtl::Matrix44f vp_M_wand_xform(
-      mWandInterface->getWandPos()->getData(viewer->getDrawScaleFactor())
+      mWandInterface->getSnapshot().getWandPos()
    );
 
    std::for_each(mMoveStrategies.begin(), mMoveStrategies.end(),
@@ -384,16 +425,53 @@ void GrabPlugin::objectsGrabbed(ViewerPtr viewer,
                              objs, isectPoint, vp_M_wand_xform));
 
    // Emit the object selection signal.
-   mEventData->objectsSelected(objs);
+   mEventData->postObjectsSelected(objs);
 }
 
 void GrabPlugin::objectsReleased(ViewerPtr viewer,
                                  const std::vector<SceneObjectPtr>& objs)
 {
+   bool removed(false);
+
+   // Clear the slots of the released objects.
    std::vector<SceneObjectPtr>::const_iterator o;
    for ( o = objs.begin(); o != objs.end(); ++o )
    {
-      mGrabbed_pobj_M_obj_map.erase(*o);
+      const std::map<SceneObjectPtr, std::size_t>::iterator i =
+         mGrabbedIndex.find(*o);
+
+      if ( i != mGrabbedIndex.end() )
+      {
+         mGrabbedObjs[(*i).second].reset();
+         mGrabbedIndex.erase(i);
+         removed = true;
+      }
+   }
+
+   // Close the gaps in a single pass that preserves the order of the
+   // objects that are still grabbed.
+   if ( removed )
+   {
+      std::size_t dst(0);
+      for ( std::size_t src = 0; src < mGrabbedObjs.size(); ++src )
+      {
+         if ( mGrabbedObjs[src] )
+         {
+            if ( dst != src )
+            {
+               mGrabbedObjs[dst]        = mGrabbedObjs[src];
+               mGrabbed_pobj_M_obj[dst] = mGrabbed_pobj_M_obj[src];
+               mPosted_pobj_M_obj[dst]  = mPosted_pobj_M_obj[src];
+               mGrabbedIndex[mGrabbedObjs[dst]] = dst;
+            }
+
+            ++dst;
+         }
+      }
+
+      mGrabbedObjs.resize(dst);
+      mGrabbed_pobj_M_obj.resize(dst);
+      mPosted_pobj_M_obj.resize(dst);
    }
 
    std::for_each(mMoveStrategies.begin(), mMoveStrategies.end(),
@@ -401,7 +479,7 @@ void GrabPlugin::objectsReleased(ViewerPtr viewer,
                              objs));
 
    // Emit the de-select event for all the objects that were released.
-   mEventData->objectsDeselected(objs);
+   mEventData->postObjectsDeselected(objs);
 }
 
 }
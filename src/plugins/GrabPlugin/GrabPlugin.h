@@ -21,6 +21,7 @@
 
 #include <vrkit/plugin/Config.h>
 
+#include <cstddef>
 #include <string>
 #include <map>
 #include <vector>
@@ -113,11 +114,37 @@ private:
    grab::StrategyPtr mGrabStrategy;
    //@}
 
+   /** @name Grabbed Objects
+    * The grabbed objects and their transformations relative to their parent
+    * at the time they were grabbed are stored in parallel arrays that change
+    * only when objects are grabbed or released. \c mGrabbedIndex maps an
+    * object to its index in these arrays. \c mPosted_pobj_M_obj holds the
+    * last transformation posted for each object so that unchanged objects
+    * are left out of the move event.
+    */
+   //@{
+   std::vector<SceneObjectPtr>              mGrabbedObjs;
+   std::vector<gmtl::Matrix44f>             mGrabbed_pobj_M_obj;
+   std::vector<gmtl::Matrix44f>             mPosted_pobj_M_obj;
+   std::map<SceneObjectPtr, std::size_t>    mGrabbedIndex;
+   //@}
+
    /** @name Move Strategies */
    //@{
-   std::map<SceneObjectPtr, gmtl::Matrix44f> mGrabbed_pobj_M_obj_map;
    std::vector<move::StrategyPtr> mMoveStrategies;
    std::vector<std::string> mMoveStrategyNames;
+
+   /**
+    * Storage for the transformations computed by the move strategies. This
+    * is reused from frame to frame.
+    */
+   std::vector<gmtl::Matrix44f> mMoveXforms;
+
+   /**
+    * The data for the move event. It contains only the objects whose
+    * transformation changed. This is reused from frame to frame.
+    */
+   EventData::moved_obj_list_t  mMoveData;
    //@}
 
    EventDataPtr mEventData;
@@ -18,10 +18,12 @@
 
 #include <vrkit/Config.h>
 
+#include <algorithm>
 #include <functional>
 #include <boost/bind.hpp>
 #include <boost/assign/list_of.hpp>
 
+#include <gmtl/MatrixOps.h>
 #include <gmtl/External/OpenSGConvert.h>
 
 #include <vpr/Util/Assert.h>
@@ -35,6 +37,7 @@
 #include <vrkit/InterfaceTrader.h>
 #include <vrkit/WandInterface.h>
 #include <vrkit/SceneObject.h>
+#include <vrkit/DynamicSceneObject.h>
 #include <vrkit/Version.h>
 #include <vrkit/scenedata/StatusPanelData.h>
 #include <vrkit/plugin/Creator.h>
@@ -79,6 +82,17 @@ VRKIT_PLUGIN_API(vrkit::plugin::CreatorBase*) getGrabStrategyCreator()
 
 }
 
+namespace
+{
+
+// The group scene object has no scene object children or ancestors.
+bool isNotSceneObject(OSG::NodePtr)
+{
+   return false;
+}
+
+}
+
 namespace vrkit
 {
 
@@ -88,6 +102,7 @@ MultiObjectGrabStrategy::MultiObjectGrabStrategy(const plugin::Info& info)
    , mGrabText("Grab object(s)")
    , mReleaseText("Release object(s)")
    , mGrabbing(false)
+   , mGroupGrab(false)
 {
    /* Do nothing. */ ;
 }
@@ -96,11 +111,11 @@ MultiObjectGrabStrategy::~MultiObjectGrabStrategy()
 {
    std::for_each(
       mObjConnections.begin(), mObjConnections.end(),
-      boost::bind(&boost::signals::connection::disconnect,
+      boost::bind(&signal::Connection::disconnect,
                   boost::bind(&obj_conn_map_t::value_type::second, _1))
    );
    std::for_each(mIsectConnections.begin(), mIsectConnections.end(),
-                 boost::bind(&boost::signals::connection::disconnect, _1));
+                 boost::bind(&signal::Connection::disconnect, _1));
 }
 
 grab::StrategyPtr MultiObjectGrabStrategy::
@@ -200,13 +215,9 @@ void MultiObjectGrabStrategy::update(ViewerPtr viewer)
       // objects selected for later grabbing.
       if ( mCurIsectObject && mCurIsectObject->isGrabbable() && mChooseBtn() )
       {
-         std::vector<SceneObjectPtr>::iterator o =
-            std::find(mChosenObjects.begin(), mChosenObjects.end(),
-                      mCurIsectObject);
-
          // Only choose mCurIsectObject for grabbing if it is not already in
          // mChosenObjcts.
-         if ( o == mChosenObjects.end() )
+         if ( mChosenSet.insert(mCurIsectObject).second )
          {
             mChosenObjects.push_back(mCurIsectObject);
 
@@ -220,7 +231,7 @@ void MultiObjectGrabStrategy::update(ViewerPtr viewer)
                );
 
             std::vector<SceneObjectPtr> objs(1, mCurIsectObject);
-            mEventData->selectionListExpanded(objs);
+            mEventData->postSelectionListExpanded(objs);
 
             // Use the intersection point of the most recently chosen object.
             mIntersectPoint = mCurIntersectPoint;
@@ -236,6 +247,7 @@ void MultiObjectGrabStrategy::update(ViewerPtr viewer)
          {
             mGrabbedObjects = mChosenObjects;
             mChosenObjects.clear();
+            mChosenSet.clear();
             mGrabbing = true;
          }
          // If mChosenObjects is empty but we are intersecting an object,
@@ -252,7 +264,17 @@ void MultiObjectGrabStrategy::update(ViewerPtr viewer)
          // objects are now grabbed.
          if ( mGrabbing )
          {
-            mGrabCallback(mGrabbedObjects, mIntersectPoint);
+            // In group grab mode, the grab callback only sees the group.
+            if ( mGroupGrab && mGrabbedObjects.size() > 1 )
+            {
+               groupObjects();
+               mGrabCallback(std::vector<SceneObjectPtr>(1, mGroupObj),
+                             mIntersectPoint);
+            }
+            else
+            {
+               mGrabCallback(mGrabbedObjects, mIntersectPoint);
+            }
          }
       }
    }
@@ -264,19 +286,34 @@ void MultiObjectGrabStrategy::update(ViewerPtr viewer)
       // mGrabbedObjects is about to be emptied.
       std::for_each(
          mObjConnections.begin(), mObjConnections.end(),
-         boost::bind(&boost::signals::connection::disconnect,
+         boost::bind(&signal::Connection::disconnect,
                      boost::bind(&obj_conn_map_t::value_type::second, _1))
       );
 
       // Update our state to reflect that we are no longer grabbing an object.
       mGrabbing = false;
-      mReleaseCallback(mGrabbedObjects);
+
+      if ( mGroupObj )
+      {
+         mReleaseCallback(std::vector<SceneObjectPtr>(1, mGroupObj));
+         ungroupObjects();
+      }
+      else
+      {
+         mReleaseCallback(mGrabbedObjects);
+      }
+
       mGrabbedObjects.clear();
    }
 }
 
 std::vector<SceneObjectPtr> MultiObjectGrabStrategy::getGrabbedObjects()
 {
+   if ( mGroupObj )
+   {
+      return std::vector<SceneObjectPtr>(1, mGroupObj);
+   }
+
    return mGrabbedObjects;
 }
 
@@ -300,6 +337,7 @@ void MultiObjectGrabStrategy::configure(jccl::ConfigElementPtr elt)
    const std::string choose_btn_prop("choose_button_nums");
    const std::string grab_btn_prop("grab_button_nums");
    const std::string release_btn_prop("release_button_nums");
+   const std::string group_grab_prop("group_grab");
 
    mChooseBtn.configure(elt->getProperty<std::string>(choose_btn_prop),
                         mWandInterface);
@@ -307,6 +345,12 @@ void MultiObjectGrabStrategy::configure(jccl::ConfigElementPtr elt)
                       mWandInterface);
    mReleaseBtn.configure(elt->getProperty<std::string>(release_btn_prop),
                          mWandInterface);
+
+   // Group grabbing was added in version 2.
+   if ( elt->getVersion() >= 2 )
+   {
+      mGroupGrab = elt->getProperty<bool>(group_grab_prop);
+   }
 }
 
 event::ResultType MultiObjectGrabStrategy::
@@ -349,18 +393,17 @@ void MultiObjectGrabStrategy::grabbableObjStateChanged(SceneObjectPtr obj)
    // if it is not grabbable, then it must be removed.
    if ( ! mChosenObjects.empty() )
    {
-      std::vector<SceneObjectPtr>::iterator o =
-         std::find(mChosenObjects.begin(), mChosenObjects.end(), obj);
-
-      if ( o != mChosenObjects.end() && ! (*o)->isGrabbable() )
+      if ( mChosenSet.count(obj) != 0 && ! obj->isGrabbable() )
       {
-         mObjConnections[*o].disconnect();
-         mObjConnections.erase(*o);
+         mObjConnections[obj].disconnect();
+         mObjConnections.erase(obj);
 
-         std::vector<SceneObjectPtr> objs(1, *o);
-         mEventData->selectionListReduced(objs);
+         std::vector<SceneObjectPtr> objs(1, obj);
+         mEventData->postSelectionListReduced(objs);
 
-         mChosenObjects.erase(o);
+         mChosenObjects.erase(std::find(mChosenObjects.begin(),
+                                        mChosenObjects.end(), obj));
+         mChosenSet.erase(obj);
       }
    }
    // If mGrabbedObjects is not empty, then we have grabbed objects, and obj
@@ -376,9 +419,34 @@ void MultiObjectGrabStrategy::grabbableObjStateChanged(SceneObjectPtr obj)
          mObjConnections[*o].disconnect();
          mObjConnections.erase(*o);
 
-         // Inform the code that is using us that we have released a grabbed
-         // object.
-         mReleaseCallback(std::vector<SceneObjectPtr>(1, *o));
+         if ( mGroupObj )
+         {
+            // The object leaves the group. The code that is using us only
+            // knows about the group, so it is only informed when the group
+            // becomes empty.
+            std::vector<GroupMember>::iterator m;
+            for ( m = mGroupMembers.begin(); m != mGroupMembers.end(); ++m )
+            {
+               if ( (*m).obj == obj )
+               {
+                  restoreGroupMember(*m);
+                  mGroupMembers.erase(m);
+                  break;
+               }
+            }
+
+            if ( mGroupMembers.empty() )
+            {
+               mReleaseCallback(std::vector<SceneObjectPtr>(1, mGroupObj));
+               ungroupObjects();
+            }
+         }
+         else
+         {
+            // Inform the code that is using us that we have released a
+            // grabbed object.
+            mReleaseCallback(std::vector<SceneObjectPtr>(1, *o));
+         }
 
          mGrabbedObjects.erase(o);
 
@@ -389,4 +457,165 @@ void MultiObjectGrabStrategy::grabbableObjStateChanged(SceneObjectPtr obj)
    }
 }
 
+void MultiObjectGrabStrategy::groupObjects()
+{
+   vprASSERT(mGrabbedObjects.size() > 1);
+
+   // The group node is added to the parent of the first object. Its
+   // transformation is then in the same space as that of a single grabbed
+   // object.
+   mGroupParent = mGrabbedObjects[0]->getRoot()->getParent();
+   vprASSERT(OSG::NullFC != mGroupParent);
+
+   OSG::Matrix vw_M_p0_osg;
+   mGroupParent->getToWorld(vw_M_p0_osg);
+   gmtl::Matrix44f p0_M_vw;
+   gmtl::set(p0_M_vw, vw_M_p0_osg);
+   gmtl::invert(p0_M_vw);
+
+   mGroupNode = OSG::TransformNodePtr::create();
+
+   mGroupMembers.resize(mGrabbedObjects.size());
+   for ( std::size_t i = 0; i < mGrabbedObjects.size(); ++i )
+   {
+      GroupMember& member(mGroupMembers[i]);
+      member.obj = mGrabbedObjects[i];
+
+      // Hold a reference to the root so that it survives being removed from
+      // its parent.
+      OSG::NodeRefPtr root(member.obj->getRoot());
+      member.parent = root->getParent();
+      vprASSERT(OSG::NullFC != member.parent);
+
+      OSG::NodePtr new_parent(mGroupNode.node());
+
+      // An object with a different parent keeps its world transformation
+      // through a wrapper node that maps its parent space into that of the
+      // group parent.
+      if ( member.parent != mGroupParent )
+      {
+         OSG::Matrix vw_M_p_osg;
+         member.parent->getToWorld(vw_M_p_osg);
+         gmtl::Matrix44f vw_M_p;
+         gmtl::set(vw_M_p, vw_M_p_osg);
+         member.p0_M_p = p0_M_vw * vw_M_p;
+
+         OSG::Matrix p0_M_p_osg;
+         gmtl::set(p0_M_p_osg, member.p0_M_p);
+
+         member.wrapper = OSG::TransformNodePtr::create();
+#if OSG_MAJOR_VERSION < 2
+         OSG::CPEditor wce(member.wrapper.core(),
+                           OSG::Transform::MatrixFieldMask);
+#endif
+         member.wrapper->setMatrix(p0_M_p_osg);
+
+         {
+#if OSG_MAJOR_VERSION < 2
+            OSG::CPEditor gne(mGroupNode.node(), OSG::Node::ChildrenFieldMask);
+#endif
+            mGroupNode.node()->addChild(member.wrapper.node());
+         }
+
+         new_parent = member.wrapper.node();
+      }
+      else
+      {
+         gmtl::identity(member.p0_M_p);
+         member.wrapper = OSG::TransformNodePtr();
+      }
+
+      {
+#if OSG_MAJOR_VERSION < 2
+         OSG::CPEditor pe(member.parent, OSG::Node::ChildrenFieldMask);
+#endif
+         member.parent->subChild(root);
+      }
+
+      {
+#if OSG_MAJOR_VERSION < 2
+         OSG::CPEditor npe(new_parent, OSG::Node::ChildrenFieldMask);
+#endif
+         new_parent->addChild(root);
+      }
+   }
+
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor gpe(mGroupParent, OSG::Node::ChildrenFieldMask);
+#endif
+      mGroupParent->addChild(mGroupNode.node());
+   }
+
+   mGroupObj = DynamicSceneObject::create()->init(mGroupNode.node(),
+                                                  &isNotSceneObject);
+}
+
+void MultiObjectGrabStrategy::ungroupObjects()
+{
+   std::for_each(mGroupMembers.begin(), mGroupMembers.end(),
+                 boost::bind(&MultiObjectGrabStrategy::restoreGroupMember,
+                             this, _1));
+   mGroupMembers.clear();
+
+   if ( OSG::NullFC != mGroupNode.node() )
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor gpe(mGroupParent, OSG::Node::ChildrenFieldMask);
+#endif
+      mGroupParent->subChild(mGroupNode.node());
+   }
+
+   mGroupObj    = DynamicSceneObjectPtr();
+   mGroupNode   = OSG::TransformNodePtr();
+   mGroupParent = OSG::NullFC;
+}
+
+void MultiObjectGrabStrategy::restoreGroupMember(const GroupMember& member)
+{
+   // Bake the group transformation into the transformation of the object:
+   //
+   //    p_M_obj' = p_M_p0 * p0_M_group * p0_M_p * p_M_obj
+   gmtl::Matrix44f p0_M_group;
+   gmtl::set(p0_M_group, mGroupNode->getMatrix());
+
+   gmtl::Matrix44f p_M_obj;
+   gmtl::set(p_M_obj, member.obj->getPos());
+
+   gmtl::Matrix44f p_M_p0;
+   gmtl::invert(p_M_p0, member.p0_M_p);
+
+   const gmtl::Matrix44f new_p_M_obj(p_M_p0 * p0_M_group * member.p0_M_p *
+                                        p_M_obj);
+
+   OSG::NodeRefPtr root(member.obj->getRoot());
+   OSG::NodePtr cur_parent(root->getParent());
+
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor cpe(cur_parent, OSG::Node::ChildrenFieldMask);
+#endif
+      cur_parent->subChild(root);
+   }
+
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor pe(member.parent, OSG::Node::ChildrenFieldMask);
+#endif
+      member.parent->addChild(root);
+   }
+
+   if ( OSG::NullFC != member.wrapper.node() )
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor gne(mGroupNode.node(), OSG::Node::ChildrenFieldMask);
+#endif
+      mGroupNode.node()->subChild(member.wrapper.node());
+   }
+
+   OSG::Matrix new_p_M_obj_osg;
+   gmtl::set(new_p_M_obj_osg, new_p_M_obj);
+   member.obj->moveTo(new_p_M_obj_osg);
+}
+
 }
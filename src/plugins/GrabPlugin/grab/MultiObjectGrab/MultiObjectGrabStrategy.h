@@ -19,18 +19,33 @@
 #ifndef _VRKIT_MULTI_OBJECT_GRAB_STRATEGY_H_
 #define _VRKIT_MULTI_OBJECT_GRAB_STRATEGY_H_
 
+#include <cstddef>
 #include <string>
 #include <vector>
+#include <boost/version.hpp>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/signals/connection.hpp>
+
+#if BOOST_VERSION >= 103600
+#  include <boost/functional/hash.hpp>
+#  include <boost/unordered_set.hpp>
+#else
+#  include <set>
+#endif
 
 #include <gmtl/Matrix.h>
 #include <gmtl/Point.h>
 
+#include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGRefPtr.h>
+#include <OpenSG/OSGCoredNodePtr.h>
+#include <OpenSG/OSGTransform.h>
+
 #include <jccl/Config/ConfigElementPtr.h>
 
 #include <vrkit/SceneObjectPtr.h>
+#include <vrkit/DynamicSceneObjectPtr.h>
 #include <vrkit/scenedata/EventDataPtr.h>
+#include <vrkit/signal/Connection.h>
 #include <vrkit/grab/Strategy.h>
 #include <vrkit/util/DigitalCommand.h>
 
@@ -38,6 +53,16 @@
 namespace vrkit
 {
 
+/**
+ * Grab strategy for choosing any number of objects and then grabbing them
+ * together. In group grab mode, the chosen objects are reparented under a
+ * single transform node for the duration of the grab, and that node is
+ * presented to the Grab Plug-in as the only grabbed object. Moving the
+ * selection then costs the same regardless of the number of objects. When
+ * the objects are released, their transformations are updated to include
+ * the transformation of the group, and they are returned to their
+ * original parents.
+ */
 class MultiObjectGrabStrategy
    : public grab::Strategy
    , public boost::enable_shared_from_this<MultiObjectGrabStrategy>
@@ -107,6 +132,52 @@ private:
     */
    void grabbableObjStateChanged(SceneObjectPtr obj);
 
+   /** @name Group Grabbing */
+   //@{
+   /**
+    * A grabbed object that was reparented under the group node.
+    */
+   struct GroupMember
+   {
+      SceneObjectPtr  obj;
+      OSG::NodeRefPtr parent;    /**< The original parent of the object root */
+
+      /**
+       * The node between the group node and the object root when the
+       * original parent is not the parent of the group node. It holds
+       * \c p0_M_p.
+       */
+      OSG::TransformNodePtr wrapper;
+
+      /**
+       * The transformation from the space of the original parent into the
+       * space of the parent of the group node.
+       */
+      gmtl::Matrix44f p0_M_p;
+   };
+
+   /**
+    * Reparents the objects in \c mGrabbedObjects under a new group node and
+    * creates \c mGroupObj for it.
+    *
+    * @pre \c mGrabbedObjects contains at least two objects.
+    */
+   void groupObjects();
+
+   /**
+    * Returns all grouped objects to their original parents and removes the
+    * group node.
+    */
+   void ungroupObjects();
+
+   /**
+    * Returns the given member of the group to its original parent. The
+    * transformation of the object is changed to include the current group
+    * transformation so that the object does not move.
+    */
+   void restoreGroupMember(const GroupMember& member);
+   //@}
+
    WandInterfacePtr mWandInterface;
 
    EventDataPtr mEventData;
@@ -135,13 +206,33 @@ private:
    std::string mReleaseText;
    //@}
 
+   /** Hashes a scene object by address. */
+   struct SceneObjectHash
+   {
+      std::size_t operator()(const SceneObjectPtr& obj) const
+      {
+#if BOOST_VERSION >= 103600
+         return boost::hash<SceneObject*>()(obj.get());
+#else
+         return reinterpret_cast<std::size_t>(obj.get());
+#endif
+      }
+   };
+
+#if BOOST_VERSION >= 103600
+   typedef boost::unordered_set<SceneObjectPtr, SceneObjectHash> obj_set_t;
+#else
+   typedef std::set<SceneObjectPtr> obj_set_t;
+#endif
+
    /** @name Intersection State */
    //@{
    SceneObjectPtr mCurIsectObject;
    std::vector<SceneObjectPtr> mChosenObjects;
+   obj_set_t mChosenSet;         /**< The elements of \c mChosenObjects */
    gmtl::Point3f mCurIntersectPoint;
    gmtl::Point3f mIntersectPoint;
-   std::vector<boost::signals::connection> mIsectConnections;
+   std::vector<signal::Connection> mIsectConnections;
    //@}
 
    /** @name Grab State */
@@ -150,7 +241,16 @@ private:
    std::vector<SceneObjectPtr> mGrabbedObjects;
    //@}
 
-   typedef std::map<SceneObjectPtr, boost::signals::connection> obj_conn_map_t;
+   /** @name Group Grab State */
+   //@{
+   bool                     mGroupGrab;     /**< Configured grab mode */
+   OSG::NodeRefPtr          mGroupParent;
+   OSG::TransformNodePtr    mGroupNode;
+   DynamicSceneObjectPtr    mGroupObj;      /**< Non-null while grouped */
+   std::vector<GroupMember> mGroupMembers;
+   //@}
+
+   typedef std::map<SceneObjectPtr, signal::Connection> obj_conn_map_t;
    obj_conn_map_t mObjConnections;
 };
 
@@ -21,7 +21,6 @@
 
 #include <string>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/signals/connection.hpp>
 
 #include <gmtl/Matrix.h>
 #include <gmtl/Point.h>
@@ -29,6 +28,7 @@
 #include <jccl/Config/ConfigElementPtr.h>
 
 #include <vrkit/SceneObjectPtr.h>
+#include <vrkit/signal/Connection.h>
 #include <vrkit/grab/Strategy.h>
 #include <vrkit/util/DigitalCommand.h>
 
@@ -132,15 +132,15 @@ private:
    bool mIntersecting;
    SceneObjectPtr mIntersectedObj;
    gmtl::Point3f mIntersectPoint;
-   boost::signals::connection mIsectConnection;
-   boost::signals::connection mDeIsectConnection;
+   signal::Connection mIsectConnection;
+   signal::Connection mDeIsectConnection;
    //@}
 
    /** @name Grab State */
    //@{
    bool mGrabbing;
    SceneObjectPtr mGrabbedObj;
-   boost::signals::connection mGrabbedObjConnection;
+   signal::Connection mGrabbedObjConnection;
    //@}
 };
 
@@ -87,7 +87,7 @@ findIntersection(ViewerPtr viewer, const std::vector<SceneObjectPtr>& objs,
    WandInterfacePtr wand =
       viewer->getUser()->getInterfaceTrader().getWandInterface();
    const gmtl::Matrix44f vp_M_wand_xform(
-      wand->getWandPos()->getData(viewer->getDrawScaleFactor())
+      wand->getSnapshot().getWandPos()
    );
 
    // Reset the intersection test data.
@@ -26,6 +26,7 @@
 #include <OpenSG/OSGLineChunk.h>
 #include <OpenSG/OSGIntersectAction.h>
 #include <OpenSG/OSGTriangleIterator.h>
+#include <OpenSG/OSGDistanceLOD.h>
 
 #include <gmtl/Intersection.h>
 #include <gmtl/Matrix.h>
@@ -130,6 +131,25 @@ OSG::Action::ResultE geometryEnter(enter_t nodeCore, OSG::Action* action)
    return OSG::Action::Continue;
 }
 
+/**
+ * Restricts the intersection traversal of a distance LOD node to its first
+ * child, which holds the most detailed geometry. The simplified levels are
+ * never picked, so the result does not depend on the distance from the
+ * viewer.
+ */
+OSG::Action::ResultE distanceLODEnter(enter_t, OSG::Action* action)
+{
+   OSG::NodePtr node(action->getActNode());
+
+   if ( node->getNChildren() > 0 )
+   {
+      action->useNodeList();
+      action->addNode(node->getChild(0));
+   }
+
+   return OSG::Action::Continue;
+}
+
 }
 
 namespace vrkit
@@ -169,7 +189,9 @@ isect::StrategyPtr RayIntersectionStrategy::init(ViewerPtr viewer)
    }
 
    // If we are going to do triangle-level intersections, then register our
-   // geometry core callback with OSG::IntersectAction.
+   // geometry core callback with OSG::IntersectAction. Levels of detail
+   // are skipped so that the triangles tested are always the full
+   // resolution ones.
    if ( mTriangleIsect )
    {
       OSG::IntersectAction::registerEnterDefault(
@@ -180,6 +202,17 @@ isect::StrategyPtr RayIntersectionStrategy::init(ViewerPtr viewer)
          >(geometryEnter)
 #else
          &geometryEnter
+#endif
+      );
+
+      OSG::IntersectAction::registerEnterDefault(
+         OSG::DistanceLOD::getClassType(),
+#if OSG_MAJOR_VERSION < 2
+         OSG::osgTypedFunctionFunctor2CPtrRef<
+            OSG::Action::ResultE, OSG::CNodePtr, OSG::Action*
+         >(distanceLODEnter)
+#else
+         &distanceLODEnter
 #endif
       );
    }
@@ -204,14 +237,10 @@ isect::StrategyPtr RayIntersectionStrategy::init(ViewerPtr viewer)
    typedef boost::signal<void (bool)> sig_type;
    std::string sig_name("Set Intersection Ray Visibility");
 
-   if ( ! sig_repos->hasSignal(sig_name) )
-   {
-      sig_repos->addSignal(sig_name, signal::Container<sig_type>::create());
-   }
-
-   // Connect new signal to slot after SwitchNode creation
+   // Connect new signal to slot after SwitchNode creation. The signal is
+   // registered if no other code has done so yet.
    mRayIsectConn =
-      sig_repos->getSignal<sig_type>(sig_name)->connect(
+      sig_repos->getOrAddSignal<sig_type>(sig_name)->connect(
          boost::bind(&RayIntersectionStrategy::setVisible, this, _1)
       );
 
@@ -223,7 +252,7 @@ void RayIntersectionStrategy::update(ViewerPtr viewer)
    WandInterfacePtr wand =
       viewer->getUser()->getInterfaceTrader().getWandInterface();
    const gmtl::Matrix44f vp_M_wand(
-      wand->getWandPos()->getData(viewer->getDrawScaleFactor())
+      wand->getSnapshot().getWandPos()
    );
 
    gmtl::Rayf wand_ray(gmtl::Vec3f(0.0f, 0.0f, 0.0f),
@@ -335,7 +364,7 @@ findIntersection(ViewerPtr viewer, const std::vector<SceneObjectPtr>& objs,
    WandInterfacePtr wand =
       viewer->getUser()->getInterfaceTrader().getWandInterface();
    const gmtl::Matrix44f vp_M_wand(
-      wand->getWandPos()->getData(viewer->getDrawScaleFactor())
+      wand->getSnapshot().getWandPos()
    );
 
    // Reset the intersection test data.
@@ -86,6 +86,9 @@ void BasicMoveStrategy::objectsGrabbed(ViewerPtr,
                                        const gmtl::Point3f&,
                                        const gmtl::Matrix44f& vp_M_wand)
 {
+   mGrabbedObjs.reserve(mGrabbedObjs.size() + objs.size());
+   m_wand_M_pobj.reserve(m_wand_M_pobj.size() + objs.size());
+
    std::for_each(objs.begin(), objs.end(),
                  boost::bind(&BasicMoveStrategy::objectGrabbed, this, _1,
                              vp_M_wand));
@@ -95,13 +98,45 @@ void
 BasicMoveStrategy::objectsReleased(ViewerPtr,
                                    const std::vector<SceneObjectPtr>& objs)
 {
-   // This does not use std::for_each() because the cast needed to
-   // disambiguate which std::map<...>::erase() overload to use would make
-   // the code virtually unreadable.
+   bool removed(false);
+
+   // Clear the slots of the released objects.
    std::vector<SceneObjectPtr>::const_iterator o;
    for ( o = objs.begin(); o != objs.end(); ++o )
    {
-      m_wand_M_pobj_map.erase(*o);
+      const std::map<SceneObjectPtr, std::size_t>::iterator i =
+         mGrabbedIndex.find(*o);
+
+      if ( i != mGrabbedIndex.end() )
+      {
+         mGrabbedObjs[(*i).second].reset();
+         mGrabbedIndex.erase(i);
+         removed = true;
+      }
+   }
+
+   // Close the gaps in a single pass that preserves the order of the
+   // objects that are still grabbed.
+   if ( removed )
+   {
+      std::size_t dst(0);
+      for ( std::size_t src = 0; src < mGrabbedObjs.size(); ++src )
+      {
+         if ( mGrabbedObjs[src] )
+         {
+            if ( dst != src )
+            {
+               mGrabbedObjs[dst] = mGrabbedObjs[src];
+               m_wand_M_pobj[dst] = m_wand_M_pobj[src];
+               mGrabbedIndex[mGrabbedObjs[dst]] = dst;
+            }
+
+            ++dst;
+         }
+      }
+
+      mGrabbedObjs.resize(dst);
+      m_wand_M_pobj.resize(dst);
    }
 }
 
@@ -113,7 +148,6 @@ BasicMoveStrategy::computeMove(ViewerPtr, SceneObjectPtr obj,
    // pobj_M_vp is the inverse of the object in view platform space.
    OSG::Matrix world_xform;
    vprASSERT(obj->getRoot() != OSG::NullFC);
-   vprASSERT(m_wand_M_pobj_map.count(obj) != 0);
 
    // If we have no parent then we want to use the identity.
    if (obj->getRoot()->getParent() != OSG::NullFC)
@@ -127,7 +161,51 @@ BasicMoveStrategy::computeMove(ViewerPtr, SceneObjectPtr obj,
 
    const gmtl::Matrix44f pobj_M_wand = pobj_M_vp * vp_M_wand;
 
-   return pobj_M_wand * m_wand_M_pobj_map[obj] * curObjMat;
+   return pobj_M_wand * getGrabOffset(obj) * curObjMat;
+}
+
+void BasicMoveStrategy::computeMoves(ViewerPtr, const SceneObjectPtr* objs,
+                                     gmtl::Matrix44f* objPos,
+                                     const std::size_t count,
+                                     const gmtl::Matrix44f& vp_M_wand)
+{
+   OSG::NodePtr last_parent(OSG::NullFC);
+   gmtl::Matrix44f pobj_M_wand;
+
+   for ( std::size_t i = 0; i < count; ++i )
+   {
+      const SceneObjectPtr& obj(objs[i]);
+      vprASSERT(obj->getRoot() != OSG::NullFC);
+
+      const OSG::NodePtr parent(obj->getRoot()->getParent());
+
+      if ( 0 == i || parent != last_parent )
+      {
+         // pobj_M_vp is the inverse of the object in view platform space.
+         // If we have no parent then we want to use the identity.
+         OSG::Matrix world_xform;
+         if ( parent != OSG::NullFC )
+         {
+            parent->getToWorld(world_xform);
+         }
+
+         gmtl::Matrix44f pobj_M_vp;
+         gmtl::set(pobj_M_vp, world_xform);
+         gmtl::invert(pobj_M_vp);
+
+         pobj_M_wand = pobj_M_vp * vp_M_wand;
+         last_parent = parent;
+      }
+
+      // The batch is normally in grab order, so the offset is at the same
+      // index. Otherwise, it has to be looked up.
+      const gmtl::Matrix44f& wand_M_pobj(
+         i < mGrabbedObjs.size() && mGrabbedObjs[i] == obj
+            ? m_wand_M_pobj[i] : getGrabOffset(obj)
+      );
+
+      objPos[i] = pobj_M_wand * wand_M_pobj * objPos[i];
+   }
 }
 
 void BasicMoveStrategy::objectGrabbed(SceneObjectPtr obj,
@@ -154,7 +232,29 @@ void BasicMoveStrategy::objectGrabbed(SceneObjectPtr obj,
 
    gmtl::invert(wand_M_vp, vp_M_wand);
 
-   m_wand_M_pobj_map[obj] = wand_M_vp * vp_M_pobj;
+   const std::map<SceneObjectPtr, std::size_t>::iterator i =
+      mGrabbedIndex.find(obj);
+
+   // An object that is grabbed again keeps its place.
+   if ( i != mGrabbedIndex.end() )
+   {
+      m_wand_M_pobj[(*i).second] = wand_M_vp * vp_M_pobj;
+   }
+   else
+   {
+      mGrabbedIndex[obj] = mGrabbedObjs.size();
+      mGrabbedObjs.push_back(obj);
+      m_wand_M_pobj.push_back(wand_M_vp * vp_M_pobj);
+   }
+}
+
+const gmtl::Matrix44f&
+BasicMoveStrategy::getGrabOffset(const SceneObjectPtr& obj) const
+{
+   const std::map<SceneObjectPtr, std::size_t>::const_iterator i =
+      mGrabbedIndex.find(obj);
+   vprASSERT(i != mGrabbedIndex.end());
+   return m_wand_M_pobj[(*i).second];
 }
 
 }
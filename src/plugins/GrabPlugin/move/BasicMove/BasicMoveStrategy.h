@@ -20,6 +20,7 @@
 #define _VRKIT_BASIC_MOVE_STRATEGY_H_
 
 #include <map>
+#include <vector>
 #include <boost/enable_shared_from_this.hpp>
 
 #include <vrkit/move/Strategy.h>
@@ -70,14 +71,39 @@ public:
                                        const gmtl::Matrix44f& vp_M_wand,
                                        const gmtl::Matrix44f& curObjMat);
 
+   /**
+    * Moves a batch of objects. Grabbed objects often share a parent (for
+    * example, the parts of an assembly), so the transformation from the
+    * wand into the parent space is computed only when the parent differs
+    * from that of the previous object. When \p objs is in the order in
+    * which the objects were grabbed (as it is when this is invoked by the
+    * Grab Plug-in), the grab offsets are read in order without any lookup.
+    *
+    * @since 0.51.19
+    */
+   virtual void computeMoves(ViewerPtr viewer, const SceneObjectPtr* objs,
+                             gmtl::Matrix44f* objPos, const std::size_t count,
+                             const gmtl::Matrix44f& vp_M_wand);
+
 private:
    void objectGrabbed(SceneObjectPtr obj, const gmtl::Matrix44f& vp_M_wand);
 
-   /**
-    * Map of transformations from the wand coordinate space into the
-    * coordinate space of the parent of a grabbed scene object.
+   /** Returns the grab offset of the given grabbed object. */
+   const gmtl::Matrix44f& getGrabOffset(const SceneObjectPtr& obj) const;
+
+   /** @name Grabbed Objects
+    * The grabbed objects and the transformations from the wand coordinate
+    * space into the coordinate space of their parents are stored in
+    * parallel arrays. Objects are added and removed in the same way as the
+    * Grab Plug-in does for its own array of grabbed objects, so the two
+    * arrays have the same order. \c mGrabbedIndex maps an object to its
+    * index in these arrays.
     */
-   std::map<SceneObjectPtr, gmtl::Matrix44f> m_wand_M_pobj_map;
+   //@{
+   std::vector<SceneObjectPtr>           mGrabbedObjs;
+   std::vector<gmtl::Matrix44f>          m_wand_M_pobj;
+   std::map<SceneObjectPtr, std::size_t> mGrabbedIndex;
+   //@}
 };
 
 }
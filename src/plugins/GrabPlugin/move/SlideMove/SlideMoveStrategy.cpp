@@ -131,11 +131,11 @@ SlideMoveStrategy::computeMove(ViewerPtr viewer, SceneObjectPtr obj,
 {
    WandInterfacePtr wand_if =
       viewer->getUser()->getInterfaceTrader().getWandInterface();
-   gadget::AnalogInterface& analog_dev = wand_if->getAnalog(mAnalogNum);
+   const WandSnapshot& wand_state(wand_if->getSnapshot());
 
-   if ( ! analog_dev->isStupefied() )
+   if ( ! wand_state.isAnalogStupefied(mAnalogNum) )
    {
-      const float analog_value(analog_dev->getData());
+      const float analog_value(wand_state.getAnalog(mAnalogNum));
       //std::cout << "Analog Value: " << analog_value << std::endl;
 
       // Rescale [0,1] to [-1,1]
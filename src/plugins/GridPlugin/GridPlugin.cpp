@@ -175,15 +175,14 @@ void GridPlugin::update(ViewerPtr viewer)
          // slid along its Z-axis.
          if ( -1 != mAnalogNum )
          {
-            gadget::AnalogInterface& analog_dev =
-               mWandInterface->getAnalog(mAnalogNum);
+            const WandSnapshot& wand_state(mWandInterface->getSnapshot());
 
             // Only check for analog data if the indicated analog device is not
             // stupefied.
-            if ( ! analog_dev->isStupefied() )
+            if ( ! wand_state.isAnalogStupefied(mAnalogNum) )
             {
                const float to_meters(viewer->getDrawScaleFactor());
-               const float analog_value(analog_dev->getData());
+               const float analog_value(wand_state.getAnalog(mAnalogNum));
 
                // Rescale [0,1] to [-1,1].
                in_out_val = analog_value * 2.0 - 1.0f;
@@ -37,6 +37,7 @@
 #include <gmtl/gmtl.h>
 #include <gmtl/External/OpenSGConvert.h>
 
+#include <vpr/Sync/Guard.h>
 #include <vpr/Util/FileUtils.h>
 #include <jccl/Config/ConfigElement.h>
 
@@ -44,6 +45,7 @@
 #include <vrkit/Viewer.h>
 #include <vrkit/Status.h>
 #include <vrkit/Version.h>
+#include <vrkit/util/SceneFileLock.h>
 #include <vrkit/plugin/Creator.h>
 #include <vrkit/plugin/Info.h>
 #include <vrkit/exceptions/PluginException.h>
@@ -216,6 +218,10 @@ viewer::PluginPtr LogoPlugin::init(ViewerPtr viewer)
       else if ( ! model_name.empty() )
       {
          VRKIT_STATUS << "      Loading model: " << model_name << std::endl;
+
+         // This plug-in may be initialized concurrently with others that
+         // read scene files.
+         vpr::Guard<vpr::Mutex> guard(util::getSceneFileLock());
          model_root =
 #if OSG_MAJOR_VERSION < 2
             OSG::SceneFileHandler::the().read(model_name.c_str());
@@ -193,18 +193,11 @@ viewer::PluginPtr ModeHarnessPlugin::init(ViewerPtr viewer)
                          << std::endl;
 
             typedef boost::signal<void ()> signal_type;
-            typedef signal::Container<signal_type> signal_container_type;
 
-            // Ensure that sig_name is a known signal.
-            if ( ! signal_data->hasSignal(sig_name) )
-            {
-               signal_data->addSignal(sig_name,
-                                      signal_container_type::create());
-            }
-
-            // Connect the newly instantiated component with its signal.
+            // Connect the newly instantiated component with its signal,
+            // registering sig_name as a known signal if necessary.
             mConnections.push_back(
-               signal_data->getSignal<signal_type>(sig_name)->connect(
+               signal_data->getOrAddSignal<signal_type>(sig_name)->connect(
                   boost::bind(&ModeHarnessPlugin::prepComponentSwitch,
                               this, component)
                )
@@ -16,9 +16,17 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
 #include <vector>
 #include <boost/bind.hpp>
+#include <boost/ref.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/mpl/vector.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/convenience.hpp>
 
 #include <gmtl/Matrix.h>
 #include <gmtl/Generate.h>
@@ -28,16 +36,36 @@
 #include <OpenSG/OSGNode.h>
 #include <OpenSG/OSGFieldContainerFactory.h>
 #include <OpenSG/OSGSceneFileHandler.h>
+#include <OpenSG/OSGSimpleGeometry.h>
+#include <OpenSG/OSGThread.h>
+#include <OpenSG/OSGChangeList.h>
+
+#include <vpr/Thread/Thread.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Sync/Guard.h>
+#include <vpr/Util/Interval.h>
 
 #include <jccl/Config/ConfigElement.h>
+#include <gadget/Type/PositionProxy.h>
 
 #include <vrkit/Scene.h>
 #include <vrkit/Viewer.h>
+#include <vrkit/User.h>
+#include <vrkit/ViewPlatform.h>
 #include <vrkit/DynamicSceneObject.h>
 #include <vrkit/DynamicSceneObjectTransform.h>
 #include <vrkit/Status.h>
 #include <vrkit/Version.h>
+#include <vrkit/scenedata/StatusPanelData.h>
+#include <vrkit/scenedata/PagingData.h>
+#include <vrkit/scenedata/CollisionData.h>
+#include <vrkit/paging/ChunkFile.h>
+#include <vrkit/paging/PagedModel.h>
 #include <vrkit/util/CoreTypePredicate.h>
+#include <vrkit/util/CoreTypeSeqPredicate.h>
+#include <vrkit/util/TaskGraph.h>
+#include <vrkit/util/SceneCache.h>
+#include <vrkit/util/SceneFileLock.h>
 #include <vrkit/plugin/Creator.h>
 #include <vrkit/plugin/Info.h>
 #include <vrkit/exceptions/PluginException.h>
@@ -46,6 +74,7 @@
 
 
 using namespace boost::assign;
+namespace fs = boost::filesystem;
 
 static const vrkit::plugin::Info sInfo(
    "com.infiscape", "ModelLoaderPlugin",
@@ -80,6 +109,100 @@ VRKIT_PLUGIN_API(vrkit::plugin::CreatorBase*) getCreator()
 
 }
 
+namespace
+{
+
+/**
+ * Registers the calling model loader worker thread with OpenSG so that it
+ * can create field containers.
+ */
+void initLoaderWorker(const unsigned int index)
+{
+   std::ostringstream name_stream;
+   name_stream << "vrkit model loader worker " << index;
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::ExternalThread* thread =
+      OSG::ExternalThread::get(name_stream.str().c_str());
+#else
+   OSG::ExternalThreadRefPtr thread =
+      OSG::ExternalThread::get(name_stream.str().c_str(), true);
+#endif
+
+   if ( ! thread->isInitialized() )
+   {
+      thread->initialize(0);
+   }
+}
+
+/**
+ * Moves the changes recorded by the calling model loader worker thread into
+ * the change list of the thread that is loading the models.
+ */
+void mergeLoaderWorkerChanges(vpr::Mutex* lock, OSG::ChangeList* targetList,
+                              const unsigned int)
+{
+   vpr::Guard<vpr::Mutex> guard(*lock);
+
+   OSG::ChangeList* worker_list = OSG::Thread::getCurrentChangeList();
+   targetList->merge(*worker_list);
+#if OSG_MAJOR_VERSION < 2
+   worker_list->clearAll();
+#else
+   worker_list->clear();
+#endif
+}
+
+/**
+ * Adds the root of a loaded model to the scene and registers its scene
+ * object and paged model (if any) with the viewer. The collision hierarchy
+ * of the scene is invalidated. This must be invoked in the application
+ * thread.
+ */
+void attachModel(vrkit::ViewerPtr viewer, OSG::NodeRefPtr modelRoot,
+                 vrkit::SceneObjectPtr sceneObj,
+                 vrkit::paging::PagedModelPtr pagedModel)
+{
+   OSG::TransformNodePtr scene_xform_root =
+      viewer->getSceneObj()->getTransformRoot();
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor sxre(scene_xform_root.node(), OSG::Node::ChildrenFieldMask);
+#endif
+   scene_xform_root.node()->addChild(modelRoot);
+   viewer->getSceneObj()->getSceneData<vrkit::CollisionData>()->invalidate();
+
+   if ( sceneObj )
+   {
+      viewer->addObject(sceneObj);
+   }
+
+   if ( pagedModel )
+   {
+      viewer->getSceneObj()->getSceneData<vrkit::PagingData>()->addModel(
+         pagedModel
+      );
+   }
+}
+
+/**
+ * Removes the given node from the scene and invalidates the collision
+ * hierarchy of the scene. This must be invoked in the application thread.
+ */
+void detachNode(vrkit::ViewerPtr viewer, OSG::NodeRefPtr node)
+{
+   OSG::TransformNodePtr scene_xform_root =
+      viewer->getSceneObj()->getTransformRoot();
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor sxre(scene_xform_root.node(), OSG::Node::ChildrenFieldMask);
+#endif
+   scene_xform_root.node()->subChild(node);
+   viewer->getSceneObj()->getSceneData<vrkit::CollisionData>()->invalidate();
+}
+
+}
+
 namespace vrkit
 {
 
@@ -93,16 +216,36 @@ std::string ModelLoaderPlugin::getDescription()
    return std::string("Model Loader Plug-in");
 }
 
+ModelLoaderPlugin::~ModelLoaderPlugin()
+{
+   mDestinationConn.disconnect();
+   stopStreaming();
+}
+
 viewer::PluginPtr ModelLoaderPlugin::init(ViewerPtr viewer)
 {
    const std::string plugin_tkn("model_loader_plugin");
    const std::string units_to_meters_tkn("units_to_meters");
+   const std::string load_threads_tkn("load_threads");
+   const std::string streaming_tkn("streaming");
+   const std::string stream_budget_tkn("stream_budget");
+   const std::string optimization_tkn("optimization");
    const std::string position_tkn("position");
    const std::string rotation_tkn("rotation");
    const std::string models_tkn("models");
    const std::string path_tkn("path");
    const std::string grabbing_tkn("enable_grabbing");
    const std::string core_type_tkn("core_type");
+   const std::string bounds_tkn("placeholder_bounds");
+   const std::string lod_error_tkn("lod_error");
+   const std::string lod_range_tkn("lod_range");
+   const std::string lod_min_tris_tkn("lod_min_triangles");
+   const std::string paging_budget_tkn("paging_budget");
+   const std::string paging_threads_tkn("paging_threads");
+   const std::string paging_view_angle_tkn("paging_view_angle");
+   const std::string paging_report_tkn("paging_report_interval");
+   const std::string paged_tkn("paged");
+   const std::string chunk_tris_tkn("chunk_triangles");
 
    const unsigned int req_cfg_version(1);
 
@@ -132,164 +275,903 @@ viewer::PluginPtr ModelLoaderPlugin::init(ViewerPtr viewer)
    // Get the scaling factor
    const float to_meters = elt->getProperty<float>(units_to_meters_tkn);
 
-   // Get the paths to all the models, load them, and add them to the scene
-   ScenePtr scene = viewer->getSceneObj();
-   OSG::TransformNodePtr scene_xform_root = scene->getTransformRoot();
+   // The number of load threads was added in version 2.
+   unsigned int load_threads(0);
+   if ( elt->getVersion() >= 2 )
+   {
+      load_threads = elt->getProperty<unsigned int>(load_threads_tkn);
+   }
 
-#if OSG_MAJOR_VERSION < 2
-   OSG::CPEditor sxre(scene_xform_root.node(), OSG::Node::ChildrenFieldMask);
-#endif
+   // Streaming was added in version 3.
+   bool streaming(false);
+   if ( elt->getVersion() >= 3 )
+   {
+      streaming     = elt->getProperty<bool>(streaming_tkn);
+      mStreamBudget = elt->getProperty<float>(stream_budget_tkn);
+   }
 
+   // Scene optimization was added in version 4.
+   mOptimizer.setOperations(0);
+   if ( elt->getVersion() >= 4 )
+   {
+      unsigned int operations(0);
+      const unsigned int num_ops(elt->getNum(optimization_tkn));
+      for ( unsigned int i = 0; i < num_ops; ++i )
+      {
+         const std::string op_name =
+            elt->getProperty<std::string>(optimization_tkn, i);
+
+         try
+         {
+            operations |= util::SceneOptimizer::getOperation(op_name);
+         }
+         catch (Exception&)
+         {
+            VRKIT_STATUS << "Skipping unknown scene optimization '" << op_name
+                         << "'" << std::endl;
+         }
+      }
+
+      mOptimizer.setOperations(operations);
+   }
+
+   // Paging was added in version 5. The budget is given in megabytes and
+   // the view angle in degrees.
+   if ( elt->getVersion() >= 5 )
+   {
+      const float budget_mb(elt->getProperty<float>(paging_budget_tkn));
+      mPagingBudget = budget_mb > 0.0f
+                         ? vpr::Uint64(budget_mb * 1024.0f * 1024.0f) : 0;
+      mPagingThreads = elt->getProperty<unsigned int>(paging_threads_tkn);
+      mPagingViewAngle = gmtl::Math::deg2Rad(
+         elt->getProperty<float>(paging_view_angle_tkn)
+      );
+      mPagingReportInterval = elt->getProperty<float>(paging_report_tkn);
+   }
+
+   // Get the paths and transformations of all the models.
    const unsigned int num_models(elt->getNum(models_tkn));
+   mModelCfgs.resize(num_models);
    for ( unsigned int i = 0; i < num_models; ++i )
    {
       jccl::ConfigElementPtr model_elt =
          elt->getProperty<jccl::ConfigElementPtr>(models_tkn, i);
       vprASSERT(model_elt.get() != NULL);
-      const std::string model_path =
-         model_elt->getProperty<std::string>(path_tkn);
-      OSG::NodeRefPtr model_node(
-#if OSG_MAJOR_VERSION < 2
-         OSG::SceneFileHandler::the().read(model_path.c_str())
-#else
-         OSG::SceneFileHandler::the()->read(model_path.c_str())
-#endif
-      );
 
-      if ( model_node != OSG::NullFC )
+      ModelConfig& cfg(mModelCfgs[i]);
+      cfg.path = model_elt->getProperty<std::string>(path_tkn);
+
+      // Set up the model switch transform
+      const float xt =
+         model_elt->getProperty<float>(position_tkn, 0) * to_meters;
+      const float yt =
+         model_elt->getProperty<float>(position_tkn, 1) * to_meters;
+      const float zt =
+         model_elt->getProperty<float>(position_tkn, 2) * to_meters;
+
+      const float xr = model_elt->getProperty<float>(rotation_tkn, 0);
+      const float yr = model_elt->getProperty<float>(rotation_tkn, 1);
+      const float zr = model_elt->getProperty<float>(rotation_tkn, 2);
+
+      gmtl::Coord3fXYZ coord;
+      coord.pos().set(xt,yt,zt);
+      coord.rot().set(gmtl::Math::deg2Rad(xr), gmtl::Math::deg2Rad(yr),
+                      gmtl::Math::deg2Rad(zr));
+
+      // Set at T*R
+      gmtl::set(cfg.xform, gmtl::make<gmtl::Matrix44f>(coord));
+
+      cfg.grabbable = model_elt->getProperty<bool>(grabbing_tkn);
+
+      // Paging was added in version 5. Paged geometry exists only on the
+      // node that loaded it, so paged models cannot be grabbed, and each
+      // chunk is small enough that it gets no levels of detail.
+      if ( model_elt->getVersion() >= 5 )
       {
-         // Set up the model switch transform
-         const float xt =
-            model_elt->getProperty<float>(position_tkn, 0) * to_meters;
-         const float yt =
-            model_elt->getProperty<float>(position_tkn, 1) * to_meters;
-         const float zt =
-            model_elt->getProperty<float>(position_tkn, 2) * to_meters;
-
-         const float xr = model_elt->getProperty<float>(rotation_tkn, 0);
-         const float yr = model_elt->getProperty<float>(rotation_tkn, 1);
-         const float zr = model_elt->getProperty<float>(rotation_tkn, 2);
-
-         gmtl::Coord3fXYZ coord;
-         coord.pos().set(xt,yt,zt);
-         coord.rot().set(gmtl::Math::deg2Rad(xr), gmtl::Math::deg2Rad(yr),
-                         gmtl::Math::deg2Rad(zr));
-
-         // Set at T*R
-         OSG::Matrix xform_mat_osg;
-         gmtl::set(xform_mat_osg, gmtl::make<gmtl::Matrix44f>(coord));
-
-         OSG::NodeRefPtr child_root;
-
-         // If this model is supposed to be grabbable, we create a vrkit
-         // dynamic scene object for it. As a result, we can be assured
-         // that the root node will have a core of type OSG::Transform.
-         if ( model_elt->getProperty<bool>(grabbing_tkn) )
+         cfg.paged = model_elt->getProperty<bool>(paged_tkn);
+         cfg.chunkTriangles =
+            model_elt->getProperty<unsigned int>(chunk_tris_tkn);
+
+         if ( cfg.paged && cfg.grabbable )
          {
-            std::vector<OSG::FieldContainerType*> core_types;
-            const unsigned int num_types = model_elt->getNum(core_type_tkn);
-            for ( unsigned int t = 0; t < num_types; ++t )
-            {
-               const std::string type_name = 
-                  model_elt->getProperty<std::string>(core_type_tkn, i);
-               OSG::FieldContainerType* fct =
-                  OSG::FieldContainerFactory::the()->findType(
-                     type_name.c_str()
-                  );
-
-               if ( NULL != fct )
-               {
-                  core_types.push_back(fct);
-               }
-               else
-               {
-                  VRKIT_STATUS << "Skipping unknown type '" << type_name
-                               << "'" << std::endl;
-               }
-            }
+            VRKIT_STATUS << "Grabbing is not supported for paged model '"
+                         << cfg.path << "'" << std::endl;
+            cfg.grabbable = false;
+         }
+      }
 
-            DynamicSceneObjectPtr scene_obj;
+      if ( cfg.grabbable )
+      {
+         const unsigned int num_types = model_elt->getNum(core_type_tkn);
+         for ( unsigned int t = 0; t < num_types; ++t )
+         {
+            const std::string type_name =
+               model_elt->getProperty<std::string>(core_type_tkn, t);
+            OSG::FieldContainerType* fct =
+               OSG::FieldContainerFactory::the()->findType(
+                  type_name.c_str()
+               );
 
-            if ( ! core_types.empty() )
+            if ( NULL != fct )
             {
-               util::CoreTypePredicate pred(core_types);
-               scene_obj = DynamicSceneObject::create()->init(model_node,
-                                                              pred, true);
+               cfg.coreTypes.push_back(fct);
             }
             else
             {
-               scene_obj =
-                  DynamicSceneObjectTransform::create()->init(model_node);
+               VRKIT_STATUS << "Skipping unknown type '" << type_name
+                            << "'" << std::endl;
             }
+         }
+      }
+
+      // The placeholder bounds were added in version 3. They are given in
+      // the coordinate frame of the model.
+      if ( model_elt->getVersion() >= 3 )
+      {
+         gmtl::Point3f min, max;
+         for ( unsigned int c = 0; c < 3; ++c )
+         {
+            min[c] = model_elt->getProperty<float>(bounds_tkn, c) * to_meters;
+            max[c] =
+               model_elt->getProperty<float>(bounds_tkn, c + 3) * to_meters;
+         }
+
+         if ( min[0] < max[0] && min[1] < max[1] && min[2] < max[2] )
+         {
+            cfg.bounds.setMin(min);
+            cfg.bounds.setMax(max);
+            cfg.bounds.setEmpty(false);
+         }
+      }
+
+      // The level of detail settings were added in version 4. The errors
+      // are in the units of the model, and the ranges are scaled like the
+      // position.
+      if ( model_elt->getVersion() >= 4 && ! cfg.paged )
+      {
+         std::vector<float> errors;
+         const unsigned int num_errors(model_elt->getNum(lod_error_tkn));
+         for ( unsigned int e = 0; e < num_errors; ++e )
+         {
+            errors.push_back(model_elt->getProperty<float>(lod_error_tkn, e));
+         }
 
-            // scene_obj's root will be added as a child of
-            // scene_xform_root.
-            child_root = scene_obj->getRoot();
-            scene_obj->moveTo(xform_mat_osg);
-            viewer->addObject(scene_obj);
+         std::vector<float> ranges;
+         const unsigned int num_ranges(model_elt->getNum(lod_range_tkn));
+         for ( unsigned int r = 0; r < num_ranges; ++r )
+         {
+            ranges.push_back(
+               model_elt->getProperty<float>(lod_range_tkn, r) * to_meters
+            );
+         }
+
+         cfg.lodGen.setLevels(errors, ranges);
+         cfg.lodGen.setMinTriangles(
+            model_elt->getProperty<unsigned int>(lod_min_tris_tkn)
+         );
+      }
+   }
+
+   mSceneCache = viewer->getSceneCache();
+
+   // The generated levels of detail are pinned during view platform
+   // transitions so that the finer levels needed at the destination are
+   // ready when the view platform gets there. This plug-in may be
+   // initialized concurrently with others, so the connection to the view
+   // platform is made by the application thread.
+   for ( unsigned int i = 0; i < num_models; ++i )
+   {
+      if ( mModelCfgs[i].lodGen.isEnabled() )
+      {
+         viewer->callOnMainThread(
+            boost::bind(&ModelLoaderPlugin::connectDestination, this, viewer)
+         );
+         break;
+      }
+   }
+
+   if ( streaming )
+   {
+      startStreaming(viewer, load_threads);
+   }
+   else
+   {
+      loadModels(viewer, load_threads);
+   }
+
+   return shared_from_this();
+}
+
+bool ModelLoaderPlugin::canInitConcurrently() const
+{
+   return true;
+}
+
+void ModelLoaderPlugin::update(ViewerPtr viewer)
+{
+   if ( mPagingReportInterval > 0.0f )
+   {
+      const vpr::Interval now(vpr::Interval::now());
+      if ( (now - mLastPagingReport).secf() >= mPagingReportInterval )
+      {
+         mLastPagingReport = now;
+
+         const paging::PagedModel::Stats stats =
+            viewer->getSceneObj()->getSceneData<PagingData>()->getStats();
+
+         if ( stats.numChunks > 0 )
+         {
+            VRKIT_STATUS << "Paging: " << stats.numResident << " of "
+                         << stats.numChunks << " chunk(s) resident ("
+                         << stats.residentBytes / (1024 * 1024) << " MB), "
+                         << stats.numPending << " pending, "
+                         << stats.numLoads << " load(s) averaging "
+                         << stats.averageLoadTime << " ms (max "
+                         << stats.maxLoadTime << " ms), "
+                         << stats.numEvictions << " eviction(s), "
+                         << stats.numFailures << " failure(s)" << std::endl;
          }
-         // If this model is not supposed to be grabbable, we examine the
-         // core of the root node.
-         else
+      }
+   }
+
+   if ( mLODPrefetcher.hasPinnedNodes() &&
+        ! viewer->getUser()->getViewPlatform().hasDestination() )
+   {
+      mLODPrefetcher.release();
+   }
+
+   if ( mStreamWorkers.empty() )
+   {
+      return;
+   }
+
+   mStreamCond.acquire();
+   {
+      // Let the streaming threads that have read a model add their OpenSG
+      // changes to the change list of this thread. This has to happen
+      // before the models are added to the scene so that the changes reach
+      // cluster slaves in the right order.
+      if ( mMergesPending > 0 )
+      {
+         mAppChangeList   = OSG::Thread::getCurrentChangeList();
+         mMergeWindowOpen = true;
+         mStreamCond.broadcast();
+
+         while ( mMergesPending > 0 )
          {
-            OSG::NodeCorePtr root_core = model_node->getCore();
-            OSG::TransformPtr xform_core =
+            mStreamCond.wait();
+         }
+
+         mMergeWindowOpen = false;
+      }
+
+      mReadyModels.insert(mReadyModels.end(), mStreamedModels.begin(),
+                          mStreamedModels.end());
+      mStreamedModels.clear();
+   }
+   mStreamCond.release();
+
+   // Add models to the scene until the time budget for this frame is used
+   // up. At least one model is added per frame.
+   const vpr::Interval start(vpr::Interval::now());
+   while ( ! mReadyModels.empty() )
+   {
+      attachStreamedModel(viewer, mReadyModels.front());
+      mReadyModels.pop_front();
+      ++mNumStreamed;
+
+      if ( (vpr::Interval::now() - start).msecf() >= mStreamBudget )
+      {
+         break;
+      }
+   }
+
+   if ( mNumStreamed == mModelCfgs.size() )
+   {
+      stopStreaming();
+      mPlaceholders.clear();
+
+      VRKIT_STATUS << "Finished streaming " << mModelCfgs.size()
+                   << " model(s)" << std::endl;
+   }
+}
+
+void ModelLoaderPlugin::loadModel(const ModelConfig& cfg,
+                                  LoadedModel* result) const
+{
+   if ( cfg.paged )
+   {
+      loadPagedModel(cfg, result);
+      return;
+   }
+
+   OSG::NodeRefPtr model_node(readModel(cfg));
+
+   // If this model is supposed to be grabbable, we create a vrkit dynamic
+   // scene object for it. As a result, we can be assured that the root node
+   // will have a core of type OSG::Transform.
+   if ( cfg.grabbable )
+   {
+      DynamicSceneObjectPtr scene_obj;
+
+      if ( ! cfg.coreTypes.empty() )
+      {
+         util::CoreTypePredicate pred(cfg.coreTypes);
+         scene_obj = DynamicSceneObject::create()->init(model_node, pred,
+                                                        true);
+      }
+      else
+      {
+         scene_obj = DynamicSceneObjectTransform::create()->init(model_node);
+      }
+
+      // scene_obj's root will be added as a child of the scene transform
+      // root.
+      result->root = scene_obj->getRoot();
+      scene_obj->moveTo(cfg.xform);
+      result->sceneObj = scene_obj;
+   }
+   // If this model is not supposed to be grabbable, we examine the core of
+   // the root node.
+   else
+   {
+      OSG::NodeCorePtr root_core = model_node->getCore();
+      OSG::TransformPtr xform_core =
 #if OSG_MAJOR_VERSION < 2
-               OSG::TransformPtr::dcast(root_core);
+         OSG::TransformPtr::dcast(root_core);
 #else
-               OSG::cast_dynamic<OSG::TransformPtr>(root_core);
+         OSG::cast_dynamic<OSG::TransformPtr>(root_core);
 #endif
 
-            // If model_node's core is of type OSG::Transform, then we set
-            // set the matrix on that core to be xform_mat_osg.
-            if ( OSG::NullFC != xform_core )
-            {
+      // If model_node's core is of type OSG::Transform, then we set set the
+      // matrix on that core to be cfg.xform.
+      if ( OSG::NullFC != xform_core )
+      {
 #if OSG_MAJOR_VERSION < 2
-               OSG::CPEditor xce(xform_core, OSG::Transform::MatrixFieldMask);
+         OSG::CPEditor xce(xform_core, OSG::Transform::MatrixFieldMask);
 #endif
-               xform_core->setMatrix(xform_mat_osg);
+         xform_core->setMatrix(cfg.xform);
 
-               // model_node will be added as a child of scene_xform_root.
-               child_root = model_node;
-            }
-            // If model_node's core is not of type OSG::Transform, then we
-            // need to make a new node with an OSG::Transform core and make
-            // it the parent of model_node.
-            else
-            {
-               OSG::TransformNodePtr xform_node(OSG::Transform::create());
+         // model_node will be added as a child of the scene transform root.
+         result->root = model_node;
+      }
+      // If model_node's core is not of type OSG::Transform, then we need to
+      // make a new node with an OSG::Transform core and make it the parent
+      // of model_node.
+      else
+      {
+         OSG::TransformNodePtr xform_node(OSG::Transform::create());
 
 #if OSG_MAJOR_VERSION < 2
-               OSG::CPEditor xnce(xform_node.core(),
-                                  OSG::Transform::MatrixFieldMask);
+         OSG::CPEditor xnce(xform_node.core(),
+                            OSG::Transform::MatrixFieldMask);
 #endif
-               xform_node->setMatrix(xform_mat_osg);
+         xform_node->setMatrix(cfg.xform);
 
 #if OSG_MAJOR_VERSION < 2
-               OSG::CPEditor xne(xform_node.node(),
-                                 OSG::Node::ChildrenFieldMask);
+         OSG::CPEditor xne(xform_node.node(), OSG::Node::ChildrenFieldMask);
 #endif
-               xform_node.node()->addChild(model_node);
+         xform_node.node()->addChild(model_node);
+
+         // xform_node will be added as a child of the scene transform root.
+         result->root = xform_node.node();
+      }
+   }
+
+   vprASSERT(result->root != OSG::NullFC);
+}
+
+OSG::NodeRefPtr ModelLoaderPlugin::readModel(const ModelConfig& cfg) const
+{
+   OSG::NodeRefPtr model_node;
 
-               // xform_node will be added as a child of scene_xform_root.
-               child_root = xform_node.node();
+   // The model is processed before its scene object is created. When there
+   // is a scene cache, the processed model is cached as well.
+   const std::string processing(getProcessingDescription(cfg));
+
+   if ( mSceneCache )
+   {
+      if ( processing.empty() )
+      {
+         model_node = mSceneCache->read(cfg.path);
+      }
+      else
+      {
+         model_node = mSceneCache->read(
+            cfg.path, processing,
+            boost::bind(&ModelLoaderPlugin::processModel, this,
+                        boost::cref(cfg), _1)
+         );
+      }
+   }
+   else
+   {
+      // Only the parsing is serialized. The processing of the model can be
+      // done concurrently with the reading of other models.
+      {
+         vpr::Guard<vpr::Mutex> guard(util::getSceneFileLock());
+         model_node =
+#if OSG_MAJOR_VERSION < 2
+            OSG::SceneFileHandler::the().read(cfg.path.c_str());
+#else
+            OSG::SceneFileHandler::the()->read(cfg.path.c_str());
+#endif
+      }
+
+      if ( model_node != OSG::NullFC && ! processing.empty() )
+      {
+         processModel(cfg, model_node);
+      }
+   }
+
+   if ( model_node == OSG::NullFC )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Could not read model '" << cfg.path << "'";
+      throw PluginException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   return model_node;
+}
+
+void ModelLoaderPlugin::loadPagedModel(const ModelConfig& cfg,
+                                       LoadedModel* result) const
+{
+   const fs::path chunk_path(getChunkFilePath(cfg));
+
+   // Without a scene cache, the chunk file is rebuilt when the model is
+   // newer than it. With a scene cache, a change to the model changes the
+   // path of the chunk file.
+   bool build(! fs::exists(chunk_path));
+   if ( ! build && ! mSceneCache )
+   {
+      const fs::path model_path(cfg.path, fs::native);
+      build = fs::exists(model_path) &&
+                 fs::last_write_time(model_path) >
+                    fs::last_write_time(chunk_path);
+   }
+
+   if ( build )
+   {
+      OSG::NodeRefPtr model_node(readModel(cfg));
+
+      const vpr::Interval start(vpr::Interval::now());
+      const unsigned int num_chunks =
+         paging::ChunkFile::build(model_node, chunk_path,
+                                  cfg.chunkTriangles);
+
+      VRKIT_STATUS << "Split '" << cfg.path << "' into " << num_chunks
+                   << " chunk(s) in "
+                   << (vpr::Interval::now() - start).msecf() << " ms"
+                   << std::endl;
+   }
+
+   paging::ChunkFilePtr chunk_file(paging::ChunkFile::open(chunk_path));
+   result->pagedModel = paging::PagedModel::create(chunk_file, mPagingBudget,
+                                                   mPagingThreads);
+   result->pagedModel->setViewAngle(mPagingViewAngle);
+
+   OSG::TransformNodePtr xform_node(OSG::Transform::create());
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor xnce(xform_node.core(), OSG::Transform::MatrixFieldMask);
+#endif
+   xform_node->setMatrix(cfg.xform);
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor xne(xform_node.node(), OSG::Node::ChildrenFieldMask);
+#endif
+   xform_node.node()->addChild(result->pagedModel->getRoot());
+
+   // xform_node will be added as a child of the scene transform root.
+   result->root = xform_node.node();
+}
+
+fs::path ModelLoaderPlugin::getChunkFilePath(const ModelConfig& cfg) const
+{
+   std::ostringstream variant_stream;
+   variant_stream << getProcessingDescription(cfg) << "chunks "
+                  << cfg.chunkTriangles;
+
+   if ( mSceneCache )
+   {
+      const fs::path entry_path(
+         mSceneCache->getEntryPath(cfg.path, variant_stream.str())
+      );
+      if ( ! entry_path.empty() )
+      {
+         return entry_path.branch_path() /
+                   (fs::basename(entry_path) + ".vpg");
+      }
+   }
+
+   return fs::path(cfg.path + ".vpg", fs::native);
+}
+
+void ModelLoaderPlugin::processModel(const ModelConfig& cfg,
+                                     OSG::NodePtr root) const
+{
+   util::SceneOptimizer::predicate_t keep;
+
+   if ( cfg.grabbable )
+   {
+      if ( ! cfg.coreTypes.empty() )
+      {
+         keep = util::CoreTypePredicate(cfg.coreTypes);
+      }
+      else
+      {
+         keep = util::CoreTypeSeqPredicate<
+                   boost::mpl::vector<OSG::Transform>
+                >();
+      }
+   }
+
+   if ( mOptimizer.getOperations() != 0 )
+   {
+      mOptimizer.optimize(root, keep);
+   }
+
+   // The levels of detail are generated after the optimization so that
+   // they are made from the merged geometry.
+   if ( cfg.lodGen.isEnabled() )
+   {
+      const vpr::Interval start(vpr::Interval::now());
+      const unsigned int count(cfg.lodGen.generate(root, keep));
+
+      VRKIT_STATUS << "Generated levels of detail for " << count
+                   << " geometry core(s) of '" << cfg.path << "' in "
+                   << (vpr::Interval::now() - start).msecf() << " ms"
+                   << std::endl;
+   }
+}
+
+std::string ModelLoaderPlugin::
+getProcessingDescription(const ModelConfig& cfg) const
+{
+   std::ostringstream desc_stream;
+
+   if ( mOptimizer.getOperations() != 0 )
+   {
+      desc_stream << "optimize " << mOptimizer.getOperations() << " ";
+   }
+
+   if ( cfg.lodGen.isEnabled() )
+   {
+      desc_stream << cfg.lodGen.getDescription() << " ";
+   }
+
+   // The nodes that are preserved depend on the grabbable core types.
+   if ( ! desc_stream.str().empty() && cfg.grabbable )
+   {
+      desc_stream << "keep";
+
+      typedef std::vector<OSG::FieldContainerType*>::const_iterator iter_type;
+      for ( iter_type t = cfg.coreTypes.begin(); t != cfg.coreTypes.end(); ++t )
+      {
+         desc_stream << " " << (*t)->getCName();
+      }
+   }
+
+   return desc_stream.str();
+}
+
+OSG::NodeRefPtr ModelLoaderPlugin::makePlaceholder(const ModelConfig& cfg)
+{
+   if ( cfg.bounds.isEmpty() )
+   {
+      return OSG::NodeRefPtr();
+   }
+
+   const gmtl::Point3f& min(cfg.bounds.getMin());
+   const gmtl::Point3f& max(cfg.bounds.getMax());
+   const gmtl::Point3f center((min + max) * 0.5f);
+
+   OSG::NodeRefPtr box(OSG::makeBox(max[0] - min[0], max[1] - min[1],
+                                    max[2] - min[2], 1, 1, 1));
+
+   // The box is centered on the origin, and the bounds are in the
+   // coordinate frame of the model.
+   OSG::Matrix xform_mat(cfg.xform);
+   OSG::Matrix center_mat;
+   center_mat.setTranslate(center[0], center[1], center[2]);
+   xform_mat.mult(center_mat);
+
+   OSG::TransformNodePtr xform_node(OSG::Transform::create());
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor xnce(xform_node.core(), OSG::Transform::MatrixFieldMask);
+#endif
+   xform_node->setMatrix(xform_mat);
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor xne(xform_node.node(), OSG::Node::ChildrenFieldMask);
+#endif
+   xform_node.node()->addChild(box);
+
+   return OSG::NodeRefPtr(xform_node.node());
+}
+
+void ModelLoaderPlugin::loadModels(ViewerPtr viewer,
+                                   const unsigned int numThreads)
+{
+   const unsigned int num_models(mModelCfgs.size());
+
+   // Each model is read into a sub-tree that is not attached to the scene,
+   // so models can be read by worker threads independently of each other.
+   // OSG::SceneFileHandler is not thread-safe, so the scene files are
+   // parsed one at a time, but the processing of the models overlaps.
+   // There is no point in having more workers than models.
+   const unsigned int load_threads(std::min(numThreads, num_models));
+
+   vpr::Mutex change_list_lock;
+   util::TaskGraph load_graph(
+      load_threads, &initLoaderWorker,
+      boost::bind(&mergeLoaderWorkerChanges, &change_list_lock,
+                  OSG::Thread::getCurrentChangeList(), _1)
+   );
+
+   std::vector<LoadedModel> models(num_models);
+   std::vector<util::TaskGraph::task_id_type> tasks(num_models);
+   for ( unsigned int i = 0; i < num_models; ++i )
+   {
+      tasks[i] = load_graph.addTask(mModelCfgs[i].path,
+                                    boost::bind(&ModelLoaderPlugin::loadModel,
+                                                this,
+                                                boost::cref(mModelCfgs[i]),
+                                                &models[i]));
+   }
+
+   const vpr::Interval load_start(vpr::Interval::now());
+   load_graph.execute();
+   const vpr::Interval load_time(vpr::Interval::now() - load_start);
+
+   // Add the models to the scene in the order in which they are configured.
+   // Adding them to the scene is left to the application thread because
+   // init() may be invoked concurrently with the initialization of other
+   // plug-ins.
+   for ( unsigned int i = 0; i < num_models; ++i )
+   {
+      const util::TaskGraph::Result& result =
+         load_graph.getResult(tasks[i]);
+
+      if ( result.status == util::TaskGraph::Result::SUCCEEDED )
+      {
+         VRKIT_STATUS << "Loaded model '" << mModelCfgs[i].path << "' ["
+                      << result.elapsed.msecf() << " ms]" << std::endl;
+
+         viewer->callOnMainThread(
+            boost::bind(&attachModel, viewer, models[i].root,
+                        models[i].sceneObj, models[i].pagedModel)
+         );
+
+         if ( mModelCfgs[i].lodGen.isEnabled() )
+         {
+            viewer->callOnMainThread(
+               boost::bind(&util::LODPrefetcher::addGraph, &mLODPrefetcher,
+                           OSG::NodePtr(models[i].root))
+            );
+         }
+      }
+      else
+      {
+         VRKIT_STATUS << "WARNING: Failed to load model '"
+                      << mModelCfgs[i].path << "': " << result.error
+                      << std::endl;
+      }
+   }
+
+   VRKIT_STATUS << "Loading " << num_models << " model(s) using "
+                << load_threads << " worker thread(s) took "
+                << load_time.msecf() << " ms" << std::endl;
+}
+
+void ModelLoaderPlugin::startStreaming(ViewerPtr viewer,
+                                       const unsigned int numThreads)
+{
+   const unsigned int num_models(mModelCfgs.size());
+
+   if ( num_models == 0 )
+   {
+      return;
+   }
+
+   mPlaceholders.resize(num_models);
+   for ( unsigned int i = 0; i < num_models; ++i )
+   {
+      mPlaceholders[i] = makePlaceholder(mModelCfgs[i]);
+
+      if ( OSG::NullFC != mPlaceholders[i] )
+      {
+         viewer->callOnMainThread(
+            boost::bind(&attachModel, viewer, mPlaceholders[i],
+                        SceneObjectPtr(), paging::PagedModelPtr())
+         );
+      }
+
+      mStreamQueue.push_back(i);
+   }
+
+   // Streaming needs at least one thread.
+   const unsigned int stream_threads(
+      std::max(1u, std::min(numThreads, num_models))
+   );
+
+   for ( unsigned int w = 0; w < stream_threads; ++w )
+   {
+      mStreamWorkers.push_back(
+         new vpr::Thread(boost::bind(&ModelLoaderPlugin::streamWorkerLoop,
+                                     this, w))
+      );
+   }
+
+   VRKIT_STATUS << "Streaming " << num_models << " model(s) using "
+                << stream_threads << " thread(s)" << std::endl;
+}
+
+void ModelLoaderPlugin::stopStreaming()
+{
+   if ( mStreamWorkers.empty() )
+   {
+      return;
+   }
+
+   mStreamCond.acquire();
+   {
+      mStreamShutdown = true;
+      mStreamCond.broadcast();
+   }
+   mStreamCond.release();
+
+   typedef std::vector<vpr::Thread*>::iterator iter_type;
+   for ( iter_type w = mStreamWorkers.begin(); w != mStreamWorkers.end(); ++w )
+   {
+      (*w)->join();
+      delete *w;
+   }
+
+   mStreamWorkers.clear();
+}
+
+void ModelLoaderPlugin::streamWorkerLoop(const unsigned int index)
+{
+   initLoaderWorker(index);
+
+   mStreamCond.acquire();
+   {
+      while ( ! mStreamShutdown && ! mStreamQueue.empty() )
+      {
+         StreamedModel streamed;
+         streamed.index = mStreamQueue.front();
+         mStreamQueue.pop_front();
+
+         mStreamCond.release();
+         {
+            const vpr::Interval start(vpr::Interval::now());
+
+            // mStreamCond must not be held here. Parsing the scene file
+            // takes the scene file lock, and it may be held for a long
+            // time by another thread.
+            try
+            {
+               loadModel(mModelCfgs[streamed.index], &streamed.model);
             }
+            catch (std::exception& ex)
+            {
+               streamed.error = ex.what();
+            }
+
+            streamed.elapsed = vpr::Interval::now() - start;
+         }
+         mStreamCond.acquire();
+
+         // Wait for the application thread to accept the OpenSG changes
+         // that were made while reading the model.
+         ++mMergesPending;
+         mStreamCond.broadcast();
+
+         while ( ! mMergeWindowOpen && ! mStreamShutdown )
+         {
+            mStreamCond.wait();
          }
 
-         vprASSERT(child_root != OSG::NullFC);
+         --mMergesPending;
 
-         // The OSG::{begin,end}EditCP() calls for scene_xform_root wrap
-         // the for loop that we are in.
-         scene_xform_root.node()->addChild(child_root);
+         if ( ! mStreamShutdown )
+         {
+            OSG::ChangeList* worker_list = OSG::Thread::getCurrentChangeList();
+            mAppChangeList->merge(*worker_list);
+#if OSG_MAJOR_VERSION < 2
+            worker_list->clearAll();
+#else
+            worker_list->clear();
+#endif
+
+            mStreamedModels.push_back(streamed);
+         }
+
+         mStreamCond.broadcast();
       }
    }
+   mStreamCond.release();
+}
 
-   return shared_from_this();
+void ModelLoaderPlugin::attachStreamedModel(ViewerPtr viewer,
+                                            const StreamedModel& streamed)
+{
+   const ModelConfig& cfg(mModelCfgs[streamed.index]);
+
+   OSG::NodeRefPtr placeholder(mPlaceholders[streamed.index]);
+   if ( OSG::NullFC != placeholder )
+   {
+      detachNode(viewer, placeholder);
+      mPlaceholders[streamed.index] = OSG::NullFC;
+   }
+
+   std::ostringstream msg_stream;
+
+   if ( streamed.error.empty() )
+   {
+      attachModel(viewer, streamed.model.root, streamed.model.sceneObj,
+                  streamed.model.pagedModel);
+
+      if ( cfg.lodGen.isEnabled() )
+      {
+         mLODPrefetcher.addGraph(streamed.model.root);
+      }
+
+      VRKIT_STATUS << "Loaded model '" << cfg.path << "' ["
+                   << streamed.elapsed.msecf() << " ms]" << std::endl;
+      msg_stream << "Loaded model " << mNumStreamed + 1 << " of "
+                 << mModelCfgs.size();
+   }
+   else
+   {
+      VRKIT_STATUS << "WARNING: Failed to load model '" << cfg.path
+                   << "': " << streamed.error << std::endl;
+      msg_stream << "Failed to load model " << mNumStreamed + 1 << " of "
+                 << mModelCfgs.size();
+   }
+
+   StatusPanelDataPtr status_panel_data =
+      viewer->getSceneObj()->getSceneData<StatusPanelData>();
+   status_panel_data->addStatusMessage(msg_stream.str());
 }
 
-void ModelLoaderPlugin::update(ViewerPtr)
+void ModelLoaderPlugin::connectDestination(ViewerPtr viewer)
 {
-   /* Do nothing. */ ;
+   mDestinationConn =
+      viewer->getUser()->getViewPlatform().destinationSet().connect(
+         boost::bind(&ModelLoaderPlugin::destinationSet, this,
+                     ViewerWeakPtr(viewer), _1)
+      );
+}
+
+void ModelLoaderPlugin::destinationSet(ViewerWeakPtr viewer,
+                                       const gmtl::Matrix44f& vw_M_vpDest)
+{
+   ViewerPtr the_viewer(viewer.lock());
+
+   if ( ! the_viewer )
+   {
+      return;
+   }
+
+   UserPtr user(the_viewer->getUser());
+   const gmtl::Matrix44f vp_M_head(
+      user->getHeadProxy()->getData(the_viewer->getDrawScaleFactor())
+   );
+
+   const unsigned int count =
+      mLODPrefetcher.prefetch(user->getViewPlatform().getCurPos(),
+                              vw_M_vpDest,
+                              gmtl::makeTrans<gmtl::Point3f>(vp_M_head));
+
+   if ( count > 0 )
+   {
+      VRKIT_STATUS << "Pinned " << count << " level(s) of detail for the "
+                   << "view platform destination" << std::endl;
+   }
 }
 
 }  // namespace vrkit
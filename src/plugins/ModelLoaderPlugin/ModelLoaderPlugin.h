@@ -22,14 +22,59 @@
 #include <vrkit/plugin/Config.h>
 
 #include <string>
+#include <vector>
+#include <deque>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/signals/connection.hpp>
 
+#include <gmtl/AABox.h>
+#include <gmtl/Math.h>
+#include <gmtl/Matrix.h>
+
+#include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGRefPtr.h>
+#include <OpenSG/OSGMatrix.h>
+#include <OpenSG/OSGFieldContainerType.h>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Sync/CondVar.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/ViewerPtr.h>
+#include <vrkit/SceneObjectPtr.h>
+#include <vrkit/util/SceneCachePtr.h>
+#include <vrkit/util/SceneOptimizer.h>
+#include <vrkit/util/LODGenerator.h>
+#include <vrkit/util/LODPrefetcher.h>
+#include <vrkit/paging/PagedModelPtr.h>
 #include <vrkit/viewer/Plugin.h>
 
 
+namespace OSG
+{
+   class ChangeList;
+}
+
+namespace vpr
+{
+   class Thread;
+}
+
 namespace vrkit
 {
 
+/**
+ * Loads the configured models and adds them to the scene. By default, all
+ * the models are loaded in init(). In streaming mode, the models are loaded
+ * by background threads while the viewer is running, and each is added to
+ * the scene in update() once it has been loaded. Until then, a box is shown
+ * in place of each model whose bounds are configured.
+ *
+ * A model can also be paged. Its geometry is then split into chunks that
+ * are stored in a chunk file, and the chunks are paged in and out while the
+ * viewer is running (see vrkit::paging::PagedModel).
+ */
 class ModelLoaderPlugin
    : public viewer::Plugin
    , public boost::enable_shared_from_this<ModelLoaderPlugin>
@@ -37,6 +82,17 @@ class ModelLoaderPlugin
 protected:
    ModelLoaderPlugin(const plugin::Info& info)
       : viewer::Plugin(info)
+      , mOptimizer(0)
+      , mPagingBudget(0)
+      , mPagingThreads(2)
+      , mPagingViewAngle(gmtl::Math::PI)
+      , mPagingReportInterval(0.0f)
+      , mStreamBudget(5.0f)
+      , mStreamShutdown(false)
+      , mMergeWindowOpen(false)
+      , mMergesPending(0)
+      , mAppChangeList(NULL)
+      , mNumStreamed(0)
    {
       /* Do nothing. */ ;
    }
@@ -44,10 +100,11 @@ protected:
 public:
    static viewer::PluginPtr create(const plugin::Info& info);
 
-   virtual ~ModelLoaderPlugin()
-   {
-      /* Do nothing. */ ;
-   }
+   /**
+    * Stops the background threads (if any). Models that are still being
+    * read when this is invoked are discarded.
+    */
+   virtual ~ModelLoaderPlugin();
 
    virtual std::string getDescription();
 
@@ -56,7 +113,210 @@ public:
     */
    virtual viewer::PluginPtr init(ViewerPtr viewer);
 
+   /**
+    * Models are read and prepared in init() without touching the scene, so
+    * this plug-in can be initialized concurrently with others.
+    *
+    * @return true is always returned.
+    */
+   virtual bool canInitConcurrently() const;
+
+   /**
+    * In streaming mode, adds the models that have been loaded since the last
+    * frame to the scene. This stops once the configured time budget has been
+    * used up, and any remaining models are added in later frames. The
+    * paging statistics are reported here if that is enabled, and the levels
+    * of detail pinned for a view platform transition are released once the
+    * transition is over.
+    */
    virtual void update(ViewerPtr viewer);
+
+private:
+   /** The configuration of a single model. */
+   struct ModelConfig
+   {
+      ModelConfig()
+         : grabbable(false)
+         , paged(false)
+         , chunkTriangles(65536)
+      {
+         /* Do nothing. */ ;
+      }
+
+      std::string                            path;
+      OSG::Matrix                            xform;
+      bool                                   grabbable;
+      std::vector<OSG::FieldContainerType*>  coreTypes;
+      gmtl::AABoxf                           bounds;    /**< Placeholder */
+      util::LODGenerator                     lodGen;
+      bool                                   paged;
+      unsigned int                           chunkTriangles;
+   };
+
+   /** A model that has been read but not yet added to the scene. */
+   struct LoadedModel
+   {
+      OSG::NodeRefPtr root;             /**< The node to add to the scene */
+      SceneObjectPtr  sceneObj;         /**< Null if grabbing is disabled */
+      paging::PagedModelPtr pagedModel; /**< Null unless paging is enabled */
+   };
+
+   /** The result of reading a model in streaming mode. */
+   struct StreamedModel
+   {
+      unsigned int  index;              /**< Index into \c mModelCfgs */
+      LoadedModel   model;
+      std::string   error;              /**< Empty if the model was read */
+      vpr::Interval elapsed;
+   };
+
+   /**
+    * Reads the described model (through the scene cache of the viewer if
+    * there is one), processes it, and prepares the sub-tree that will be
+    * added to the scene. The sub-tree is not attached to anything, so this
+    * can be invoked concurrently for different models.
+    *
+    * @throw vrkit::PluginException Thrown if the model cannot be read.
+    */
+   void loadModel(const ModelConfig& cfg, LoadedModel* result) const;
+
+   /**
+    * Reads and processes the described model through the scene cache of
+    * the viewer if there is one. The scene file is parsed while holding
+    * the lock returned by vrkit::util::getSceneFileLock().
+    *
+    * @throw vrkit::PluginException Thrown if the model cannot be read.
+    */
+   OSG::NodeRefPtr readModel(const ModelConfig& cfg) const;
+
+   /**
+    * Prepares the paged model for the described model. The chunk file is
+    * built first if it does not exist or if it is out of date.
+    *
+    * @throw vrkit::Exception Thrown if the chunk file cannot be built or
+    *                         opened.
+    */
+   void loadPagedModel(const ModelConfig& cfg, LoadedModel* result) const;
+
+   /**
+    * Returns the path of the chunk file for the described model. When there
+    * is a scene cache, the chunk file is kept in the cache directory.
+    * Otherwise, it is kept next to the model.
+    */
+   boost::filesystem::path getChunkFilePath(const ModelConfig& cfg) const;
+
+   /**
+    * Optimizes the graph of the described model and generates its levels
+    * of detail. The nodes that the scene object of the model will treat as
+    * grabbable parts are preserved.
+    */
+   void processModel(const ModelConfig& cfg, OSG::NodePtr root) const;
+
+   /**
+    * Returns a description of the processing done by processModel() for
+    * the given model. This names the processed model in the scene cache.
+    */
+   std::string getProcessingDescription(const ModelConfig& cfg) const;
+
+   /**
+    * Creates a box that fills the configured bounds of the given model.
+    *
+    * @return OSG::NullFC is returned if no bounds are configured.
+    */
+   static OSG::NodeRefPtr makePlaceholder(const ModelConfig& cfg);
+
+   /**
+    * Loads all of the configured models before returning.
+    */
+   void loadModels(ViewerPtr viewer, const unsigned int numThreads);
+
+   /** @name Background Streaming */
+   //@{
+   /**
+    * Adds the placeholders to the scene and starts the threads that read
+    * the models.
+    */
+   void startStreaming(ViewerPtr viewer, const unsigned int numThreads);
+
+   /**
+    * Tells the streaming threads to exit and waits for them to do so.
+    */
+   void stopStreaming();
+
+   /**
+    * Reads queued models until the queue is empty or streaming is stopped.
+    * The scene files are parsed by loadModel() while holding the lock
+    * returned by vrkit::util::getSceneFileLock(), so the streaming threads
+    * parse one file at a time, and they do not race with other threads
+    * that read scene files while the viewer is running.
+    */
+   void streamWorkerLoop(const unsigned int index);
+
+   /**
+    * Replaces the placeholder for the given model with the model (if it was
+    * read successfully).
+    */
+   void attachStreamedModel(ViewerPtr viewer, const StreamedModel& streamed);
+   //@}
+
+   /**
+    * Connects destinationSet() to the "destination set" signal of the view
+    * platform. This must be invoked by the application thread.
+    */
+   void connectDestination(ViewerPtr viewer);
+
+   /**
+    * Responds to the "destination set" signal of the view platform by
+    * pinning the levels of detail that the models will need at the
+    * destination.
+    *
+    * @see vrkit::ViewPlatform::destinationSet()
+    */
+   void destinationSet(ViewerWeakPtr viewer,
+                       const gmtl::Matrix44f& vw_M_vpDest);
+
+   std::vector<ModelConfig> mModelCfgs;
+   util::SceneCachePtr      mSceneCache;
+   util::SceneOptimizer     mOptimizer;
+
+   /** @name Level of Detail Prefetching */
+   //@{
+   util::LODPrefetcher        mLODPrefetcher;
+   boost::signals::connection mDestinationConn;
+   //@}
+
+   /** @name Paging */
+   //@{
+   vpr::Uint64              mPagingBudget;  /**< Bytes per model */
+   unsigned int             mPagingThreads;
+   float                    mPagingViewAngle;       /**< Radians */
+   float                    mPagingReportInterval;  /**< Seconds */
+   vpr::Interval            mLastPagingReport;
+   //@}
+
+   /** @name Background Streaming */
+   //@{
+   float                        mStreamBudget;  /**< Milliseconds per frame */
+   std::vector<OSG::NodeRefPtr> mPlaceholders;
+   std::vector<vpr::Thread*>    mStreamWorkers;
+   std::deque<StreamedModel>    mReadyModels;   /**< Used only by update() */
+
+   // State shared with the streaming threads (protected by mStreamCond).
+   vpr::CondVar                 mStreamCond;
+   std::deque<unsigned int>     mStreamQueue;   /**< Models to be read */
+   std::deque<StreamedModel>    mStreamedModels;
+   bool                         mStreamShutdown;
+
+   /**
+    * Indicates that the application thread is waiting for the streaming
+    * threads to merge their OpenSG changes into \c mAppChangeList.
+    */
+   bool                         mMergeWindowOpen;
+   unsigned int                 mMergesPending;
+   OSG::ChangeList*             mAppChangeList;
+
+   unsigned int                 mNumStreamed;   /**< Models handled so far */
+   //@}
 }; // ModelLoaderPlugin
 
 }  // namespace vrkit
@@ -20,6 +20,8 @@
 #include <windows.h>
 #endif
 
+#include <algorithm>
+#include <sstream>
 #include <boost/bind.hpp>
 #include <boost/assign/list_of.hpp>
 
@@ -30,7 +32,13 @@
 #include <OpenSG/OSGSwitch.h>
 #include <OpenSG/OSGTransform.h>
 #include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGGroup.h>
 #include <OpenSG/OSGSceneFileHandler.h>
+#include <OpenSG/OSGThread.h>
+#include <OpenSG/OSGChangeList.h>
+
+#include <vpr/Thread/Thread.h>
+#include <vpr/Sync/Guard.h>
 
 #include <jccl/Config/ConfigElement.h>
 
@@ -40,6 +48,12 @@
 #include <vrkit/InterfaceTrader.h>
 #include <vrkit/User.h>
 #include <vrkit/Version.h>
+#include <vrkit/Status.h>
+#include <vrkit/scenedata/StatusPanelData.h>
+#include <vrkit/scenedata/CollisionData.h>
+#include <vrkit/util/SceneCache.h>
+#include <vrkit/util/SceneFileLock.h>
+#include <vrkit/util/MemoryUsage.h>
 #include <vrkit/plugin/Creator.h>
 #include <vrkit/plugin/Info.h>
 #include <vrkit/exceptions/PluginException.h>
@@ -82,6 +96,31 @@ VRKIT_PLUGIN_API(vrkit::plugin::CreatorBase*) getCreator()
 
 }
 
+namespace
+{
+
+/**
+ * Registers the calling thread with OpenSG so that it can create field
+ * containers.
+ */
+void initLoaderThread()
+{
+#if OSG_MAJOR_VERSION < 2
+   OSG::ExternalThread* thread =
+      OSG::ExternalThread::get("vrkit model swap loader");
+#else
+   OSG::ExternalThreadRefPtr thread =
+      OSG::ExternalThread::get("vrkit model swap loader", true);
+#endif
+
+   if ( ! thread->isInitialized() )
+   {
+      thread->initialize(0);
+   }
+}
+
+}
+
 namespace vrkit
 {
 
@@ -90,6 +129,23 @@ viewer::PluginPtr ModelSwapPlugin::create(const plugin::Info& info)
    return viewer::PluginPtr(new ModelSwapPlugin(info));
 }
 
+ModelSwapPlugin::~ModelSwapPlugin()
+{
+   if ( NULL != mLoader )
+   {
+      mLoaderCond.acquire();
+      {
+         mLoaderShutdown = true;
+         mLoaderCond.broadcast();
+      }
+      mLoaderCond.release();
+
+      mLoader->join();
+      delete mLoader;
+      mLoader = NULL;
+   }
+}
+
 std::string ModelSwapPlugin::getDescription()
 {
    return std::string("Model Swap Plug-in");
@@ -103,6 +159,8 @@ viewer::PluginPtr ModelSwapPlugin::init(ViewerPtr viewer)
    const std::string position_tkn("position");
    const std::string rotation_tkn("rotation");
    const std::string model_tkn("model");
+   const std::string memory_budget_tkn("memory_budget");
+   const std::string prefetch_tkn("prefetch");
 
    const unsigned int req_cfg_version(1);
 
@@ -140,7 +198,17 @@ viewer::PluginPtr ModelSwapPlugin::init(ViewerPtr viewer)
    // Get the scaling factor
    float to_meters_scalar = elt->getProperty<float>(units_to_meters_tkn);
 
-   // Get the paths to all the models, load them, and add them to the switch
+   // The memory budget and prefetching were added in version 2.
+   if ( elt->getVersion() >= 2 )
+   {
+      const float budget_mb = elt->getProperty<float>(memory_budget_tkn);
+      mMemoryBudget = budget_mb > 0.0f ? vpr::Uint64(budget_mb * 1048576.0f)
+                                       : 0;
+      mPrefetch = elt->getProperty<bool>(prefetch_tkn);
+   }
+
+   // Each model gets a slot under the switch so that the choice of the
+   // switch is the index of the model, whether or not it is in memory.
    mSwitchNode = OSG::Node::create();
    mSwitchCore = OSG::Switch::create();
 
@@ -149,28 +217,55 @@ viewer::PluginPtr ModelSwapPlugin::init(ViewerPtr viewer)
                      OSG::Node::CoreFieldMask | OSG::Node::ChildrenFieldMask);
 #endif
    mSwitchNode->setCore(mSwitchCore);
+   mSceneCache = viewer->getSceneCache();
    const unsigned int num_models(elt->getNum(model_tkn));
+   mVariants.resize(num_models);
    for ( unsigned int i = 0; i < num_models; ++i )
    {
-      std::string model_path = elt->getProperty<std::string>(model_tkn, i);
-      OSG::NodeRefPtr model_node(
+      mVariants[i].path = elt->getProperty<std::string>(model_tkn, i);
+      mVariants[i].slot = OSG::Node::create();
+
 #if OSG_MAJOR_VERSION < 2
-         OSG::SceneFileHandler::the().read(model_path.c_str())
-#else
-         OSG::SceneFileHandler::the()->read(model_path.c_str())
+      OSG::CPEditor se(mVariants[i].slot, OSG::Node::CoreFieldMask);
 #endif
-      );
+      mVariants[i].slot->setCore(OSG::Group::create());
+      mSwitchNode->addChild(mVariants[i].slot);
+   }
+
+   // Only the first model that can be read is loaded now.
+   for ( unsigned int i = 0; i < num_models; ++i )
+   {
+      const vpr::Interval start(vpr::Interval::now());
+      OSG::NodeRefPtr model_node(loadModel(mVariants[i].path));
 
       if ( model_node != OSG::NullFC )
       {
-         mSwitchNode->addChild(model_node);
+         LoadResult result;
+         result.index   = i;
+         result.root    = model_node;
+         result.elapsed = vpr::Interval::now() - start;
+
+         mPending   = i;
+         mSwapStart = start;
+         acceptResult(viewer, result);
+         break;
       }
+
+      VRKIT_STATUS << "Could not read model '" << mVariants[i].path << "'"
+                   << std::endl;
+      mVariants[i].failed = true;
    }
 
-#if OSG_MAJOR_VERSION < 2
-   OSG::CPEditor sce(mSwitchCore, OSG::Switch::ChoiceFieldMask);
-#endif
-   mSwitchCore->setChoice(0);
+   if ( num_models > 1 )
+   {
+      mLoader = new vpr::Thread(boost::bind(&ModelSwapPlugin::loaderLoop,
+                                            this));
+
+      if ( mPrefetch )
+      {
+         requestLoad(getNextVariant(mCurrent), false);
+      }
+   }
 
    // Set up the model switch transform
    float xt = elt->getProperty<float>(position_tkn, 0);
@@ -218,24 +313,324 @@ viewer::PluginPtr ModelSwapPlugin::init(ViewerPtr viewer)
    OSG::CPEditor sxre(scene_xform_root.node(), OSG::Node::ChildrenFieldMask);
 #endif
    scene_xform_root.node()->addChild(xform_node);
+   scene->getSceneData<CollisionData>()->invalidate();
 
    return shared_from_this();
 }
 
-void ModelSwapPlugin::update(ViewerPtr)
+void ModelSwapPlugin::update(ViewerPtr viewer)
+{
+   bool have_result(false);
+   LoadResult result;
+
+   mLoaderCond.acquire();
+   {
+      if ( mResultReady )
+      {
+         // The loader thread is waiting, so its change list can be merged
+         // into that of this thread.
+         OSG::ChangeList* app_list = OSG::Thread::getCurrentChangeList();
+         app_list->merge(*mLoaderChangeList);
+#if OSG_MAJOR_VERSION < 2
+         mLoaderChangeList->clearAll();
+#else
+         mLoaderChangeList->clear();
+#endif
+
+         result       = mResult;
+         mResult      = LoadResult();
+         mResultReady = false;
+         have_result  = true;
+         mLoaderCond.broadcast();
+      }
+   }
+   mLoaderCond.release();
+
+   if ( have_result )
+   {
+      acceptResult(viewer, result);
+   }
+
+   if ( isFocused() && mSwapButton() && mVariants.size() > 1 )
+   {
+      // Pressing the button again while a model is being read moves on to
+      // the model after that one.
+      const unsigned int from(mPending >= 0 ? mPending : mCurrent);
+      const unsigned int next(getNextVariant(from));
+
+      if ( next != from )
+      {
+         mSwapStart = vpr::Interval::now();
+
+         if ( OSG::NullFC != mVariants[next].root )
+         {
+            showVariant(viewer, next);
+         }
+         else
+         {
+            mPending = next;
+            requestLoad(next, true);
+
+            std::ostringstream msg_stream;
+            msg_stream << "Loading model " << next + 1 << " of "
+                       << mVariants.size();
+            reportStatus(viewer, msg_stream.str());
+         }
+      }
+   }
+}
+
+OSG::NodeRefPtr ModelSwapPlugin::loadModel(const std::string& path) const
+{
+   if ( mSceneCache )
+   {
+      return mSceneCache->read(path);
+   }
+
+   vpr::Guard<vpr::Mutex> guard(util::getSceneFileLock());
+   return OSG::NodeRefPtr(
+#if OSG_MAJOR_VERSION < 2
+      OSG::SceneFileHandler::the().read(path.c_str())
+#else
+      OSG::SceneFileHandler::the()->read(path.c_str())
+#endif
+   );
+}
+
+unsigned int ModelSwapPlugin::getNextVariant(const unsigned int index) const
+{
+   const unsigned int num_models(mVariants.size());
+
+   for ( unsigned int i = 1; i < num_models; ++i )
+   {
+      const unsigned int next((index + i) % num_models);
+
+      if ( ! mVariants[next].failed )
+      {
+         return next;
+      }
+   }
+
+   return index;
+}
+
+void ModelSwapPlugin::requestLoad(const unsigned int index, const bool urgent)
+{
+   Variant& variant(mVariants[index]);
+
+   if ( NULL == mLoader || OSG::NullFC != variant.root || variant.failed )
+   {
+      return;
+   }
+
+   mLoaderCond.acquire();
+   {
+      if ( variant.loading )
+      {
+         // Move the model to the front of the queue if it has not been
+         // started yet.
+         if ( urgent )
+         {
+            std::deque<unsigned int>::iterator i =
+               std::find(mLoadQueue.begin(), mLoadQueue.end(), index);
+
+            if ( i != mLoadQueue.end() )
+            {
+               mLoadQueue.erase(i);
+               mLoadQueue.push_front(index);
+            }
+         }
+      }
+      else
+      {
+         variant.loading = true;
+
+         if ( urgent )
+         {
+            mLoadQueue.push_front(index);
+         }
+         else
+         {
+            mLoadQueue.push_back(index);
+         }
+
+         mLoaderCond.broadcast();
+      }
+   }
+   mLoaderCond.release();
+}
+
+void ModelSwapPlugin::acceptResult(ViewerPtr viewer, const LoadResult& result)
 {
-   if ( isFocused() )
+   Variant& variant(mVariants[result.index]);
+   variant.loading = false;
+
+   if ( OSG::NullFC == result.root )
    {
-      if ( mSwapButton() )
+      variant.failed = true;
+
+      std::ostringstream msg_stream;
+      msg_stream << "Could not read model '" << variant.path << "'";
+      reportStatus(viewer, msg_stream.str());
+
+      if ( mPending == int(result.index) )
       {
-         unsigned int num_models = mSwitchNode->getNChildren();
-         unsigned int cur_model = mSwitchCore->getChoice();
+         mPending = -1;
+      }
+
+      return;
+   }
+
+   {
 #if OSG_MAJOR_VERSION < 2
-         OSG::CPEditor sce(mSwitchCore, OSG::Switch::ChoiceFieldMask);
+      OSG::CPEditor se(variant.slot, OSG::Node::ChildrenFieldMask);
 #endif
-         mSwitchCore->setChoice((cur_model + 1) % num_models);
+      variant.slot->addChild(result.root);
+   }
+
+   variant.root     = result.root;
+   variant.bytes    = util::estimateMemoryUsage(result.root);
+   variant.lastUsed = ++mUseCount;
+   mResidentBytes  += variant.bytes;
+
+   VRKIT_STATUS << "Loaded model '" << variant.path << "' ["
+                << result.elapsed.msecf() << " ms, "
+                << variant.bytes / 1024 << " KB]" << std::endl;
+
+   if ( mPending == int(result.index) )
+   {
+      showVariant(viewer, result.index);
+   }
+   else
+   {
+      enforceBudget();
+   }
+}
+
+void ModelSwapPlugin::showVariant(ViewerPtr viewer, const unsigned int index)
+{
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor sce(mSwitchCore, OSG::Switch::ChoiceFieldMask);
+#endif
+      mSwitchCore->setChoice(index);
+   }
+
+   // Navigation has to collide with the model that is now shown.
+   viewer->getSceneObj()->getSceneData<CollisionData>()->invalidate();
+
+   mCurrent                  = index;
+   mPending                  = -1;
+   mVariants[index].lastUsed = ++mUseCount;
+
+   std::ostringstream msg_stream;
+   msg_stream << "Showing model " << index + 1 << " of " << mVariants.size()
+              << " [" << (vpr::Interval::now() - mSwapStart).msecf()
+              << " ms]";
+   reportStatus(viewer, msg_stream.str());
+
+   enforceBudget();
+
+   if ( mPrefetch )
+   {
+      requestLoad(getNextVariant(index), false);
+   }
+}
+
+void ModelSwapPlugin::enforceBudget()
+{
+   if ( mMemoryBudget == 0 )
+   {
+      return;
+   }
+
+   while ( mResidentBytes > mMemoryBudget )
+   {
+      Variant* lru(NULL);
+
+      for ( unsigned int i = 0; i < mVariants.size(); ++i )
+      {
+         Variant& variant(mVariants[i]);
+
+         if ( i != mCurrent && int(i) != mPending &&
+              OSG::NullFC != variant.root &&
+              (NULL == lru || variant.lastUsed < lru->lastUsed) )
+         {
+            lru = &variant;
+         }
+      }
+
+      if ( NULL == lru )
+      {
+         break;
+      }
+
+      {
+#if OSG_MAJOR_VERSION < 2
+         OSG::CPEditor se(lru->slot, OSG::Node::ChildrenFieldMask);
+#endif
+         lru->slot->subChild(lru->root);
       }
+
+      lru->root       = OSG::NullFC;
+      mResidentBytes -= lru->bytes;
+      lru->bytes      = 0;
+
+      VRKIT_STATUS << "Removed model '" << lru->path << "' from memory"
+                   << std::endl;
    }
 }
 
+void ModelSwapPlugin::loaderLoop()
+{
+   initLoaderThread();
+
+   mLoaderCond.acquire();
+   {
+      mLoaderChangeList = OSG::Thread::getCurrentChangeList();
+
+      while ( ! mLoaderShutdown )
+      {
+         if ( mLoadQueue.empty() )
+         {
+            mLoaderCond.wait();
+            continue;
+         }
+
+         LoadResult result;
+         result.index = mLoadQueue.front();
+         mLoadQueue.pop_front();
+         const std::string path(mVariants[result.index].path);
+
+         mLoaderCond.release();
+         {
+            const vpr::Interval start(vpr::Interval::now());
+            result.root    = loadModel(path);
+            result.elapsed = vpr::Interval::now() - start;
+         }
+         mLoaderCond.acquire();
+
+         // Hand the model over and wait for the application thread to take
+         // the OpenSG changes that were made while reading it.
+         mResult      = result;
+         mResultReady = true;
+
+         while ( mResultReady && ! mLoaderShutdown )
+         {
+            mLoaderCond.wait();
+         }
+      }
+   }
+   mLoaderCond.release();
+}
+
+void ModelSwapPlugin::reportStatus(ViewerPtr viewer, const std::string& msg)
+{
+   VRKIT_STATUS << msg << std::endl;
+
+   StatusPanelDataPtr status_panel_data =
+      viewer->getSceneObj()->getSceneData<StatusPanelData>();
+   status_panel_data->addStatusMessage(msg);
+}
+
 }  // namespace vrkit
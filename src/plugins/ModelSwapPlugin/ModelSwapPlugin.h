@@ -22,18 +22,53 @@
 #include <vrkit/plugin/Config.h>
 
 #include <string>
+#include <vector>
+#include <deque>
 #include <boost/enable_shared_from_this.hpp>
 
+#include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGRefPtr.h>
 #include <OpenSG/OSGSwitch.h>
 
+#include <vpr/vprTypes.h>
+#include <vpr/Sync/CondVar.h>
+#include <vpr/Util/Interval.h>
+
 #include <vrkit/WandInterfacePtr.h>
+#include <vrkit/util/SceneCachePtr.h>
 #include <vrkit/viewer/Plugin.h>
 #include <vrkit/util/DigitalCommand.h>
 
 
+namespace OSG
+{
+   class ChangeList;
+}
+
+namespace vpr
+{
+   class Thread;
+}
+
 namespace vrkit
 {
 
+/**
+ * Shows one of a list of models at a time and swaps to the next one in the
+ * list when a button is pressed. Only the first model is read in init().
+ * The others are read by a background thread when they are first needed,
+ * and the model after the one being shown is read ahead of time. If a
+ * memory budget is configured, the least recently shown models are removed
+ * from memory to stay within it. The model being shown is never removed.
+ *
+ * Unlike levels of detail, the model that is shown does not depend on the
+ * position of the view platform. It changes only when the button is
+ * pressed, so a view platform destination (see
+ * vrkit::ViewPlatform::destinationSet()) says nothing about which model
+ * will be needed next, and this plug-in does not respond to it. The
+ * read-ahead of the next model in the list covers the one swap that can be
+ * anticipated.
+ */
 class ModelSwapPlugin
    : public viewer::Plugin
    , public boost::enable_shared_from_this<ModelSwapPlugin>
@@ -41,6 +76,16 @@ class ModelSwapPlugin
 protected:
    ModelSwapPlugin(const plugin::Info& info)
       : viewer::Plugin(info)
+      , mCurrent(0)
+      , mPending(-1)
+      , mMemoryBudget(0)
+      , mResidentBytes(0)
+      , mUseCount(0)
+      , mPrefetch(true)
+      , mLoader(NULL)
+      , mLoaderShutdown(false)
+      , mResultReady(false)
+      , mLoaderChangeList(NULL)
    {
       /* Do nothing. */ ;
    }
@@ -48,10 +93,11 @@ protected:
 public:
    static viewer::PluginPtr create(const plugin::Info& info);
 
-   virtual ~ModelSwapPlugin()
-   {
-      /* Do nothing. */ ;
-   }
+   /**
+    * Stops the background thread. A model that is still being read when
+    * this is invoked is discarded.
+    */
+   virtual ~ModelSwapPlugin();
 
    virtual std::string getDescription();
 
@@ -63,10 +109,117 @@ public:
    virtual void update(ViewerPtr viewer);
 
 protected:
+   /** A model in the swap order. */
+   struct Variant
+   {
+      Variant()
+         : bytes(0)
+         , lastUsed(0)
+         , loading(false)
+         , failed(false)
+      {
+         /* Do nothing. */ ;
+      }
+
+      std::string     path;
+      OSG::NodeRefPtr slot;       /**< The child of the switch for this model */
+      OSG::NodeRefPtr root;       /**< Null if the model is not in memory */
+      vpr::Uint64     bytes;      /**< Estimated memory usage */
+      vpr::Uint64     lastUsed;   /**< For least recently used eviction */
+      bool            loading;
+      bool            failed;     /**< The model could not be read */
+   };
+
+   /** The result of reading a model in the background. */
+   struct LoadResult
+   {
+      unsigned int    index;
+      OSG::NodeRefPtr root;       /**< Null if the model could not be read */
+      vpr::Interval   elapsed;
+   };
+
+   /**
+    * Reads the given model through the scene cache if there is one. The
+    * scene file is parsed while holding the lock returned by
+    * vrkit::util::getSceneFileLock(), because the background loader may
+    * run while other threads read scene files.
+    */
+   OSG::NodeRefPtr loadModel(const std::string& path) const;
+
+   /**
+    * Returns the index of the model after the given one in the swap order,
+    * skipping models that could not be read.
+    */
+   unsigned int getNextVariant(const unsigned int index) const;
+
+   /**
+    * Asks the background thread to read the given model if it is not in
+    * memory already.
+    *
+    * @param index  The model to read.
+    * @param urgent Read this model before any others that have been asked
+    *               for.
+    */
+   void requestLoad(const unsigned int index, const bool urgent);
+
+   /**
+    * Adds a model read by the background thread to its slot. If the model
+    * is the one waiting to be shown, it is shown.
+    */
+   void acceptResult(ViewerPtr viewer, const LoadResult& result);
+
+   /**
+    * Makes the given model the one shown and reports the time taken since
+    * the swap was requested. The collision hierarchy of the scene is
+    * invalidated.
+    */
+   void showVariant(ViewerPtr viewer, const unsigned int index);
+
+   /**
+    * Removes the least recently shown models from memory until the memory
+    * budget is met or only the model being shown (and the one waiting to
+    * be shown) are left.
+    */
+   void enforceBudget();
+
+   void loaderLoop();
+
+   void reportStatus(ViewerPtr viewer, const std::string& msg);
+
    WandInterfacePtr     mWandInterface; /**< Ptr to the wand interface to use. */
    util::DigitalCommand mSwapButton;    /**< Ptr to the digital button. */
    OSG::NodeRefPtr      mSwitchNode;
    OSG::SwitchRefPtr    mSwitchCore;
+   util::SceneCachePtr  mSceneCache;
+
+   std::vector<Variant> mVariants;
+   unsigned int         mCurrent;       /**< The model being shown */
+   int                  mPending;       /**< Model to show once read or -1 */
+   vpr::Interval        mSwapStart;     /**< When mPending was requested */
+   vpr::Uint64          mMemoryBudget;  /**< Bytes (0 means no limit) */
+   vpr::Uint64          mResidentBytes;
+   vpr::Uint64          mUseCount;
+   bool                 mPrefetch;
+
+   /** @name Background Loading */
+   //@{
+   vpr::Thread*             mLoader;
+
+   // State shared with the loader thread (protected by mLoaderCond).
+   vpr::CondVar             mLoaderCond;
+   std::deque<unsigned int> mLoadQueue;
+   bool                     mLoaderShutdown;
+
+   /**
+    * Indicates that \c mResult holds a model that the application thread
+    * has not accepted yet. The loader thread waits until it has, so that
+    * the application thread can take the OpenSG changes that were made
+    * while reading the model from \c mLoaderChangeList.
+    */
+   bool                     mResultReady;
+   LoadResult               mResult;
+   OSG::ChangeList*         mLoaderChangeList;
+   //@}
 }; // ModelSwapPlugin
 
 }  // namespace vrkit
@@ -159,7 +159,7 @@ void PickPlugin::update(ViewerPtr)
          if (mIntersectedObj == mPickedObj)
          {
             std::cout << "Double click deselect" << std::endl;
-            mEventData->objectUnpicked(mPickedObj);
+            mEventData->postObjectUnpicked(mPickedObj);
             mPickedObj = SceneObjectPtr();
             mPicking = false;
          }
@@ -168,7 +168,7 @@ void PickPlugin::update(ViewerPtr)
             if (mPickedObj != NULL)
             {
                std::cout << "New object selected, so deselect" << std::endl;
-               mEventData->objectUnpicked(mPickedObj);
+               mEventData->postObjectUnpicked(mPickedObj);
                mPickedObj = SceneObjectPtr();
                mPicking = false;
             }
@@ -178,7 +178,7 @@ void PickPlugin::update(ViewerPtr)
             mPicking = true;
 
             // Send a select event.
-            mEventData->objectPicked(mPickedObj);
+            mEventData->postObjectPicked(mPickedObj);
          }
       }
    }
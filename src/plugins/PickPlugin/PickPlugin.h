@@ -31,6 +31,7 @@
 #include <vrkit/SceneObjectPtr.h>
 #include <vrkit/WandInterfacePtr.h>
 #include <vrkit/scenedata/EventDataPtr.h>
+#include <vrkit/signal/Connection.h>
 #include <vrkit/util/DigitalCommand.h>
 #include <vrkit/isect/Strategy.h>
 #include <vrkit/viewer/Plugin.h>
@@ -120,8 +121,8 @@ private:
    /** @name Intersection Strategy */
    //@{
    gmtl::Point3f mIntersectPoint;
-   boost::signals::connection mIsectConnection;
-   boost::signals::connection mDeIsectConnection;
+   signal::Connection mIsectConnection;
+   signal::Connection mDeIsectConnection;
    //@}
 
    EventDataPtr mEventData;
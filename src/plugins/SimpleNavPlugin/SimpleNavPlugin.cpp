@@ -109,6 +109,9 @@ viewer::PluginPtr SimpleNavPlugin::init(ViewerPtr viewer)
    const std::string rev_btn_prop("reverse_button_nums");
    const std::string rot_btn_prop("rotate_button_nums");
    const std::string mode_btn_prop("nav_mode_button_nums");
+   const std::string collision_prop("collision_detection");
+   const std::string radius_prop("collision_radius");
+   const std::string step_height_prop("step_height");
    const int unsigned req_cfg_version(2);
 
    InterfaceTrader& if_trader = viewer->getUser()->getInterfaceTrader();
@@ -147,6 +150,14 @@ viewer::PluginPtr SimpleNavPlugin::init(ViewerPtr viewer)
    mModeBtn.configure(elt->getProperty<std::string>(mode_btn_prop),
                       mWandInterface);
 
+   // Collision detection was added in version 3.
+   if ( elt->getVersion() >= 3 )
+   {
+      mCollider.setEnabled(elt->getProperty<bool>(collision_prop));
+      mCollider.setRadius(elt->getProperty<float>(radius_prop));
+      mCollider.setStepHeight(elt->getProperty<float>(step_height_prop));
+   }
+
    return shared_from_this();
 }
 
@@ -216,36 +227,20 @@ void SimpleNavPlugin::focusChanged(ViewerPtr viewer)
 void SimpleNavPlugin::updateNav(ViewerPtr viewer, ViewPlatform& viewPlatform)
 {
    NavState nav_state(RESET);
+   int direction(0);
 
    if ( isFocused() )
    {
       vprASSERT(mWandInterface.get() != NULL && "No valid wand interface");
 
-      const float inc_vel(0.005f);
-      const float max_vel(0.5f);
-
-      // Update velocity
+      // Determine which way to accelerate.
       if ( mForBtn() )
       {
-         mVelocity += inc_vel;
+         direction = 1;
       }
       else if ( mRevBtn() )
       {
-         mVelocity -= inc_vel;
-      }
-      else if ( mVelocity > 0 )
-      {
-         mVelocity = 0.0f;
-      }
-
-      // Restrict range
-      if ( mVelocity < -max_vel )
-      {
-         mVelocity = -max_vel;
-      }
-      if ( mVelocity > max_vel )
-      {
-         mVelocity = max_vel;
+         direction = -1;
       }
 
       // Swap the navigation mode if the mode switching button was toggled on.
@@ -272,79 +267,123 @@ void SimpleNavPlugin::updateNav(ViewerPtr viewer, ViewPlatform& viewPlatform)
       }
    }
 
-   if ( mCanNavigate )
+   if ( ! mCanNavigate )
+   {
+      mIntegrator.reset();
+   }
+   else if ( RESET == nav_state )
+   {
+      mVelocity = 0.0f;
+      mIntegrator.reset();
+      viewPlatform.setCurPos(gmtl::MAT_IDENTITY44F);
+   }
+   else
+   {
+      mIntegrator.update(mWandInterface->getSnapshot().getTimeStamp(),
+                         viewPlatform,
+                         boost::bind(&SimpleNavPlugin::step, this, viewer,
+                                     nav_state, direction, _1, _2));
+   }
+}
+
+void SimpleNavPlugin::step(ViewerPtr viewer, const NavState navState,
+                           const int direction, gmtl::Matrix44f& curPos,
+                           const float dt)
+{
+   // These rates give the same motion as the original per-frame values did
+   // at 60 Hz.
+   const float accel(18.0f);         // Units per second squared
+   const float max_vel(30.0f);       // Units per second
+   const float rot_rate(0.3f);       // Fraction of the wand rotation per second
+
+   // Update velocity
+   if ( direction != 0 )
+   {
+      mVelocity += direction * accel * dt;
+   }
+   else
+   {
+      mVelocity = 0.0f;
+   }
+
+   // Restrict range
+   if ( mVelocity < -max_vel )
    {
-      gmtl::Matrix44f cur_pos = viewPlatform.getCurPos();
+      mVelocity = -max_vel;
+   }
+   if ( mVelocity > max_vel )
+   {
+      mVelocity = max_vel;
+   }
+
+   switch ( navState )
+   {
+      case RESET:
+         break;
+      // Handle rotations.
+      case ROTATE:
+         {
+            gmtl::Matrix44f rot_mat(
+               mWandInterface->getSnapshot().getWandPos()
+            );
+            gmtl::setTrans(rot_mat, gmtl::Vec3f(0.0f, 0.0f, 0.0f));
+
+            if ( gmtl::MAT_IDENTITY44F != rot_mat )
+            {
+               float y_rot = gmtl::makeYRot(rot_mat);
+               gmtl::Quatf goal_quat(0.0f, 1.0f, 0.0f, y_rot);
 
-      const float scale_factor(viewer->getDrawScaleFactor());
+               gmtl::Quatf source_quat;
+               gmtl::Quatf slerp_quat;
+               gmtl::slerp(slerp_quat, rot_rate * dt, source_quat, goal_quat);
 
-      switch ( nav_state )
-      {
-         case RESET:
-            mVelocity = 0.0f;
-            gmtl::identity(cur_pos);
-            break;
-         // Handle rotations.
-         case ROTATE:
+               gmtl::Matrix44f rot_xform;
+               gmtl::set(rot_xform, slerp_quat);
+               gmtl::postMult(curPos, rot_xform);
+            }
+         }
+         break;
+      // Travel in model.
+      case TRANSLATE:
+         {
+            // - Find forward direction of wand (negative z)
+            // - Translate along that direction
+            // Get the wand matrix
+            // - Translation is in the real world (virtual platform)
+            //   coordinate system
+            gmtl::Matrix44f wand_mat(
+               mWandInterface->getSnapshot().getWandPos()
+            );
+            gmtl::Vec3f z_dir = gmtl::Vec3f(0.0f, 0.0f, -mVelocity * dt);
+            gmtl::Vec3f trans = wand_mat * z_dir;
+
+            gmtl::Matrix44f trans_mat;
+            gmtl::setTrans(trans_mat, trans);
+
+            const gmtl::Matrix44f prev_pos(curPos);
+
+            // vw_M_vp = vw_M_vp * vp_M_vp'
+            curPos = curPos * trans_mat;
+
+            // Keep the user from moving through the scene. In walk mode,
+            // this also puts the user on the ground.
+            if ( mCollider.isEnabled() )
             {
-               gmtl::Matrix44f rot_mat(
-                  mWandInterface->getWandPos()->getData(scale_factor)
-               );
-               gmtl::setTrans(rot_mat, gmtl::Vec3f(0.0f, 0.0f, 0.0f));
-
-               if ( gmtl::MAT_IDENTITY44F != rot_mat )
-               {
-                  float y_rot = gmtl::makeYRot(rot_mat);
-                  gmtl::Quatf goal_quat(0.0f, 1.0f, 0.0f, y_rot);
-
-                  gmtl::Quatf source_quat;
-                  gmtl::Quatf slerp_quat;
-                  // XXX: This needs to be time-based rotation.  This value of
-                  // 0.005f is to compensate for a high frame rate with a
-                  // simple test model.
-                  gmtl::slerp(slerp_quat, 0.005f, source_quat, goal_quat);
-
-                  gmtl::Matrix44f rot_xform;
-                  gmtl::set(rot_xform, slerp_quat);
-                  gmtl::postMult(cur_pos, rot_xform);
-               }
+               curPos = mCollider.constrain(viewer, prev_pos, curPos,
+                                            mNavMode == WALK);
             }
-            break;
-         // Travel in model.
-         case TRANSLATE:
+            // If we are in walk mode, we have to clamp the Y translation
+            // value to the "ground."
+            else if ( mNavMode == WALK )
             {
-               // - Find forward direction of wand (negative z)
-               // - Translate along that direction
-               // Get the wand matrix
-               // - Translation is in the real world (virtual platform)
-               //   coordinate system
-               gmtl::Matrix44f wand_mat(
-                  mWandInterface->getWandPos()->getData(scale_factor)
-               );
-               gmtl::Vec3f z_dir = gmtl::Vec3f(0.0f, 0.0f, -mVelocity);
-               gmtl::Vec3f trans = wand_mat * z_dir;
-
-               gmtl::Matrix44f trans_mat;
-               gmtl::setTrans(trans_mat, trans);
-
-               // vw_M_vp = vw_M_vp * vp_M_vp'
-               cur_pos = cur_pos * trans_mat;
-
-               // If we are in walk mode, we have to clamp the Y translation
-               // value to the "ground."
-               if ( mNavMode == WALK )
-               {
-                  // Remember that GMTL matrices are column-major.
-                  cur_pos[1][3] = 0.0f;
-               }
+               // Remember that GMTL matrices are column-major.
+               curPos[1][3] = 0.0f;
             }
-            break;
-         default:
-            vprASSERT(false && "Bad value in nav_state");
-            break;
-      }
-
-      viewPlatform.setCurPos(cur_pos);
+         }
+         break;
+      default:
+         vprASSERT(false && "Bad value in nav_state");
+         break;
    }
 }
 
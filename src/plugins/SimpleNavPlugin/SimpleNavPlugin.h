@@ -23,8 +23,12 @@
 
 #include <boost/enable_shared_from_this.hpp>
 
+#include <gmtl/Matrix.h>
+
 #include <vrkit/WandInterfacePtr.h>
 #include <vrkit/nav/Strategy.h>
+#include <vrkit/nav/Collider.h>
+#include <vrkit/nav/Integrator.h>
 #include <vrkit/util/DigitalCommand.h>
 
 
@@ -75,6 +79,15 @@ protected:
 
    virtual void updateNav(ViewerPtr viewer, ViewPlatform& viewPlatform);
 
+   /**
+    * Advances navigation by one fixed time step. This is invoked by
+    * \c mIntegrator zero or more times per frame.
+    *
+    * @since 0.51.16
+    */
+   void step(ViewerPtr viewer, const NavState navState, const int direction,
+             gmtl::Matrix44f& curPos, const float dt);
+
    static std::string getElementType()
    {
       return std::string("simple_nav_plugin");
@@ -84,9 +97,12 @@ protected:
 
    bool mCanNavigate;
 
-   float mVelocity;
+   float mVelocity;             /**< Units per second */
    NavMode mNavMode;
 
+   nav::Collider mCollider;     /**< Collision detection with the scene. */
+   nav::Integrator mIntegrator; /**< Frame rate independent stepping. */
+
    util::DigitalCommand mForBtn;         /**< Button for forward motion. */
    util::DigitalCommand mRevBtn;         /**< Button for reverse. */
    util::DigitalCommand mRotateBtn;      /**< Button for rotate. */
@@ -209,14 +209,10 @@ viewer::PluginPtr StatusPanelPlugin::init(ViewerPtr viewer)
    typedef boost::signal<void (bool)> sig_type;
    const std::string sig_name("Toggle Status Panel Visibility");
 
-   if ( ! sig_repos->hasSignal(sig_name) )
-   {
-      sig_repos->addSignal(sig_name, signal::Container<sig_type>::create());
-   }
-
-   // Connect new signal to slot after SwitchNode creation
+   // Connect new signal to slot after SwitchNode creation. The signal is
+   // registered if no other code has done so yet.
    mVisConn =
-      sig_repos->getSignal<sig_type>(sig_name)->connect(
+      sig_repos->getOrAddSignal<sig_type>(sig_name)->connect(
          boost::bind(&StatusPanelPlugin::setVisibility, this, _1)
       );
 
@@ -235,7 +235,7 @@ VideoCapturePlugin::~VideoCapturePlugin()
    }
 
    std::for_each(mConnections.begin(), mConnections.end(),
-                 boost::bind(&boost::signals::connection::disconnect, _1));
+                 boost::bind(&signal::Connection::disconnect, _1));
 }
 
 void VideoCapturePlugin::contextInit(ViewerPtr viewer)
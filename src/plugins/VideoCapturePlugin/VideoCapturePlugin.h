@@ -24,7 +24,6 @@
 #include <string>
 #include <vector>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/signals/connection.hpp>
 
 #include <OpenSG/OSGSwitch.h>
 #include <OpenSG/OSGTransform.h>
@@ -34,6 +33,7 @@
 #include <vrkit/ViewerPtr.h>
 #include <vrkit/viewer/Plugin.h>
 #include <vrkit/video/RecorderPtr.h>
+#include <vrkit/signal/Connection.h>
 #include <vrkit/util/DigitalCommand.h>
 
 
@@ -120,7 +120,7 @@ private:
    OSG::SwitchNodePtr   mDebugFrameNode;
    OSG::TransformRefPtr mDebugFrameXform;
 
-   std::vector<boost::signals::connection> mConnections;
+   std::vector<signal::Connection> mConnections;
 
    util::DigitalCommand mStartCmd;
    util::DigitalCommand mPauseCmd;
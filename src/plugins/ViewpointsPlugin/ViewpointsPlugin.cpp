@@ -21,6 +21,7 @@
 #endif
 
 #include <sstream>
+#include <algorithm>
 #include <boost/bind.hpp>
 #include <boost/format.hpp>
 #include <boost/assign/list_of.hpp>
@@ -52,6 +53,8 @@ namespace
    const std::string vp_control_command_exp_tkn("control_command_exp");
    const std::string vp_viewpoints_tkn("viewpoints");
    const std::string vp_units_to_meters_tkn("units_to_meters");
+   const std::string vp_transition_duration_tkn("transition_duration");
+   const std::string vp_transition_easing_tkn("transition_easing");
 
    const std::string vp_vp_elt_tkn("viewpoints_vp");
    const std::string vp_pos_elt_tkn("position");
@@ -140,6 +143,21 @@ viewer::PluginPtr ViewpointsPlugin::init(ViewerPtr viewer)
 
    float to_meters_scalar = elt->getProperty<float>(vp_units_to_meters_tkn);
 
+   // Animated transitions were added in version 3. Older configurations
+   // jump to the viewpoint as before.
+   if ( elt->getVersion() >= 3 )
+   {
+      mTransitionDuration =
+         std::max(elt->getProperty<float>(vp_transition_duration_tkn), 0.0f);
+
+      const int easing = elt->getProperty<int>(vp_transition_easing_tkn);
+      if ( easing >= nav::CameraPath::LINEAR &&
+           easing <= nav::CameraPath::EASE_OUT )
+      {
+         mEasing = static_cast<nav::CameraPath::Easing>(easing);
+      }
+   }
+
    // Read in all the viewpoints
    unsigned int num_vps = elt->getNum(vp_viewpoints_tkn);
    for ( unsigned int i = 0; i < num_vps; ++i )
@@ -186,11 +204,18 @@ viewer::PluginPtr ViewpointsPlugin::init(ViewerPtr viewer)
 // Update the state of the plugin
 // - If there are viewpoints and the button is pressed
 //    - Get the new transform
-//    - Set it on the viewplatform
+//    - Start a transition to it (or set it on the viewplatform)
 //    - Get ready for the next location
+// - Move the viewplatform along the transition path
 //
 void ViewpointsPlugin::update(ViewerPtr viewer)
 {
+   ViewPlatform& viewplatform = viewer->getUser()->getViewPlatform();
+
+   // The time stamp of the wand snapshot is used as the clock so that
+   // transitions are reproduced exactly when wand input is played back.
+   const vpr::Interval cur_time(mWandInterface->getSnapshot().getTimeStamp());
+
    if ( isFocused() )
    {
       // If we have viewpoints and the button has been pressed
@@ -206,8 +231,20 @@ void ViewpointsPlugin::update(ViewerPtr viewer)
          gmtl::Coord3fXYZ new_coord = gmtl::make<gmtl::Coord3fXYZ>(vp.mXform);
          VRKIT_STATUS << "   New pos: " << new_coord << std::endl;
 
-         ViewPlatform& viewplatform = viewer->getUser()->getViewPlatform();
-         viewplatform.setCurPos(vp.mXform);
+         if ( mTransitionDuration > 0.0f )
+         {
+            // A transition already in progress continues from wherever the
+            // view platform is now.
+            mTransitionPath.build(viewplatform.getCurPos(), vp.mXform);
+            mTransitionTarget = vp.mXform;
+            mTransitionStart  = cur_time;
+            mInTransition     = true;
+            viewplatform.setDestination(vp.mXform);
+         }
+         else
+         {
+            viewplatform.setCurPos(vp.mXform);
+         }
 
          mNextViewpoint += 1;
          if ( mNextViewpoint >= mViewpoints.size() )
@@ -216,6 +253,29 @@ void ViewpointsPlugin::update(ViewerPtr viewer)
          }
       }
    }
+
+   if ( mInTransition )
+   {
+      float t(0.0f);
+      if ( cur_time > mTransitionStart )
+      {
+         t = (cur_time - mTransitionStart).secf() / mTransitionDuration;
+      }
+
+      if ( t >= 1.0f )
+      {
+         viewplatform.setCurPos(mTransitionTarget);
+         viewplatform.clearDestination();
+         mTransitionPath.clear();
+         mInTransition = false;
+      }
+      else
+      {
+         viewplatform.setCurPos(
+            mTransitionPath.evaluate(nav::CameraPath::ease(mEasing, t))
+         );
+      }
+   }
 }
 
 } // namespace vrkit
@@ -25,17 +25,23 @@
 #include <vector>
 #include <boost/enable_shared_from_this.hpp>
 #include <gmtl/Matrix.h>
+#include <vpr/Util/Interval.h>
 
 #include <vrkit/WandInterfacePtr.h>
 #include <vrkit/viewer/Plugin.h>
 #include <vrkit/util/DigitalCommand.h>
+#include <vrkit/nav/CameraPath.h>
 
 
 namespace vrkit
 {
 
 /**
- * Plug-in for moving between configured viewpoints.
+ * Plug-in for moving between configured viewpoints. Unless the configured
+ * transition duration is zero, the view platform is animated along a path
+ * from its current position to the selected viewpoint. The destination is
+ * announced through vrkit::ViewPlatform::setDestination() when the
+ * transition starts.
  */
 class ViewpointsPlugin
    : public viewer::Plugin
@@ -45,6 +51,9 @@ protected:
    ViewpointsPlugin(const plugin::Info& info)
       : viewer::Plugin(info)
       , mNextViewpoint(0)
+      , mTransitionDuration(0.0f)
+      , mEasing(nav::CameraPath::EASE_IN_OUT)
+      , mInTransition(false)
    {;}
 
 public:
@@ -74,6 +83,16 @@ private:
    util::DigitalCommand    mControlCmd;         /**< The control digital command. */
    unsigned int            mNextViewpoint;      /**< The next viewpoint to switch to. */
    std::vector<Viewpoint>  mViewpoints;         /**< The predefined viewpoints. */
+
+   /** @name Viewpoint Transitions */
+   //@{
+   float                   mTransitionDuration; /**< Seconds; 0 jumps to the viewpoint. */
+   nav::CameraPath::Easing mEasing;
+   bool                    mInTransition;
+   vpr::Interval           mTransitionStart;
+   gmtl::Matrix44f         mTransitionTarget;
+   nav::CameraPath         mTransitionPath;
+   //@}
 };
 
 } // namespace vrkit
@@ -92,11 +92,12 @@ namespace vrkit
 
 WandNavPlugin::WandNavPlugin(const plugin::Info& info)
    : nav::Strategy(info)
-   , mLastFrameTime(0, vpr::Interval::Sec)
    , mCanNavigate(false)
    , mVelocity(0.0f)
    , mMaxVelocity(0.5f)
-   , mAcceleration(0.005f)
+   , mAcceleration(0.3f)
+   , mDeceleration(0.3f)
+   , mIsDecelerationEnabled(true)
    , mRotationSensitivity(0.5f)
    , mNavMode(WALK)
    , mForwardText("Forward")
@@ -139,6 +140,9 @@ bool WandNavPlugin::config(jccl::ConfigElementPtr elt)
    const std::string reset_btn_prop("reset_button_nums");
    const std::string initial_mode_prop("initial_mode");
    const std::string rotation_sensitivity("rotation_sensitivity");
+   const std::string collision_prop("collision_detection");
+   const std::string radius_prop("collision_radius");
+   const std::string step_height_prop("step_height");
    const unsigned int req_cfg_version(3);
 
    vprASSERT(elt->getID() == getElementType() &&
@@ -171,6 +175,15 @@ bool WandNavPlugin::config(jccl::ConfigElementPtr elt)
    float max_velocity = elt->getProperty<float>("max_velocity");
    float accel        = elt->getProperty<float>("acceleration");
    float decel        = elt->getProperty<float>("deceleration");
+
+   // Before version 5, acceleration and deceleration were applied once per
+   // frame. Convert them to units per second squared assuming the 60 Hz
+   // frame rate for which the old defaults were chosen.
+   if ( elt->getVersion() < 5 )
+   {
+      accel *= 60.0f;
+      decel *= 60.0f;
+   }
    mIsDecelerationEnabled = elt->getProperty<bool>("enable_deceleration");
    mRotationSensitivity = elt->getProperty<float>(rotation_sensitivity);
 
@@ -201,6 +214,14 @@ bool WandNavPlugin::config(jccl::ConfigElementPtr elt)
    mResetBtn.configure(elt->getProperty<std::string>(reset_btn_prop),
                        mWandInterface);
 
+   // Collision detection was added in version 4.
+   if ( elt->getVersion() >= 4 )
+   {
+      mCollider.setEnabled(elt->getProperty<bool>(collision_prop));
+      mCollider.setRadius(elt->getProperty<float>(radius_prop));
+      mCollider.setStepHeight(elt->getProperty<float>(step_height_prop));
+   }
+
    // Get initial mode
    unsigned int mode_id = elt->getProperty<unsigned int>(initial_mode_prop);
    if ( WandNavPlugin::WALK == mode_id )
@@ -298,51 +319,22 @@ void WandNavPlugin::focusChanged(ViewerPtr viewer)
 void WandNavPlugin::updateNav(ViewerPtr viewer, ViewPlatform& viewPlatform)
 {
    NavState nav_state(NONE);
+   int direction(0);
 
    if ( isFocused() )
    {
       vprASSERT(mWandInterface.get() != NULL && "No valid wand interface");
 
-      // Update velocity
+      // Determine which way to accelerate. The velocity itself is updated in
+      // step() so that it changes at the same rate regardless of the frame
+      // rate.
       if ( mForwardBtn() )
       {
-         mVelocity += mAcceleration;
+         direction = 1;
       }
       else if ( mReverseBtn() )
       {
-         mVelocity -= mAcceleration;
-      }
-      else if ( mVelocity != 0.0f )
-      {
-         if ( mIsDecelerationEnabled )
-         {
-            if( fabs(mVelocity) <= mDeceleration )
-            {
-               mVelocity = 0.0f;
-            }
-            else if ( mVelocity > 0.0f )
-            {
-               mVelocity -= mDeceleration;
-            }
-            else
-            {
-               mVelocity += mDeceleration;
-            }
-         }
-         else
-         {
-            mVelocity = 0.0f;
-         }
-      }
-
-      // Restrict velocity range to [0.0,max_vel].
-      if ( mVelocity < -mMaxVelocity )
-      {
-         mVelocity = -mMaxVelocity;
-      }
-      if ( mVelocity > mMaxVelocity )
-      {
-         mVelocity = mMaxVelocity;
+         direction = -1;
       }
 
       // Swap the navigation mode if the mode switching button was toggled on.
@@ -369,104 +361,148 @@ void WandNavPlugin::updateNav(ViewerPtr viewer, ViewPlatform& viewPlatform)
       }
    }
 
-   // Perform the work of navigating.
-   const vpr::Interval cur_time(mWandInterface->getWandPos()->getTimeStamp());
-   const vpr::Interval delta(cur_time - mLastFrameTime);
-   float delta_sec(0.0f);
+   if ( ! mCanNavigate )
+   {
+      mIntegrator.reset();
+   }
+   else if ( RESET == nav_state )
+   {
+      mVelocity = 0.0f;
+      mIntegrator.reset();
+      viewPlatform.setCurPos(gmtl::MAT_IDENTITY44F);
+   }
+   else
+   {
+      // The time base is the time stamp of the wand snapshot so that the
+      // navigation is reproduced exactly when wand input is played back.
+      mIntegrator.update(mWandInterface->getSnapshot().getTimeStamp(),
+                         viewPlatform,
+                         boost::bind(&WandNavPlugin::step, this, viewer,
+                                     nav_state, direction, _1, _2));
+   }
+}
 
-   // Sanity check on the frame delta.
-   if ( cur_time > mLastFrameTime )
+void WandNavPlugin::step(ViewerPtr viewer, const NavState navState,
+                         const int direction, gmtl::Matrix44f& curPos,
+                         const float dt)
+{
+   // Update velocity
+   if ( direction != 0 )
    {
-      delta_sec = delta.secf();
+      mVelocity += direction * mAcceleration * dt;
+   }
+   else if ( mVelocity != 0.0f )
+   {
+      if ( mIsDecelerationEnabled )
+      {
+         const float decel(mDeceleration * dt);
 
-      if ( delta_sec > 1.0f )
+         if ( fabs(mVelocity) <= decel )
+         {
+            mVelocity = 0.0f;
+         }
+         else if ( mVelocity > 0.0f )
+         {
+            mVelocity -= decel;
+         }
+         else
+         {
+            mVelocity += decel;
+         }
+      }
+      else
       {
-         delta_sec = 1.0f;
+         mVelocity = 0.0f;
       }
    }
 
-   mLastFrameTime = cur_time;
+   // Restrict velocity range to [-max_vel,max_vel].
+   if ( mVelocity < -mMaxVelocity )
+   {
+      mVelocity = -mMaxVelocity;
+   }
+   if ( mVelocity > mMaxVelocity )
+   {
+      mVelocity = mMaxVelocity;
+   }
 
-   if ( mCanNavigate )
+   switch ( navState )
    {
-      gmtl::Matrix44f cur_pos = viewPlatform.getCurPos();
-      const float scale_factor(viewer->getDrawScaleFactor());
+      // Do nothing if so directed. Resetting is handled by updateNav().
+      case NONE:
+      case RESET:
+         break;
+      // Handle rotations.
+      case ROTATE:
+         {
+            const gmtl::Vec3f y_axis(0.0, 1.0, 0.0);
 
-      switch ( nav_state )
-      {
-         // Do nothing if so directed.
-         case NONE:
-            break;
-         // Handle reset.
-         case RESET:
-            mVelocity = 0.0f;
-            gmtl::identity(cur_pos);
-            break;
-         // Handle rotations.
-         case ROTATE:
+            gmtl::Matrix44f rot_mat(
+               mWandInterface->getSnapshot().getWandPos()
+            );
+            gmtl::setTrans(rot_mat, gmtl::Vec3f(0.0f, 0.0f, 0.0f));
+
+            if ( gmtl::MAT_IDENTITY44F != rot_mat )
             {
-               const gmtl::Vec3f y_axis(0.0, 1.0, 0.0);
-
-               gmtl::Matrix44f rot_mat(
-                  mWandInterface->getWandPos()->getData(scale_factor)
-               );
-               gmtl::setTrans(rot_mat, gmtl::Vec3f(0.0f, 0.0f, 0.0f));
-
-               if ( gmtl::MAT_IDENTITY44F != rot_mat )
-               {
-                  float y_rot = gmtl::makeYRot(rot_mat);
-                  gmtl::Matrix44f goal_mat =
-                     gmtl::make<gmtl::Matrix44f>(gmtl::AxisAnglef(y_rot,
-                                                                  y_axis));
-                  gmtl::Quatf goal_quat = gmtl::make<gmtl::Quatf>(goal_mat);
-
-                  gmtl::Quatf source_quat;
-                  gmtl::Quatf slerp_quat;
-                  gmtl::slerp(slerp_quat, delta_sec * mRotationSensitivity,
-                              source_quat, goal_quat);
-
-                  gmtl::Matrix44f rot_xform;
-                  gmtl::set(rot_xform, slerp_quat);
-                  gmtl::postMult(cur_pos, rot_xform);
-               }
+               float y_rot = gmtl::makeYRot(rot_mat);
+               gmtl::Matrix44f goal_mat =
+                  gmtl::make<gmtl::Matrix44f>(gmtl::AxisAnglef(y_rot,
+                                                               y_axis));
+               gmtl::Quatf goal_quat = gmtl::make<gmtl::Quatf>(goal_mat);
+
+               gmtl::Quatf source_quat;
+               gmtl::Quatf slerp_quat;
+               gmtl::slerp(slerp_quat, dt * mRotationSensitivity,
+                           source_quat, goal_quat);
+
+               gmtl::Matrix44f rot_xform;
+               gmtl::set(rot_xform, slerp_quat);
+               gmtl::postMult(curPos, rot_xform);
             }
-            break;
-         // Travel in model.
-         case TRANSLATE:
+         }
+         break;
+      // Travel in model.
+      case TRANSLATE:
+         {
+            // - Find forward direction of wand (negative z)
+            // - Translate along that direction
+            // Get the wand matrix
+            // - Translation is in the real world (virtual platform)
+            //   coordinate system
+            gmtl::Matrix44f wand_mat(
+               mWandInterface->getSnapshot().getWandPos()
+            );
+            gmtl::Vec3f z_dir(0.0f, 0.0f, -mVelocity);
+            gmtl::Vec3f trans_delta = z_dir * dt;
+            gmtl::Vec3f trans = wand_mat * trans_delta;
+
+            gmtl::Matrix44f trans_mat;
+            gmtl::setTrans(trans_mat, trans);
+
+            const gmtl::Matrix44f prev_pos(curPos);
+
+            // vw_M_vp = vw_M_vp * vp_M_vp'
+            curPos = curPos * trans_mat;
+
+            // Keep the user from moving through the scene. In walk mode,
+            // this also puts the user on the ground.
+            if ( mCollider.isEnabled() )
             {
-               // - Find forward direction of wand (negative z)
-               // - Translate along that direction
-               // Get the wand matrix
-               // - Translation is in the real world (virtual platform)
-               //   coordinate system
-               gmtl::Matrix44f wand_mat(
-                  mWandInterface->getWandPos()->getData(scale_factor)
-               );
-               gmtl::Vec3f z_dir(0.0f, 0.0f, -mVelocity);
-               gmtl::Vec3f trans_delta = z_dir * delta_sec;
-               gmtl::Vec3f trans = wand_mat * trans_delta;
-
-               gmtl::Matrix44f trans_mat;
-               gmtl::setTrans(trans_mat, trans);
-
-               // vw_M_vp = vw_M_vp * vp_M_vp'
-               cur_pos = cur_pos * trans_mat;
-
-               // If we are in walk mode, we have to clamp the Y translation
-               // value to the "ground."
-               if ( mNavMode == WALK )
-               {
-                  // Remember that GMTL matrices are column-major.
-                  cur_pos[1][3] = 0.0f;
-               }
+               curPos = mCollider.constrain(viewer, prev_pos, curPos,
+                                            mNavMode == WALK);
             }
-            break;
-         default:
-            vprASSERT(false && "Bad value for nav_state");
-            break;
-      }
-
-      viewPlatform.setCurPos(cur_pos);
+            // If we are in walk mode, we have to clamp the Y translation
+            // value to the "ground."
+            else if ( mNavMode == WALK )
+            {
+               // Remember that GMTL matrices are column-major.
+               curPos[1][3] = 0.0f;
+            }
+         }
+         break;
+      default:
+         vprASSERT(false && "Bad value for nav_state");
+         break;
    }
 }
 
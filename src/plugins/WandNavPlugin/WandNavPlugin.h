@@ -23,11 +23,13 @@
 
 #include <boost/enable_shared_from_this.hpp>
 
-#include <vpr/Util/Interval.h>
+#include <gmtl/Matrix.h>
 
 #include <vrkit/WandInterfacePtr.h>
 #include <vrkit/util/DigitalCommand.h>
 #include <vrkit/nav/Strategy.h>
+#include <vrkit/nav/Collider.h>
+#include <vrkit/nav/Integrator.h>
 
 
 namespace vrkit
@@ -65,8 +67,13 @@ public:
 
    /** @name Configuration methods */
    //@{
+   /** Sets the maximum velocity in units per second. */
    void setMaximumVelocity(const float minVelocity);
+
+   /** Sets the acceleration in units per second squared. */
    void setAcceleration(const float acceleration);
+
+   /** Sets the deceleration in units per second squared. */
    void setDeceleration(const float deceleration);
    //@}
 
@@ -90,25 +97,42 @@ protected:
 
    virtual void updateNav(ViewerPtr viewer, ViewPlatform& viewPlatform);
 
+   /**
+    * Advances navigation by one fixed time step. This is invoked by
+    * \c mIntegrator zero or more times per frame.
+    *
+    * @param viewer    The VR Juggler application object.
+    * @param navState  The navigation state sampled at the start of the frame.
+    * @param direction 1 to accelerate forward, -1 to accelerate in reverse,
+    *                  or 0 to slow down.
+    * @param curPos    The view platform transformation to advance.
+    * @param dt        The length of the step in seconds.
+    *
+    * @since 0.51.16
+    */
+   void step(ViewerPtr viewer, const NavState navState, const int direction,
+             gmtl::Matrix44f& curPos, const float dt);
+
    static std::string getElementType()
    {
       return std::string("wand_nav_plugin");
    }
 
-   vpr::Interval mLastFrameTime;
-
    WandInterfacePtr mWandInterface;
 
    bool mCanNavigate;
 
-   float mVelocity;
-   float mMaxVelocity;
-   float mAcceleration;
-   float mDeceleration;
+   float mVelocity;        /**< Units per second */
+   float mMaxVelocity;     /**< Units per second */
+   float mAcceleration;    /**< Units per second squared */
+   float mDeceleration;    /**< Units per second squared */
    bool mIsDecelerationEnabled;
    float mRotationSensitivity;      /**< Scalar on rotation delta.  Used to adjust sensitivity. */
    NavMode mNavMode;
 
+   nav::Collider mCollider;     /**< Collision detection with the scene. */
+   nav::Integrator mIntegrator; /**< Frame rate independent stepping. */
+
    util::DigitalCommand mForwardBtn;     /**< Button for forward motion. */
    util::DigitalCommand mReverseBtn;     /**< Button for reverse. */
    util::DigitalCommand mRotateBtn;      /**< Button for rotate. */
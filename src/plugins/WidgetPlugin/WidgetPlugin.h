@@ -24,7 +24,6 @@
 #include <string>
 #include <vector>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/signal.hpp>
 
 #include <gmtl/Matrix.h>
 #include <jccl/Config/ConfigElementPtr.h>
@@ -35,6 +34,7 @@
 #include <vrkit/scenedata/Event.h>
 #include <vrkit/scenedata/WidgetDataPtr.h>
 #include <vrkit/scenedata/EventData.h>
+#include <vrkit/signal/Connection.h>
 #include <vrkit/viewer/Plugin.h>
 #include <vrkit/isect/Strategy.h>
 #include <vrkit/util/DigitalCommand.h>
@@ -162,12 +162,12 @@ private:
 
    /** @name Intersection Strategy */
    //@{
-   boost::signals::connection mIsectConnection;
-   boost::signals::connection mDeIsectConnection;
+   signal::Connection mIsectConnection;
+   signal::Connection mDeIsectConnection;
    //@}
 
    WidgetDataPtr mWidgetData;
-   boost::signals::connection mMovedConnection;
+   signal::Connection mMovedConnection;
    SceneObjectPtr mSelectedObject;
 };
 
@@ -0,0 +1,158 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Test for vrkit::nav::Integrator
+//
+// Drives the integrator with the same navigation step function at 30, 60,
+// and 120 Hz and checks that the view platform follows the same trajectory
+// at each frame rate.
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/MatrixOps.h>
+#include <gmtl/Generate.h>
+#include <gmtl/AxisAngle.h>
+#include <gmtl/Vec.h>
+#include <gmtl/Output.h>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/ViewPlatform.h>
+#include <vrkit/nav/Integrator.h>
+
+
+namespace
+{
+
+const float sSpeed(2.0f);       /**< Meters per second */
+const float sTurnRate(0.75f);   /**< Radians per second */
+const unsigned int sDuration(10);       /**< Seconds */
+const unsigned int sSampleRate(30);     /**< Samples per second */
+const float sTolerance(1.0e-5f);
+
+/**
+ * Moves forward while turning. The speeds are constant, so a trajectory
+ * that does not depend on the frame rate is expected.
+ */
+void step(gmtl::Matrix44f& curPos, const float dt)
+{
+   const gmtl::Matrix44f trans =
+      gmtl::makeTrans<gmtl::Matrix44f>(gmtl::Vec3f(0.0f, 0.0f,
+                                                   -sSpeed * dt));
+   const gmtl::Matrix44f rot =
+      gmtl::makeRot<gmtl::Matrix44f>(
+         gmtl::AxisAnglef(sTurnRate * dt, gmtl::Vec3f(0.0f, 1.0f, 0.0f))
+      );
+
+   curPos = curPos * trans * rot;
+}
+
+/**
+ * Runs the integrator at the given frame rate and returns the view platform
+ * transformation at every frame that falls on a sample time. The frame
+ * times are rounded to microseconds like those of a real clock.
+ */
+std::vector<gmtl::Matrix44f> run(const unsigned int frameRate)
+{
+   vrkit::ViewPlatform view_platform;
+   vrkit::nav::Integrator integrator;
+
+   const unsigned int num_frames(sDuration * frameRate);
+   const unsigned int frames_per_sample(frameRate / sSampleRate);
+
+   std::vector<gmtl::Matrix44f> samples;
+   unsigned int num_steps(0);
+
+   for ( unsigned int f = 0; f <= num_frames; ++f )
+   {
+      const vpr::Uint64 usec =
+         static_cast<vpr::Uint64>(f * 1000000.0 / frameRate + 0.5);
+      num_steps += integrator.update(vpr::Interval(usec, vpr::Interval::Usec),
+                                     view_platform, &step);
+
+      if ( f % frames_per_sample == 0 )
+      {
+         samples.push_back(view_platform.getCurPos());
+      }
+   }
+
+   std::cout << frameRate << " Hz: " << num_frames << " frames, "
+             << num_steps << " steps" << std::endl;
+
+   return samples;
+}
+
+bool compare(const std::vector<gmtl::Matrix44f>& expected,
+             const std::vector<gmtl::Matrix44f>& actual,
+             const unsigned int frameRate)
+{
+   if ( expected.size() != actual.size() )
+   {
+      std::cout << "FAILED: " << frameRate << " Hz has " << actual.size()
+                << " samples instead of " << expected.size() << std::endl;
+      return false;
+   }
+
+   for ( unsigned int i = 0; i < expected.size(); ++i )
+   {
+      if ( ! gmtl::isEqual(expected[i], actual[i], sTolerance) )
+      {
+         std::cout << "FAILED: " << frameRate << " Hz differs at "
+                   << static_cast<float>(i) / sSampleRate << " s:\n"
+                   << actual[i] << "\ninstead of\n" << expected[i]
+                   << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+}
+
+int main()
+{
+   const std::vector<gmtl::Matrix44f> samples_30(run(30));
+   const std::vector<gmtl::Matrix44f> samples_60(run(60));
+   const std::vector<gmtl::Matrix44f> samples_120(run(120));
+
+   bool passed = compare(samples_120, samples_30, 30) &&
+                    compare(samples_120, samples_60, 60);
+
+   // Make sure that the view platform actually moved.
+   if ( passed && gmtl::isEqual(samples_120.front(), samples_120.back(),
+                                sTolerance) )
+   {
+      std::cout << "FAILED: The view platform did not move" << std::endl;
+      passed = false;
+   }
+
+   if ( passed )
+   {
+      std::cout << "PASSED: The trajectories match at " << sSampleRate
+                << " samples per second over " << sDuration << " s"
+                << std::endl;
+   }
+
+   return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
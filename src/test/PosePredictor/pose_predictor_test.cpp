@@ -0,0 +1,179 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Test for vrkit::util::PosePredictor
+//
+// Feeds synthetic 60 Hz tracker traces with known motion through the
+// predictor and checks that predicting each sample ahead by the display
+// latency brings the pose closer to the true pose at the time of display
+// than using the sample as is.
+//
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/MatrixOps.h>
+#include <gmtl/Generate.h>
+#include <gmtl/AxisAngle.h>
+#include <gmtl/Vec.h>
+#include <gmtl/VecOps.h>
+#include <gmtl/Point.h>
+#include <gmtl/Xforms.h>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/util/PosePredictor.h>
+
+
+namespace
+{
+
+const unsigned int sSampleRate(60);     /**< Samples per second */
+const unsigned int sDuration(10);       /**< Seconds */
+const float sLead(0.033f);              /**< Display latency in seconds */
+
+typedef gmtl::Matrix44f (*trace_func_t)(const float);
+
+/**
+ * The wand moves in a straight line while spinning about a fixed axis. The
+ * linear and angular velocities are constant, which is the motion that the
+ * predictor assumes, so prediction should remove nearly all of the error.
+ */
+gmtl::Matrix44f getSpinPose(const float t)
+{
+   gmtl::Vec3f axis(0.0f, 1.0f, 1.0f);
+   gmtl::normalize(axis);
+
+   const gmtl::Matrix44f trans =
+      gmtl::makeTrans<gmtl::Matrix44f>(gmtl::Vec3f(0.5f * t, 1.0f, 0.0f));
+   const gmtl::Matrix44f rot =
+      gmtl::makeRot<gmtl::Matrix44f>(gmtl::AxisAnglef(3.0f * t, axis));
+
+   return trans * rot;
+}
+
+/**
+ * The wand circles the user at waist height while facing along its path,
+ * and it tilts up and down. The velocities change continuously, so some of
+ * the error remains after prediction.
+ */
+gmtl::Matrix44f getOrbitPose(const float t)
+{
+   const float radius(0.5f);
+   const float angle(1.5f * t);
+
+   const gmtl::Matrix44f trans =
+      gmtl::makeTrans<gmtl::Matrix44f>(
+         gmtl::Vec3f(radius * std::sin(angle), 1.0f,
+                     radius * std::cos(angle))
+      );
+   const gmtl::Matrix44f yaw =
+      gmtl::makeRot<gmtl::Matrix44f>(
+         gmtl::AxisAnglef(angle, gmtl::Vec3f(0.0f, 1.0f, 0.0f))
+      );
+   const gmtl::Matrix44f pitch =
+      gmtl::makeRot<gmtl::Matrix44f>(
+         gmtl::AxisAnglef(0.3f * std::sin(2.0f * t),
+                          gmtl::Vec3f(1.0f, 0.0f, 0.0f))
+      );
+
+   return trans * yaw * pitch;
+}
+
+/**
+ * Measures the error of a pose as the distance between the tip of the wand
+ * (one unit in front of it) and where the tip should be. This includes
+ * both the positional and the rotational error.
+ */
+float getError(const gmtl::Matrix44f& pose, const gmtl::Matrix44f& truth)
+{
+   const gmtl::Point3f tip(0.0f, 0.0f, -1.0f);
+   return gmtl::length(gmtl::Vec3f((pose * tip) - (truth * tip)));
+}
+
+/**
+ * Runs the given trace through a predictor with the default settings and
+ * checks that the mean predicted error is at most \p maxRatio times the
+ * mean error of the unpredicted samples.
+ */
+bool run(const char* name, trace_func_t trace, const float maxRatio)
+{
+   vrkit::util::PosePredictor predictor;
+
+   const unsigned int num_samples(sSampleRate * sDuration);
+   float raw_error(0.0f), predicted_error(0.0f);
+   unsigned int num_compared(0);
+
+   for ( unsigned int s = 0; s < num_samples; ++s )
+   {
+      const vpr::Uint64 usec =
+         static_cast<vpr::Uint64>(s * 1000000.0 / sSampleRate + 0.5);
+      const float t(usec / 1000000.0f);
+      const gmtl::Matrix44f pose(trace(t));
+
+      predictor.addSample(pose, vpr::Interval(usec, vpr::Interval::Usec));
+
+      // Give the velocity estimates time to settle.
+      if ( s < sSampleRate / 2 )
+      {
+         continue;
+      }
+
+      const gmtl::Matrix44f truth(trace(t + sLead));
+      raw_error       += getError(pose, truth);
+      predicted_error += getError(predictor.predict(sLead), truth);
+      ++num_compared;
+   }
+
+   raw_error       /= num_compared;
+   predicted_error /= num_compared;
+
+   std::cout << name << ": mean error " << sLead * 1000.0f << " ms ahead is "
+             << raw_error << " without prediction and " << predicted_error
+             << " with prediction ("
+             << predicted_error / raw_error * 100.0f << "%)" << std::endl;
+
+   if ( ! (predicted_error <= raw_error * maxRatio) )
+   {
+      std::cout << "FAILED: Prediction did not reduce the " << name
+                << " error to " << maxRatio * 100.0f << "% or less"
+                << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+}
+
+int main()
+{
+   bool passed = run("Spin", &getSpinPose, 0.01f);
+   passed = run("Orbit", &getOrbitPose, 0.1f) && passed;
+
+   if ( passed )
+   {
+      std::cout << "PASSED: Prediction reduced the error of every trace"
+                << std::endl;
+   }
+
+   return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
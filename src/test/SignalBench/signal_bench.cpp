@@ -0,0 +1,151 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Benchmark for vrkit::signal::Signal
+//
+// Emits a vrkit::signal::Signal and a boost::signal<> with the same slots
+// and the combiner used by the per-frame event signals
+// (vrkit::event::ResultOperator) and reports the cost per emission for
+// each.
+//
+// Usage: signal_bench [num_emits]
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <boost/signal.hpp>
+
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/scenedata/Event.h>
+#include <vrkit/signal/Signal.h>
+
+
+namespace
+{
+
+const unsigned int sDefaultEmits(10000000);
+const unsigned int sSlotCounts[] = { 1, 4, 16 };
+
+typedef vrkit::event::ResultType (signature_t)(const int);
+
+typedef vrkit::signal::Signal<signature_t, vrkit::event::ResultOperator>
+   vrkit_signal_t;
+typedef boost::signal<signature_t, vrkit::event::ResultOperator>
+   boost_signal_t;
+
+/**
+ * A slot that counts its invocations so that the benchmark can verify that
+ * every slot was invoked.
+ */
+struct Counter
+{
+   Counter(unsigned long& count)
+      : mCount(&count)
+   {
+      /* Do nothing. */ ;
+   }
+
+   vrkit::event::ResultType operator()(const int value) const
+   {
+      *mCount += value;
+      return vrkit::event::CONTINUE;
+   }
+
+   unsigned long* mCount;
+};
+
+/**
+ * Connects \p numSlots slots to \p sig, emits it \p numEmits times, and
+ * returns the average time per emission in nanoseconds.
+ */
+template<typename Signal>
+float run(Signal& sig, const unsigned int numSlots,
+          const unsigned int numEmits, unsigned long& count)
+{
+   for ( unsigned int i = 0; i < numSlots; ++i )
+   {
+      sig.connect(Counter(count));
+   }
+
+   const vpr::Interval start(vpr::Interval::now());
+
+   for ( unsigned int i = 0; i < numEmits; ++i )
+   {
+      sig(1);
+   }
+
+   const vpr::Interval elapsed(vpr::Interval::now() - start);
+   return elapsed.usec() * 1000.0f / numEmits;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   const unsigned int num_emits =
+      argc > 1 ? std::strtoul(argv[1], NULL, 10) : sDefaultEmits;
+
+   if ( num_emits == 0 )
+   {
+      std::cerr << "Usage: " << argv[0] << " [num_emits]" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   bool passed(true);
+
+   for ( unsigned int i = 0;
+         i < sizeof(sSlotCounts) / sizeof(sSlotCounts[0]);
+         ++i )
+   {
+      const unsigned int num_slots(sSlotCounts[i]);
+      const unsigned long expected =
+         static_cast<unsigned long>(num_slots) * num_emits;
+
+      unsigned long vrkit_count(0), boost_count(0);
+
+      vrkit_signal_t vrkit_sig;
+      const float vrkit_ns(run(vrkit_sig, num_slots, num_emits,
+                               vrkit_count));
+
+      boost_signal_t boost_sig;
+      const float boost_ns(run(boost_sig, num_slots, num_emits,
+                               boost_count));
+
+      std::cout << num_slots << " slot(s): vrkit::signal::Signal "
+                << vrkit_ns << " ns, boost::signal " << boost_ns
+                << " ns per emit" << std::endl;
+
+      if ( vrkit_count != expected || boost_count != expected )
+      {
+         std::cout << "FAILED: Expected " << expected
+                   << " slot invocations but got " << vrkit_count
+                   << " (vrkit) and " << boost_count << " (boost)"
+                   << std::endl;
+         passed = false;
+      }
+   }
+
+   if ( passed )
+   {
+      std::cout << "PASSED: Every slot was invoked on every emit"
+                << std::endl;
+   }
+
+   return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
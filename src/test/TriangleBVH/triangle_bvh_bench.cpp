@@ -0,0 +1,247 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Benchmark for vrkit::util::TriangleBVH
+//
+// Builds the hierarchy over a synthetic terrain with boxes scattered on it
+// and measures the cost of each swept sphere and ground ray query. These are
+// the queries that vrkit::nav::Collider makes every frame, so each must stay
+// well under the per-query budget.
+//
+// Usage: triangle_bvh_bench [num_triangles] [num_queries]
+//
+
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <gmtl/Point.h>
+#include <gmtl/Vec.h>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/util/TriangleBVH.h>
+
+
+namespace
+{
+
+const unsigned int sDefaultTriangles(10000000);
+const unsigned int sDefaultQueries(100000);
+const float sCellSize(0.5f);            /**< Meters */
+const float sRadius(0.3f);              /**< Radius of the swept sphere */
+const float sStepLength(0.1f);          /**< Sweep length per query */
+const float sBudget(0.5f);              /**< Milliseconds per query */
+
+float random(const float lo, const float hi)
+{
+   return lo + (hi - lo) * std::rand() / static_cast<float>(RAND_MAX);
+}
+
+float terrainHeight(const float x, const float z)
+{
+   return 2.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f) +
+             0.25f * std::sin(x * 0.9f + z * 0.6f);
+}
+
+void addQuad(std::vector<gmtl::Point3f>& vertices, const gmtl::Point3f& p0,
+             const gmtl::Point3f& p1, const gmtl::Point3f& p2,
+             const gmtl::Point3f& p3)
+{
+   vertices.push_back(p0);
+   vertices.push_back(p1);
+   vertices.push_back(p2);
+   vertices.push_back(p0);
+   vertices.push_back(p2);
+   vertices.push_back(p3);
+}
+
+void addBox(std::vector<gmtl::Point3f>& vertices, const gmtl::Point3f& lo,
+            const gmtl::Point3f& hi)
+{
+   const gmtl::Point3f p[8] = {
+      gmtl::Point3f(lo[0], lo[1], lo[2]), gmtl::Point3f(hi[0], lo[1], lo[2]),
+      gmtl::Point3f(hi[0], hi[1], lo[2]), gmtl::Point3f(lo[0], hi[1], lo[2]),
+      gmtl::Point3f(lo[0], lo[1], hi[2]), gmtl::Point3f(hi[0], lo[1], hi[2]),
+      gmtl::Point3f(hi[0], hi[1], hi[2]), gmtl::Point3f(lo[0], hi[1], hi[2])
+   };
+
+   addQuad(vertices, p[0], p[1], p[2], p[3]);
+   addQuad(vertices, p[4], p[5], p[6], p[7]);
+   addQuad(vertices, p[0], p[1], p[5], p[4]);
+   addQuad(vertices, p[3], p[2], p[6], p[7]);
+   addQuad(vertices, p[0], p[3], p[7], p[4]);
+   addQuad(vertices, p[1], p[2], p[6], p[5]);
+}
+
+/**
+ * Generates a square height field using most of the triangle budget and
+ * fills the rest with boxes standing on it. Returns the length of a side
+ * of the terrain.
+ */
+float makeScene(std::vector<gmtl::Point3f>& vertices,
+                const unsigned int numTriangles)
+{
+   const unsigned int num_box_tris(numTriangles / 10);
+   const unsigned int cells = static_cast<unsigned int>(
+      std::sqrt((numTriangles - num_box_tris) / 2.0)
+   );
+   const float size(cells * sCellSize);
+
+   vertices.reserve(numTriangles * 3);
+
+   for ( unsigned int i = 0; i < cells; ++i )
+   {
+      const float x0(i * sCellSize), x1(x0 + sCellSize);
+
+      for ( unsigned int j = 0; j < cells; ++j )
+      {
+         const float z0(j * sCellSize), z1(z0 + sCellSize);
+         addQuad(vertices,
+                 gmtl::Point3f(x0, terrainHeight(x0, z0), z0),
+                 gmtl::Point3f(x1, terrainHeight(x1, z0), z0),
+                 gmtl::Point3f(x1, terrainHeight(x1, z1), z1),
+                 gmtl::Point3f(x0, terrainHeight(x0, z1), z1));
+      }
+   }
+
+   while ( vertices.size() + 36 <= numTriangles * 3 )
+   {
+      const float x(random(0.0f, size)), z(random(0.0f, size));
+      const float y(terrainHeight(x, z));
+      const float w(random(0.2f, 2.0f)), d(random(0.2f, 2.0f));
+      addBox(vertices, gmtl::Point3f(x, y - 0.5f, z),
+             gmtl::Point3f(x + w, y + random(0.5f, 4.0f), z + d));
+   }
+
+   return size;
+}
+
+struct Stats
+{
+   Stats() : total(0.0f), max(0.0f), hits(0)
+   {
+   }
+
+   void add(const vpr::Interval& elapsed, const bool hit)
+   {
+      total += elapsed.msecf();
+      max = std::max(max, elapsed.msecf());
+
+      if ( hit )
+      {
+         ++hits;
+      }
+   }
+
+   bool report(const char* name, const unsigned int count) const
+   {
+      const float avg(total / count);
+      std::cout << name << ": avg " << avg << " ms, max " << max
+                << " ms, " << hits << " of " << count << " hit" << std::endl;
+      return avg < sBudget;
+   }
+
+   float        total;
+   float        max;
+   unsigned int hits;
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+   const unsigned int num_triangles =
+      argc > 1 ? std::strtoul(argv[1], NULL, 10) : sDefaultTriangles;
+   const unsigned int num_queries =
+      argc > 2 ? std::strtoul(argv[2], NULL, 10) : sDefaultQueries;
+
+   if ( num_triangles < 2 || num_queries == 0 )
+   {
+      std::cerr << "Usage: " << argv[0] << " [num_triangles] [num_queries]"
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   std::srand(37);
+
+   std::vector<gmtl::Point3f> vertices;
+   const float size(makeScene(vertices, num_triangles));
+
+   vrkit::util::TriangleBVH bvh;
+   const vpr::Interval build_start(vpr::Interval::now());
+   bvh.build(vertices);
+   const vpr::Interval build_time(vpr::Interval::now() - build_start);
+
+   std::vector<gmtl::Point3f>().swap(vertices);
+
+   std::cout << "Built " << bvh.getNumTriangles() << " triangles into "
+             << bvh.getNumNodes() << " nodes in " << build_time.secf()
+             << " s" << std::endl;
+
+   Stats sweep_stats, ray_stats;
+   const gmtl::Vec3f down(0.0f, -1.0f, 0.0f);
+
+   for ( unsigned int q = 0; q < num_queries; ++q )
+   {
+      const float x(random(0.0f, size)), z(random(0.0f, size));
+      const gmtl::Point3f center(x, terrainHeight(x, z) + 1.0f, z);
+      const float angle(random(0.0f, 6.2831853f));
+      const gmtl::Vec3f motion(sStepLength * std::cos(angle),
+                               random(-0.02f, 0.02f),
+                               sStepLength * std::sin(angle));
+
+      float fraction, distance;
+      gmtl::Vec3f normal;
+
+      vpr::Interval start(vpr::Interval::now());
+      bool hit = bvh.sweepSphere(center, sRadius, motion, fraction, normal);
+      sweep_stats.add(vpr::Interval::now() - start, hit);
+
+      start = vpr::Interval::now();
+      hit = bvh.intersectRay(center, down, 10.0f, distance, normal);
+      ray_stats.add(vpr::Interval::now() - start, hit);
+   }
+
+   // The ground is always below the ray origin, so every ray must hit.
+   bool passed(ray_stats.hits == num_queries);
+
+   if ( ! passed )
+   {
+      std::cout << "FAILED: " << num_queries - ray_stats.hits
+                << " ground rays missed the terrain" << std::endl;
+   }
+
+   passed = sweep_stats.report("Swept sphere", num_queries) && passed;
+   passed = ray_stats.report("Ground ray", num_queries) && passed;
+
+   if ( passed )
+   {
+      std::cout << "PASSED: Average query cost is under " << sBudget
+                << " ms" << std::endl;
+   }
+   else
+   {
+      std::cout << "FAILED" << std::endl;
+   }
+
+   return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -21,7 +21,6 @@
 
 #include <vector>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/signal.hpp>
 
 #include <OpenSG/OSGDynamicVolume.h>
 #include <OpenSG/OSGNodePtr.h>
@@ -29,6 +28,7 @@
 
 #include <vrkit/Config.h>
 #include <vrkit/SceneObjectPtr.h>
+#include <vrkit/signal/Signal.h>
 #include <vrkit/signal/Proxy.h>
 
 
@@ -257,7 +257,7 @@ public:
     *
     * @since 0.24.1
     */
-   typedef boost::signal<void (SceneObjectPtr)> self_signal_t;
+   typedef signal::Signal<void (SceneObjectPtr)> self_signal_t;
 
    /**
     * A signal whose slot takes the source scene object and another modified
@@ -265,7 +265,7 @@ public:
     *
     * @since 0.24.1
     */
-   typedef boost::signal<void (SceneObjectPtr, SceneObjectPtr)>
+   typedef signal::Signal<void (SceneObjectPtr, SceneObjectPtr)>
       self_obj_signal_t;
 
    /**
@@ -27,12 +27,22 @@ namespace vrkit
 {
 
 ViewPlatform::ViewPlatform()
+   : mCurPosInvDirty(false)
+   , mXformDirty(true)
+   , mHasDestination(false)
 {
    /* Do nothing. */ ;
 }
 
 void ViewPlatform::update(ViewerPtr viewer)
 {
+   // Writing the matrix when nothing changed would still record a change
+   // that has to be synchronized across the cluster.
+   if ( ! mXformDirty )
+   {
+      return;
+   }
+
    // Update the scene graph transformation here
    OSG::TransformNodePtr xform_node = viewer->getSceneObj()->getTransformRoot();
    OSG::Matrix new_xform;
@@ -43,6 +53,8 @@ void ViewPlatform::update(ViewerPtr viewer)
    OSG::CPEditor xnce(xform_node.core(), OSG::Transform::MatrixFieldMask);
 #endif
    xform_node->setMatrix(new_xform);
+
+   mXformDirty = false;
 }
 
 }
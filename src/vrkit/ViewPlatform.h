@@ -47,7 +47,12 @@ class VRKIT_CLASS_API ViewPlatform
 public:
    ViewPlatform();
 
-   /** Updates the view platform (navigation). */
+   /**
+    * Updates the view platform (navigation). The transformation of the
+    * scene transform root is written only if the view platform moved since
+    * the last update so that idle frames do not produce scene graph
+    * changes.
+    */
    void update(ViewerPtr viewer);
 
    /**
@@ -62,28 +67,103 @@ public:
    /**
     * Sets the current position of the view platform to the given
     * transformation and emits the "platform moved" signal indicating this
-    * fact to connected slots.
+    * fact to connected slots. If \p mat is the current position, nothing
+    * happens.
     *
-    * @post \c mCurPos == \p mat and \c mCurPosInv is the inverse of the
-    *       updated \c mCurPos.
+    * @post \c mCurPos == \p mat.
     *
     * @param mat The new transformation matrix for the view platform.
     */
    void setCurPos(const gmtl::Matrix44f& mat)
    {
-      mCurPos = mat;
-      gmtl::invert(mCurPosInv, mCurPos);
-      mPlatformMoved();
+      if ( mat != mCurPos )
+      {
+         mCurPos          = mat;
+         mCurPosInvDirty  = true;
+         mXformDirty      = true;
+         mPlatformMoved();
+      }
    }
 
    /**
-    * Returns the inverse of the current position: vp_M_vw.
+    * Returns the inverse of the current position: vp_M_vw. The inverse is
+    * computed the first time it is requested after the position changes.
     */
    const gmtl::Matrix44f& getCurPosInv() const
    {
+      if ( mCurPosInvDirty )
+      {
+         gmtl::invert(mCurPosInv, mCurPos);
+         mCurPosInvDirty = false;
+      }
+
       return mCurPosInv;
    }
 
+   /**
+    * Indicates whether the view platform moved since the scene graph was
+    * last updated by update().
+    *
+    * @since 0.51.17
+    */
+   bool isDirty() const
+   {
+      return mXformDirty;
+   }
+
+   /** @name Destination */
+   //@{
+   /**
+    * Announces that the view platform is on its way to the given position,
+    * such as during an animated transition between viewpoints. This emits
+    * the "destination set" signal so that slots can prepare resources
+    * that depend on the position of the view platform (such as levels of
+    * detail) for the destination before the view platform arrives. This
+    * does not move the view platform.
+    *
+    * @param mat The transformation (vw_M_vp) that the view platform is
+    *            moving to.
+    *
+    * @since 0.51.18
+    */
+   void setDestination(const gmtl::Matrix44f& mat)
+   {
+      mDestination    = mat;
+      mHasDestination = true;
+      mDestinationSet(mat);
+   }
+
+   /**
+    * Indicates that the view platform is no longer moving to a destination.
+    *
+    * @since 0.51.18
+    */
+   void clearDestination()
+   {
+      mHasDestination = false;
+   }
+
+   /**
+    * @since 0.51.18
+    */
+   bool hasDestination() const
+   {
+      return mHasDestination;
+   }
+
+   /**
+    * Returns the last destination given to setDestination().
+    *
+    * @pre hasDestination() returns true.
+    *
+    * @since 0.51.18
+    */
+   const gmtl::Matrix44f& getDestination() const
+   {
+      return mDestination;
+   }
+   //@}
+
    /** @name Signals */
    //@{
    typedef boost::signal<void ()> signal_t;
@@ -98,10 +178,26 @@ public:
    {
       return signal::Proxy<signal_t>(mPlatformMoved);
    }
+
+   typedef boost::signal<void (const gmtl::Matrix44f&)> destination_signal_t;
+
+   /**
+    * Provides access to the "destination set" signal for this view
+    * platform so that slots may be connected to it.
+    *
+    * @see setDestination()
+    *
+    * @since 0.51.18
+    */
+   signal::Proxy<destination_signal_t> destinationSet()
+   {
+      return signal::Proxy<destination_signal_t>(mDestinationSet);
+   }
    //@}
 
 private:
-   signal_t mPlatformMoved;
+   signal_t             mPlatformMoved;
+   destination_signal_t mDestinationSet;
 
    /**
     * The current positon of the platform in the virtual world: vw_M_vp.
@@ -110,9 +206,21 @@ private:
    gmtl::Matrix44f   mCurPos;
 
    /**
-    * Inverse matrix of the current position: vp_M_vw.
+    * Inverse matrix of the current position: vp_M_vw. This is computed on
+    * demand by getCurPosInv().
+    */
+   mutable gmtl::Matrix44f   mCurPosInv;
+   mutable bool              mCurPosInvDirty;
+
+   /**
+    * Indicates that the scene transform root does not yet have the current
+    * position. This is initially true so that the first update always
+    * writes the transformation.
     */
-   gmtl::Matrix44f   mCurPosInv;
+   bool mXformDirty;
+
+   gmtl::Matrix44f mDestination;
+   bool            mHasDestination;
 };
 
 }
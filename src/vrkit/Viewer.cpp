@@ -17,8 +17,13 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <sstream>
+#include <set>
+#include <map>
 #include <boost/bind.hpp>
 
+#include <OpenSG/OSGThread.h>
+#include <OpenSG/OSGChangeList.h>
 #include <OpenSG/OSGRemoteAspect.h>
 #include <OpenSG/OSGGroupConnection.h>
 #include <OpenSG/OSGConnectionFactory.h>
@@ -27,6 +32,8 @@
 #include <vpr/vpr.h>
 #include <vpr/Util/Debug.h>
 #include <vpr/Util/FileUtils.h>
+#include <vpr/Util/Interval.h>
+#include <vpr/Sync/Guard.h>
 #include <jccl/Config/Configuration.h>
 #include <vrj/Kernel/Kernel.h>
 
@@ -37,17 +44,75 @@
 #include <vrkit/WandInterface.h>
 #include <vrkit/Version.h>
 #include <vrkit/scenedata/EventData.h>
+#include <vrkit/scenedata/PagingData.h>
 #include <vrkit/isect/Strategy.h>
 #include <vrkit/viewer/Plugin.h>
+#include <vrkit/plugin/Data.h>
 #include <vrkit/plugin/Registry.h>
 #include <vrkit/plugin/TypedInitRegistryEntry.h>
 #include <vrkit/plugin/Helpers.h>
 #include <vrkit/util/OpenSGHelpers.h>
+#include <vrkit/util/TaskGraph.h>
+#include <vrkit/util/SceneCache.h>
 #include <vrkit/util/Debug.h>
+#include <vrkit/exceptions/PluginException.h>
 
 #include <vrkit/Viewer.h>
 
 
+namespace
+{
+
+/**
+ * Registers the calling plug-in initialization worker thread with OpenSG so
+ * that it can create field containers.
+ */
+void initPluginWorker(const unsigned int index)
+{
+   std::ostringstream name_stream;
+   name_stream << "vrkit plug-in init worker " << index;
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::ExternalThread* thread =
+      OSG::ExternalThread::get(name_stream.str().c_str());
+#else
+   OSG::ExternalThreadRefPtr thread =
+      OSG::ExternalThread::get(name_stream.str().c_str(), true);
+#endif
+
+   if ( ! thread->isInitialized() )
+   {
+      thread->initialize(0);
+   }
+}
+
+/**
+ * Moves the changes recorded by the calling plug-in initialization worker
+ * thread into the change list of the application thread so that they are
+ * included in the initial sync with cluster slaves.
+ */
+void mergePluginWorkerChanges(vpr::Mutex* lock, OSG::ChangeList* appList,
+                              const unsigned int)
+{
+   vpr::Guard<vpr::Mutex> guard(*lock);
+
+   OSG::ChangeList* worker_list = OSG::Thread::getCurrentChangeList();
+   appList->merge(*worker_list);
+#if OSG_MAJOR_VERSION < 2
+   worker_list->clearAll();
+#else
+   worker_list->clear();
+#endif
+}
+
+void failPluginInit(const std::string& msg)
+{
+   throw vrkit::PluginException(msg, VRKIT_LOCATION);
+}
+
+}
+
+
 namespace vrkit
 {
 
@@ -102,7 +167,8 @@ void Viewer::init()
    // Create and initialize the base scene object.
    mScene = Scene::create()->init();
 
-   mEventData = mScene->getSceneData<EventData>();
+   mEventData  = mScene->getSceneData<EventData>();
+   mPagingData = mScene->getSceneData<PagingData>();
 
    // Load the app configuration and then...
    // - Setup scene root for networking
@@ -120,7 +186,7 @@ void Viewer::init()
 
       if ( app_cfg )
       {
-         const unsigned int app_cfg_ver(4);
+         const unsigned int app_cfg_ver(7);
          if ( app_cfg->getVersion() < app_cfg_ver )
          {
             std::cerr << "WARNING: vrkit Viewer config element '"
@@ -181,17 +247,18 @@ void Viewer::preFrame()
 {
    ViewerPtr myself = shared_from_this();
 
+   // Make the calls that were queued for us since the last frame.
+   runMainThreadCalls();
+
+   // Capture the wand state that all code executing during this frame will
+   // use.
+   getUser()->getInterfaceTrader().getWandInterface()->update(myself);
+
    // Strategy for intersection
    if ( NULL != mIsectStrategy.get() )
    {
       mIsectStrategy->update(myself);
 
-      WandInterfacePtr wand =
-         getUser()->getInterfaceTrader().getWandInterface();
-      const gmtl::Matrix44f vp_M_wand(
-         wand->getWandPos()->getData(getDrawScaleFactor())
-      );
-
       gmtl::Point3f intersect_point;
       SceneObjectPtr intersect_obj =
          mIsectStrategy->findIntersection(myself, mObjects, intersect_point);
@@ -211,7 +278,7 @@ void Viewer::preFrame()
                << util::getName(mIntersectedObj->getRoot())
                << std::endl << vprDEBUG_FLUSH;
 
-            mEventData->objectDeintersected(mIntersectedObj);
+            mEventData->postObjectDeintersected(mIntersectedObj);
          }
 
          // Change the intersected object to the one we found above.
@@ -228,7 +295,8 @@ void Viewer::preFrame()
                << util::getName(mIntersectedObj->getRoot().get())
                << std::endl << vprDEBUG_FLUSH;
 
-            mEventData->objectIntersected(mIntersectedObj, intersect_point);
+            mEventData->postObjectIntersected(mIntersectedObj,
+                                              intersect_point);
          }
       }
    }
@@ -238,8 +306,20 @@ void Viewer::preFrame()
    std::for_each(mPlugins.begin(), mPlugins.end(),
                  boost::bind(&viewer::Plugin::update, _1, myself));
 
+   // Dispatch the events queued during this frame (if queued event dispatch
+   // is enabled).
+   mEventData->dispatchEvents();
+
+   // Deliver the batched notifications for plug-in data modified during
+   // this frame.
+   plugin::Data::deliverChanges();
+
    // Update the user (and navigation)
    getUser()->update(myself);
+
+   // Page the geometry of paged models in and out for the new position of
+   // the user.
+   mPagingData->update(myself);
 }
 
 void Viewer::latePreFrame()
@@ -382,6 +462,10 @@ void Viewer::sendDataToSlaves(OSG::BinaryDataHandler& writer)
    vrj::Projection::getNearFar(near_val, far_val);
    writer.putValue(near_val);
    writer.putValue(far_val);
+
+   // The slaves load the chunks of paged models themselves, so only the
+   // chunk selections are sent.
+   mPagingData->writeSelections(writer);
 }
 
 void Viewer::readDataFromSlave(OSG::BinaryDataHandler& reader)
@@ -439,6 +523,7 @@ void Viewer::deallocate()
 //   mPluginRegistry.reset();
    mUser.reset();
    mEventData.reset();
+   mPagingData.reset();
    mScene.reset();
 
    // Output information about what is left over
@@ -591,6 +676,38 @@ void Viewer::config(jccl::ConfigElementPtr appCfg)
 {
    const std::string plugin_path_prop("plugin_path");
    const std::string strategy_plugin_path_prop("strategy_plugin_path");
+   const std::string queue_events_prop("queue_events");
+   const std::string scene_cache_dir_prop("scene_cache_dir");
+
+   // Set the event dispatch mode before any plug-in can post events.
+   mEventData->setQueued(appCfg->getProperty<bool>(queue_events_prop));
+
+   // The scene cache directory was added in version 7. The cache has to be
+   // set up before any plug-in can read a scene file.
+   if ( appCfg->getVersion() >= 7 )
+   {
+      const std::string cache_dir =
+         vpr::replaceEnvVars(
+            appCfg->getProperty<std::string>(scene_cache_dir_prop)
+         );
+
+      if ( ! cache_dir.empty() )
+      {
+         try
+         {
+            mSceneCache = util::SceneCache::create(
+               boost::filesystem::path(cache_dir, boost::filesystem::native)
+            );
+            VRKIT_STATUS << "Using scene cache directory " << cache_dir
+                         << std::endl;
+         }
+         catch (Exception& ex)
+         {
+            VRKIT_STATUS << "WARNING: Scene cache disabled: " << ex.what()
+                         << std::endl;
+         }
+      }
+   }
 
    // Set up default search paths:
    //
@@ -656,9 +773,17 @@ void Viewer::loadAndInitPlugins(jccl::ConfigElementPtr appCfg)
    VRKIT_STATUS << "Viewer: Loading plug-ins" << std::endl;
 
    const std::string plugin_prop("plugin");
+   const std::string init_threads_prop("init_threads");
    const std::string isect_strategy_prop("isect_strategy");
    const unsigned int num_plugins(appCfg->getNum(plugin_prop));
 
+   // Determine the order in which the configured plug-ins and their
+   // dependencies have to be instantiated. Each registry entry appears only
+   // once, and it appears after all of its dependencies.
+   std::vector<plugin::RegistryEntryPtr> entries;
+   std::set<plugin::RegistryEntryPtr> known_entries;
+   std::set<plugin::RegistryEntryPtr> configured_entries;
+
    for ( unsigned int i = 0; i < num_plugins; ++i )
    {
       const std::string plugin_type =
@@ -666,38 +791,143 @@ void Viewer::loadAndInitPlugins(jccl::ConfigElementPtr appCfg)
 
       try
       {
-         VRKIT_STATUS << "   Creating instance of plug-in type "
-                      << plugin_type << " ... " << std::flush;
-         std::vector<AbstractPluginPtr> deps;
-         AbstractPluginPtr p = mPluginRegistry->makeInstance(plugin_type,
-                                                             deps);
-         processDeps(deps);
+         const std::vector<std::string> type_ids(1, plugin_type);
+         const std::vector<plugin::RegistryEntryPtr> order =
+            mPluginRegistry->getInstantiationOrder(type_ids);
 
+         // The entry for plugin_type has the highest dependency level, so
+         // it is the last one in order.
+         configured_entries.insert(order.back());
+
+         typedef std::vector<plugin::RegistryEntryPtr>::const_iterator
+            iter_type;
+         for ( iter_type e = order.begin(); e != order.end(); ++e )
+         {
+            if ( known_entries.insert(*e).second )
+            {
+               entries.push_back(*e);
+            }
+         }
+      }
+      catch (std::runtime_error& ex)
+      {
+         VRKIT_STATUS << "   WARNING: Failed to load plug-in '"
+                      << plugin_type << "': " << ex.what() << std::endl;
+      }
+   }
+
+   // Create the plug-in instances and set up the initialization of each as
+   // a task. Plug-ins that allow it are initialized by worker threads.
+   // Everything else is initialized in this thread. Either way, a plug-in
+   // is not initialized until all of its dependencies have been initialized.
+   const unsigned int init_threads =
+      appCfg->getProperty<unsigned int>(init_threads_prop);
+
+   vpr::Mutex change_list_lock;
+   util::TaskGraph init_graph(
+      init_threads, &initPluginWorker,
+      boost::bind(&mergePluginWorkerChanges, &change_list_lock,
+                  OSG::Thread::getCurrentChangeList(), _1)
+   );
+
+   std::map<plugin::RegistryEntryPtr, util::TaskGraph::task_id_type> tasks;
+   std::vector<AbstractPluginPtr> instances(entries.size());
+
+   for ( unsigned int e = 0; e < entries.size(); ++e )
+   {
+      plugin::RegistryEntryPtr entry(entries[e]);
+      const std::string& name(entry->getInfo().getFullName());
+
+      std::vector<util::TaskGraph::task_id_type> deps;
+
+      const std::vector<plugin::RegistryEntryPtr>& entry_deps =
+         mPluginRegistry->getDependencies(entry);
+
+      typedef std::vector<plugin::RegistryEntryPtr>::const_iterator
+         iter_type;
+      for ( iter_type d = entry_deps.begin(); d != entry_deps.end(); ++d )
+      {
+         std::map<
+            plugin::RegistryEntryPtr, util::TaskGraph::task_id_type
+         >::iterator t = tasks.find(*d);
+
+         if ( t != tasks.end() )
+         {
+            deps.push_back((*t).second);
+         }
+      }
+
+      try
+      {
+         instances[e] = entry->allocate();
+      }
+      catch (std::runtime_error& ex)
+      {
+         // Let the task graph record the failure so that the plug-ins that
+         // depend on this one are skipped.
+         tasks[entry] = init_graph.addTask(
+            name, boost::bind(&failPluginInit, std::string(ex.what())), deps,
+            true
+         );
+         continue;
+      }
+
+      viewer::PluginPtr viewer_plugin =
+         boost::dynamic_pointer_cast<viewer::Plugin>(instances[e]);
+      const bool main_thread(! viewer_plugin ||
+                             ! viewer_plugin->canInitConcurrently());
+
+      tasks[entry] = init_graph.addTask(
+         name,
+         boost::bind(&plugin::RegistryEntry::initialize, entry, instances[e]),
+         deps, main_thread,
+         boost::bind(&Viewer::pluginInitialized, this, entry, instances[e])
+      );
+   }
+
+   VRKIT_STATUS << "   Initializing " << entries.size() << " plug-in(s) using "
+                << init_threads << " worker thread(s)" << std::endl;
+
+   const vpr::Interval init_start(vpr::Interval::now());
+   init_graph.execute();
+   const vpr::Interval init_time(vpr::Interval::now() - init_start);
+
+   // Add the plug-ins in the order in which they would have been initialized
+   // serially so that the order of updates does not depend on scheduling.
+   for ( unsigned int e = 0; e < entries.size(); ++e )
+   {
+      const std::string& name(entries[e]->getInfo().getFullName());
+      const util::TaskGraph::Result& result =
+         init_graph.getResult(tasks[entries[e]]);
+
+      if ( result.status == util::TaskGraph::Result::SUCCEEDED )
+      {
          viewer::PluginPtr cur_plugin =
-            boost::dynamic_pointer_cast<viewer::Plugin>(p);
+            boost::dynamic_pointer_cast<viewer::Plugin>(instances[e]);
 
          if ( cur_plugin )
          {
             addPlugin(cur_plugin);
+            VRKIT_STATUS << "   Initialized " << name << " ["
+                         << result.elapsed.msecf() << " ms]" << std::endl;
          }
-         else
+         else if ( configured_entries.count(entries[e]) > 0 )
          {
-            std::ostringstream msg_stream;
-            msg_stream << "Invalid plug-in type '"
-                       << p->getInfo().getFullName()
-                       << "' given as vrkit::Viewer plug-in!";
-            throw PluginException(msg_stream.str(), VRKIT_LOCATION);
+            VRKIT_STATUS << "   WARNING: Invalid plug-in type '" << name
+                         << "' given as vrkit::Viewer plug-in!"
+                         << std::endl;
          }
-
-         VRKIT_STATUS << "[OK]" << std::endl;
       }
-      catch (std::runtime_error& ex)
+      else
       {
-         VRKIT_STATUS << "[FAILED]\n   WARNING: Failed to load plug-in '"
-                      << plugin_type << "': " << ex.what() << std::endl;
+         VRKIT_STATUS << "   WARNING: Failed to load plug-in '" << name
+                      << "': " << result.error << std::endl;
       }
    }
 
+   VRKIT_STATUS << "   Plug-in initialization took " << init_time.msecf()
+                << " ms" << std::endl;
+
    mIsectStrategyName = appCfg->getProperty<std::string>(isect_strategy_prop);
 
    if ( ! mIsectStrategyName.empty() )
@@ -762,6 +992,37 @@ void Viewer::processDeps(const std::vector<AbstractPluginPtr>& deps)
    }
 }
 
+void Viewer::pluginInitialized(plugin::RegistryEntryPtr entry,
+                               AbstractPluginPtr plugin)
+{
+   // Apply the changes that the plug-in queued during its initialization
+   // before anything that depends on it is initialized.
+   runMainThreadCalls();
+   mPluginRegistry->registerInstantiatedPlugin(entry->getInfo(), plugin);
+}
+
+void Viewer::callOnMainThread(const boost::function<void ()>& func)
+{
+   vpr::Guard<vpr::Mutex> guard(mMainThreadCallsLock);
+   mMainThreadCalls.push_back(func);
+}
+
+void Viewer::runMainThreadCalls()
+{
+   std::vector< boost::function<void ()> > calls;
+
+   {
+      vpr::Guard<vpr::Mutex> guard(mMainThreadCallsLock);
+      calls.swap(mMainThreadCalls);
+   }
+
+   typedef std::vector< boost::function<void ()> >::iterator iter_type;
+   for ( iter_type c = calls.begin(); c != calls.end(); ++c )
+   {
+      (*c)();
+   }
+}
+
 void Viewer::addPlugin(viewer::PluginPtr plugin)
 {
    plugin->setFocused(shared_from_this(), true);
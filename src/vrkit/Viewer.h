@@ -23,11 +23,13 @@
 
 #include <vector>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/function.hpp>
 
 #include <OpenSG/OSGConnection.h>
 #include <OpenSG/OSGBinaryDataHandler.h>
 
 #include <vpr/DynLoad/Library.h>
+#include <vpr/Sync/Mutex.h>
 #include <jccl/Config/ConfigElementPtr.h>
 
 #include <vrj/vrjParam.h>
@@ -44,9 +46,12 @@
 #include <vrkit/AbstractPluginPtr.h>
 #include <vrkit/Configuration.h>
 #include <vrkit/scenedata/EventDataPtr.h>
+#include <vrkit/scenedata/PagingDataPtr.h>
 #include <vrkit/plugin/RegistryPtr.h>
+#include <vrkit/plugin/RegistryEntryPtr.h>
 #include <vrkit/isect/StrategyPtr.h>
 #include <vrkit/viewer/PluginPtr.h>
+#include <vrkit/util/SceneCachePtr.h>
 #include <vrkit/ViewerPtr.h>
 
 
@@ -237,6 +242,20 @@ public:
       return mPluginRegistry;
    }
 
+   /**
+    * Returns the cache of converted scene files. Code that reads scene files
+    * should read them through the cache when there is one.
+    *
+    * @return A null pointer is returned if no scene cache directory is
+    *         configured.
+    *
+    * @since 0.51.24
+    */
+   const util::SceneCachePtr getSceneCache() const
+   {
+      return mSceneCache;
+   }
+
    /** @name Cluster Application Data Interface
     *
     * These methods are used to communicate data over an OpenSG network
@@ -293,6 +312,25 @@ public:
    void removeObject(SceneObjectPtr obj);
    //@}
 
+   /**
+    * Queues the given callable for execution in the application thread (the
+    * thread that invokes init() and preFrame()). This may be called from any
+    * thread. It is intended primarily for plug-ins that are initialized
+    * concurrently (see vrkit::viewer::Plugin::canInitConcurrently()) so that
+    * they can make scene graph changes safely.
+    *
+    * Calls queued during plug-in initialization are made before that
+    * plug-in is considered to be initialized (and thus before any plug-ins
+    * that depend on it are initialized). Otherwise, queued calls are made
+    * at the start of the next invocation of preFrame(). In all cases, calls
+    * are made in the order in which they were queued.
+    *
+    * @param func The callable to invoke.
+    *
+    * @since 0.51.5
+    */
+   void callOnMainThread(const boost::function<void ()>& func);
+
 protected:
    /**
     * Override this method to deallocate OpenSG resources when the
@@ -330,6 +368,17 @@ private:
 
    void processDeps(const std::vector<AbstractPluginPtr>& deps);
 
+   /**
+    * Completes the initialization of the given plug-in instance. This is
+    * invoked in the application thread after the instance has been
+    * initialized.
+    */
+   void pluginInitialized(plugin::RegistryEntryPtr entry,
+                          AbstractPluginPtr plugin);
+
+   /** Makes all calls queued through callOnMainThread(). */
+   void runMainThreadCalls();
+
    void addPlugin(viewer::PluginPtr plugin);
 
    void config(jccl::ConfigElementPtr appCfg);
@@ -367,6 +416,14 @@ private:
    /** The configuration for the system (and the viewer). */
    Configuration mConfiguration;
 
+   util::SceneCachePtr mSceneCache;     /**< Null if not configured */
+
+   /** @name Application Thread Call Queue */
+   //@{
+   vpr::Mutex                             mMainThreadCallsLock;
+   std::vector< boost::function<void ()> > mMainThreadCalls;
+   //@}
+
    /** @name Intersection Strategy */
    //@{
    std::vector<std::string> mStrategyPluginPath;
@@ -377,6 +434,8 @@ private:
 
    object_list_t mObjects;
 
+   PagingDataPtr mPagingData;   /**< @since 0.51.28 */
+
 protected:
    EventDataPtr mEventData;
 };
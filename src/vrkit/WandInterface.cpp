@@ -17,19 +17,29 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <sstream>
+#include <algorithm>
 
 #include <vpr/Util/Assert.h>
 #include <jccl/Config/ConfigElement.h>
 
 #include <vrkit/Viewer.h>
+#include <vrkit/Status.h>
 #include <vrkit/Exception.h>
+#include <vrkit/WandRecorder.h>
+#include <vrkit/WandPlayback.h>
 #include <vrkit/WandInterface.h>
 
 
+namespace fs = boost::filesystem;
+
 namespace vrkit
 {
 
 WandInterface::WandInterface()
+   : mPredictPose(false)
+   , mDisplayLatency(0.0f)
+   , mFrameTime(0.0f)
+   , mLatencyEstimate(0.0f)
 {
    /* Do nothing. */ ;
 }
@@ -56,6 +66,117 @@ void WandInterface::init(ViewerPtr viewer)
    {
       configureDefault();
    }
+
+   mSnapshot.reset(mButtonInterfaces.size(), mAnalogInterfaces.size());
+}
+
+void WandInterface::update(ViewerPtr viewer)
+{
+   const float scale_factor(viewer->getDrawScaleFactor());
+   const vpr::Interval now(vpr::Interval::now());
+
+   bool captured(false);
+
+   if ( mPlayback )
+   {
+      try
+      {
+         captured = mPlayback->next(mSnapshot, scale_factor);
+
+         if ( ! captured )
+         {
+            VRKIT_STATUS << "Wand playback of "
+                         << mPlayback->getFile().string() << " finished after "
+                         << mPlayback->getFrameCount() << " frame(s)"
+                         << std::endl;
+            mPlayback.reset();
+         }
+      }
+      catch (Exception& ex)
+      {
+         VRKIT_STATUS << "Wand playback failed:\n" << ex.what()
+                      << "\nResuming live input." << std::endl;
+         mPlayback.reset();
+      }
+   }
+
+   if ( ! captured )
+   {
+      captureDeviceState(scale_factor);
+   }
+
+   if ( mRecorder )
+   {
+      try
+      {
+         mRecorder->record(mSnapshot, scale_factor);
+      }
+      catch (Exception& ex)
+      {
+         VRKIT_STATUS << "Wand recording failed:\n" << ex.what() << std::endl;
+         mRecorder.reset();
+      }
+   }
+
+   // Track the average frame time, which approximates the time between now
+   // and the display of this frame.
+   if ( mLastUpdateTime != vpr::Interval() && now > mLastUpdateTime )
+   {
+      const float frame_time((now - mLastUpdateTime).secf());
+      mFrameTime = mFrameTime > 0.0f ? 0.9f * mFrameTime + 0.1f * frame_time
+                                     : frame_time;
+   }
+   mLastUpdateTime = now;
+
+   const float sample_age(
+      now > mSnapshot.mTimeStamp ? (now - mSnapshot.mTimeStamp).secf() : 0.0f
+   );
+   mLatencyEstimate = sample_age + mFrameTime + mDisplayLatency;
+
+   if ( mPredictPose )
+   {
+      mPosePredictor.addSample(mSnapshot.m_vp_M_wand, mSnapshot.mTimeStamp);
+      mSnapshot.m_vp_M_wand = mPosePredictor.predict(mLatencyEstimate);
+   }
+}
+
+void WandInterface::startRecording(const fs::path& file)
+{
+   stopRecording();
+   mRecorder = WandRecorder::create(file, mButtonInterfaces.size(),
+                                    mAnalogInterfaces.size());
+}
+
+void WandInterface::stopRecording()
+{
+   if ( mRecorder )
+   {
+      VRKIT_STATUS << "Recorded " << mRecorder->getFrameCount()
+                   << " frame(s) of wand input to "
+                   << mRecorder->getFile().string() << std::endl;
+      mRecorder.reset();
+   }
+}
+
+void WandInterface::startPlayback(const fs::path& file, const bool realTime)
+{
+   mPlayback = WandPlayback::create(file, realTime);
+
+   if ( mPlayback->getNumButtons() != mButtonInterfaces.size() ||
+        mPlayback->getNumAnalogs() != mAnalogInterfaces.size() )
+   {
+      VRKIT_STATUS << "WARNING: Wand recording " << file.string()
+                   << " has " << mPlayback->getNumButtons() << " button(s) and "
+                   << mPlayback->getNumAnalogs() << " analog(s), but "
+                   << mButtonInterfaces.size() << " button(s) and "
+                   << mAnalogInterfaces.size() << " analog(s) are configured"
+                   << std::endl;
+   }
+}
+
+void WandInterface::stopPlayback()
+{
+   mPlayback.reset();
 }
 
 gadget::PositionInterface& WandInterface::getWandPos()
@@ -107,6 +228,13 @@ void WandInterface::configure(jccl::ConfigElementPtr elt)
    const std::string pos_name_prop("position_name");
    const std::string digital_name_prop("digital_name");
    const std::string analog_name_prop("analog_name");
+   const std::string predict_prop("pose_prediction");
+   const std::string smoothing_prop("prediction_smoothing");
+   const std::string display_latency_prop("display_latency");
+   const std::string max_predict_prop("max_prediction_time");
+   const std::string record_file_prop("record_file");
+   const std::string playback_file_prop("playback_file");
+   const std::string playback_real_time_prop("playback_real_time");
 
    const std::string wand_name = elt->getProperty<std::string>(pos_name_prop);
 
@@ -166,6 +294,46 @@ void WandInterface::configure(jccl::ConfigElementPtr elt)
          mAnalogInterfaces[a].init(analog_name);
       }
    }
+
+   // Pose prediction was added in version 2.
+   if ( elt->getVersion() >= 2 )
+   {
+      mPredictPose = elt->getProperty<bool>(predict_prop);
+      mPosePredictor.setSmoothing(elt->getProperty<float>(smoothing_prop));
+      mPosePredictor.setMaxPredictionTime(
+         elt->getProperty<float>(max_predict_prop) / 1000.0f
+      );
+      mDisplayLatency = elt->getProperty<float>(display_latency_prop) / 1000.0f;
+   }
+
+   // Input recording and playback were added in version 3. A failure to
+   // open either file is not fatal to the configuration.
+   if ( elt->getVersion() >= 3 )
+   {
+      const std::string record_file =
+         elt->getProperty<std::string>(record_file_prop);
+      const std::string playback_file =
+         elt->getProperty<std::string>(playback_file_prop);
+
+      try
+      {
+         if ( ! playback_file.empty() )
+         {
+            startPlayback(
+               playback_file, elt->getProperty<bool>(playback_real_time_prop)
+            );
+         }
+
+         if ( ! record_file.empty() )
+         {
+            startRecording(record_file);
+         }
+      }
+      catch (Exception& ex)
+      {
+         VRKIT_STATUS << "WARNING: " << ex.what() << std::endl;
+      }
+   }
 }
 
 void WandInterface::configureDefault()
@@ -187,4 +355,31 @@ void WandInterface::configureDefault()
    mAnalogInterfaces[3].init("VJAnalog3");
 }
 
+void WandInterface::captureDeviceState(const float scaleFactor)
+{
+   mSnapshot.m_vp_M_wand = mWandInterface->getData(scaleFactor);
+   mSnapshot.mTimeStamp  = mWandInterface->getTimeStamp();
+
+   std::fill(mSnapshot.mButtonStates.begin(), mSnapshot.mButtonStates.end(),
+             0);
+
+   const unsigned int num_buttons(mButtonInterfaces.size());
+   for ( unsigned int b = 0; b < num_buttons; ++b )
+   {
+      mSnapshot.setButtonState(
+         b,
+         static_cast<gadget::Digital::State>(mButtonInterfaces[b]->getData())
+      );
+   }
+
+   const unsigned int num_analogs(mAnalogInterfaces.size());
+   for ( unsigned int a = 0; a < num_analogs; ++a )
+   {
+      gadget::AnalogInterface& analog_if(mAnalogInterfaces[a]);
+      mSnapshot.mAnalogStupefied[a] = analog_if->isStupefied();
+      mSnapshot.mAnalogValues[a]    =
+         mSnapshot.mAnalogStupefied[a] ? 0.0f : analog_if->getData();
+   }
+}
+
 }
@@ -24,6 +24,9 @@
 #include <string>
 #include <vector>
 
+#include <boost/filesystem/path.hpp>
+
+#include <vpr/Util/Interval.h>
 #include <jccl/Config/ConfigElementPtr.h>
 #include <gadget/Type/DigitalInterface.h>
 #include <gadget/Type/PositionInterface.h>
@@ -32,6 +35,10 @@
 #include <vrkit/ViewerPtr.h>
 #include <vrkit/WandInterfacePtr.h>
 #include <vrkit/DeviceInterface.h>
+#include <vrkit/WandSnapshot.h>
+#include <vrkit/WandRecorderPtr.h>
+#include <vrkit/WandPlaybackPtr.h>
+#include <vrkit/util/PosePredictor.h>
 
 
 namespace vrkit
@@ -60,7 +67,82 @@ public:
     */
    void init(ViewerPtr viewer);
 
-   /** Returns the position interface for the wand. */
+   /**
+    * Captures the current wand transformation, button states, and analog
+    * values in the snapshot returned by getSnapshot(). vrkit::Viewer invokes
+    * this once at the start of each frame before updating any plug-in. If
+    * pose prediction is enabled, the wand transformation in the snapshot is
+    * extrapolated by getLatencyEstimate().
+    *
+    * @param viewer The viewer whose draw scale factor is applied to the
+    *               wand transformation.
+    *
+    * @since 0.51.11
+    */
+   void update(ViewerPtr viewer);
+
+   /**
+    * Returns the wand state captured by the last call to update(). The
+    * snapshot does not change during the frame.
+    *
+    * @since 0.51.12
+    */
+   const WandSnapshot& getSnapshot() const
+   {
+      return mSnapshot;
+   }
+
+   /**
+    * Indicates whether the wand transformation captured by update() is
+    * extrapolated to the expected display time of the frame.
+    *
+    * @since 0.51.13
+    */
+   bool isPosePredictionEnabled() const
+   {
+      return mPredictPose;
+   }
+
+   /**
+    * Returns the estimated time (in seconds) between the sampling of the
+    * wand position captured by the last call to update() and the display of
+    * the current frame. This is the sum of the age of the sample, the
+    * average frame time, and the configured display latency. It is computed
+    * whether or not pose prediction is enabled.
+    *
+    * @since 0.51.13
+    */
+   float getLatencyEstimate() const
+   {
+      return mLatencyEstimate;
+   }
+
+   /**
+    * Returns the object that extrapolates the wand transformation.
+    *
+    * @since 0.51.13
+    */
+   const util::PosePredictor& getPosePredictor() const
+   {
+      return mPosePredictor;
+   }
+
+   /**
+    * Returns the number of configured buttons.
+    *
+    * @since 0.51.11
+    */
+   unsigned int getNumButtons() const
+   {
+      return mButtonInterfaces.size();
+   }
+
+   /**
+    * Returns the position interface for the wand.
+    *
+    * @note Code that executes during a frame should use getSnapshot()
+    *       instead.
+    */
    gadget::PositionInterface& getWandPos();
 
    /**
@@ -77,6 +159,79 @@ public:
     */
    gadget::AnalogInterface& getAnalog(const int analogNum);
 
+   /** @name Input Recording and Playback */
+   //@{
+   /**
+    * Starts writing the wand state captured by each call to update() to the
+    * given file. Any recording already in progress is stopped first. The
+    * recorded state is the input before pose prediction is applied.
+    *
+    * @pre init() has been called.
+    *
+    * @throw vrkit::RecordingException
+    *           Thrown if the file cannot be opened for writing.
+    *
+    * @see vrkit::WandRecorder
+    *
+    * @since 0.51.14
+    */
+   void startRecording(const boost::filesystem::path& file);
+
+   /**
+    * Stops the recording in progress (if any) and closes the file.
+    *
+    * @since 0.51.14
+    */
+   void stopRecording();
+
+   /**
+    * @since 0.51.14
+    */
+   bool isRecording() const
+   {
+      return mRecorder.get() != NULL;
+   }
+
+   /**
+    * Starts feeding the frames of the given recording to update() in place
+    * of the live device input. When the end of the recording is reached,
+    * live input resumes. Any playback already in progress is stopped first.
+    *
+    * @param file     The recording to play back.
+    * @param realTime Whether the recording is played back following its
+    *                 time stamps (true) or one recorded frame per call to
+    *                 update() (false).
+    *
+    * @throw vrkit::RecordingException
+    *           Thrown if the file cannot be opened or is not a wand
+    *           recording.
+    *
+    * @note When using a cluster, each node must play back the same file.
+    *
+    * @see vrkit::WandPlayback
+    *
+    * @since 0.51.14
+    */
+   void startPlayback(const boost::filesystem::path& file,
+                      const bool realTime);
+
+   /**
+    * Stops the playback in progress (if any). Live input resumes with the
+    * next call to update().
+    *
+    * @since 0.51.14
+    */
+   void stopPlayback();
+
+   /**
+    * @since 0.51.14
+    */
+   bool isPlayingBack() const
+   {
+      return mPlayback.get() != NULL;
+   }
+   //@}
+
 private:
    /** @name Configuration Aspects */
    //@{
@@ -120,12 +275,32 @@ private:
    void configureDefault();
    //@}
 
+   /**
+    * Stores the state of the Gadgeteer device interfaces in \c mSnapshot.
+    */
+   void captureDeviceState(const float scaleFactor);
+
    gadget::PositionInterface              mWandInterface;
    std::vector<gadget::DigitalInterface>  mButtonInterfaces;   /**< References to VRJ buttons. */
    std::vector<gadget::AnalogInterface>   mAnalogInterfaces;   /**< References to VRJ analogs. */
 
    gadget::DigitalInterface               mDummyDigital; /**< Dummy to return for digital. */
    gadget::AnalogInterface                mDummyAnalog;  /**< Dummy to return for analog. */
+
+   WandSnapshot                           mSnapshot;     /**< Captured by update(). */
+
+   /** @name Pose Prediction */
+   //@{
+   bool                mPredictPose;
+   util::PosePredictor mPosePredictor;
+   float               mDisplayLatency;  /**< Configured latency (seconds) */
+   float               mFrameTime;       /**< Average frame time (seconds) */
+   vpr::Interval       mLastUpdateTime;
+   float               mLatencyEstimate;
+   //@}
+
+   WandRecorderPtr mRecorder;
+   WandPlaybackPtr mPlayback;
 };
 
 }
@@ -0,0 +1,283 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <sstream>
+#include <algorithm>
+
+#include <vrkit/WandSnapshot.h>
+#include <vrkit/WandRecorder.h>
+#include <vrkit/exceptions/RecordingException.h>
+#include <vrkit/WandPlayback.h>
+
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+
+/**
+ * Replaces the toggle state of each button with the corresponding steady
+ * state so that a repeated frame does not report a toggle twice.
+ */
+void clearToggles(std::vector<vpr::Uint8>& buttons)
+{
+   for ( unsigned int b = 0; b < buttons.size(); ++b )
+   {
+      if ( buttons[b] == gadget::Digital::TOGGLE_ON )
+      {
+         buttons[b] = gadget::Digital::ON;
+      }
+      else if ( buttons[b] == gadget::Digital::TOGGLE_OFF )
+      {
+         buttons[b] = gadget::Digital::OFF;
+      }
+   }
+}
+
+/**
+ * Carries the toggles in \p skipped over to \p next so that a button press
+ * or release in a frame that is not played back is still reported.
+ */
+void carryToggles(const std::vector<vpr::Uint8>& skipped,
+                  std::vector<vpr::Uint8>& next)
+{
+   for ( unsigned int b = 0; b < next.size(); ++b )
+   {
+      if ( skipped[b] == gadget::Digital::TOGGLE_ON &&
+           next[b] == gadget::Digital::ON )
+      {
+         next[b] = gadget::Digital::TOGGLE_ON;
+      }
+      else if ( skipped[b] == gadget::Digital::TOGGLE_OFF &&
+                next[b] == gadget::Digital::OFF )
+      {
+         next[b] = gadget::Digital::TOGGLE_OFF;
+      }
+   }
+}
+
+}
+
+namespace vrkit
+{
+
+WandPlayback::WandPlayback(const fs::path& file, const bool realTime)
+   : mFile(file)
+   , mStream(file, std::ios::in | std::ios::binary)
+   , mRealTime(realTime)
+   , mNumButtons(0)
+   , mNumAnalogs(0)
+   , mFrameCount(0)
+   , mHaveNextFrame(false)
+{
+   if ( ! mStream )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to open wand recording file " << file.string()
+                 << " for reading";
+      throw RecordingException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   vpr::Uint32 magic(0), version(0), bom(0), num_buttons(0), num_analogs(0);
+   read(magic);
+   read(version);
+   read(bom);
+   read(num_buttons);
+   read(num_analogs);
+
+   if ( ! mStream || magic != WandRecorder::sMagic )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << file.string() << " is not a wand recording";
+      throw RecordingException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   if ( version != WandRecorder::sFormatVersion )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Wand recording " << file.string() << " uses format "
+                 << "version " << version << ", but only version "
+                 << WandRecorder::sFormatVersion << " is supported";
+      throw RecordingException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   if ( bom != WandRecorder::sByteOrderMark )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Wand recording " << file.string() << " was written on "
+                 << "a host with a different byte order";
+      throw RecordingException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   mNumButtons = num_buttons;
+   mNumAnalogs = num_analogs;
+
+   mHaveNextFrame = readFrame();
+}
+
+WandPlayback::~WandPlayback()
+{
+   mStream.close();
+}
+
+bool WandPlayback::next(WandSnapshot& snapshot, const float scaleFactor)
+{
+   const vpr::Interval now(vpr::Interval::now());
+
+   if ( mFrameCount == 0 )
+   {
+      if ( ! mHaveNextFrame )
+      {
+         return false;
+      }
+
+      mStartTime      = now;
+      mFirstTimeStamp = mNextFrame.timeStamp;
+      advance();
+   }
+   else if ( mRealTime )
+   {
+      // Play the most recent frame that is due. Frames that are skipped
+      // hand their button toggles on to the frame after them.
+      const vpr::Interval elapsed(now - mStartTime);
+      bool advanced(false);
+
+      while ( mHaveNextFrame &&
+              mNextFrame.timeStamp - mFirstTimeStamp <= elapsed )
+      {
+         if ( advanced )
+         {
+            carryToggles(mCurFrame.buttons, mNextFrame.buttons);
+         }
+
+         advance();
+         advanced = true;
+      }
+
+      if ( ! advanced )
+      {
+         if ( ! mHaveNextFrame )
+         {
+            return false;
+         }
+
+         // The next frame is not due yet, so the current frame is played
+         // again.
+         clearToggles(mCurFrame.buttons);
+      }
+   }
+   else
+   {
+      if ( ! mHaveNextFrame )
+      {
+         return false;
+      }
+
+      advance();
+   }
+
+   const float* m(mCurFrame.xform);
+   snapshot.m_vp_M_wand.set(m[0], m[1], m[2],  m[3]  * scaleFactor,
+                            m[4], m[5], m[6],  m[7]  * scaleFactor,
+                            m[8], m[9], m[10], m[11] * scaleFactor,
+                            0.0f, 0.0f, 0.0f,  1.0f);
+   snapshot.mTimeStamp =
+      mStartTime + (mCurFrame.timeStamp - mFirstTimeStamp);
+
+   std::fill(snapshot.mButtonStates.begin(), snapshot.mButtonStates.end(), 0);
+
+   for ( unsigned int b = 0; b < snapshot.getNumButtons(); ++b )
+   {
+      snapshot.setButtonState(
+         b,
+         b < mNumButtons ?
+            static_cast<gadget::Digital::State>(mCurFrame.buttons[b]) :
+            gadget::Digital::OFF
+      );
+   }
+
+   for ( unsigned int a = 0; a < snapshot.getNumAnalogs(); ++a )
+   {
+      const bool recorded(a < mNumAnalogs);
+      snapshot.mAnalogStupefied[a] = ! recorded || mCurFrame.stupefied[a];
+      snapshot.mAnalogValues[a]    =
+         snapshot.mAnalogStupefied[a] ? 0.0f : mCurFrame.analogs[a];
+   }
+
+   return true;
+}
+
+bool WandPlayback::readFrame()
+{
+   vpr::Uint64 time_stamp(0);
+   read(time_stamp);
+
+   if ( mStream.eof() )
+   {
+      return false;
+   }
+
+   mNextFrame.timeStamp = vpr::Interval(time_stamp, vpr::Interval::Usec);
+   mStream.read(reinterpret_cast<char*>(mNextFrame.xform),
+                sizeof(mNextFrame.xform));
+
+   std::vector<vpr::Uint8> packed((mNumButtons + 3) / 4);
+   if ( ! packed.empty() )
+   {
+      mStream.read(reinterpret_cast<char*>(&packed[0]), packed.size());
+   }
+
+   mNextFrame.buttons.resize(mNumButtons);
+   for ( unsigned int b = 0; b < mNumButtons; ++b )
+   {
+      mNextFrame.buttons[b] = (packed[b / 4] >> ((b % 4) * 2)) & 0x3;
+   }
+
+   packed.assign((mNumAnalogs + 7) / 8, 0);
+   if ( ! packed.empty() )
+   {
+      mStream.read(reinterpret_cast<char*>(&packed[0]), packed.size());
+   }
+
+   mNextFrame.stupefied.resize(mNumAnalogs);
+   mNextFrame.analogs.resize(mNumAnalogs);
+   for ( unsigned int a = 0; a < mNumAnalogs; ++a )
+   {
+      mNextFrame.stupefied[a] = (packed[a / 8] >> (a % 8)) & 1;
+      read(mNextFrame.analogs[a]);
+   }
+
+   if ( ! mStream )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Wand recording " << mFile.string()
+                 << " is truncated";
+      throw RecordingException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   return true;
+}
+
+void WandPlayback::advance()
+{
+   std::swap(mCurFrame, mNextFrame);
+   ++mFrameCount;
+   mHaveNextFrame = readFrame();
+}
+
+}
@@ -0,0 +1,179 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_WAND_PLAYBACK_H_
+#define _VRKIT_WAND_PLAYBACK_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/WandPlaybackPtr.h>
+
+
+namespace vrkit
+{
+
+class WandSnapshot;
+
+/** \class WandPlayback WandPlayback.h vrkit/WandPlayback.h
+ *
+ * Reads the frames of a recording written by vrkit::WandRecorder so that
+ * they can be fed back through vrkit::WandInterface in place of live
+ * Gadgeteer input. Frames can be played back in one of two ways:
+ *
+ *  - At a fixed rate of one recorded frame per rendered frame. Every run
+ *    sees exactly the same sequence of input regardless of how long each
+ *    frame takes to render, which makes this mode suitable for comparing
+ *    frame times across builds.
+ *  - In real time, where the recorded time stamps are followed. Recorded
+ *    frames are skipped if rendering is slower than it was during the
+ *    recording, and repeated if it is faster. Button toggles in skipped
+ *    frames are not lost.
+ *
+ * In either case, the time stamps of the frames are offset so that the
+ * first frame appears to have been sampled when playback started.
+ *
+ * @see vrkit::WandInterface::startPlayback()
+ *
+ * @since 0.51.14
+ */
+class VRKIT_CLASS_API WandPlayback : private boost::noncopyable
+{
+protected:
+   WandPlayback(const boost::filesystem::path& file, const bool realTime);
+
+public:
+   /**
+    * Opens the given recording for playback.
+    *
+    * @param file     The file from which the recording will be read.
+    * @param realTime Whether the recording will be played back following
+    *                 its time stamps (true) or one frame at a time (false).
+    *
+    * @throw vrkit::RecordingException
+    *           Thrown if the file cannot be opened or is not a wand
+    *           recording that this class can read.
+    */
+   static WandPlaybackPtr create(const boost::filesystem::path& file,
+                                 const bool realTime)
+   {
+      return WandPlaybackPtr(new WandPlayback(file, realTime));
+   }
+
+   ~WandPlayback();
+
+   /**
+    * Stores the next frame of the recording in the given snapshot. Buttons
+    * and analog axes that are not in the recording are left in the off and
+    * stupefied states respectively.
+    *
+    * @param snapshot    The snapshot to fill in.
+    * @param scaleFactor The draw scale factor to apply to the translation of
+    *                    the wand transformation.
+    *
+    * @return false is returned if there are no more frames to play back, in
+    *         which case \p snapshot is not modified. Otherwise, true is
+    *         returned.
+    *
+    * @throw vrkit::RecordingException Thrown if the recording is truncated.
+    */
+   bool next(WandSnapshot& snapshot, const float scaleFactor);
+
+   const boost::filesystem::path& getFile() const
+   {
+      return mFile;
+   }
+
+   bool isRealTime() const
+   {
+      return mRealTime;
+   }
+
+   unsigned int getNumButtons() const
+   {
+      return mNumButtons;
+   }
+
+   unsigned int getNumAnalogs() const
+   {
+      return mNumAnalogs;
+   }
+
+   /**
+    * Returns the number of recorded frames read so far.
+    */
+   unsigned int getFrameCount() const
+   {
+      return mFrameCount;
+   }
+
+private:
+   /** A single frame read from the recording. */
+   struct Frame
+   {
+      vpr::Interval           timeStamp;
+      float                   xform[12];  /**< Upper 3x4, row major */
+      std::vector<vpr::Uint8> buttons;    /**< gadget::Digital::State */
+      std::vector<bool>       stupefied;
+      std::vector<float>      analogs;
+   };
+
+   template<typename T>
+   void read(T& value)
+   {
+      mStream.read(reinterpret_cast<char*>(&value), sizeof(T));
+   }
+
+   /**
+    * Reads the next frame from the file into \c mNextFrame.
+    *
+    * @return false is returned if the end of the file was reached.
+    */
+   bool readFrame();
+
+   /**
+    * Replaces \c mCurFrame with \c mNextFrame and reads the frame after
+    * that.
+    */
+   void advance();
+
+   boost::filesystem::path     mFile;
+   boost::filesystem::ifstream mStream;
+   bool                        mRealTime;
+   unsigned int                mNumButtons;
+   unsigned int                mNumAnalogs;
+   unsigned int                mFrameCount;
+
+   Frame         mCurFrame;       /**< Most recently played frame */
+   Frame         mNextFrame;
+   bool          mHaveNextFrame;
+   vpr::Interval mFirstTimeStamp; /**< Recorded time of the first frame */
+   vpr::Interval mStartTime;      /**< Time at which playback started */
+};
+
+}
+
+
+#endif /* _VRKIT_WAND_PLAYBACK_H_ */
@@ -0,0 +1,129 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <sstream>
+#include <vector>
+
+#include <vrkit/WandSnapshot.h>
+#include <vrkit/exceptions/RecordingException.h>
+#include <vrkit/WandRecorder.h>
+
+
+namespace fs = boost::filesystem;
+
+namespace vrkit
+{
+
+const vpr::Uint32 WandRecorder::sMagic(0x574b5256);      // "VRKW"
+const vpr::Uint32 WandRecorder::sFormatVersion(1);
+const vpr::Uint32 WandRecorder::sByteOrderMark(0x01020304);
+
+WandRecorder::WandRecorder(const fs::path& file, const unsigned int numButtons,
+                           const unsigned int numAnalogs)
+   : mFile(file)
+   , mStream(file, std::ios::out | std::ios::binary | std::ios::trunc)
+   , mNumButtons(numButtons)
+   , mNumAnalogs(numAnalogs)
+   , mFrameCount(0)
+{
+   if ( ! mStream )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to open wand recording file "
+                 << file.string() << " for writing";
+      throw RecordingException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   write(sMagic);
+   write(sFormatVersion);
+   write(sByteOrderMark);
+   write(vpr::Uint32(mNumButtons));
+   write(vpr::Uint32(mNumAnalogs));
+}
+
+WandRecorder::~WandRecorder()
+{
+   mStream.close();
+}
+
+void WandRecorder::record(const WandSnapshot& snapshot,
+                          const float scaleFactor)
+{
+   write(vpr::Uint64(snapshot.getTimeStamp().usec()));
+
+   // Only the upper 3x4 portion of the matrix is stored. The translation is
+   // stored in tracker units.
+   const gmtl::Matrix44f& xform(snapshot.getWandPos());
+   const float inv_scale(scaleFactor != 0.0f ? 1.0f / scaleFactor : 1.0f);
+   for ( unsigned int r = 0; r < 3; ++r )
+   {
+      for ( unsigned int c = 0; c < 3; ++c )
+      {
+         write(xform(r, c));
+      }
+      write(xform(r, 3) * inv_scale);
+   }
+
+   // Two bits per button state, packed four to a byte.
+   std::vector<vpr::Uint8> buttons((mNumButtons + 3) / 4, 0);
+   for ( unsigned int b = 0; b < mNumButtons; ++b )
+   {
+      const vpr::Uint8 state(snapshot.getButtonState(b));
+      buttons[b / 4] |= (state & 0x3) << ((b % 4) * 2);
+   }
+
+   if ( ! buttons.empty() )
+   {
+      mStream.write(reinterpret_cast<const char*>(&buttons[0]),
+                    buttons.size());
+   }
+
+   // One bit per analog axis indicating whether it was stupefied, followed
+   // by the analog values.
+   std::vector<vpr::Uint8> stupefied((mNumAnalogs + 7) / 8, 0);
+   for ( unsigned int a = 0; a < mNumAnalogs; ++a )
+   {
+      if ( snapshot.isAnalogStupefied(a) )
+      {
+         stupefied[a / 8] |= 1 << (a % 8);
+      }
+   }
+
+   if ( ! stupefied.empty() )
+   {
+      mStream.write(reinterpret_cast<const char*>(&stupefied[0]),
+                    stupefied.size());
+   }
+
+   for ( unsigned int a = 0; a < mNumAnalogs; ++a )
+   {
+      write(snapshot.getAnalog(a));
+   }
+
+   if ( ! mStream )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to write frame " << mFrameCount
+                 << " to wand recording file " << mFile.string();
+      throw RecordingException(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   ++mFrameCount;
+}
+
+}
@@ -0,0 +1,137 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_WAND_RECORDER_H_
+#define _VRKIT_WAND_RECORDER_H_
+
+#include <vrkit/Config.h>
+
+#include <vpr/vprTypes.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <vrkit/WandRecorderPtr.h>
+
+
+namespace vrkit
+{
+
+class WandSnapshot;
+
+/** \class WandRecorder WandRecorder.h vrkit/WandRecorder.h
+ *
+ * Writes the wand state captured in each frame to a binary file so that a
+ * session can be replayed later using vrkit::WandPlayback. The file starts
+ * with a header identifying the format and the number of buttons and analog
+ * axes. Each frame after that holds the time stamp of the tracker sample,
+ * the upper 3x4 portion of the wand transformation, two bits per button
+ * state, one bit per analog axis indicating whether it was stupefied, and
+ * the analog values. The translation of the wand transformation is stored
+ * without the draw scale factor so that a recording can be replayed with a
+ * different scale factor.
+ *
+ * Data is written in the byte order of the host. vrkit::WandPlayback
+ * rejects files written on a host with a different byte order.
+ *
+ * @see vrkit::WandInterface::startRecording()
+ *
+ * @since 0.51.14
+ */
+class VRKIT_CLASS_API WandRecorder : private boost::noncopyable
+{
+protected:
+   WandRecorder(const boost::filesystem::path& file,
+                const unsigned int numButtons, const unsigned int numAnalogs);
+
+public:
+   /**
+    * Creates a recorder that writes to the given file. The file is created
+    * or truncated, and the header is written immediately.
+    *
+    * @param file       The file to which the recording will be written.
+    * @param numButtons The number of buttons to record for each frame.
+    * @param numAnalogs The number of analog axes to record for each frame.
+    *
+    * @throw vrkit::RecordingException
+    *           Thrown if the file cannot be opened for writing.
+    */
+   static WandRecorderPtr create(const boost::filesystem::path& file,
+                                 const unsigned int numButtons,
+                                 const unsigned int numAnalogs)
+   {
+      return WandRecorderPtr(new WandRecorder(file, numButtons, numAnalogs));
+   }
+
+   ~WandRecorder();
+
+   /**
+    * Appends the given snapshot to the recording as the next frame.
+    *
+    * @param snapshot    The wand state to record.
+    * @param scaleFactor The draw scale factor that was applied to the wand
+    *                    transformation in \p snapshot.
+    *
+    * @throw vrkit::RecordingException Thrown if writing to the file fails.
+    */
+   void record(const WandSnapshot& snapshot, const float scaleFactor);
+
+   const boost::filesystem::path& getFile() const
+   {
+      return mFile;
+   }
+
+   /**
+    * Returns the number of frames recorded so far.
+    */
+   unsigned int getFrameCount() const
+   {
+      return mFrameCount;
+   }
+
+   /** @name File Format */
+   //@{
+   /** Identifies a wand recording. */
+   static const vpr::Uint32 sMagic;
+
+   /** The version of the format written by this class. */
+   static const vpr::Uint32 sFormatVersion;
+
+   /** Written as-is to identify the byte order of the recording. */
+   static const vpr::Uint32 sByteOrderMark;
+   //@}
+
+private:
+   template<typename T>
+   void write(const T& value)
+   {
+      mStream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+   }
+
+   boost::filesystem::path     mFile;
+   boost::filesystem::ofstream mStream;
+   unsigned int                mNumButtons;
+   unsigned int                mNumAnalogs;
+   unsigned int                mFrameCount;
+};
+
+}
+
+
+#endif /* _VRKIT_WAND_RECORDER_H_ */
@@ -0,0 +1,101 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <vrkit/WandSnapshot.h>
+
+
+namespace vrkit
+{
+
+WandSnapshot::WandSnapshot()
+   : mNumButtons(0)
+{
+   /* Do nothing. */ ;
+}
+
+gadget::Digital::State WandSnapshot::getButtonState(const int buttonNum) const
+{
+   if ( buttonNum >= 0 && buttonNum < static_cast<int>(mNumButtons) )
+   {
+      const gadget::Digital::State states[] =
+         {
+            gadget::Digital::ON, gadget::Digital::TOGGLE_ON,
+            gadget::Digital::TOGGLE_OFF
+         };
+
+      for ( unsigned int s = 0; s < sizeof(states) / sizeof(states[0]); ++s )
+      {
+         const unsigned int bit(getButtonStateBit(buttonNum, states[s]));
+         if ( (mButtonStates[bit / 64] >> (bit % 64)) & 1 )
+         {
+            return states[s];
+         }
+      }
+   }
+
+   return gadget::Digital::OFF;
+}
+
+unsigned int
+WandSnapshot::getButtonStateBit(const unsigned int buttonNum,
+                                const gadget::Digital::State state)
+{
+   unsigned int offset(0);
+
+   switch ( state )
+   {
+      case gadget::Digital::ON:
+         offset = 1;
+         break;
+      case gadget::Digital::TOGGLE_ON:
+         offset = 2;
+         break;
+      case gadget::Digital::TOGGLE_OFF:
+         offset = 3;
+         break;
+      default:
+         offset = 0;
+         break;
+   }
+
+   return buttonNum * 4 + offset;
+}
+
+void WandSnapshot::reset(const unsigned int numButtons,
+                         const unsigned int numAnalogs)
+{
+   mNumButtons = numButtons;
+   mButtonStates.assign((numButtons * 4 + 63) / 64, 0);
+
+   for ( unsigned int b = 0; b < numButtons; ++b )
+   {
+      setButtonState(b, gadget::Digital::OFF);
+   }
+
+   mAnalogValues.assign(numAnalogs, 0.0f);
+   mAnalogStupefied.assign(numAnalogs, true);
+}
+
+void WandSnapshot::setButtonState(const unsigned int buttonNum,
+                                  const gadget::Digital::State state)
+{
+   const unsigned int bit(getButtonStateBit(buttonNum, state));
+   mButtonStates[bit / 64] |= vpr::Uint64(1) << (bit % 64);
+}
+
+}
@@ -0,0 +1,163 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_WAND_SNAPSHOT_H_
+#define _VRKIT_WAND_SNAPSHOT_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+#include <gadget/Type/Digital.h>
+#include <gmtl/Matrix.h>
+
+
+namespace vrkit
+{
+
+class WandInterface;
+class WandPlayback;
+
+/** \class WandSnapshot WandSnapshot.h vrkit/WandSnapshot.h
+ *
+ * The state of the wand captured at the start of a frame by
+ * vrkit::WandInterface::update(). This includes the wand transformation,
+ * the time stamp of the tracker sample, the state of every button, and the
+ * value of every analog axis. Code that reads the wand state during a frame
+ * should use the snapshot rather than querying the Gadgeteer device
+ * interfaces so that all code sees the same input and the wand
+ * transformation is converted only once per frame.
+ *
+ * @see vrkit::WandInterface::getSnapshot()
+ *
+ * @since 0.51.12
+ */
+class VRKIT_CLASS_API WandSnapshot
+{
+public:
+   WandSnapshot();
+
+   /**
+    * Returns the wand transformation in virtual platform coordinates. The
+    * translation is scaled by the draw scale factor of vrkit::Viewer.
+    */
+   const gmtl::Matrix44f& getWandPos() const
+   {
+      return m_vp_M_wand;
+   }
+
+   /**
+    * Returns the time stamp of the tracker sample from which the wand
+    * transformation was taken.
+    */
+   const vpr::Interval& getTimeStamp() const
+   {
+      return mTimeStamp;
+   }
+
+   unsigned int getNumButtons() const
+   {
+      return mNumButtons;
+   }
+
+   /**
+    * Returns the state of the identified button. If \p buttonNum is out of
+    * range, then \c gadget::Digital::OFF is returned.
+    */
+   gadget::Digital::State getButtonState(const int buttonNum) const;
+
+   /**
+    * Returns the button states as a bit set in which the bit identified by
+    * getButtonStateBit() is set if and only if the button was in the
+    * corresponding state.
+    */
+   const std::vector<vpr::Uint64>& getButtonStates() const
+   {
+      return mButtonStates;
+   }
+
+   /**
+    * Returns the index of the bit in getButtonStates() that indicates
+    * whether the given button is in the given state.
+    */
+   static unsigned int getButtonStateBit(const unsigned int buttonNum,
+                                         const gadget::Digital::State state);
+
+   unsigned int getNumAnalogs() const
+   {
+      return mAnalogValues.size();
+   }
+
+   /**
+    * Returns the normalized value of the identified analog axis. If
+    * \p analogNum is out of range, then 0 is returned.
+    */
+   float getAnalog(const int analogNum) const
+   {
+      return isValidAnalog(analogNum) ? mAnalogValues[analogNum] : 0.0f;
+   }
+
+   /**
+    * Indicates whether the identified analog axis had no device data when
+    * the snapshot was captured. This is true if \p analogNum is out of
+    * range.
+    */
+   bool isAnalogStupefied(const int analogNum) const
+   {
+      return ! isValidAnalog(analogNum) || mAnalogStupefied[analogNum];
+   }
+
+private:
+   friend class WandInterface;
+   friend class WandPlayback;
+class WandPlayback;
+
+   bool isValidAnalog(const int analogNum) const
+   {
+      return analogNum >= 0 &&
+                analogNum < static_cast<int>(mAnalogValues.size());
+   }
+
+   /**
+    * Sizes the button and analog data and puts every button in the off
+    * state.
+    */
+   void reset(const unsigned int numButtons, const unsigned int numAnalogs);
+
+   /**
+    * Records that the identified button is in the given state.
+    *
+    * @pre The button states for the previous frame have been cleared.
+    */
+   void setButtonState(const unsigned int buttonNum,
+                       const gadget::Digital::State state);
+
+   gmtl::Matrix44f          m_vp_M_wand;
+   vpr::Interval            mTimeStamp;
+   unsigned int             mNumButtons;
+   std::vector<vpr::Uint64> mButtonStates;
+   std::vector<float>       mAnalogValues;
+   std::vector<bool>        mAnalogStupefied;
+};
+
+}
+
+
+#endif /* _VRKIT_WAND_SNAPSHOT_H_ */
@@ -43,6 +43,16 @@ Strategy::~Strategy()
    /* Do nothing. */ ;
 }
 
+void Strategy::computeMoves(ViewerPtr viewer, const SceneObjectPtr* objs,
+                            gmtl::Matrix44f* objPos, const std::size_t count,
+                            const gmtl::Matrix44f& vp_M_wand)
+{
+   for ( std::size_t i = 0; i < count; ++i )
+   {
+      objPos[i] = computeMove(viewer, objs[i], vp_M_wand, objPos[i]);
+   }
+}
+
 bool Strategy::validatePluginLib(vpr::LibraryPtr pluginLib)
 {
    plugin::Module pm(pluginLib);
@@ -21,6 +21,7 @@
 
 #include <vrkit/Config.h>
 
+#include <cstddef>
 #include <vector>
 
 #include <gmtl/Matrix.h>
@@ -33,8 +34,8 @@
 
 #include <vrkit/move/StrategyPtr.h>
 
-#define VRKIT_MOVE_STRATEGY_PLUGIN_API_MAJOR 2
-#define VRKIT_MOVE_STRATEGY_PLUGIN_API_MINOR 1
+#define VRKIT_MOVE_STRATEGY_PLUGIN_API_MAJOR 3
+#define VRKIT_MOVE_STRATEGY_PLUGIN_API_MINOR 0
 
 
 namespace vrkit
@@ -171,6 +172,33 @@ public:
    virtual gmtl::Matrix44f computeMove(ViewerPtr viewer, SceneObjectPtr obj,
                                        const gmtl::Matrix44f& vp_M_wand,
                                        const gmtl::Matrix44f& curObjPos) = 0;
+
+   /**
+    * Computes the new transformations for a batch of grabbed scene objects.
+    * This is invoked once per frame with all the grabbed objects instead of
+    * invoking computeMove() once per object. On input, \p objPos[i] is the
+    * current transformation of \p objs[i] relative to its parent (see the
+    * \p curObjPos parameter of computeMove()). On output, it is the new
+    * transformation (pobj_M_obj').
+    *
+    * The default implementation invokes computeMove() for each object. Move
+    * strategies should override this when work can be shared between the
+    * objects of a batch.
+    *
+    * @pre objectGrabbed() was called for each object in \p objs.
+    *
+    * @param viewer    The VR Juggler application object.
+    * @param objs      The start of an array of \p count grabbed scene
+    *                  objects.
+    * @param objPos    The start of an array of \p count transformations.
+    * @param count     The number of elements in \p objs and \p objPos.
+    * @param vp_M_wand The wand transformation in view platform coordiantes.
+    *
+    * @since 0.51.19
+    */
+   virtual void computeMoves(ViewerPtr viewer, const SceneObjectPtr* objs,
+                             gmtl::Matrix44f* objPos, const std::size_t count,
+                             const gmtl::Matrix44f& vp_M_wand);
 };
 
 }
@@ -0,0 +1,221 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include <gmtl/Math.h>
+#include <gmtl/MatrixOps.h>
+#include <gmtl/QuatOps.h>
+#include <gmtl/VecOps.h>
+#include <gmtl/Generate.h>
+
+#include <vpr/Util/Assert.h>
+
+#include <vrkit/nav/CameraPath.h>
+
+
+namespace
+{
+
+// Evaluates the Catmull-Rom segment from p1 to p2 at t in [0,1].
+gmtl::Vec3f catmullRom(const gmtl::Vec3f& p0, const gmtl::Vec3f& p1,
+                       const gmtl::Vec3f& p2, const gmtl::Vec3f& p3,
+                       const float t)
+{
+   const float t2(t * t);
+   const float t3(t2 * t);
+
+   return (p1 * 2.0f + (p2 - p0) * t +
+           (p0 * 2.0f - p1 * 5.0f + p2 * 4.0f - p3) * t2 +
+           (p1 * 3.0f - p0 - p2 * 3.0f + p3) * t3) * 0.5f;
+}
+
+}
+
+namespace vrkit
+{
+
+namespace nav
+{
+
+CameraPath::CameraPath()
+{
+   /* Do nothing. */ ;
+}
+
+void CameraPath::build(const gmtl::Matrix44f& from, const gmtl::Matrix44f& to,
+                       const unsigned int numSamples)
+{
+   std::vector<gmtl::Matrix44f> keys(2);
+   keys[0] = from;
+   keys[1] = to;
+   build(keys, numSamples);
+}
+
+void CameraPath::build(const std::vector<gmtl::Matrix44f>& keys,
+                       const unsigned int numSamples)
+{
+   vprASSERT(keys.size() >= 2 && "A path needs at least two keys");
+
+   mSamples.clear();
+
+   const unsigned int num_keys(keys.size());
+   const unsigned int samples_per_seg(std::max(numSamples, 1u));
+
+   std::vector<gmtl::Vec3f> pos(num_keys);
+   std::vector<gmtl::Quatf> rot(num_keys);
+
+   for ( unsigned int k = 0; k < num_keys; ++k )
+   {
+      pos[k] = gmtl::makeTrans<gmtl::Vec3f>(keys[k]);
+      rot[k] = gmtl::make<gmtl::Quatf>(keys[k]);
+
+      // Keep consecutive rotations in the same hemisphere so that each
+      // segment takes the shorter way around.
+      if ( k > 0 && gmtl::dot(rot[k - 1], rot[k]) < 0.0f )
+      {
+         rot[k] = -rot[k];
+      }
+   }
+
+   // The end tangents are chosen by reflecting the neighbouring key.
+   const gmtl::Vec3f first(pos[0] * 2.0f - pos[1]);
+   const gmtl::Vec3f last(pos[num_keys - 1] * 2.0f - pos[num_keys - 2]);
+
+   mSamples.reserve((num_keys - 1) * samples_per_seg + 1);
+
+   for ( unsigned int k = 0; k + 1 < num_keys; ++k )
+   {
+      const gmtl::Vec3f& p0(k == 0 ? first : pos[k - 1]);
+      const gmtl::Vec3f& p3(k + 2 == num_keys ? last : pos[k + 2]);
+
+      // The last segment includes its end point.
+      const unsigned int count(k + 2 == num_keys ? samples_per_seg + 1
+                                                 : samples_per_seg);
+
+      for ( unsigned int i = 0; i < count; ++i )
+      {
+         const float t(static_cast<float>(i) / samples_per_seg);
+
+         Sample sample;
+         sample.pos = catmullRom(p0, pos[k], pos[k + 1], p3, t);
+         gmtl::slerp(sample.rot, t, rot[k], rot[k + 1]);
+         sample.dist = 0.0f;
+
+         if ( ! mSamples.empty() )
+         {
+            const Sample& prev(mSamples.back());
+            sample.dist = prev.dist + gmtl::length(sample.pos - prev.pos);
+         }
+
+         mSamples.push_back(sample);
+      }
+   }
+
+   // A path with no translation (rotation only) is parameterized evenly so
+   // that the rotation still progresses.
+   if ( mSamples.back().dist <= 1e-6f )
+   {
+      const float last_index(mSamples.size() - 1);
+      for ( unsigned int i = 0; i < mSamples.size(); ++i )
+      {
+         mSamples[i].dist = i / last_index * 1e-6f;
+      }
+   }
+}
+
+void CameraPath::clear()
+{
+   mSamples.clear();
+}
+
+float CameraPath::getLength() const
+{
+   return mSamples.empty() ? 0.0f : mSamples.back().dist;
+}
+
+gmtl::Matrix44f CameraPath::evaluate(const float s) const
+{
+   vprASSERT(! mSamples.empty() && "Cannot evaluate an empty path");
+
+   gmtl::Matrix44f result;
+
+   if ( s <= 0.0f || mSamples.size() == 1 )
+   {
+      gmtl::setRot(result, mSamples.front().rot);
+      gmtl::setTrans(result, mSamples.front().pos);
+      return result;
+   }
+   else if ( s >= 1.0f )
+   {
+      gmtl::setRot(result, mSamples.back().rot);
+      gmtl::setTrans(result, mSamples.back().pos);
+      return result;
+   }
+
+   const float dist(s * mSamples.back().dist);
+
+   // Find the first sample at or beyond the target distance.
+   unsigned int lo(0), hi(mSamples.size() - 1);
+   while ( lo + 1 < hi )
+   {
+      const unsigned int mid((lo + hi) / 2);
+      if ( mSamples[mid].dist < dist )
+      {
+         lo = mid;
+      }
+      else
+      {
+         hi = mid;
+      }
+   }
+
+   const Sample& a(mSamples[lo]);
+   const Sample& b(mSamples[hi]);
+   const float span(b.dist - a.dist);
+   const float t(span > 0.0f ? (dist - a.dist) / span : 0.0f);
+
+   gmtl::Quatf rot;
+   gmtl::slerp(rot, t, a.rot, b.rot);
+   gmtl::setRot(result, rot);
+   gmtl::setTrans(result, a.pos + (b.pos - a.pos) * t);
+
+   return result;
+}
+
+float CameraPath::ease(const Easing easing, const float t)
+{
+   const float x(gmtl::Math::clamp(t, 0.0f, 1.0f));
+
+   switch ( easing )
+   {
+      case EASE_IN_OUT:
+         return x * x * (3.0f - 2.0f * x);
+      case EASE_IN:
+         return x * x;
+      case EASE_OUT:
+         return x * (2.0f - x);
+      case LINEAR:
+      default:
+         return x;
+   }
+}
+
+}
+
+}
@@ -0,0 +1,125 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_NAV_CAMERA_PATH_H_
+#define _VRKIT_NAV_CAMERA_PATH_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/Vec.h>
+#include <gmtl/Quat.h>
+
+
+namespace vrkit
+{
+
+namespace nav
+{
+
+/** \class CameraPath CameraPath.h vrkit/nav/CameraPath.h
+ *
+ * A path for the view platform through a sequence of key transformations.
+ * The translation follows a Catmull-Rom spline through the key positions,
+ * and the rotation is interpolated spherically between the key rotations.
+ * The path is sampled when it is built, and evaluating it looks up the two
+ * nearest samples by arc length. Evaluating the path at evenly spaced
+ * parameter values therefore moves at constant speed.
+ *
+ * @since 0.51.18
+ */
+class VRKIT_CLASS_API CameraPath
+{
+public:
+   /** Easing functions for mapping time onto the path parameter. */
+   enum Easing
+   {
+      LINEAR      = 0,   /**< Constant speed */
+      EASE_IN_OUT = 1,   /**< Accelerate from rest and decelerate to rest */
+      EASE_IN     = 2,   /**< Accelerate from rest */
+      EASE_OUT    = 3    /**< Decelerate to rest */
+   };
+
+   CameraPath();
+
+   /**
+    * Builds the path through the given transformations. Any previous path
+    * is discarded.
+    *
+    * @pre \p keys contains at least two transformations. Each is a rigid
+    *      transformation.
+    *
+    * @param keys       The transformations that the path passes through in
+    *                   order.
+    * @param numSamples The number of samples taken on each segment between
+    *                   keys.
+    */
+   void build(const std::vector<gmtl::Matrix44f>& keys,
+              const unsigned int numSamples = 32);
+
+   /**
+    * Builds a path between two transformations.
+    */
+   void build(const gmtl::Matrix44f& from, const gmtl::Matrix44f& to,
+              const unsigned int numSamples = 32);
+
+   void clear();
+
+   bool empty() const
+   {
+      return mSamples.empty();
+   }
+
+   /**
+    * Returns the length of the path in the units of the key translations.
+    */
+   float getLength() const;
+
+   /**
+    * Returns the transformation at the given fraction of the path.
+    *
+    * @pre The path is not empty.
+    *
+    * @param s The fraction of the path length. It is clamped to [0,1].
+    */
+   gmtl::Matrix44f evaluate(const float s) const;
+
+   /**
+    * Applies the given easing function to \p t, which is clamped to [0,1].
+    */
+   static float ease(const Easing easing, const float t);
+
+private:
+   struct Sample
+   {
+      gmtl::Vec3f pos;
+      gmtl::Quatf rot;
+      float       dist;   /**< Distance along the path from the start */
+   };
+
+   std::vector<Sample> mSamples;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_NAV_CAMERA_PATH_H_ */
@@ -0,0 +1,169 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include <gmtl/Vec.h>
+#include <gmtl/VecOps.h>
+#include <gmtl/MatrixOps.h>
+#include <gmtl/Xforms.h>
+#include <gmtl/Generate.h>
+
+#include <gadget/Type/PositionProxy.h>
+
+#include <vrkit/Scene.h>
+#include <vrkit/Viewer.h>
+#include <vrkit/User.h>
+#include <vrkit/util/TriangleBVH.h>
+#include <vrkit/scenedata/CollisionData.h>
+#include <vrkit/nav/Collider.h>
+
+
+namespace vrkit
+{
+
+namespace nav
+{
+
+Collider::Collider()
+   : mEnabled(false)
+   , mRadius(0.25f)
+   , mStepHeight(0.3f)
+{
+   /* Do nothing. */ ;
+}
+
+void Collider::setRadius(const float radius)
+{
+   mRadius = std::max(radius, 0.01f);
+}
+
+void Collider::setStepHeight(const float height)
+{
+   mStepHeight = std::max(height, 0.0f);
+}
+
+gmtl::Matrix44f Collider::constrain(ViewerPtr viewer,
+                                    const gmtl::Matrix44f& curPos,
+                                    const gmtl::Matrix44f& goalPos,
+                                    const bool walk) const
+{
+   if ( ! mEnabled )
+   {
+      return goalPos;
+   }
+
+   const float scale(viewer->getDrawScaleFactor());
+   const gmtl::Matrix44f vp_M_head(
+      viewer->getUser()->getHeadProxy()->getData(scale)
+   );
+   const gmtl::Point3f vp_foot(vp_M_head[0][3], 0.0f, vp_M_head[2][3]);
+
+   ScenePtr scene = viewer->getSceneObj();
+   CollisionDataPtr collision_data = scene->getSceneData<CollisionData>();
+
+   // Until the first hierarchy has been built, the hierarchy is empty and
+   // the move is not constrained.
+   const CollisionData::bvh_ptr_type bvh(collision_data->getBVH(scene));
+   return constrain(*bvh, vp_foot, scale, curPos, goalPos, walk);
+}
+
+gmtl::Matrix44f Collider::constrain(const util::TriangleBVH& bvh,
+                                    const gmtl::Point3f& vpFootPos,
+                                    const float scale,
+                                    const gmtl::Matrix44f& curPos,
+                                    const gmtl::Matrix44f& goalPos,
+                                    const bool walk) const
+{
+   if ( bvh.empty() )
+   {
+      return goalPos;
+   }
+
+   const unsigned int max_slides(4);
+   const float radius(mRadius * scale);
+   const float lift(mStepHeight * scale + radius);
+
+   // Distance kept between the sphere and any surface it hits so that the
+   // next sweep does not start in contact.
+   const float skin(radius * 0.01f);
+
+   const gmtl::Point3f vp_center(vpFootPos[0], lift, vpFootPos[2]);
+   const gmtl::Point3f start(curPos * vp_center);
+   gmtl::Point3f center(start);
+   gmtl::Vec3f motion((goalPos * vp_center) - start);
+
+   if ( walk )
+   {
+      motion[1] = 0.0f;
+   }
+
+   // Collide and slide: move until the sphere hits something, then remove
+   // the part of the remaining motion that goes into the surface.
+   for ( unsigned int i = 0;
+         i < max_slides && gmtl::lengthSquared(motion) > skin * skin * 1e-4f;
+         ++i )
+   {
+      float fraction;
+      gmtl::Vec3f normal;
+
+      if ( ! bvh.sweepSphere(center, radius, motion, fraction, normal) )
+      {
+         center += motion;
+         break;
+      }
+
+      const float length(gmtl::length(motion));
+      const float travel(std::max(fraction * length - skin, 0.0f));
+      center += motion * (travel / length);
+
+      motion *= 1.0f - fraction;
+      motion -= normal * gmtl::dot(motion, normal);
+
+      if ( walk )
+      {
+         motion[1] = 0.0f;
+      }
+   }
+
+   // Put the feet on the ground beneath the sphere. If there is no ground,
+   // the height does not change.
+   if ( walk )
+   {
+      const float max_drop(
+         std::max(center[1] - bvh.getBounds().getMin()[1], 0.0f) + lift
+      );
+      float distance;
+      gmtl::Vec3f normal;
+
+      if ( bvh.intersectRay(center, gmtl::Vec3f(0.0f, -1.0f, 0.0f), max_drop,
+                            distance, normal) )
+      {
+         center[1] += lift - distance;
+      }
+   }
+
+   gmtl::Matrix44f result(goalPos);
+   gmtl::setTrans(result,
+                  gmtl::makeTrans<gmtl::Vec3f>(curPos) + (center - start));
+   return result;
+}
+
+}
+
+}
@@ -0,0 +1,145 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_NAV_COLLIDER_H_
+#define _VRKIT_NAV_COLLIDER_H_
+
+#include <vrkit/Config.h>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/Point.h>
+
+#include <vrkit/ViewerPtr.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+   class TriangleBVH;
+}
+
+namespace nav
+{
+
+/** \class Collider Collider.h vrkit/nav/Collider.h
+ *
+ * Keeps navigation from moving the user through the geometry of the scene.
+ * The user is represented by a sphere centered beneath the head, raised off
+ * the floor of the view platform by the step height. A proposed move of the
+ * view platform is swept against vrkit::CollisionData and slides along any
+ * surface that it hits. In walk mode, vertical motion is ignored, and the
+ * view platform instead follows the ground beneath the user. Ledges lower
+ * than the step height are climbed, and drops of any height are followed.
+ *
+ * Navigation strategies hold an instance of this class and pass each
+ * translation of the view platform through constrain() before applying it.
+ *
+ * @see vrkit::CollisionData
+ *
+ * @since 0.51.15
+ */
+class VRKIT_CLASS_API Collider
+{
+public:
+   Collider();
+
+   void setEnabled(const bool enabled)
+   {
+      mEnabled = enabled;
+   }
+
+   bool isEnabled() const
+   {
+      return mEnabled;
+   }
+
+   /**
+    * Sets the radius (in meters) of the sphere that represents the user.
+    */
+   void setRadius(const float radius);
+
+   float getRadius() const
+   {
+      return mRadius;
+   }
+
+   /**
+    * Sets the height (in meters) of the tallest ledge that can be climbed
+    * in walk mode.
+    */
+   void setStepHeight(const float height);
+
+   float getStepHeight() const
+   {
+      return mStepHeight;
+   }
+
+   /**
+    * Constrains a move of the view platform so that the user does not pass
+    * through the scene.
+    *
+    * @param viewer  The viewer whose scene, user, and draw scale factor are
+    *                used.
+    * @param curPos  The current view platform transformation (vw_M_vp).
+    * @param goalPos The proposed view platform transformation. This must
+    *                differ from \p curPos only in its translation.
+    * @param walk    Whether the user is walking rather than flying.
+    *
+    * @return The view platform transformation to use instead of
+    *         \p goalPos. If collision detection is disabled or the collision
+    *         hierarchy of the scene is still being built for the first time,
+    *         \p goalPos is returned.
+    */
+   gmtl::Matrix44f constrain(ViewerPtr viewer, const gmtl::Matrix44f& curPos,
+                             const gmtl::Matrix44f& goalPos,
+                             const bool walk) const;
+
+   /**
+    * Constrains a move of the view platform against the given hierarchy.
+    * This is the implementation of the above overload. It does not consult
+    * isEnabled().
+    *
+    * @param bvh       The scene geometry in virtual world coordinates.
+    * @param vpFootPos The position on the floor of the view platform
+    *                  beneath the user's head.
+    * @param scale     The draw scale factor.
+    * @param curPos    The current view platform transformation.
+    * @param goalPos   The proposed view platform transformation.
+    * @param walk      Whether the user is walking rather than flying.
+    */
+   gmtl::Matrix44f constrain(const util::TriangleBVH& bvh,
+                             const gmtl::Point3f& vpFootPos,
+                             const float scale,
+                             const gmtl::Matrix44f& curPos,
+                             const gmtl::Matrix44f& goalPos,
+                             const bool walk) const;
+
+private:
+   bool  mEnabled;
+   float mRadius;
+   float mStepHeight;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_NAV_COLLIDER_H_ */
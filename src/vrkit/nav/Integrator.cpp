@@ -0,0 +1,157 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gmtl/MatrixOps.h>
+#include <gmtl/Quat.h>
+#include <gmtl/QuatOps.h>
+#include <gmtl/Vec.h>
+#include <gmtl/VecOps.h>
+#include <gmtl/Generate.h>
+
+#include <vrkit/ViewPlatform.h>
+#include <vrkit/nav/Integrator.h>
+
+
+namespace vrkit
+{
+
+namespace nav
+{
+
+Integrator::Integrator()
+   : mStepSize(8333, vpr::Interval::Usec)
+   , mMaxFrameTime(250, vpr::Interval::Msec)
+   , mStarted(false)
+{
+   /* Do nothing. */ ;
+}
+
+void Integrator::setStepSize(const vpr::Interval& stepSize)
+{
+   if ( stepSize.usec() > 0 )
+   {
+      mStepSize = stepSize;
+   }
+}
+
+void Integrator::setMaxFrameTime(const vpr::Interval& maxFrameTime)
+{
+   mMaxFrameTime = maxFrameTime;
+}
+
+void Integrator::reset()
+{
+   mStarted     = false;
+   mAccumulator = vpr::Interval();
+}
+
+unsigned int Integrator::update(const vpr::Interval& time,
+                                ViewPlatform& viewPlatform,
+                                const step_func_t& step)
+{
+   const gmtl::Matrix44f& platform_pos(viewPlatform.getCurPos());
+
+   // Start over if this is the first update or if something else moved the
+   // view platform since the last update.
+   if ( ! mStarted || platform_pos != mOutputPos )
+   {
+      mPrevPos     = platform_pos;
+      mCurPos      = platform_pos;
+      mOutputPos   = platform_pos;
+      mAccumulator = vpr::Interval();
+
+      if ( ! mStarted )
+      {
+         mStarted  = true;
+         mLastTime = time;
+         return 0;
+      }
+   }
+
+   // Time stamps that go backwards are treated as no time passing.
+   if ( time > mLastTime )
+   {
+      vpr::Interval elapsed(time - mLastTime);
+      if ( elapsed > mMaxFrameTime )
+      {
+         elapsed = mMaxFrameTime;
+      }
+
+      mAccumulator += elapsed;
+   }
+
+   mLastTime = time;
+
+   const float dt(mStepSize.secf());
+   unsigned int steps(0);
+
+   while ( mAccumulator.usec() >= mStepSize.usec() )
+   {
+      mPrevPos = mCurPos;
+      step(mCurPos, dt);
+      mAccumulator -= mStepSize;
+      ++steps;
+   }
+
+   const gmtl::Matrix44f output(interpolate(mPrevPos, mCurPos, getAlpha()));
+
+   if ( output != platform_pos )
+   {
+      mOutputPos = output;
+      viewPlatform.setCurPos(output);
+   }
+
+   return steps;
+}
+
+float Integrator::getAlpha() const
+{
+   return static_cast<float>(mAccumulator.usec()) /
+             static_cast<float>(mStepSize.usec());
+}
+
+gmtl::Matrix44f Integrator::interpolate(const gmtl::Matrix44f& from,
+                                        const gmtl::Matrix44f& to,
+                                        const float alpha)
+{
+   if ( from == to || alpha >= 1.0f )
+   {
+      return to;
+   }
+   else if ( alpha <= 0.0f )
+   {
+      return from;
+   }
+
+   const gmtl::Quatf from_rot(gmtl::make<gmtl::Quatf>(from));
+   const gmtl::Quatf to_rot(gmtl::make<gmtl::Quatf>(to));
+   gmtl::Quatf rot;
+   gmtl::slerp(rot, alpha, from_rot, to_rot);
+
+   const gmtl::Vec3f from_trans(gmtl::makeTrans<gmtl::Vec3f>(from));
+   const gmtl::Vec3f to_trans(gmtl::makeTrans<gmtl::Vec3f>(to));
+
+   gmtl::Matrix44f result;
+   gmtl::setRot(result, rot);
+   gmtl::setTrans(result, from_trans + (to_trans - from_trans) * alpha);
+   return result;
+}
+
+}
+
+}
@@ -0,0 +1,144 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_NAV_INTEGRATOR_H_
+#define _VRKIT_NAV_INTEGRATOR_H_
+
+#include <vrkit/Config.h>
+
+#include <boost/function.hpp>
+
+#include <vpr/Util/Interval.h>
+#include <gmtl/Matrix.h>
+
+
+namespace vrkit
+{
+
+class ViewPlatform;
+
+namespace nav
+{
+
+/** \class Integrator Integrator.h vrkit/nav/Integrator.h
+ *
+ * Advances navigation in fixed time steps so that the motion of the view
+ * platform does not depend on the frame rate. Each frame, the time elapsed
+ * since the previous frame is added to an accumulator, and the navigation
+ * step function is invoked once for every whole step in the accumulator.
+ * The view platform is then set to a transformation interpolated between
+ * the last two steps using the time left in the accumulator. The elapsed
+ * time is clamped so that a long frame (while loading a model, for
+ * example) does not cause a jump.
+ *
+ * The integrator keeps its own copy of the view platform transformation.
+ * If something else moves the view platform between frames, the integrator
+ * starts over from the new transformation.
+ *
+ * @since 0.51.16
+ */
+class VRKIT_CLASS_API Integrator
+{
+public:
+   /**
+    * The signature of a navigation step.
+    *
+    * @param curPos The view platform transformation (vw_M_vp) to advance.
+    * @param dt     The length of the step in seconds.
+    */
+   typedef boost::function<void (gmtl::Matrix44f& curPos, const float dt)>
+      step_func_t;
+
+   Integrator();
+
+   /**
+    * Sets the length of each step. The default is 1/120 second.
+    */
+   void setStepSize(const vpr::Interval& stepSize);
+
+   const vpr::Interval& getStepSize() const
+   {
+      return mStepSize;
+   }
+
+   /**
+    * Sets the longest frame time that is integrated. Time beyond this is
+    * discarded. The default is 1/4 second.
+    */
+   void setMaxFrameTime(const vpr::Interval& maxFrameTime);
+
+   const vpr::Interval& getMaxFrameTime() const
+   {
+      return mMaxFrameTime;
+   }
+
+   /**
+    * Discards the accumulated time and the copy of the view platform
+    * transformation. The next call to update() starts from the current
+    * transformation of the view platform and does not take any steps.
+    */
+   void reset();
+
+   /**
+    * Advances navigation to the given time.
+    *
+    * @param time         The time of the current frame. This should come
+    *                     from the same clock on each call.
+    * @param viewPlatform The view platform to move.
+    * @param step         The function that advances the view platform
+    *                     transformation by one step.
+    *
+    * @return The number of steps taken.
+    */
+   unsigned int update(const vpr::Interval& time, ViewPlatform& viewPlatform,
+                       const step_func_t& step);
+
+   /**
+    * Returns the fraction of a step left in the accumulator after the last
+    * call to update().
+    */
+   float getAlpha() const;
+
+   /**
+    * Interpolates between two rigid transformations. The rotation is
+    * interpolated spherically, and the translation is interpolated
+    * linearly.
+    */
+   static gmtl::Matrix44f interpolate(const gmtl::Matrix44f& from,
+                                      const gmtl::Matrix44f& to,
+                                      const float alpha);
+
+private:
+   vpr::Interval mStepSize;
+   vpr::Interval mMaxFrameTime;
+
+   bool          mStarted;
+   vpr::Interval mLastTime;
+   vpr::Interval mAccumulator;
+
+   gmtl::Matrix44f mPrevPos;    /**< Result of the step before last */
+   gmtl::Matrix44f mCurPos;     /**< Result of the last step */
+   gmtl::Matrix44f mOutputPos;  /**< Last value given to the view platform */
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_NAV_INTEGRATOR_H_ */
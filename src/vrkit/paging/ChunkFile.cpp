@@ -0,0 +1,918 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#if defined(WIN32) || defined(WIN64)
+#  include <process.h>
+#else
+#  include <sys/types.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGGroup.h>
+#include <OpenSG/OSGMaterialGroup.h>
+#include <OpenSG/OSGDistanceLOD.h>
+#include <OpenSG/OSGTriangleIterator.h>
+#include <OpenSG/OSGSceneFileHandler.h>
+#if OSG_MAJOR_VERSION >= 2
+#  include <OpenSG/OSGGeoProperties.h>
+#endif
+
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Sync/Guard.h>
+
+#include <vrkit/Exception.h>
+#include <vrkit/util/MemoryUsage.h>
+#include <vrkit/util/SceneFileLock.h>
+#include <vrkit/paging/ChunkFile.h>
+
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+
+const char sMagic[8] = { 'V', 'R', 'K', 'P', 'A', 'G', 'E', 'S' };
+const vpr::Uint32 sFormatVersion(1);
+const vpr::Uint32 sByteOrderMark(0x01020304);
+
+/** Magic, format version, byte order mark, and number of chunks. */
+const std::size_t sHeaderSize(sizeof(sMagic) + 3 * sizeof(vpr::Uint32));
+
+/** Bounds, triangle count, memory usage, offset, and size. */
+const std::size_t sEntrySize(6 * sizeof(float) + sizeof(vpr::Uint32) +
+                             3 * sizeof(vpr::Uint64));
+
+vpr::Mutex   sTempNameLock;
+unsigned int sTempNameCount(0);
+
+template<typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+   stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Reads a value from \p data and advances \p data past it. The index is not
+ * necessarily aligned, so the value is copied out.
+ */
+template<typename T>
+T readValue(const char*& data)
+{
+   T value;
+   std::memcpy(&value, data, sizeof(T));
+   data += sizeof(T);
+   return value;
+}
+
+/**
+ * A read-only stream buffer over a block of memory. This is used to parse
+ * chunks directly out of the mapped file.
+ */
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+   MemoryStreamBuf(const char* data, const std::size_t size)
+   {
+      char* begin(const_cast<char*>(data));
+      setg(begin, begin, begin + size);
+   }
+
+protected:
+   virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                            std::ios_base::openmode which)
+   {
+      char* pos(gptr() + off);
+
+      if ( std::ios_base::beg == dir )
+      {
+         pos = eback() + off;
+      }
+      else if ( std::ios_base::end == dir )
+      {
+         pos = egptr() + off;
+      }
+
+      if ( ! (which & std::ios_base::in) || pos < eback() || pos > egptr() )
+      {
+         return pos_type(off_type(-1));
+      }
+
+      setg(eback(), pos, egptr());
+      return pos_type(off_type(pos - eback()));
+   }
+
+   virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+   {
+      return seekoff(off_type(pos), std::ios_base::beg, which);
+   }
+};
+
+void extendBounds(gmtl::AABoxf& bounds, const OSG::Pnt3f& point)
+{
+   gmtl::Point3f min(point[0], point[1], point[2]);
+   gmtl::Point3f max(min);
+
+   if ( ! bounds.isEmpty() )
+   {
+      for ( unsigned int i = 0; i < 3; ++i )
+      {
+         min[i] = std::min(min[i], bounds.getMin()[i]);
+         max[i] = std::max(max[i], bounds.getMax()[i]);
+      }
+   }
+
+   bounds.setMin(min);
+   bounds.setMax(max);
+   bounds.setEmpty(false);
+}
+
+/** A geometry core of the source graph and the state that applies to it. */
+struct SourceGeometry
+{
+   OSG::GeometryPtr geom;
+   OSG::Matrix      xform;
+   OSG::Matrix      normalXform;       /**< Inverse transpose of xform */
+   OSG::MaterialPtr material;
+   vpr::Uint32      numTriangles;
+};
+
+/**
+ * Collects the geometry below \p node along with the accumulated
+ * transformation and the material that applies to each. Only the highest
+ * level of detail of a distance LOD node is visited.
+ */
+void collectGeometry(OSG::NodePtr node, OSG::Matrix xform,
+                     OSG::MaterialPtr material,
+                     std::vector<SourceGeometry>& geoms)
+{
+   if ( OSG::NullFC == node )
+   {
+      return;
+   }
+
+   OSG::UInt32 num_children(node->getNChildren());
+   OSG::NodeCorePtr core = node->getCore();
+
+   if ( OSG::NullFC != core )
+   {
+      core->accumulateMatrix(xform);
+
+#if OSG_MAJOR_VERSION < 2
+      OSG::GeometryPtr geom = OSG::GeometryPtr::dcast(core);
+      OSG::MaterialGroupPtr mat_group = OSG::MaterialGroupPtr::dcast(core);
+      OSG::DistanceLODPtr lod = OSG::DistanceLODPtr::dcast(core);
+#else
+      OSG::GeometryPtr geom = OSG::cast_dynamic<OSG::GeometryPtr>(core);
+      OSG::MaterialGroupPtr mat_group =
+         OSG::cast_dynamic<OSG::MaterialGroupPtr>(core);
+      OSG::DistanceLODPtr lod = OSG::cast_dynamic<OSG::DistanceLODPtr>(core);
+#endif
+
+      if ( OSG::NullFC != mat_group &&
+           OSG::NullFC != mat_group->getMaterial() )
+      {
+         material = mat_group->getMaterial();
+      }
+
+      if ( OSG::NullFC != geom && OSG::NullFC != geom->getPositions() )
+      {
+         SourceGeometry source;
+         source.geom         = geom;
+         source.xform        = xform;
+         source.normalXform  = xform;
+         source.normalXform.invert();
+         source.normalXform.transpose();
+         source.material     = OSG::NullFC != geom->getMaterial() ?
+                                  geom->getMaterial() : material;
+         source.numTriangles = 0;
+         geoms.push_back(source);
+      }
+
+      if ( OSG::NullFC != lod && num_children > 1 )
+      {
+         num_children = 1;
+      }
+   }
+
+   for ( OSG::UInt32 c = 0; c < num_children; ++c )
+   {
+      collectGeometry(node->getChild(c), xform, material, geoms);
+   }
+}
+
+/** A triangle of the source graph, sorted by its center when splitting. */
+struct TriangleRef
+{
+   float       center[3];
+   vpr::Uint32 geom;                   /**< Index of the SourceGeometry */
+   vpr::Uint32 triangle;               /**< Index within the geometry */
+};
+
+class CenterLess
+{
+public:
+   CenterLess(const unsigned int axis)
+      : mAxis(axis)
+   {
+      /* Do nothing. */ ;
+   }
+
+   bool operator()(const TriangleRef& lhs, const TriangleRef& rhs) const
+   {
+      return lhs.center[mAxis] < rhs.center[mAxis];
+   }
+
+private:
+   unsigned int mAxis;
+};
+
+/**
+ * Recursively halves the given range of triangles along the longest axis
+ * of the bounds of their centers until no range has more than
+ * \p maxTriangles triangles. The ends of the resulting ranges are appended
+ * to \p ends in order.
+ */
+void splitTriangles(std::vector<TriangleRef>& triangles,
+                    const std::size_t begin, const std::size_t end,
+                    const std::size_t maxTriangles,
+                    std::vector<std::size_t>& ends)
+{
+   if ( end - begin <= maxTriangles )
+   {
+      ends.push_back(end);
+      return;
+   }
+
+   float min[3], max[3];
+   for ( unsigned int a = 0; a < 3; ++a )
+   {
+      min[a] = max[a] = triangles[begin].center[a];
+   }
+
+   for ( std::size_t i = begin + 1; i < end; ++i )
+   {
+      for ( unsigned int a = 0; a < 3; ++a )
+      {
+         min[a] = std::min(min[a], triangles[i].center[a]);
+         max[a] = std::max(max[a], triangles[i].center[a]);
+      }
+   }
+
+   unsigned int axis(0);
+   for ( unsigned int a = 1; a < 3; ++a )
+   {
+      if ( max[a] - min[a] > max[axis] - min[axis] )
+      {
+         axis = a;
+      }
+   }
+
+   const std::size_t middle(begin + (end - begin) / 2);
+   std::nth_element(triangles.begin() + begin, triangles.begin() + middle,
+                    triangles.begin() + end, CenterLess(axis));
+
+   splitTriangles(triangles, begin, middle, maxTriangles, ends);
+   splitTriangles(triangles, middle, end, maxTriangles, ends);
+}
+
+template<typename Field, typename T>
+void fillField(Field* field, const std::vector<T>& values)
+{
+   field->reserve(values.size());
+
+   typedef typename std::vector<T>::const_iterator iter_type;
+   for ( iter_type v = values.begin(); v != values.end(); ++v )
+   {
+      field->push_back(*v);
+   }
+}
+
+/**
+ * Collects the triangles of one source geometry core that fall into one
+ * chunk and makes a compact, transformed, single-indexed copy of them.
+ */
+class GeometryBuilder
+{
+public:
+   GeometryBuilder()
+      : mSource(NULL)
+      , mHasNormals(false)
+      , mHasColors(false)
+      , mHasTexCoords(false)
+   {
+      /* Do nothing. */ ;
+   }
+
+   void init(const SourceGeometry* source)
+   {
+      mSource = source;
+
+      OSG::GeometryPtr geom(source->geom);
+#if OSG_MAJOR_VERSION < 2
+      mHasNormals   = OSG::NullFC != geom->getNormals() &&
+                         geom->getNormals()->getSize() > 0;
+      mHasColors    = OSG::NullFC != geom->getColors() &&
+                         geom->getColors()->getSize() > 0;
+      mHasTexCoords = OSG::NullFC != geom->getTexCoords() &&
+                         geom->getTexCoords()->getSize() > 0;
+#else
+      mHasNormals   = OSG::NullFC != geom->getNormals() &&
+                         geom->getNormals()->size() > 0;
+      mHasColors    = OSG::NullFC != geom->getColors() &&
+                         geom->getColors()->size() > 0;
+      mHasTexCoords = OSG::NullFC != geom->getTexCoords() &&
+                         geom->getTexCoords()->size() > 0;
+#endif
+   }
+
+   bool isInitialized() const
+   {
+      return NULL != mSource;
+   }
+
+   void addTriangle(const OSG::TriangleIterator& t)
+   {
+      for ( OSG::Int32 v = 0; v < 3; ++v )
+      {
+         mIndices.push_back(addVertex(t, v));
+      }
+   }
+
+   vpr::Uint32 getNumTriangles() const
+   {
+      return mIndices.size() / 3;
+   }
+
+   const gmtl::AABoxf& getBounds() const
+   {
+      return mBounds;
+   }
+
+   OSG::NodePtr makeNode() const;
+
+private:
+   struct VertexKey
+   {
+      bool operator<(const VertexKey& rhs) const
+      {
+         return std::lexicographical_compare(index, index + 4, rhs.index,
+                                             rhs.index + 4);
+      }
+
+      OSG::Int32 index[4];
+   };
+
+   vpr::Uint32 addVertex(const OSG::TriangleIterator& t, const OSG::Int32 v)
+   {
+      VertexKey key;
+      key.index[0] = t.getPositionIndex(v);
+      key.index[1] = mHasNormals ? t.getNormalIndex(v) : -1;
+      key.index[2] = mHasColors ? t.getColorIndex(v) : -1;
+      key.index[3] = mHasTexCoords ? t.getTexCoordsIndex(v) : -1;
+
+      std::map<VertexKey, vpr::Uint32>::iterator i = mVertices.find(key);
+      if ( i != mVertices.end() )
+      {
+         return i->second;
+      }
+
+      const vpr::Uint32 index(mPositions.size());
+      mVertices.insert(std::make_pair(key, index));
+
+      OSG::Pnt3f pos(t.getPosition(v));
+#if OSG_MAJOR_VERSION < 2
+      mSource->xform.multFullMatrixPnt(pos);
+#else
+      mSource->xform.multFull(pos, pos);
+#endif
+      mPositions.push_back(pos);
+      extendBounds(mBounds, pos);
+
+      if ( mHasNormals )
+      {
+         OSG::Vec3f normal(t.getNormal(v));
+#if OSG_MAJOR_VERSION < 2
+         mSource->normalXform.multMatrixVec(normal);
+#else
+         mSource->normalXform.mult(normal, normal);
+#endif
+         normal.normalize();
+         mNormals.push_back(normal);
+      }
+
+      if ( mHasColors )
+      {
+         mColors.push_back(t.getColor(v));
+      }
+
+      if ( mHasTexCoords )
+      {
+         mTexCoords.push_back(t.getTexCoords(v));
+      }
+
+      return index;
+   }
+
+   const SourceGeometry* mSource;
+   bool                  mHasNormals;
+   bool                  mHasColors;
+   bool                  mHasTexCoords;
+
+   std::map<VertexKey, vpr::Uint32> mVertices;
+   std::vector<OSG::Pnt3f>          mPositions;
+   std::vector<OSG::Vec3f>          mNormals;
+   std::vector<OSG::Color3f>        mColors;
+   std::vector<OSG::Vec2f>          mTexCoords;
+   std::vector<vpr::Uint32>         mIndices;
+   gmtl::AABoxf                     mBounds;
+};
+
+OSG::NodePtr GeometryBuilder::makeNode() const
+{
+   OSG::GeoPTypesUI8Ptr types         = OSG::GeoPTypesUI8::create();
+   OSG::GeoPLengthsUI32Ptr lens       = OSG::GeoPLengthsUI32::create();
+   OSG::GeoIndicesUI32Ptr indices     = OSG::GeoIndicesUI32::create();
+   OSG::GeoPositions3fPtr positions   = OSG::GeoPositions3f::create();
+   OSG::GeoNormals3fPtr normals       = OSG::NullFC;
+   OSG::GeoColors3fPtr colors         = OSG::NullFC;
+   OSG::GeoTexCoords2fPtr tex_coords  = OSG::NullFC;
+
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor te(types);
+      OSG::CPEditor le(lens);
+      OSG::CPEditor ie(indices);
+      OSG::CPEditor pe(positions);
+
+      types->getFieldPtr()->push_back(GL_TRIANGLES);
+      lens->getFieldPtr()->push_back(mIndices.size());
+      fillField(indices->getFieldPtr(), mIndices);
+      fillField(positions->getFieldPtr(), mPositions);
+#else
+      types->editFieldPtr()->push_back(GL_TRIANGLES);
+      lens->editFieldPtr()->push_back(mIndices.size());
+      fillField(indices->editFieldPtr(), mIndices);
+      fillField(positions->editFieldPtr(), mPositions);
+#endif
+   }
+
+   if ( mHasNormals )
+   {
+      normals = OSG::GeoNormals3f::create();
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor ne(normals);
+      fillField(normals->getFieldPtr(), mNormals);
+#else
+      fillField(normals->editFieldPtr(), mNormals);
+#endif
+   }
+
+   if ( mHasColors )
+   {
+      colors = OSG::GeoColors3f::create();
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor ce(colors);
+      fillField(colors->getFieldPtr(), mColors);
+#else
+      fillField(colors->editFieldPtr(), mColors);
+#endif
+   }
+
+   if ( mHasTexCoords )
+   {
+      tex_coords = OSG::GeoTexCoords2f::create();
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor tce(tex_coords);
+      fillField(tex_coords->getFieldPtr(), mTexCoords);
+#else
+      fillField(tex_coords->editFieldPtr(), mTexCoords);
+#endif
+   }
+
+   OSG::GeometryPtr geom = OSG::Geometry::create();
+
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor ge(geom);
+#endif
+      geom->setTypes(types);
+      geom->setLengths(lens);
+      geom->setIndices(indices);
+      geom->setPositions(positions);
+      geom->setNormals(normals);
+      geom->setColors(colors);
+      geom->setTexCoords(tex_coords);
+      geom->setMaterial(mSource->material);
+   }
+
+   OSG::NodePtr node = OSG::Node::create();
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor ne(node, OSG::Node::CoreFieldMask);
+#endif
+   node->setCore(geom);
+
+   return node;
+}
+
+void writeEntry(std::ostream& stream,
+                const vrkit::paging::ChunkFile::ChunkInfo& info)
+{
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      writeValue(stream, info.bounds.getMin()[i]);
+   }
+
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      writeValue(stream, info.bounds.getMax()[i]);
+   }
+
+   writeValue(stream, info.numTriangles);
+   writeValue(stream, info.memoryUsage);
+   writeValue(stream, info.offset);
+   writeValue(stream, info.size);
+}
+
+vrkit::paging::ChunkFile::ChunkInfo readEntry(const char* data)
+{
+   vrkit::paging::ChunkFile::ChunkInfo info;
+
+   gmtl::Point3f min, max;
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      min[i] = readValue<float>(data);
+   }
+
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      max[i] = readValue<float>(data);
+   }
+
+   info.bounds.setMin(min);
+   info.bounds.setMax(max);
+   info.bounds.setEmpty(false);
+
+   info.numTriangles = readValue<vpr::Uint32>(data);
+   info.memoryUsage  = readValue<vpr::Uint64>(data);
+   info.offset       = readValue<vpr::Uint64>(data);
+   info.size         = readValue<vpr::Uint64>(data);
+
+   return info;
+}
+
+/**
+ * Writes the given chunks to the given stream in the chunk file format.
+ * The roots of the chunks are released as they are written.
+ */
+void writeChunks(std::ostream& stream, std::vector<OSG::NodeRefPtr>& chunks,
+                 std::vector<vrkit::paging::ChunkFile::ChunkInfo>& infos)
+{
+   const vpr::Uint32 num_chunks(chunks.size());
+
+   stream.write(sMagic, sizeof(sMagic));
+   writeValue(stream, sFormatVersion);
+   writeValue(stream, sByteOrderMark);
+   writeValue(stream, num_chunks);
+
+   // The index is written once the offsets of the chunks are known.
+   const std::streampos index_pos(stream.tellp());
+   const std::vector<char> empty_index(num_chunks * sEntrySize, 0);
+   if ( ! empty_index.empty() )
+   {
+      stream.write(&empty_index[0], empty_index.size());
+   }
+
+   for ( vpr::Uint32 c = 0; c < num_chunks && stream; ++c )
+   {
+      infos[c].offset = static_cast<vpr::Uint64>(stream.tellp());
+      infos[c].memoryUsage = vrkit::util::estimateMemoryUsage(chunks[c]);
+
+      // The lock is taken per chunk so that paging threads are not held
+      // up for the whole build.
+      {
+         vpr::Guard<vpr::Mutex> guard(vrkit::util::getSceneFileLock());
+#if OSG_MAJOR_VERSION < 2
+         OSG::SceneFileHandler::the().write(chunks[c], stream, "osb");
+#else
+         OSG::SceneFileHandler::the()->write(chunks[c], stream, "osb");
+#endif
+      }
+
+      infos[c].size =
+         static_cast<vpr::Uint64>(stream.tellp()) - infos[c].offset;
+      chunks[c] = OSG::NullFC;
+   }
+
+   stream.seekp(index_pos);
+   for ( vpr::Uint32 c = 0; c < num_chunks; ++c )
+   {
+      writeEntry(stream, infos[c]);
+   }
+}
+
+}
+
+namespace vrkit
+{
+
+namespace paging
+{
+
+ChunkFile::ChunkFile(const fs::path& file)
+   : mFile(file)
+{
+   const char* data(mFile.getData());
+   const std::size_t size(mFile.getSize());
+
+   std::ostringstream error_stream;
+
+   if ( size < sHeaderSize ||
+        std::memcmp(data, sMagic, sizeof(sMagic)) != 0 )
+   {
+      error_stream << "not a vrkit chunk file";
+   }
+   else
+   {
+      data += sizeof(sMagic);
+      const vpr::Uint32 version(readValue<vpr::Uint32>(data));
+      const vpr::Uint32 byte_order(readValue<vpr::Uint32>(data));
+      const vpr::Uint32 num_chunks(readValue<vpr::Uint32>(data));
+
+      if ( version != sFormatVersion )
+      {
+         error_stream << "unsupported format version " << version;
+      }
+      else if ( byte_order != sByteOrderMark )
+      {
+         error_stream << "written with a different byte order";
+      }
+      else if ( size < sHeaderSize + std::size_t(num_chunks) * sEntrySize )
+      {
+         error_stream << "truncated index";
+      }
+      else
+      {
+         mChunks.reserve(num_chunks);
+         for ( vpr::Uint32 c = 0; c < num_chunks; ++c, data += sEntrySize )
+         {
+            mChunks.push_back(readEntry(data));
+
+            if ( mChunks.back().offset + mChunks.back().size > size )
+            {
+               error_stream << "chunk " << c << " is truncated";
+               break;
+            }
+         }
+      }
+   }
+
+   if ( ! error_stream.str().empty() )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to open chunk file " << file.native_file_string()
+                 << ": " << error_stream.str();
+      throw Exception(msg_stream.str(), VRKIT_LOCATION);
+   }
+}
+
+ChunkFilePtr ChunkFile::open(const fs::path& file)
+{
+   return ChunkFilePtr(new ChunkFile(file));
+}
+
+unsigned int ChunkFile::build(OSG::NodePtr root, const fs::path& file,
+                              const unsigned int maxTriangles)
+{
+   OSG::Matrix identity;
+   identity.setIdentity();
+
+   std::vector<SourceGeometry> geoms;
+   collectGeometry(root, identity, OSG::NullFC, geoms);
+
+   // Find the center of every triangle in the coordinate frame of the root.
+   std::vector<TriangleRef> triangles;
+   for ( vpr::Uint32 g = 0; g < geoms.size(); ++g )
+   {
+      OSG::GeometryPtr geom(geoms[g].geom);
+
+      for ( OSG::TriangleIterator t = geom->beginTriangles();
+            t != geom->endTriangles();
+            ++t )
+      {
+         TriangleRef ref;
+         ref.center[0] = ref.center[1] = ref.center[2] = 0.0f;
+         ref.geom     = g;
+         ref.triangle = geoms[g].numTriangles++;
+
+         for ( OSG::Int32 v = 0; v < 3; ++v )
+         {
+            OSG::Pnt3f pos(t.getPosition(v));
+#if OSG_MAJOR_VERSION < 2
+            geoms[g].xform.multFullMatrixPnt(pos);
+#else
+            geoms[g].xform.multFull(pos, pos);
+#endif
+            for ( unsigned int a = 0; a < 3; ++a )
+            {
+               ref.center[a] += pos[a] / 3.0f;
+            }
+         }
+
+         triangles.push_back(ref);
+      }
+   }
+
+   std::vector<std::size_t> chunk_ends;
+   if ( ! triangles.empty() )
+   {
+      splitTriangles(triangles, 0, triangles.size(),
+                     std::max(1u, maxTriangles), chunk_ends);
+   }
+
+   const vpr::Uint32 num_chunks(chunk_ends.size());
+
+   // Record the chunk of every triangle so that the geometry can be split
+   // in a single pass over the triangles of each core.
+   std::vector< std::vector<vpr::Uint32> > chunk_of(geoms.size());
+   for ( vpr::Uint32 g = 0; g < geoms.size(); ++g )
+   {
+      chunk_of[g].resize(geoms[g].numTriangles);
+   }
+
+   for ( vpr::Uint32 c = 0, i = 0; c < num_chunks; ++c )
+   {
+      for ( ; i < chunk_ends[c]; ++i )
+      {
+         chunk_of[triangles[i].geom][triangles[i].triangle] = c;
+      }
+   }
+
+   std::vector<TriangleRef>().swap(triangles);
+
+   std::vector<OSG::NodeRefPtr> chunks(num_chunks);
+   std::vector<ChunkInfo> infos(num_chunks);
+   for ( vpr::Uint32 c = 0; c < num_chunks; ++c )
+   {
+      OSG::NodePtr chunk = OSG::Node::create();
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor ce(chunk, OSG::Node::CoreFieldMask);
+#endif
+      chunk->setCore(OSG::Group::create());
+      chunks[c] = chunk;
+
+      infos[c].numTriangles = 0;
+   }
+
+   for ( vpr::Uint32 g = 0; g < geoms.size(); ++g )
+   {
+      std::map<vpr::Uint32, GeometryBuilder> builders;
+
+      OSG::GeometryPtr geom(geoms[g].geom);
+      vpr::Uint32 index(0);
+      for ( OSG::TriangleIterator t = geom->beginTriangles();
+            t != geom->endTriangles();
+            ++t, ++index )
+      {
+         GeometryBuilder& builder(builders[chunk_of[g][index]]);
+
+         if ( ! builder.isInitialized() )
+         {
+            builder.init(&geoms[g]);
+         }
+
+         builder.addTriangle(t);
+      }
+
+      std::vector<vpr::Uint32>().swap(chunk_of[g]);
+
+      typedef std::map<vpr::Uint32, GeometryBuilder>::iterator iter_type;
+      for ( iter_type b = builders.begin(); b != builders.end(); ++b )
+      {
+         const vpr::Uint32 c(b->first);
+
+#if OSG_MAJOR_VERSION < 2
+         OSG::CPEditor ce(chunks[c], OSG::Node::ChildrenFieldMask);
+#endif
+         chunks[c]->addChild(b->second.makeNode());
+
+         const gmtl::AABoxf& bounds(b->second.getBounds());
+         extendBounds(infos[c].bounds,
+                      OSG::Pnt3f(bounds.getMin()[0], bounds.getMin()[1],
+                                 bounds.getMin()[2]));
+         extendBounds(infos[c].bounds,
+                      OSG::Pnt3f(bounds.getMax()[0], bounds.getMax()[1],
+                                 bounds.getMax()[2]));
+         infos[c].numTriangles += b->second.getNumTriangles();
+      }
+   }
+
+   // The file is written under a temporary name and then renamed so that
+   // a partially written file is never opened.
+   std::ostringstream temp_stream;
+   temp_stream << file.leaf() << ".";
+#if defined(WIN32) || defined(WIN64)
+   temp_stream << _getpid();
+#else
+   temp_stream << getpid();
+#endif
+
+   {
+      vpr::Guard<vpr::Mutex> guard(sTempNameLock);
+      temp_stream << "." << sTempNameCount++ << ".tmp";
+   }
+
+   const fs::path temp_file(file.branch_path() / temp_stream.str());
+
+   bool written(false);
+
+   {
+      fs::ofstream stream(temp_file, std::ios::out | std::ios::binary);
+
+      if ( stream )
+      {
+         writeChunks(stream, chunks, infos);
+         stream.flush();
+         written = stream.good();
+      }
+   }
+
+   try
+   {
+      if ( written )
+      {
+         // Another process may have written the same file in the meantime.
+         // Both have the same contents.
+         if ( fs::exists(file) )
+         {
+            fs::remove(file);
+         }
+
+         fs::rename(temp_file, file);
+         return num_chunks;
+      }
+   }
+   catch (fs::filesystem_error&)
+   {
+      /* The temporary file is removed below. */ ;
+   }
+
+   try
+   {
+      fs::remove(temp_file);
+   }
+   catch (fs::filesystem_error&)
+   {
+      /* Nothing else can be done. */ ;
+   }
+
+   std::ostringstream msg_stream;
+   msg_stream << "Failed to write chunk file " << file.native_file_string();
+   throw Exception(msg_stream.str(), VRKIT_LOCATION);
+}
+
+OSG::NodeRefPtr ChunkFile::loadChunk(const unsigned int index) const
+{
+   const ChunkInfo& info(mChunks[index]);
+
+   MemoryStreamBuf buffer(mFile.getData() + info.offset,
+                          static_cast<std::size_t>(info.size));
+   std::istream stream(&buffer);
+
+   vpr::Guard<vpr::Mutex> guard(util::getSceneFileLock());
+   return OSG::NodeRefPtr(
+#if OSG_MAJOR_VERSION < 2
+      OSG::SceneFileHandler::the().read(stream, "osb")
+#else
+      OSG::SceneFileHandler::the()->read(stream, "osb")
+#endif
+   );
+}
+
+}
+
+}
@@ -0,0 +1,151 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_PAGING_CHUNK_FILE_H_
+#define _VRKIT_PAGING_CHUNK_FILE_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <gmtl/AABox.h>
+
+#include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGRefPtr.h>
+
+#include <vpr/vprTypes.h>
+
+#include <vrkit/util/MappedFile.h>
+#include <vrkit/paging/ChunkFilePtr.h>
+
+
+namespace vrkit
+{
+
+namespace paging
+{
+
+/** \class ChunkFile ChunkFile.h vrkit/paging/ChunkFile.h
+ *
+ * A model that has been split into spatially coherent chunks that can be
+ * loaded independently of each other. build() splits the geometry of a
+ * graph by recursively halving the set of triangles along the longest axis
+ * of their centers until no part has more than the given number of
+ * triangles. Each chunk is stored in the OpenSG binary format, and the file
+ * starts with an index that gives the bounds, triangle count, and estimated
+ * memory usage of every chunk.
+ *
+ * An opened chunk file is memory-mapped, so opening it reads only the index,
+ * and loadChunk() may be invoked concurrently from any threads that are
+ * known to OpenSG. Chunks are decoded while holding the lock returned by
+ * vrkit::util::getSceneFileLock(), because OSG::SceneFileHandler is not
+ * thread-safe, so concurrent calls are serialized.
+ *
+ * All the transformations of the graph, including that of the root, are
+ * applied to the chunk geometry, so the chunks are in the coordinate frame
+ * of the parent of the root of the graph that was split. Chunk
+ * geometry uses the material of the geometry it was made from, but each
+ * chunk has its own copy of the materials (and textures) that it uses.
+ *
+ * @note The index is written in the byte order of the machine that built
+ *       the file. open() rejects a file with a different byte order.
+ *
+ * @see vrkit::paging::PagedModel
+ *
+ * @since 0.51.28
+ */
+class VRKIT_CLASS_API ChunkFile : private boost::noncopyable
+{
+protected:
+   ChunkFile(const boost::filesystem::path& file);
+
+public:
+   /** The index entry of a chunk. */
+   struct ChunkInfo
+   {
+      gmtl::AABoxf bounds;
+      vpr::Uint32  numTriangles;
+      vpr::Uint64  memoryUsage;  /**< Estimated bytes when loaded */
+      vpr::Uint64  offset;       /**< Offset of the chunk in the file */
+      vpr::Uint64  size;         /**< Size of the chunk in the file */
+   };
+
+   /**
+    * Opens the given chunk file and reads its index.
+    *
+    * @throw vrkit::Exception Thrown if the file cannot be mapped or if it
+    *                         is not a valid chunk file.
+    */
+   static ChunkFilePtr open(const boost::filesystem::path& file);
+
+   /**
+    * Splits the geometry below the given node into chunks and writes them
+    * to the given file. Geometry of levels of detail other than the highest
+    * one is left out. The file is written under a temporary name that is
+    * then renamed, so it is safe for several processes to build the same
+    * file.
+    *
+    * @param root         The root of the graph to split.
+    * @param file         The chunk file to write.
+    * @param maxTriangles The maximum number of triangles in a chunk.
+    *
+    * @return The number of chunks written.
+    *
+    * @throw vrkit::Exception Thrown if the file cannot be written.
+    */
+   static unsigned int build(OSG::NodePtr root,
+                             const boost::filesystem::path& file,
+                             const unsigned int maxTriangles);
+
+   const boost::filesystem::path& getPath() const
+   {
+      return mFile.getPath();
+   }
+
+   unsigned int getNumChunks() const
+   {
+      return mChunks.size();
+   }
+
+   const ChunkInfo& getChunkInfo(const unsigned int index) const
+   {
+      return mChunks[index];
+   }
+
+   /**
+    * Loads the given chunk. The returned graph is not shared with anything,
+    * and every call loads a new copy of the chunk.
+    *
+    * @return The root of the chunk or OSG::NullFC if the chunk could not be
+    *         read.
+    */
+   OSG::NodeRefPtr loadChunk(const unsigned int index) const;
+
+private:
+   util::MappedFile       mFile;
+   std::vector<ChunkInfo> mChunks;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_PAGING_CHUNK_FILE_H_ */
@@ -0,0 +1,671 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <sstream>
+#include <boost/bind.hpp>
+
+#include <gmtl/Math.h>
+#include <gmtl/VecOps.h>
+
+#include <OpenSG/OSGGroup.h>
+#include <OpenSG/OSGThread.h>
+#include <OpenSG/OSGChangeList.h>
+#include <OpenSG/OSGSimpleAttachments.h>
+
+#include <vpr/Thread/Thread.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Sync/Guard.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/Exception.h>
+#include <vrkit/Status.h>
+#include <vrkit/paging/ChunkFile.h>
+#include <vrkit/paging/PagedModel.h>
+
+
+namespace
+{
+
+/**
+ * Chunks outside the view cone are ranked as if they were this many times
+ * farther away than they are.
+ */
+const float sOutOfViewFactor(4.0f);
+
+/** Distinguishes the names of the roots of paged models. */
+vpr::Mutex   sNameLock;
+unsigned int sNameCount(0);
+
+/**
+ * Throws away the OpenSG changes recorded by the calling thread. Paged
+ * geometry is local to each cluster node, so the changes made to add it to
+ * the scene must not be synchronized.
+ */
+void discardChanges()
+{
+#if OSG_MAJOR_VERSION < 2
+   OSG::Thread::getCurrentChangeList()->clearAll();
+#else
+   OSG::Thread::getCurrentChangeList()->commitChanges();
+   OSG::Thread::getCurrentChangeList()->clear();
+#endif
+}
+
+struct ChunkRank
+{
+   bool operator<(const ChunkRank& rhs) const
+   {
+      return distance < rhs.distance;
+   }
+
+   float       distance;
+   vpr::Uint32 index;
+};
+
+/**
+ * Ranks a chunk by the distance from \p eye to its bounds. The distance of
+ * a chunk whose bounding sphere is not in the view cone is scaled up.
+ */
+float rankChunk(const gmtl::AABoxf& bounds, const gmtl::Point3f& eye,
+                const gmtl::Vec3f& viewDir, const float viewAngle)
+{
+   float dist_sq(0.0f);
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      const float d = std::max(bounds.getMin()[i] - eye[i],
+                               std::max(0.0f, eye[i] - bounds.getMax()[i]));
+      dist_sq += d * d;
+   }
+
+   const float distance(gmtl::Math::sqrt(dist_sq));
+
+   if ( viewAngle >= gmtl::Math::PI )
+   {
+      return distance;
+   }
+
+   gmtl::Vec3f half_size, to_center;
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      half_size[i] = (bounds.getMax()[i] - bounds.getMin()[i]) * 0.5f;
+      to_center[i] = bounds.getMin()[i] + half_size[i] - eye[i];
+   }
+
+   const float radius(gmtl::length(half_size));
+   const float center_dist(gmtl::length(to_center));
+
+   // The viewer is inside the bounding sphere.
+   if ( center_dist <= radius )
+   {
+      return distance;
+   }
+
+   // The sphere is in the cone if the angle between the view direction and
+   // the direction to its center is no more than the half angle of the
+   // cone plus the angle subtended by the sphere.
+   const float limit(viewAngle + gmtl::Math::aSin(radius / center_dist));
+
+   if ( limit >= gmtl::Math::PI ||
+        gmtl::dot(to_center, viewDir) >= center_dist * gmtl::Math::cos(limit) )
+   {
+      return distance;
+   }
+
+   return distance * sOutOfViewFactor;
+}
+
+}
+
+namespace vrkit
+{
+
+namespace paging
+{
+
+PagedModel::Stats::Stats()
+   : numChunks(0)
+   , numResident(0)
+   , numPending(0)
+   , residentBytes(0)
+   , budget(0)
+   , numLoads(0)
+   , numEvictions(0)
+   , numFailures(0)
+   , averageLoadTime(0.0f)
+   , maxLoadTime(0.0f)
+{
+   /* Do nothing. */ ;
+}
+
+void PagedModel::Stats::add(const Stats& stats)
+{
+   if ( numLoads + stats.numLoads > 0 )
+   {
+      averageLoadTime = (averageLoadTime * numLoads +
+                         stats.averageLoadTime * stats.numLoads) /
+                           (numLoads + stats.numLoads);
+   }
+
+   maxLoadTime    = std::max(maxLoadTime, stats.maxLoadTime);
+   numChunks     += stats.numChunks;
+   numResident   += stats.numResident;
+   numPending    += stats.numPending;
+   residentBytes += stats.residentBytes;
+   budget        += stats.budget;
+   numLoads      += stats.numLoads;
+   numEvictions  += stats.numEvictions;
+   numFailures   += stats.numFailures;
+}
+
+PagedModel::PagedModel(ChunkFilePtr file, OSG::NodePtr root,
+                       const vpr::Uint64 memoryBudget)
+   : mFile(file)
+   , mRoot(root)
+   , mBudget(memoryBudget)
+   , mViewAngle(gmtl::Math::PI)
+   , mEditor(NULL)
+   , mStates(file->getNumChunks(), UNLOADED)
+   , mEditPending(false)
+   , mShutdown(false)
+   , mResidentBytes(0)
+   , mNumResident(0)
+   , mNumLoads(0)
+   , mNumEvictions(0)
+   , mNumFailures(0)
+   , mTotalLoadTime(0.0f)
+   , mMaxLoadTime(0.0f)
+{
+   const char* name = OSG::getName(root);
+   if ( NULL != name )
+   {
+      mName = name;
+   }
+
+   const OSG::UInt32 num_children(root->getNChildren());
+   for ( OSG::UInt32 c = 0; c < num_children; ++c )
+   {
+      mSlots.push_back(OSG::NodeRefPtr(root->getChild(c)));
+   }
+}
+
+void PagedModel::startThreads(const unsigned int numThreads)
+{
+   for ( unsigned int i = 0; i < std::max(1u, numThreads); ++i )
+   {
+      mLoaders.push_back(
+         new vpr::Thread(boost::bind(&PagedModel::loaderLoop, this, i))
+      );
+   }
+
+   mEditor = new vpr::Thread(boost::bind(&PagedModel::editorLoop, this));
+}
+
+PagedModelPtr PagedModel::create(ChunkFilePtr file,
+                                 const vpr::Uint64 memoryBudget,
+                                 const unsigned int numThreads)
+{
+   std::ostringstream name_stream;
+   name_stream << "vrkit paged model ";
+
+   {
+      vpr::Guard<vpr::Mutex> guard(sNameLock);
+      name_stream << sNameCount++;
+   }
+
+   OSG::NodePtr root = OSG::Node::create();
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor re(root,
+                    OSG::Node::CoreFieldMask | OSG::Node::ChildrenFieldMask);
+#endif
+   root->setCore(OSG::Group::create());
+   OSG::setName(root, name_stream.str());
+
+   const unsigned int num_chunks(file->getNumChunks());
+   for ( unsigned int c = 0; c < num_chunks; ++c )
+   {
+      OSG::NodePtr slot = OSG::Node::create();
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor se(slot, OSG::Node::CoreFieldMask);
+#endif
+      slot->setCore(OSG::Group::create());
+      root->addChild(slot);
+   }
+
+   PagedModelPtr model(new PagedModel(file, root, memoryBudget));
+   model->startThreads(numThreads);
+
+   return model;
+}
+
+PagedModelPtr PagedModel::create(ChunkFilePtr file, OSG::NodePtr root,
+                                 const unsigned int numThreads)
+{
+   if ( root->getNChildren() != file->getNumChunks() )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Paged model root has " << root->getNChildren()
+                 << " slot(s), but " << file->getPath().native_file_string()
+                 << " has " << file->getNumChunks() << " chunk(s)";
+      throw Exception(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   PagedModelPtr model(new PagedModel(file, root, 0));
+   model->startThreads(numThreads);
+
+   return model;
+}
+
+PagedModel::~PagedModel()
+{
+   mCond.acquire();
+   {
+      mShutdown = true;
+      mCond.broadcast();
+   }
+   mCond.release();
+
+   typedef std::vector<vpr::Thread*>::iterator iter_type;
+   for ( iter_type t = mLoaders.begin(); t != mLoaders.end(); ++t )
+   {
+      (*t)->join();
+      delete *t;
+   }
+
+   if ( NULL != mEditor )
+   {
+      mEditor->join();
+      delete mEditor;
+   }
+}
+
+void PagedModel::setViewAngle(const float angle)
+{
+   mViewAngle = angle;
+}
+
+bool PagedModel::update(const gmtl::Point3f& eye, const gmtl::Vec3f& viewDir)
+{
+   const unsigned int num_chunks(mFile->getNumChunks());
+
+   std::vector<ChunkRank> ranks(num_chunks);
+   for ( unsigned int c = 0; c < num_chunks; ++c )
+   {
+      ranks[c].distance = rankChunk(mFile->getChunkInfo(c).bounds, eye,
+                                    viewDir, mViewAngle);
+      ranks[c].index    = c;
+   }
+
+   std::sort(ranks.begin(), ranks.end());
+
+   mSelected.clear();
+   std::vector<bool> wanted(num_chunks, false);
+   vpr::Uint64 bytes(0);
+
+   mCond.acquire();
+   {
+      // Select the best ranked chunks that fit in the budget.
+      for ( unsigned int r = 0; r < num_chunks; ++r )
+      {
+         const vpr::Uint32 c(ranks[r].index);
+
+         if ( FAILED == mStates[c] )
+         {
+            continue;
+         }
+
+         const vpr::Uint64 usage(mFile->getChunkInfo(c).memoryUsage);
+         if ( mBudget != 0 && bytes + usage > mBudget )
+         {
+            break;
+         }
+
+         bytes += usage;
+         wanted[c] = true;
+         mSelected.push_back(c);
+      }
+
+      // Chunks that are loaded but no longer wanted are kept while they
+      // still fit in the budget so that they do not have to be loaded
+      // again if they are wanted soon.
+      for ( unsigned int r = 0; r < num_chunks; ++r )
+      {
+         const vpr::Uint32 c(ranks[r].index);
+
+         if ( ! wanted[c] &&
+              (RESIDENT == mStates[c] || READY == mStates[c]) )
+         {
+            const vpr::Uint64 usage(mFile->getChunkInfo(c).memoryUsage);
+            if ( bytes + usage <= mBudget )
+            {
+               bytes += usage;
+               mSelected.push_back(c);
+            }
+         }
+      }
+   }
+   mCond.release();
+
+   return applySelection();
+}
+
+bool PagedModel::selectChunks(const std::vector<vpr::Uint32>& chunks)
+{
+   mSelected.clear();
+   for ( std::vector<vpr::Uint32>::const_iterator c = chunks.begin();
+         c != chunks.end();
+         ++c )
+   {
+      if ( *c < mFile->getNumChunks() )
+      {
+         mSelected.push_back(*c);
+      }
+   }
+
+   return applySelection();
+}
+
+PagedModel::Stats PagedModel::getStats() const
+{
+   Stats stats;
+   stats.numChunks = mFile->getNumChunks();
+   stats.budget    = mBudget;
+
+   mCond.acquire();
+   {
+      stats.numResident     = mNumResident;
+      stats.numPending      = mLoadQueue.size();
+      stats.residentBytes   = mResidentBytes;
+      stats.numLoads        = mNumLoads;
+      stats.numEvictions    = mNumEvictions;
+      stats.numFailures     = mNumFailures;
+      stats.averageLoadTime = mNumLoads > 0 ? mTotalLoadTime / mNumLoads
+                                            : 0.0f;
+      stats.maxLoadTime     = mMaxLoadTime;
+
+      for ( unsigned int c = 0; c < mStates.size(); ++c )
+      {
+         if ( LOADING == mStates[c] || READY == mStates[c] )
+         {
+            ++stats.numPending;
+         }
+      }
+   }
+   mCond.release();
+
+   return stats;
+}
+
+bool PagedModel::applySelection()
+{
+   const unsigned int num_chunks(mFile->getNumChunks());
+
+   std::vector<bool> selected(num_chunks, false);
+   typedef std::vector<vpr::Uint32>::const_iterator iter_type;
+   for ( iter_type c = mSelected.begin(); c != mSelected.end(); ++c )
+   {
+      selected[*c] = true;
+   }
+
+   bool changed(false);
+
+   mCond.acquire();
+   {
+      // The queue is rebuilt in the order of the selection. Queued chunks
+      // that are no longer selected are dropped.
+      for ( std::deque<vpr::Uint32>::iterator c = mLoadQueue.begin();
+            c != mLoadQueue.end();
+            ++c )
+      {
+         mStates[*c] = UNLOADED;
+      }
+
+      mLoadQueue.clear();
+
+      for ( iter_type c = mSelected.begin(); c != mSelected.end(); ++c )
+      {
+         if ( UNLOADED == mStates[*c] )
+         {
+            mStates[*c] = QUEUED;
+            mLoadQueue.push_back(*c);
+         }
+      }
+
+      if ( ! mLoadQueue.empty() )
+      {
+         mCond.broadcast();
+      }
+
+      // Decide what the editor thread has to do. Loaded chunks that are
+      // selected are added to the scene, and the others are dropped.
+      bool edit(false);
+      for ( vpr::Uint32 c = 0; c < num_chunks; ++c )
+      {
+         const vpr::Uint64 usage(mFile->getChunkInfo(c).memoryUsage);
+
+         if ( RESIDENT == mStates[c] && ! selected[c] )
+         {
+            mStates[c] = UNLOADED;
+            mDetachList.push_back(c);
+            mResidentBytes -= usage;
+            --mNumResident;
+            ++mNumEvictions;
+            edit    = true;
+            changed = true;
+         }
+         else if ( READY == mStates[c] )
+         {
+            if ( selected[c] )
+            {
+               mStates[c] = RESIDENT;
+               mResidentBytes += usage;
+               ++mNumResident;
+               changed = true;
+            }
+            else
+            {
+               mStates[c] = UNLOADED;
+            }
+
+            edit = true;
+         }
+      }
+
+      if ( edit && ! mShutdown )
+      {
+         mEditPending = true;
+         mCond.broadcast();
+
+         while ( mEditPending )
+         {
+            mCond.wait();
+         }
+      }
+   }
+   mCond.release();
+
+   return changed;
+}
+
+void PagedModel::loaderLoop(const unsigned int index)
+{
+   std::ostringstream role_stream;
+   role_stream << "loader " << index;
+   initThread(role_stream.str());
+
+   mCond.acquire();
+   {
+      while ( true )
+      {
+         while ( ! mShutdown && mLoadQueue.empty() )
+         {
+            mCond.wait();
+         }
+
+         if ( mShutdown )
+         {
+            break;
+         }
+
+         const vpr::Uint32 c(mLoadQueue.front());
+         mLoadQueue.pop_front();
+         mStates[c] = LOADING;
+
+         OSG::NodeRefPtr chunk;
+         vpr::Interval elapsed;
+
+         mCond.release();
+         {
+            const vpr::Interval start(vpr::Interval::now());
+
+            try
+            {
+               chunk = mFile->loadChunk(c);
+            }
+            catch (std::exception&)
+            {
+               chunk = OSG::NullFC;
+            }
+
+            elapsed = vpr::Interval::now() - start;
+         }
+         mCond.acquire();
+
+         if ( OSG::NullFC == chunk )
+         {
+            mStates[c] = FAILED;
+            ++mNumFailures;
+
+            VRKIT_STATUS << "WARNING: Failed to load chunk " << c << " of "
+                         << mFile->getPath().native_file_string()
+                         << std::endl;
+         }
+         else
+         {
+            LoadedChunk loaded;
+            loaded.index = c;
+            loaded.root  = chunk;
+            mLoaded.push_back(loaded);
+            mStates[c] = READY;
+
+            ++mNumLoads;
+            mTotalLoadTime += elapsed.msecf();
+            mMaxLoadTime = std::max(mMaxLoadTime, elapsed.msecf());
+         }
+
+         chunk = OSG::NullFC;
+         discardChanges();
+      }
+   }
+   mCond.release();
+}
+
+void PagedModel::editorLoop()
+{
+   initThread("editor");
+
+   mCond.acquire();
+   {
+      while ( true )
+      {
+         while ( ! mShutdown && ! mEditPending )
+         {
+            mCond.wait();
+         }
+
+         if ( mShutdown )
+         {
+            break;
+         }
+
+         typedef std::vector<vpr::Uint32>::iterator detach_iter_type;
+         for ( detach_iter_type c = mDetachList.begin();
+               c != mDetachList.end();
+               ++c )
+         {
+            OSG::NodePtr slot(mSlots[*c]);
+#if OSG_MAJOR_VERSION < 2
+            OSG::CPEditor se(slot, OSG::Node::ChildrenFieldMask);
+#endif
+            while ( slot->getNChildren() > 0 )
+            {
+               slot->subChild(slot->getNChildren() - 1);
+            }
+         }
+
+         mDetachList.clear();
+
+         // Chunks that finished loading after the application thread
+         // decided what to do are kept for the next edit.
+         std::deque<LoadedChunk> later;
+         typedef std::deque<LoadedChunk>::iterator loaded_iter_type;
+         for ( loaded_iter_type l = mLoaded.begin(); l != mLoaded.end(); ++l )
+         {
+            if ( RESIDENT == mStates[l->index] )
+            {
+               OSG::NodePtr slot(mSlots[l->index]);
+#if OSG_MAJOR_VERSION < 2
+               OSG::CPEditor se(slot, OSG::Node::ChildrenFieldMask);
+#endif
+               slot->addChild(l->root);
+            }
+            else if ( READY == mStates[l->index] )
+            {
+               later.push_back(*l);
+            }
+         }
+
+         // This releases the chunks that were dropped.
+         mLoaded.swap(later);
+         later.clear();
+
+         discardChanges();
+
+         mEditPending = false;
+         mCond.broadcast();
+      }
+
+      // Release the chunks that were never added to the scene in this
+      // thread.
+      mLoaded.clear();
+      discardChanges();
+   }
+   mCond.release();
+}
+
+void PagedModel::initThread(const std::string& role) const
+{
+   const std::string name(mName + " " + role);
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::ExternalThread* thread = OSG::ExternalThread::get(name.c_str());
+#else
+   OSG::ExternalThreadRefPtr thread =
+      OSG::ExternalThread::get(name.c_str(), true);
+#endif
+
+   if ( ! thread->isInitialized() )
+   {
+      thread->initialize(0);
+   }
+}
+
+}
+
+}
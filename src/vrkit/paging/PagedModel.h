@@ -0,0 +1,278 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_PAGING_PAGED_MODEL_H_
+#define _VRKIT_PAGING_PAGED_MODEL_H_
+
+#include <vrkit/Config.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <boost/noncopyable.hpp>
+
+#include <gmtl/Point.h>
+#include <gmtl/Vec.h>
+
+#include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGRefPtr.h>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Sync/CondVar.h>
+
+#include <vrkit/paging/ChunkFilePtr.h>
+#include <vrkit/paging/PagedModelPtr.h>
+
+
+namespace vpr
+{
+   class Thread;
+}
+
+namespace vrkit
+{
+
+namespace paging
+{
+
+/** \class PagedModel PagedModel.h vrkit/paging/PagedModel.h
+ *
+ * A model whose geometry is paged in from a chunk file as it is needed.
+ * The root of a paged model is a group node with one empty group node (a
+ * slot) per chunk. The chunks are loaded by background threads and added
+ * to their slots, and they are removed again when they are no longer
+ * needed or when the memory budget is exceeded.
+ *
+ * update() ranks the chunks by their distance from the viewer, with chunks
+ * outside the view cone ranked as if they were farther away, and it
+ * selects the best ranked chunks whose estimated memory usage fits in the
+ * budget. Chunks that are no longer selected are removed lowest ranked
+ * first, and only when they do not fit in the budget any more.
+ *
+ * Adding chunks to and removing them from their slots is done by a
+ * separate thread while the thread invoking update() waits, and the OpenSG
+ * changes made for this are discarded rather than synchronized with
+ * cluster slaves. On a cluster, the root and slots are shared with the
+ * slaves, but each slave loads the chunks from its own copy of the chunk
+ * file. The master sends the list returned by getSelectedChunks() to the
+ * slaves each frame, and each slave passes it to selectChunks() on its own
+ * paged model for the same root.
+ *
+ * @note Paged geometry exists only on the node that loaded it, so it must
+ *       not be modified by the application thread. In particular, paged
+ *       models cannot be grabbed.
+ *
+ * @see vrkit::paging::ChunkFile
+ * @see vrkit::PagingData
+ *
+ * @since 0.51.28
+ */
+class VRKIT_CLASS_API PagedModel : private boost::noncopyable
+{
+public:
+   /** Paging statistics. Times are in milliseconds. */
+   struct VRKIT_CLASS_API Stats
+   {
+      Stats();
+
+      /**
+       * Adds the counts of the given statistics to these and combines the
+       * load times.
+       */
+      void add(const Stats& stats);
+
+      unsigned int numChunks;
+      unsigned int numResident;     /**< Chunks in the scene */
+      unsigned int numPending;      /**< Chunks queued or being loaded */
+      vpr::Uint64  residentBytes;   /**< Estimated usage of resident chunks */
+      vpr::Uint64  budget;          /**< 0 means no limit */
+      unsigned int numLoads;
+      unsigned int numEvictions;
+      unsigned int numFailures;
+      float        averageLoadTime;
+      float        maxLoadTime;
+   };
+
+protected:
+   PagedModel(ChunkFilePtr file, OSG::NodePtr root,
+              const vpr::Uint64 memoryBudget);
+
+   void startThreads(const unsigned int numThreads);
+
+public:
+   /**
+    * Creates a paged model for the given chunk file along with its root
+    * and slots. This must be invoked in a thread that is known to OpenSG.
+    *
+    * @param file         The chunks of the model.
+    * @param memoryBudget The maximum estimated memory usage (in bytes) of
+    *                     the resident chunks. 0 means no limit.
+    * @param numThreads   The number of threads that load chunks. At least
+    *                     one is started.
+    */
+   static PagedModelPtr create(ChunkFilePtr file,
+                               const vpr::Uint64 memoryBudget,
+                               const unsigned int numThreads);
+
+   /**
+    * Creates a paged model that pages chunks into an existing root. This
+    * is used by cluster slaves for the roots that they receive from the
+    * master. The chunks are selected by calling selectChunks().
+    *
+    * @throw vrkit::Exception Thrown if \p root does not have one child per
+    *                         chunk of \p file.
+    */
+   static PagedModelPtr create(ChunkFilePtr file, OSG::NodePtr root,
+                               const unsigned int numThreads);
+
+   /**
+    * Stops the threads. Chunks that are being loaded are discarded.
+    */
+   ~PagedModel();
+
+   OSG::NodePtr getRoot() const
+   {
+      return mRoot;
+   }
+
+   /**
+    * Returns the name of the root. This identifies the model within the
+    * scene.
+    */
+   const std::string& getName() const
+   {
+      return mName;
+   }
+
+   const ChunkFilePtr& getChunkFile() const
+   {
+      return mFile;
+   }
+
+   /**
+    * Sets the half angle (in radians) of the view cone used by update().
+    * An angle of pi or more makes every chunk count as being in view.
+    */
+   void setViewAngle(const float angle);
+
+   /**
+    * Selects the chunks to have in the scene based on the position and
+    * view direction of the viewer and applies the selection.
+    *
+    * @param eye     The position of the viewer in the coordinate frame of
+    *                the root.
+    * @param viewDir The direction (of unit length) in which the viewer is
+    *                looking in the coordinate frame of the root.
+    *
+    * @return true is returned if chunks were added to or removed from the
+    *         scene. Otherwise, false is returned.
+    */
+   bool update(const gmtl::Point3f& eye, const gmtl::Vec3f& viewDir);
+
+   /**
+    * Makes the given chunks the ones to have in the scene. Chunks are
+    * loaded in the given order, and resident chunks that are not in the
+    * list are removed. Invalid chunk indices are ignored.
+    *
+    * @return true is returned if chunks were added to or removed from the
+    *         scene. Otherwise, false is returned.
+    */
+   bool selectChunks(const std::vector<vpr::Uint32>& chunks);
+
+   /**
+    * Returns the chunks that were last selected, in the order in which they
+    * are loaded.
+    */
+   const std::vector<vpr::Uint32>& getSelectedChunks() const
+   {
+      return mSelected;
+   }
+
+   Stats getStats() const;
+
+private:
+   enum ChunkState
+   {
+      UNLOADED,
+      QUEUED,
+      LOADING,
+      READY,         /**< Loaded but not yet in the scene */
+      RESIDENT,
+      FAILED
+   };
+
+   struct LoadedChunk
+   {
+      vpr::Uint32     index;
+      OSG::NodeRefPtr root;
+   };
+
+   /**
+    * Queues the selected chunks for loading and has the editor thread
+    * update the slots. Returns whether chunks were added to or removed from
+    * the scene.
+    */
+   bool applySelection();
+
+   void loaderLoop(const unsigned int index);
+
+   void editorLoop();
+
+   /**
+    * Registers the calling thread with OpenSG under a name derived from the
+    * name of this model.
+    */
+   void initThread(const std::string& role) const;
+
+   const ChunkFilePtr           mFile;
+   OSG::NodeRefPtr              mRoot;
+   std::vector<OSG::NodeRefPtr> mSlots;
+   std::string                  mName;
+   const vpr::Uint64            mBudget;
+   float                        mViewAngle;
+
+   std::vector<vpr::Uint32>     mSelected;
+
+   std::vector<vpr::Thread*>    mLoaders;
+   vpr::Thread*                 mEditor;
+
+   // State shared with the threads (protected by mCond).
+   mutable vpr::CondVar         mCond;
+   std::vector<ChunkState>      mStates;
+   std::deque<vpr::Uint32>      mLoadQueue;
+   std::deque<LoadedChunk>      mLoaded;
+   std::vector<vpr::Uint32>     mDetachList;
+   bool                         mEditPending;
+   bool                         mShutdown;
+
+   // Statistics (protected by mCond).
+   vpr::Uint64                  mResidentBytes;
+   unsigned int                 mNumResident;
+   unsigned int                 mNumLoads;
+   unsigned int                 mNumEvictions;
+   unsigned int                 mNumFailures;
+   float                        mTotalLoadTime;
+   float                        mMaxLoadTime;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_PAGING_PAGED_MODEL_H_ */
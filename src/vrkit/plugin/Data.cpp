@@ -18,8 +18,11 @@
 
 #include <vrkit/Config.h>
 
+#include <algorithm>
 #include <utility>
 
+#include <vpr/Sync/Guard.h>
+
 #include <vrkit/plugin/Data.h>
 
 
@@ -30,16 +33,22 @@ namespace plugin
 {
 
 Data::InstanceStore Data::sInstanceStore;
+std::vector<Data::InstanceStore::ptr_type> Data::sPendingChanges;
+vpr::Mutex Data::sPendingChangesLock;
 
 Data::Data(const data::TypeDesc& desc, const std::string& name)
    : mName(name)
    , mInstanceID(0)
    , mTypeDesc(desc)
+   , mStorage((desc.getStorageSize() + sizeof(vpr::Uint64) - 1) /
+                 sizeof(vpr::Uint64))
+   , mStrings(desc.getNumStrings())
+   , mChanged(desc.getNumValues(), false)
+   , mChangeQueued(false)
 {
-   typedef data::TypeDesc::const_iterator iter_type;
-   for ( iter_type i = desc.begin(); i != desc.end(); ++i )
+   for ( unsigned int i = 0; i < desc.getNumValues(); ++i )
    {
-      mData[(*i).getName()] = (*i).getInitValue();
+      setAny(i, desc.getValueDesc(i).getInitValue());
    }
 }
 
@@ -50,73 +59,270 @@ DataPtr Data::create(const data::TypeDesc& desc, const std::string& name)
    return ptr;
 }
 
-const boost::any& Data::doGet(const std::string& key) const
+boost::any Data::getAny(const unsigned int slot) const
 {
-   if ( mData.count(key) == 0 )
+   const std::size_t offset(mTypeDesc.getValueDesc(slot).getOffset());
+
+   switch ( mTypeDesc.getValueDesc(slot).getType() )
    {
-      std::ostringstream msg_stream;
-      msg_stream << "Invalid key '" << key << "' requested";
-      throw vrkit::Exception(msg_stream.str(), VRKIT_LOCATION);
+      case data::BOOL_VALUE:
+         return boost::any(load(data::Slot<bool >(slot, offset)));
+      case data::UINT8_VALUE:
+         return boost::any(load(data::Slot<vpr::Uint8 >(slot, offset)));
+      case data::INT8_VALUE:
+         return boost::any(load(data::Slot<vpr::Int8 >(slot, offset)));
+      case data::UINT16_VALUE:
+         return boost::any(load(data::Slot<vpr::Uint16 >(slot, offset)));
+      case data::INT16_VALUE:
+         return boost::any(load(data::Slot<vpr::Int16 >(slot, offset)));
+      case data::UINT32_VALUE:
+         return boost::any(load(data::Slot<vpr::Uint32 >(slot, offset)));
+      case data::INT32_VALUE:
+         return boost::any(load(data::Slot<vpr::Int32 >(slot, offset)));
+      case data::UINT64_VALUE:
+         return boost::any(load(data::Slot<vpr::Uint64 >(slot, offset)));
+      case data::INT64_VALUE:
+         return boost::any(load(data::Slot<vpr::Int64 >(slot, offset)));
+      case data::FLOAT_VALUE:
+         return boost::any(load(data::Slot<float >(slot, offset)));
+      case data::DOUBLE_VALUE:
+         return boost::any(load(data::Slot<double >(slot, offset)));
+      case data::STRING_VALUE:
+         return boost::any(load(data::Slot<std::string >(slot, offset)));
+      case data::POINTER_VALUE:
+         return boost::any(load(data::Slot<InstanceStore::ptr_type>(slot,
+                                                                    offset)));
+      default:
+         return boost::any();
    }
+}
 
-   return (*mData.find(key)).second;
+void Data::setAny(const unsigned int slot, const boost::any& value)
+{
+   const std::size_t offset(mTypeDesc.getValueDesc(slot).getOffset());
+
+   switch ( mTypeDesc.getValueDesc(slot).getType() )
+   {
+      case data::BOOL_VALUE:
+         store(data::Slot<bool >(slot, offset), boost::any_cast<bool>(value));
+         break;
+      case data::UINT8_VALUE:
+         store(data::Slot<vpr::Uint8 >(slot, offset), boost::any_cast<vpr::Uint8>(value));
+         break;
+      case data::INT8_VALUE:
+         store(data::Slot<vpr::Int8 >(slot, offset), boost::any_cast<vpr::Int8>(value));
+         break;
+      case data::UINT16_VALUE:
+         store(data::Slot<vpr::Uint16 >(slot, offset), boost::any_cast<vpr::Uint16>(value));
+         break;
+      case data::INT16_VALUE:
+         store(data::Slot<vpr::Int16 >(slot, offset), boost::any_cast<vpr::Int16>(value));
+         break;
+      case data::UINT32_VALUE:
+         store(data::Slot<vpr::Uint32 >(slot, offset), boost::any_cast<vpr::Uint32>(value));
+         break;
+      case data::INT32_VALUE:
+         store(data::Slot<vpr::Int32 >(slot, offset), boost::any_cast<vpr::Int32>(value));
+         break;
+      case data::UINT64_VALUE:
+         store(data::Slot<vpr::Uint64 >(slot, offset), boost::any_cast<vpr::Uint64>(value));
+         break;
+      case data::INT64_VALUE:
+         store(data::Slot<vpr::Int64 >(slot, offset), boost::any_cast<vpr::Int64>(value));
+         break;
+      case data::FLOAT_VALUE:
+         store(data::Slot<float >(slot, offset), boost::any_cast<float>(value));
+         break;
+      case data::DOUBLE_VALUE:
+         store(data::Slot<double >(slot, offset), boost::any_cast<double>(value));
+         break;
+      case data::STRING_VALUE:
+         store(data::Slot<std::string >(slot, offset), boost::any_cast<std::string>(value));
+         break;
+      case data::POINTER_VALUE:
+         store(data::Slot<InstanceStore::ptr_type>(slot, offset),
+               boost::any_cast<InstanceStore::ptr_type>(value));
+         break;
+      default:
+         break;
+   }
+}
+
+void Data::queueChange(const unsigned int slot)
+{
+   if ( ! mChanged[slot] )
+   {
+      mChanged[slot] = true;
+      mChangedSlots.push_back(slot);
+   }
+
+   if ( ! mChangeQueued )
+   {
+      mChangeQueued = true;
+
+      vpr::Guard<vpr::Mutex> guard(sPendingChangesLock);
+      sPendingChanges.push_back(mInstanceID);
+   }
+}
+
+void Data::deliverChanges()
+{
+   // Slots connected to the signals may modify data, so work from a local
+   // copy of the pending list. New changes are queued for the next delivery.
+   std::vector<InstanceStore::ptr_type> pending;
+
+   {
+      vpr::Guard<vpr::Mutex> guard(sPendingChangesLock);
+      pending.swap(sPendingChanges);
+   }
+
+   typedef std::vector<InstanceStore::ptr_type>::iterator iter_type;
+   for ( iter_type p = pending.begin(); p != pending.end(); ++p )
+   {
+      // The object may have been deleted since it was queued.
+      DataPtr obj = sInstanceStore.get(*p);
+
+      if ( obj.get() != NULL )
+      {
+         std::vector<unsigned int> slots;
+         slots.swap(obj->mChangedSlots);
+         obj->mChangeQueued = false;
+
+         typedef std::vector<unsigned int>::iterator slot_iter_type;
+         for ( slot_iter_type s = slots.begin(); s != slots.end(); ++s )
+         {
+            obj->mChanged[*s] = false;
+         }
+
+         std::sort(slots.begin(), slots.end());
+         obj->mValuesChanged(obj, slots);
+      }
+   }
 }
 
 Data::InstanceStore::InstanceStore()
-   // This starts at 1 so that pointer ID 0 can act as the universal
+   // Slot 0 is never used so that pointer ID 0 can act as the universal
    // "null" pointer.
-   : mCount(1)
+   : mNumSlots(1)
+{
+   std::fill(mChunks, mChunks + max_chunks, static_cast<Entry*>(NULL));
+   mChunks[0] = new Entry[chunk_size];
+}
+
+Data::InstanceStore::~InstanceStore()
 {
-   /* Do nothing. */ ;
+   for ( vpr::Uint32 c = 0; c < max_chunks; ++c )
+   {
+      delete[] mChunks[c];
+   }
 }
 
 Data::InstanceStore::ptr_type Data::InstanceStore::add(DataPtr i)
 {
-   const ptr_type ptr_value = mCount++;
-   mInstances[ptr_value] = i;
-   mNamedInstances.insert(std::make_pair(i->getName(), i));
+   vpr::Guard<vpr::Mutex> guard(mLock);
+
+   vpr::Uint32 index;
+
+   if ( ! mFreeSlots.empty() )
+   {
+      index = mFreeSlots.back();
+      mFreeSlots.pop_back();
+   }
+   else
+   {
+      if ( mNumSlots == chunk_size * max_chunks )
+      {
+         throw vrkit::Exception("Plug-in data instance table is full",
+                                VRKIT_LOCATION);
+      }
+
+      index = mNumSlots++;
+
+      Entry*& chunk = mChunks[index / chunk_size];
+      if ( NULL == chunk )
+      {
+         chunk = new Entry[chunk_size];
+      }
+   }
+
+   Entry& entry = getEntry(index);
+   ptr_type ptr_value;
+
+   {
+      vpr::Guard<vpr::Mutex> stripe_guard(getStripeLock(index));
+      entry.instance = i;
+      ptr_value = (ptr_type(entry.generation) << 32) | index;
+   }
+
+   mNamedInstances.insert(std::make_pair(i->getName(), ptr_value));
+
    return ptr_value;
 }
 
-void Data::InstanceStore::remove(const ptr_type ptr)
+void Data::InstanceStore::remove(const ptr_type ptr, const std::string& name)
 {
-   std::map<ptr_type, DataWeakPtr>::iterator i = mInstances.find(ptr);
+   const vpr::Uint32 index      = static_cast<vpr::Uint32>(ptr);
+   const vpr::Uint32 generation = static_cast<vpr::Uint32>(ptr >> 32);
+
+   vpr::Guard<vpr::Mutex> guard(mLock);
 
-   if ( i != mInstances.end() )
+   if ( 0 == index || index >= mNumSlots )
    {
-      DataPtr obj = (*i).second.lock();
-      mInstances.erase(i);
+      return;
+   }
 
-      // If the object identified by ptr is non-NULL, then it is also non-NULL
-      // in the multimap mNamedInstances.
-      if ( obj.get() != NULL )
+   Entry& entry = getEntry(index);
+
+   {
+      vpr::Guard<vpr::Mutex> stripe_guard(getStripeLock(index));
+
+      if ( entry.generation != generation )
       {
-         // Get the range of objects with the same name as obj.
-         typedef std::multimap<std::string, DataWeakPtr>::iterator iter_type;
-         typedef std::pair<iter_type, iter_type> range_type;
-         range_type range = mNamedInstances.equal_range(obj->getName());
+         return;
+      }
 
-         for ( iter_type o = range.first; o != range.second; ++o )
-         {
-            // This seems unnecessarily expensive. There must be a better way
-            // to do by-name object lookups than using a multi-map.
-            if ( obj == (*o).second.lock() )
-            {
-               mNamedInstances.erase(o);
-               break;
-            }
-         }
+      // Invalidate all outstanding pointer values for this slot.
+      entry.instance.reset();
+      ++entry.generation;
+   }
+
+   mFreeSlots.push_back(index);
+
+   typedef std::multimap<std::string, ptr_type>::iterator iter_type;
+   typedef std::pair<iter_type, iter_type> range_type;
+   range_type range = mNamedInstances.equal_range(name);
+
+   for ( iter_type o = range.first; o != range.second; ++o )
+   {
+      if ( (*o).second == ptr )
+      {
+         mNamedInstances.erase(o);
+         break;
       }
    }
 }
 
 const DataPtr Data::InstanceStore::get(const ptr_type ptr) const
 {
+   const vpr::Uint32 index      = static_cast<vpr::Uint32>(ptr);
+   const vpr::Uint32 generation = static_cast<vpr::Uint32>(ptr >> 32);
+
    DataPtr instance;
 
-   if ( mInstances.count(ptr) != 0 )
+   // A pointer value can only have been obtained after the chunk holding its
+   // slot was allocated, and chunks are never moved or freed, so the table
+   // can be indexed without holding mLock.
+   if ( index != 0 && index < chunk_size * max_chunks &&
+        mChunks[index / chunk_size] != NULL )
    {
-      instance = (*mInstances.find(ptr)).second.lock();
+      const Entry& entry = getEntry(index);
+
+      vpr::Guard<vpr::Mutex> stripe_guard(getStripeLock(index));
+
+      if ( entry.generation == generation )
+      {
+         instance = entry.instance.lock();
+      }
    }
 
    return instance;
@@ -127,13 +333,28 @@ const DataPtr Data::InstanceStore::getByName(const vpr::GUID& typeID,
 {
    DataPtr instance;
 
-   typedef std::multimap<std::string, DataWeakPtr>::const_iterator iter_type;
-   typedef std::pair<iter_type, iter_type> range_type;
-   range_type range = mNamedInstances.equal_range(objName);
+   std::vector<ptr_type> candidates;
 
-   for ( iter_type o = range.first; o != range.second; ++o )
    {
-      DataPtr temp_inst = (*o).second.lock();
+      vpr::Guard<vpr::Mutex> guard(mLock);
+
+      typedef std::multimap<std::string, ptr_type>::const_iterator iter_type;
+      typedef std::pair<iter_type, iter_type> range_type;
+      range_type range = mNamedInstances.equal_range(objName);
+
+      for ( iter_type o = range.first; o != range.second; ++o )
+      {
+         candidates.push_back((*o).second);
+      }
+   }
+
+   // The instances are resolved after releasing mLock. If the last reference
+   // to one of them were released while mLock was held, its destructor would
+   // deadlock trying to remove it from this store.
+   typedef std::vector<ptr_type>::iterator iter_type;
+   for ( iter_type c = candidates.begin(); c != candidates.end(); ++c )
+   {
+      DataPtr temp_inst = get(*c);
 
       if ( temp_inst.get() != NULL && typeID == temp_inst->getTypeID() )
       {
@@ -21,20 +21,25 @@
 
 #include <vrkit/Config.h>
 
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <map>
-#include <typeinfo>
 #include <boost/noncopyable.hpp>
 #include <boost/any.hpp>
-#include <boost/signal.hpp>
 
+#include <vpr/vprTypes.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Util/Assert.h>
 #include <vpr/Util/GUID.h>
 
 #include <vrkit/Exception.h>
+#include <vrkit/signal/Signal.h>
 #include <vrkit/signal/Proxy.h>
 #include <vrkit/plugin/data/ValueDesc.h>
 #include <vrkit/plugin/data/TypeDesc.h>
+#include <vrkit/plugin/data/Slot.h>
 #include <vrkit/plugin/DataPtr.h>
 
 
@@ -73,6 +78,18 @@ namespace plugin
  * can create an instance of a dynamically defined data type, and another can
  * retrieve that instance by looking it up by name.
  *
+ * Data members are held in fixed-layout typed storage determined by the
+ * type description. They may be accessed by name, which requires a lookup of
+ * the name on every access, or through a vrkit::plugin::data::Slot resolved
+ * once using getSlot(). Code that reads or writes data members every frame
+ * should use slots.
+ *
+ * Two forms of change notification are available. The signal returned by
+ * valueChanged() is emitted immediately for every modification. The signal
+ * returned by valuesChanged() is emitted at most once per frame for each
+ * modified instance and reports all the slots modified since the last
+ * emission. Neither signal costs anything when nothing is connected to it.
+ *
  * @see vrkit::plugin::DataFactory
  *
  * @since 0.51.1
@@ -100,7 +117,7 @@ public:
     */
    ~Data()
    {
-      sInstanceStore.remove(mInstanceID);
+      sInstanceStore.remove(mInstanceID, mName);
       mInstanceID = 0;
    }
 
@@ -136,6 +153,76 @@ public:
       return mName;
    }
 
+   /**
+    * Resolves the named data member of this object's type to a typed slot.
+    * The returned slot may be used with any instance of the same type.
+    *
+    * @param name The name of the data member.
+    *
+    * @throw vrkit::Exception
+    *           Thrown if \p name is not a valid data member for this
+    *           dynamically defined type or if the data member cannot be
+    *           accessed as the C++ type \p T.
+    *
+    * @see vrkit::plugin::data::TypeDesc::getSlot()
+    *
+    * @since 0.51.6
+    */
+   template<typename T>
+   data::Slot<T> getSlot(const std::string& name) const
+   {
+      return mTypeDesc.template getSlot<T>(name);
+   }
+
+   /**
+    * Returns the value of the data member identified by the given slot.
+    *
+    * @pre \p slot was resolved from the type description of this object.
+    *
+    * @since 0.51.6
+    */
+   template<typename T>
+   T get(const data::Slot<T>& slot) const
+   {
+      vprASSERT(slot.isValid() && slot.getIndex() < mTypeDesc.getNumValues());
+      return load(slot);
+   }
+
+   /**
+    * Sets the value of the data member identified by the given slot.
+    *
+    * @pre \p slot was resolved from the type description of this object.
+    *
+    * @throw vrkit::Exception
+    *           Thrown if \p T is vrkit::plugin::DataPtr and the type of
+    *           \p value is not accepted as a pointee type for the data
+    *           member.
+    *
+    * @since 0.51.6
+    */
+   template<typename T>
+   void set(const data::Slot<T>& slot, const T& value)
+   {
+      vprASSERT(slot.isValid() && slot.getIndex() < mTypeDesc.getNumValues());
+
+      if ( mValueChanged.empty() )
+      {
+         store(slot, value);
+      }
+      else
+      {
+         const boost::any old_value(getAny(slot.getIndex()));
+         store(slot, value);
+         mValueChanged(mTypeDesc.getValueDesc(slot.getIndex()).getName(),
+                       old_value, getAny(slot.getIndex()));
+      }
+
+      if ( ! mValuesChanged.empty() )
+      {
+         queueChange(slot.getIndex());
+      }
+   }
+
    /**
     * Returns the named data member value as an instance of the C++ type
     * given as the template paramter.
@@ -145,7 +232,6 @@ public:
     * @throw vrkit::Exception
     *           Thrown if \p key is not a valid data member for this
     *           dynamically defined type.
-    * @throw boost::bad_any_cast
     *           Thrown if the C++ type identified in the template parameter
     *           does not match the C++ type of the stored data member
     *           identified by the given key.
@@ -153,7 +239,7 @@ public:
    template<typename T>
    T get(const std::string& key)
    {
-      return boost::any_cast<T>(doGet(key));
+      return get(getSlot<T>(key));
    }
 
    /**
@@ -165,7 +251,6 @@ public:
     * @throw vrkit::Exception
     *           Thrown if \p key is not a valid data member for this
     *           dynamically defined type.
-    * @throw boost::bad_any_cast
     *           Thrown if the C++ type identified in the template parameter
     *           does not match the C++ type of the stored data member
     *           identified by the given key.
@@ -173,7 +258,7 @@ public:
    template<typename T>
    const T get(const std::string& key) const
    {
-      return boost::any_cast<T>(doGet(key));
+      return get(getSlot<T>(key));
    }
 
    /**
@@ -192,45 +277,24 @@ public:
     *           Thrown if the C++ type identified given by the template
     *           parameter to this method does not match the C++ type of the
     *           data associated with the named key.
+    *           Thrown if \p T is vrkit::plugin::DataPtr and the type of
+    *           \p value is not accepted as a pointee type for the named data
+    *           member.
     */
    template<typename T>
    void set(const std::string& key, const T& value)
    {
-      boost::any& v = doGet(key);
-
-      // XXX: Using some sort of run-time is-convertible test here would be
-      // a lot better than this approach. It would have to work something
-      // like this:
-      //
-      //    if ( is_convertible(typed(t), v.type()) )
-      //    {
-      //       v = magic_cast<v.type()>(value)
-      //    }
-      //
-      // Having this would avoid run-time errors that would normally not be
-      // seen with C/C++.
-      if ( v.type() == typeid(T) )
-      {
-         const boost::any old_value(v);
-         v = value;
-         mValueChanged(key, old_value, v);
-      }
-      else
-      {
-         std::ostringstream msg_stream;
-         msg_stream << "Assignment failed: Stored type " << v.type().name()
-                    << " does not match value type " << typeid(T).name();
-         throw vrkit::Exception(msg_stream.str(), VRKIT_LOCATION);
-      }
+      set(getSlot<T>(key), value);
    }
 
-   typedef boost::signal<
+   typedef vrkit::signal::Signal<
       void (const std::string&, const boost::any&, const boost::any&)
    > value_change_signal_t;
 
    /**
     * Provides access to the signal emitted when the value associated with a
-    * data member in this dynamically defined type is modified.
+    * data member in this dynamically defined type is modified. The old and
+    * new values are only constructed when at least one slot is connected.
     *
     * @see set<T>()
     */
@@ -239,17 +303,68 @@ public:
       return vrkit::signal::Proxy<value_change_signal_t>(mValueChanged);
    }
 
+   typedef vrkit::signal::Signal<
+      void (DataPtr, const std::vector<unsigned int>&)
+   > values_change_signal_t;
+
+   /**
+    * Provides access to the signal emitted by deliverChanges() for this
+    * object when one or more of its data members have been modified since
+    * the last delivery. The second parameter holds the (ascending) slot
+    * indices of the modified data members. Modifications are only recorded
+    * while at least one slot is connected to this signal.
+    *
+    * @see deliverChanges()
+    *
+    * @since 0.51.6
+    */
+   vrkit::signal::Proxy<values_change_signal_t> valuesChanged()
+   {
+      return vrkit::signal::Proxy<values_change_signal_t>(mValuesChanged);
+   }
+
+   /**
+    * Emits the batched change notification for every instance that has been
+    * modified since the last call. vrkit::Viewer invokes this once per frame
+    * in the application thread.
+    *
+    * @see valuesChanged()
+    *
+    * @since 0.51.6
+    */
+   static void deliverChanges();
+
 private:
    /**
     * This type acts as the instance storage for all vrkit::plugin::Data
     * objects that are created using the Data Factory. When such instances
     * are deleted, they are removed from the instance store.
+    *
+    * Instances are kept in a table of slots. The pointer value of an
+    * instance encodes its slot index (low 32 bits) and the generation of
+    * that slot (high 32 bits). When an instance is removed, the generation
+    * of its slot is incremented before the slot is reused, so stale pointer
+    * values resolve to a null pointer rather than to an unrelated object.
+    * Pointer value 0 is never assigned and acts as the universal "null"
+    * pointer.
+    *
+    * The table grows in fixed-size chunks that are never moved or freed
+    * while the store exists, so looking up an instance by pointer value is
+    * an array index. All methods are safe to call from any thread.
+    * Registration and removal serialize on a single lock. Lookups by pointer
+    * value take only the lock for the stripe that holds the slot, so they do
+    * not wait on registration, removal, or lookups of other instances.
+    *
+    * @note Prior to version 0.51.7, this type was not thread safe.
     */
    class InstanceStore
+      : private boost::noncopyable
    {
    public:
       InstanceStore();
 
+      ~InstanceStore();
+
       typedef data::TypeDesc::ptr_type ptr_type;
 
       /**
@@ -261,6 +376,9 @@ private:
        *       instance store with a unique index.
        *
        * @param i An instance of vrkit::plugin::Data.
+       *
+       * @throw vrkit::Exception
+       *           Thrown if the instance table is full.
        */
       ptr_type add(DataPtr i);
 
@@ -268,9 +386,14 @@ private:
        * Removes the vrkit::plugin::Data instance identified by the given
        * pointer index from this instance store.
        *
-       * @post No object indexed by the value \p ptr is in \c mInstances.
+       * @post No object is indexed by the value \p ptr.
+       *
+       * @param ptr  The pointer value of the object to remove.
+       * @param name The name of the object to remove. Since this is called
+       *             from the destructor of the object, the object itself
+       *             can no longer be reached through its weak pointer.
        */
-      void remove(const ptr_type ptr);
+      void remove(const ptr_type ptr, const std::string& name);
 
       /**
        * Retrieves the vrkit::plugin::Data object identified by the given
@@ -298,55 +421,110 @@ private:
                               const std::string& objName) const;
 
    private:
-      ptr_type mCount;
-      std::map<ptr_type, DataWeakPtr> mInstances;
+      /** A single entry in the instance table. */
+      struct Entry
+      {
+         Entry()
+            : generation(0)
+         {
+            /* Do nothing. */ ;
+         }
+
+         DataWeakPtr instance;
+         vpr::Uint32 generation;
+      };
+
+      static const vpr::Uint32 chunk_size  = 1024;
+      static const vpr::Uint32 max_chunks  = 1024;
+      static const vpr::Uint32 num_stripes = 64;
+
+      /**
+       * Returns the table entry at the given index.
+       *
+       * @pre The chunk holding \p index has been allocated.
+       */
+      Entry& getEntry(const vpr::Uint32 index) const
+      {
+         return mChunks[index / chunk_size][index % chunk_size];
+      }
+
+      vpr::Mutex& getStripeLock(const vpr::Uint32 index) const
+      {
+         return mStripeLocks[index % num_stripes];
+      }
+
+      /**
+       * The chunks of the instance table. Each chunk pointer is assigned
+       * once (while holding \c mLock) before any pointer value indexing into
+       * that chunk is handed out.
+       */
+      Entry* mChunks[max_chunks];
+
+      /** @name Registration State (protected by mLock) */
+      //@{
+      mutable vpr::Mutex mLock;
+
+      /** The number of slots ever used. Slot 0 is never used. */
+      vpr::Uint32 mNumSlots;
+
+      /** Indices of the slots that are available for reuse. */
+      std::vector<vpr::Uint32> mFreeSlots;
 
       /**
-       * The store of instances, indexed by name. This uses a weak pointer so
-       * that the objects can be deleted externally. If this were not a weak
-       * pointer, memory leaks would result because this object, effectively
-       * a global, would always hold a reference to every instantiated
-       * vrkit::plugin::Data object.
+       * The pointer values of the registered instances, indexed by name.
        */
-      std::multimap<std::string, DataWeakPtr> mNamedInstances;
+      std::multimap<std::string, ptr_type> mNamedInstances;
+      //@}
+
+      /** Locks guarding the contents of the slots (slot i uses i % 64). */
+      mutable vpr::Mutex mStripeLocks[num_stripes];
    };
 
-   /**
-    * Returns the named data member value as an instance of the C++ type
-    * given as the template paramter.
-    *
-    * @param key The name of the data member whose value will be retrieved.
-    *
-    * @throw vrkit::Exception
-    *           Thrown if \p key is not a valid data member for this
-    *           dynamically defined type.
-    * @throw boost::bad_any_cast
-    *           Thrown if the C++ type identified in the template parameter
-    *           does not match the C++ type of the stored data member
-    *           identified by the given key.
-    */
-   boost::any& doGet(const std::string& key)
+   /** @name Typed Storage Access */
+   //@{
+   template<typename T>
+   T load(const data::Slot<T>& slot) const
+   {
+      T value;
+      std::memcpy(&value, getBytes() + slot.getOffset(), sizeof(T));
+      return value;
+   }
+
+   template<typename T>
+   void store(const data::Slot<T>& slot, const T& value)
    {
-      // Call the const version of this method.
-      return
-         const_cast<boost::any&>(static_cast<const Data*>(this)->doGet(key));
+      std::memcpy(getBytes() + slot.getOffset(), &value, sizeof(T));
+   }
+
+   const char* getBytes() const
+   {
+      return reinterpret_cast<const char*>(&mStorage[0]);
+   }
+
+   char* getBytes()
+   {
+      return reinterpret_cast<char*>(&mStorage[0]);
    }
 
    /**
-    * Returns the named data member value as an instance of the C++ type
-    * given as the template paramter.
-    *
-    * @param key The name of the data member whose value will be retrieved.
+    * Returns the value of the data member in the given slot wrapped in a
+    * boost::any object. Pointers are returned as their pointer values.
+    */
+   boost::any getAny(const unsigned int slot) const;
+
+   /**
+    * Stores the given value in the data member in the given slot.
     *
-    * @throw vrkit::Exception
-    *           Thrown if \p key is not a valid data member for this
-    *           dynamically defined type.
-    * @throw boost::bad_any_cast
-    *           Thrown if the C++ type identified in the template parameter
-    *           does not match the C++ type of the stored data member
-    *           identified by the given key.
+    * @pre The C++ type held by \p value matches the type of the data member.
     */
-   const boost::any& doGet(const std::string& key) const;
+   void setAny(const unsigned int slot, const boost::any& value);
+   //@}
+
+   /**
+    * Records the modification of the data member in the given slot for
+    * delivery by deliverChanges().
+    */
+   void queueChange(const unsigned int slot);
 
    static InstanceStore sInstanceStore; /**< Global instance store */
 
@@ -365,13 +543,16 @@ private:
 
    /** @name Data Member Management */
    //@{
-   typedef std::map<std::string, boost::any> data_map_t;
-
    /**
-    * The collection of named data members for this dynamically defined data
-    * type.
+    * The storage for all non-string data members. This uses 64-bit elements
+    * so that the storage is aligned suitably for every data member type.
+    *
+    * @see vrkit::plugin::data::TypeDesc::getStorageSize()
     */
-   data_map_t mData;
+   std::vector<vpr::Uint64> mStorage;
+
+   /** The storage for the string data members. */
+   std::vector<std::string> mStrings;
 
    /**
     * Signal emitted when a value within this dynamically defined data type
@@ -381,76 +562,81 @@ private:
     */
    value_change_signal_t mValueChanged;
    //@}
+
+   /** @name Batched Change Notification */
+   //@{
+   values_change_signal_t mValuesChanged;
+
+   std::vector<bool>         mChanged;      /**< Per-slot modified flags */
+   std::vector<unsigned int> mChangedSlots; /**< Modified slot indices */
+   bool                      mChangeQueued; /**< In sPendingChanges? */
+
+   /**
+    * The instance store identifiers of the objects that have changes waiting
+    * to be delivered.
+    */
+   static std::vector<InstanceStore::ptr_type> sPendingChanges;
+
+   static vpr::Mutex sPendingChangesLock; /**< Protects sPendingChanges */
+   //@}
 };
 
-/**
- * Specialization for vrkit::plugin::DataPtr to perform pointer lookups in the
- * global instance store.
- *
- * @param key The name of the data member whose value will be retrieved.
- *
- * @throw vrkit::Exception
- *           Thrown if \p key is not a valid data member for this dynamically
- *           defined type.
- */
 template<>
-inline const DataPtr Data::get<DataPtr>(const std::string& key) const
+inline std::string Data::load(const data::Slot<std::string>& slot) const
 {
-   return sInstanceStore.get(get<InstanceStore::ptr_type>(key));
+   return mStrings[slot.getOffset()];
+}
+
+template<>
+inline void Data::store(const data::Slot<std::string>& slot,
+                        const std::string& value)
+{
+   mStrings[slot.getOffset()] = value;
 }
 
 /**
  * Specialization for vrkit::plugin::DataPtr to perform pointer lookups in the
  * global instance store.
- *
- * @param key The name of the data member whose value will be retrieved.
- *
- * @throw vrkit::Exception
- *           Thrown if \p key is not a valid data member for this dynamically
- *           defined type.
  */
 template<>
-inline DataPtr Data::get<DataPtr>(const std::string& key)
+inline DataPtr Data::load(const data::Slot<DataPtr>& slot) const
 {
-   // Call the const version of this method.
-   return static_cast<const Data*>(this)->get<DataPtr>(key);
+   InstanceStore::ptr_type ptr;
+   std::memcpy(&ptr, getBytes() + slot.getOffset(), sizeof(ptr));
+   return sInstanceStore.get(ptr);
 }
 
 /**
- * Specialization for vrkit::plugin::DataPtr to perform pointer lookups in the
- * global instance store.
- *
- * @post If the data member named by \p key exists in this dynamically
- *       defined type exists and the type of \p ptr is accepted pointee type,
- *       then the pointer value for \p ptr is stored in the named data member.
- *
- * @param key The name of the data member to be modified.
- * @param ptr The pointer to assign to the named data member.
+ * Specialization for vrkit::plugin::DataPtr to store the pointer value of the
+ * given object.
  *
  * @throw vrkit::Exception
  *           Thrown if the type of \p ptr is not accepted as a pointer value
- *           for the named data member. This also covers the case of an
- *           attempt to assign a pointer to a non-pointer data member.
- *           Thrown if \p key is not a valid data member for this
- *           dynamically defined type.
+ *           for the data member in the given slot.
  */
 template<>
-inline void Data::set(const std::string& key, const DataPtr& ptr)
+inline void Data::store(const data::Slot<DataPtr>& slot, const DataPtr& ptr)
 {
-   // If the value desciption for key is not for a pointer, its pointee type
-   // will be a null GUID, which is not a valid pointee type. Thus, this
-   // condition will evaluate to false.
-   if ( mTypeDesc.getValueDesc(key).acceptsPointee(ptr->getTypeID()) )
-   {
-      set(key, ptr->mInstanceID);
-   }
-   else
+   const data::ValueDesc& desc(mTypeDesc.getValueDesc(slot.getIndex()));
+
+   // A null pointer is always allowed and is stored as pointer ID 0.
+   InstanceStore::ptr_type ptr_value(0);
+
+   if ( ptr.get() != NULL )
    {
-      std::ostringstream msg_stream;
-      msg_stream << "Pointee type " << ptr->getDescription().getID()
-                 << "\nis not allowed for member '" << key << "'";
-      throw vrkit::Exception(msg_stream.str(), VRKIT_LOCATION);
+      if ( ! desc.acceptsPointee(ptr->getTypeID()) )
+      {
+         std::ostringstream msg_stream;
+         msg_stream << "Pointee type " << ptr->getDescription().getID()
+                    << "\nis not allowed for member '" << desc.getName()
+                    << "'";
+         throw vrkit::Exception(msg_stream.str(), VRKIT_LOCATION);
+      }
+
+      ptr_value = ptr->mInstanceID;
    }
+
+   std::memcpy(getBytes() + slot.getOffset(), &ptr_value, sizeof(ptr_value));
 }
 
 }
@@ -18,13 +18,11 @@
 
 #include <sstream>
 #include <stdexcept>
-#include <queue>
 #include <vector>
 #include <iterator>
 #include <utility>
 #include <algorithm>
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/algorithm/string/split.hpp>
 
 #include <vpr/vpr.h>
 #include <vpr/vprParam.h>
@@ -45,12 +43,92 @@ namespace
 template<typename T>
 struct is_version_less
 {
-   bool operator()(boost::shared_ptr<T> lhs, boost::shared_ptr<T> rhs)
+   bool operator()(boost::shared_ptr<T> lhs, boost::shared_ptr<T> rhs) const
    {
-      return lhs->getInfo().getFullName() < rhs->getInfo().getFullName();
+      return lhs->getInfo().getVersion() < rhs->getInfo().getVersion();
    }
 };
 
+/**
+ * Returns the given plug-in type identifier without its version.
+ */
+std::string getBaseName(const std::string& pluginTypeID)
+{
+   return pluginTypeID.substr(
+      0, pluginTypeID.find(vrkit::plugin::Info::getSeparator())
+   );
+}
+
+/**
+ * Determines whether the plug-in type with the given full name satisfies the
+ * (possibly partial) plug-in type identifier. A partial version has to match
+ * on whole version components, so "Foo:1" matches "Foo:1.2.0" but not
+ * "Foo:10.0.0".
+ */
+bool matchesTypeID(const std::string& fullName,
+                   const std::string& pluginTypeID)
+{
+   return fullName == pluginTypeID ||
+          boost::algorithm::starts_with(fullName, pluginTypeID + ".");
+}
+
+/**
+ * Inserts \p value into \p seq, keeping \p seq sorted by version.
+ */
+template<typename T>
+void insertByVersion(std::vector< boost::shared_ptr<T> >& seq,
+                     boost::shared_ptr<T> value)
+{
+   seq.insert(std::upper_bound(seq.begin(), seq.end(), value,
+                               is_version_less<T>()),
+              value);
+}
+
+/**
+ * Looks up the newest version of the identified plug-in type in the given
+ * version index. If \p pluginTypeID includes a (partial) version, only
+ * matching versions are considered.
+ */
+template<typename T>
+boost::shared_ptr<T>
+findNewest(const std::map< std::string, std::vector< boost::shared_ptr<T> > >& index,
+           const std::string& pluginTypeID)
+{
+   typedef std::vector< boost::shared_ptr<T> > list_type;
+   typedef std::map<std::string, list_type> index_type;
+
+   boost::shared_ptr<T> result;
+
+   const std::string::size_type split_pos =
+      pluginTypeID.find(vrkit::plugin::Info::getSeparator());
+   typename index_type::const_iterator i =
+      index.find(pluginTypeID.substr(0, split_pos));
+
+   if ( i != index.end() && ! (*i).second.empty() )
+   {
+      const list_type& versions((*i).second);
+
+      if ( split_pos == std::string::npos )
+      {
+         result = versions.back();
+      }
+      else
+      {
+         typedef typename list_type::const_reverse_iterator iter_type;
+         for ( iter_type v = versions.rbegin(); v != versions.rend(); ++v )
+         {
+            if ( matchesTypeID((*v)->getInfo().getFullName(), pluginTypeID) )
+            {
+               result = *v;
+               break;
+            }
+         }
+      }
+   }
+
+   return result;
+}
+
 }
 
 namespace vrkit
@@ -60,6 +138,7 @@ namespace plugin
 {
 
 Registry::Registry()
+   : mDepGraphDirty(false)
 {
    /* Do nothing. */ ;
 }
@@ -67,7 +146,10 @@ Registry::Registry()
 Registry::~Registry()
 {
    mNamedInstances.clear();
+   mInstanceIndex.clear();
    mInstantiated.clear();
+   mDepGraph.clear();
+   mEntryIndex.clear();
    mRegistry.clear();
 }
 
@@ -88,7 +170,7 @@ AbstractPluginPtr Registry::makeInstance(const std::string& pluginTypeID,
       throw PluginTypeNameException(msg_stream.str(), VRKIT_LOCATION);
    }
 
-   satisfyDeps(entry);
+   satisfyDeps(entry, deps);
 
    AbstractPluginPtr plugin = entry->create();
    registerInstantiatedPlugin(entry->getInfo(), plugin);
@@ -155,11 +237,73 @@ AbstractPluginPtr Registry::getInstanceByName(const std::string& name) const
    return (*i).second;
 }
 
+std::vector<RegistryEntryPtr>
+Registry::getInstantiationOrder(const std::vector<std::string>& pluginTypeIDs)
+{
+   std::vector<const DepNode*> nodes;
+   std::map<std::string, bool> visited;
+
+   typedef std::vector<std::string>::const_iterator iter_type;
+   for ( iter_type t = pluginTypeIDs.begin(); t != pluginTypeIDs.end(); ++t )
+   {
+      RegistryEntryPtr entry = findEntry(*t);
+
+      if ( ! entry )
+      {
+         std::ostringstream msg_stream;
+         msg_stream << "No registry entry for " << *t << " was found";
+         throw PluginTypeNameException(msg_stream.str(), VRKIT_LOCATION);
+      }
+
+      collectDeps(getDepNode(entry), nodes, visited);
+   }
+
+   // collectDeps() produces a valid topological order. Bucketing the result
+   // by level keeps it valid while grouping mutually independent entries.
+   std::vector< std::vector<RegistryEntryPtr> > levels;
+
+   typedef std::vector<const DepNode*>::const_iterator node_iter_type;
+   for ( node_iter_type n = nodes.begin(); n != nodes.end(); ++n )
+   {
+      if ( (*n)->level >= levels.size() )
+      {
+         levels.resize((*n)->level + 1);
+      }
+
+      levels[(*n)->level].push_back((*n)->entry);
+   }
+
+   std::vector<RegistryEntryPtr> order;
+   order.reserve(nodes.size());
+
+   typedef std::vector< std::vector<RegistryEntryPtr> >::iterator
+      level_iter_type;
+   for ( level_iter_type l = levels.begin(); l != levels.end(); ++l )
+   {
+      order.insert(order.end(), (*l).begin(), (*l).end());
+   }
+
+   return order;
+}
+
+const std::vector<RegistryEntryPtr>&
+Registry::getDependencies(RegistryEntryPtr entry)
+{
+   return getDepNode(entry).deps;
+}
+
+unsigned int Registry::getDependencyLevel(RegistryEntryPtr entry)
+{
+   return getDepNode(entry).level;
+}
+
 void Registry::registerInstantiatedPlugin(const plugin::Info& pluginInfo,
                                           AbstractPluginPtr plugin)
 {
    // Add the instantiated plug-in to the multi-map of plug-in objects.
    mInstantiated.insert(std::make_pair(pluginInfo.getFullName(), plugin));
+   insertByVersion(mInstanceIndex[getBaseName(pluginInfo.getFullName())],
+                   plugin);
 
    // Emit the instantiation signal.
    mPluginInstantiated(plugin);
@@ -173,6 +317,12 @@ bool Registry::addEntry(RegistryEntryPtr entry)
    if ( mRegistry.count(full_name) == 0 )
    {
       mRegistry[full_name] = entry;
+      insertByVersion(mEntryIndex[getBaseName(full_name)], entry);
+
+      // The new entry may satisfy a previously missing dependency or replace
+      // the newest version of an existing dependency.
+      mDepGraphDirty = true;
+
       mModuleRegistered(entry->getInfo(), entry->getModule());
       result = true;
    }
@@ -198,9 +348,7 @@ RegistryEntryPtr Registry::findEntry(const std::string& moduleName) const
    }
    else
    {
-      const std::string::size_type split_pos =
-         moduleName.find(plugin::Info::getSeparator());
-      entry = findNewestVersionEntry(moduleName.substr(0, split_pos));
+      entry = findNewestVersionEntry(moduleName);
    }
 
    return entry;
@@ -209,164 +357,207 @@ RegistryEntryPtr Registry::findEntry(const std::string& moduleName) const
 RegistryEntryPtr
 Registry::findNewestVersionEntry(const std::string& moduleName) const
 {
-   vprASSERT(moduleName.find(plugin::Info::getSeparator()) == std::string::npos);
+   return findNewest(mEntryIndex, moduleName);
+}
 
-   std::priority_queue<
-      RegistryEntryPtr, std::vector<RegistryEntryPtr>,
-      is_version_less<RegistryEntry>
-   > queue;
+AbstractPluginPtr
+Registry::findNewestVersionInstance(const std::string& moduleName) const
+{
+   return findNewest(mInstanceIndex, moduleName);
+}
 
-   typedef registry_type::const_iterator iter_type;
-   for ( iter_type i = mRegistry.begin(); i != mRegistry.end(); ++i )
-   {
-      if ( boost::algorithm::starts_with((*i).first, moduleName) )
-      {
-         queue.push((*i).second);
-      }
-   }
+void Registry::satisfyDeps(RegistryEntryPtr entry,
+                           std::vector<AbstractPluginPtr>& deps)
+{
+   const std::string& full_name(entry->getInfo().getFullName());
 
-   RegistryEntryPtr entry;
+   std::vector<std::string> type_ids(1, full_name);
+   std::vector<RegistryEntryPtr> order;
 
-   if ( ! queue.empty() )
+   try
    {
-      entry = queue.top();
+      order = getInstantiationOrder(type_ids);
+   }
+   catch (PluginDependencyException& ex)
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to satisfy dependencies of " << full_name
+                 << std::endl << ex.what();
+      throw PluginException(msg_stream.str(), VRKIT_LOCATION);
    }
 
-   return entry;
-}
+   // The last entry in order is the one that we were given. The caller
+   // handles its instantiation.
+   vprASSERT(! order.empty() && order.back() == entry);
+   order.pop_back();
 
-AbstractPluginPtr
-Registry::findNewestVersionInstance(const std::string& moduleName) const
-{
-   std::priority_queue<
-      AbstractPluginPtr, std::vector<AbstractPluginPtr>,
-      is_version_less<AbstractPlugin>
-   > queue;
-
-   typedef std::multimap<std::string, AbstractPluginPtr>::const_iterator
-      iter_type;
-   for ( iter_type i = mInstantiated.begin(); i != mInstantiated.end(); ++i )
+   typedef std::vector<RegistryEntryPtr>::iterator iter_type;
+   for ( iter_type e = order.begin(); e != order.end(); ++e )
    {
-      if ( boost::algorithm::starts_with((*i).first, moduleName) )
+      const plugin::Info& dep_info((*e)->getInfo());
+
+      if ( mInstantiated.count(dep_info.getFullName()) == 0 )
       {
-         queue.push((*i).second);
+         AbstractPluginPtr dep = (*e)->create();
+         registerInstantiatedPlugin(dep_info, dep);
+         deps.push_back(dep);
       }
    }
+}
 
-   AbstractPluginPtr plugin;
-
-   if ( ! queue.empty() )
+Registry::DepNode& Registry::getDepNode(RegistryEntryPtr entry)
+{
+   if ( mDepGraphDirty )
    {
-      plugin = queue.top();
+      buildDependencyGraph();
    }
 
-   return plugin;
+   dep_graph_type::iterator n =
+      mDepGraph.find(entry->getInfo().getFullName());
+   vprASSERT(n != mDepGraph.end() && "Entry is not in this registry");
+
+   return (*n).second;
 }
 
-struct CompareDeps
+void Registry::buildDependencyGraph()
 {
-   bool operator()(RegistryEntryPtr e1, RegistryEntryPtr e2)
-   {
-      const plugin::Info& e1_info = e1->getInfo();
-      const plugin::Info& e2_info = e2->getInfo();
+   mDepGraph.clear();
 
-      if ( e1_info.getFullName() == e2_info.getFullName() )
-      {
-         return false;
-      }
+   // First pass: resolve the dependency identifiers of every entry.
+   typedef registry_type::const_iterator reg_iter_type;
+   for ( reg_iter_type i = mRegistry.begin(); i != mRegistry.end(); ++i )
+   {
+      DepNode& node = mDepGraph[(*i).first];
+      node.entry = (*i).second;
 
-      bool result(false);
+      const std::vector<std::string>& deps =
+         node.entry->getInfo().getDependencies();
+      node.deps.reserve(deps.size());
 
-      // Plug-in 1 does not depend on Plug-in 2.
-      if ( ! e1_info.dependsOn(e2_info) )
+      typedef std::vector<std::string>::const_iterator iter_type;
+      for ( iter_type d = deps.begin(); d != deps.end(); ++d )
       {
-         // Plug-in 2 does not depend on Plug-in 1.
-         if ( ! e2_info.dependsOn(e1_info) )
+         RegistryEntryPtr e = findEntry(*d);
+
+         if ( e )
          {
-            result = true;
+            node.deps.push_back(e);
+         }
+         else if ( node.error.empty() )
+         {
+            std::ostringstream msg_stream;
+            msg_stream << "Missing dependency " << *d << " of "
+                       << (*i).first;
+            node.error = msg_stream.str();
          }
-         // Plug-in 2 depends on Plug-in 1.
-      }
-      // Plug-in 1 depends on Plug-in 2.
-      else
-      {
-         result = true;
       }
-
-      return result;
    }
-};
 
-void Registry::satisfyDeps(RegistryEntryPtr entry)
-{
-   const std::string& full_name(entry->getInfo().getFullName());
-   std::vector<std::string>::iterator i = std::find(mInProgress.begin(),
-                                                    mInProgress.end(),
-                                                    full_name);
-
-   // Circular dependency detected!
-   // XXX: It would be nice to be able to detect this sort of problem before
-   // beginning the recursive dependency satisfication.
-   if ( i != mInProgress.end() )
+   // Second pass: a depth-first traversal that detects cycles, computes
+   // dependency levels, and propagates errors to dependent entries.
+   std::vector<std::string> path;
+
+   typedef dep_graph_type::iterator graph_iter_type;
+   for ( graph_iter_type n = mDepGraph.begin(); n != mDepGraph.end(); ++n )
    {
-      std::ostringstream msg_stream;
-      msg_stream << "Circular plug-in dependency detected:\n";
-      std::copy(i, mInProgress.end(),
-                std::ostream_iterator<std::string>(msg_stream, " -> "));
-      msg_stream << full_name;
-      throw PluginDependencyException(msg_stream.str(), VRKIT_LOCATION);
+      if ( (*n).second.state == DepNode::UNVISITED )
+      {
+         visitDepNode((*n).second, path);
+      }
    }
 
-   mInProgress.push_back(full_name);
+   mDepGraphDirty = false;
+}
 
-   const std::vector<std::string>& deps = entry->getInfo().getDependencies();
+void Registry::visitDepNode(DepNode& node, std::vector<std::string>& path)
+{
+   const std::string& full_name(node.entry->getInfo().getFullName());
 
-   std::priority_queue<
-      RegistryEntryPtr, std::vector<RegistryEntryPtr>, CompareDeps
-   > dependencies;
+   node.state = DepNode::IN_PROGRESS;
+   path.push_back(full_name);
 
-   typedef std::vector<std::string>::const_iterator iter_type;
-   for ( iter_type d = deps.begin(); d != deps.end(); ++d )
+   typedef std::vector<RegistryEntryPtr>::iterator iter_type;
+   for ( iter_type d = node.deps.begin(); d != node.deps.end(); ++d )
    {
-      if ( mInstantiated.count(*d) == 0 )
+      DepNode& dep = mDepGraph[(*d)->getInfo().getFullName()];
+
+      if ( dep.state == DepNode::IN_PROGRESS )
       {
-         RegistryEntryPtr e = findEntry(*d);
+         // Circular dependency detected! Every entry on the cycle is
+         // unusable.
+         std::vector<std::string>::iterator start =
+            std::find(path.begin(), path.end(),
+                      dep.entry->getInfo().getFullName());
 
-         if ( e )
+         std::ostringstream msg_stream;
+         msg_stream << "Circular plug-in dependency detected:\n";
+         std::copy(start, path.end(),
+                   std::ostream_iterator<std::string>(msg_stream, " -> "));
+         msg_stream << dep.entry->getInfo().getFullName();
+
+         for ( std::vector<std::string>::iterator p = start;
+               p != path.end();
+               ++p )
          {
-            dependencies.push(e);
+            DepNode& cycle_node = mDepGraph[*p];
+
+            if ( cycle_node.error.empty() )
+            {
+               cycle_node.error = msg_stream.str();
+            }
          }
-         else
+      }
+      else
+      {
+         if ( dep.state == DepNode::UNVISITED )
+         {
+            visitDepNode(dep, path);
+         }
+
+         if ( ! dep.error.empty() && node.error.empty() )
          {
             std::ostringstream msg_stream;
-            msg_stream << "Missing dependency " << *d << " of " << full_name;
-            throw PluginDependencyException(msg_stream.str(), VRKIT_LOCATION);
+            msg_stream << "Failed to satisfy dependencies of "
+                       << dep.entry->getInfo().getFullName()
+                       << ", a dependency of " << full_name << std::endl
+                       << dep.error;
+            node.error = msg_stream.str();
          }
+
+         node.level = std::max(node.level, dep.level + 1);
       }
    }
 
-   while ( ! dependencies.empty() )
-   {
-      RegistryEntryPtr dep = dependencies.top();
+   path.pop_back();
+   node.state = DepNode::DONE;
+}
 
-      try
+void Registry::collectDeps(const DepNode& node,
+                           std::vector<const DepNode*>& order,
+                           std::map<std::string, bool>& visited)
+{
+   const std::string& full_name(node.entry->getInfo().getFullName());
+
+   if ( ! visited[full_name] )
+   {
+      if ( ! node.error.empty() )
       {
-         satisfyDeps(dep);
-         registerInstantiatedPlugin(entry->getInfo(), entry->create());
+         throw PluginDependencyException(node.error, VRKIT_LOCATION);
       }
-      catch (PluginDependencyException& ex)
+
+      visited[full_name] = true;
+
+      // The graph is known to be acyclic below node, so this recursion is
+      // bounded by the depth of the dependency graph.
+      typedef std::vector<RegistryEntryPtr>::const_iterator iter_type;
+      for ( iter_type d = node.deps.begin(); d != node.deps.end(); ++d )
       {
-         std::ostringstream msg_stream;
-         msg_stream << "Failed to satisfy dependencies of "
-                    << dep->getInfo().getFullName() << ", a dependency of "
-                    << full_name << std::endl << ex.what();
-         throw PluginException(msg_stream.str(), VRKIT_LOCATION);
+         collectDeps(mDepGraph[(*d)->getInfo().getFullName()], order,
+                     visited);
       }
 
-      dependencies.pop();
+      order.push_back(&node);
    }
-
-   mInProgress.pop_back();
 }
 
 }
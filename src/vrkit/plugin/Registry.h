@@ -22,6 +22,7 @@
 #include <vrkit/Config.h>
 
 #include <string>
+#include <vector>
 #include <map>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
@@ -51,6 +52,14 @@ class Info;
  * instantiations of vrkit::plugin::TypedRegistryEntry<T> or
  * vrkit::plugin::TypedInitRegistryEntry<T,R>.
  *
+ * The dependencies of the registered plug-in types form a directed acyclic
+ * graph that is built (once) on demand after new entries are added. Cycles
+ * and unresolvable dependencies are detected at that time rather than during
+ * plug-in instantiation. Entries and instances are also indexed by their
+ * base name (the full name without its version), and each index bucket is
+ * kept sorted by version so that version-agnostic lookups do not have to
+ * scan the whole registry.
+ *
  * @since 0.36
  */
 class VRKIT_CLASS_API Registry
@@ -137,12 +146,76 @@ public:
    AbstractPluginPtr getInstanceByType(const std::string& pluginTypeID) const;
 
    AbstractPluginPtr getInstanceByName(const std::string& name) const;
-   //@}
 
-private:
+   /**
+    * Adds a plug-in instance that was created outside of makeInstance() to
+    * the collection of instantiated plug-ins and emits the instantiation
+    * signal. This is for use with vrkit::plugin::RegistryEntry::allocate().
+    *
+    * @param pluginInfo The information for the type of \p plugin.
+    * @param plugin     The plug-in instance to register.
+    *
+    * @since 0.51.5
+    */
    void registerInstantiatedPlugin(const plugin::Info& pluginInfo,
                                    AbstractPluginPtr plugin);
+   //@}
+
+   /** @name Dependency Graph Interface */
+   //@{
+   /**
+    * Determines the order in which the given plug-in types and all of their
+    * transitive dependencies must be instantiated. The returned list is in
+    * topological order, and it is further partitioned into levels: every
+    * entry appears after all of the entries with a lower dependency level.
+    * Entries that share a level do not depend on each other and could
+    * therefore be instantiated concurrently.
+    *
+    * @post The dependency graph is up to date with respect to the current
+    *       set of registry entries.
+    *
+    * @param pluginTypeIDs The plug-in type identifiers (full or partial) for
+    *                      which an instantiation order is needed.
+    *
+    * @return A list of registry entries (without duplicates) is returned.
+    *
+    * @throw vrkit::PluginTypeNameException
+    *           Thrown if one of \p pluginTypeIDs does not identify a
+    *           registered plug-in type.
+    * @throw vrkit::PluginDependencyException
+    *           Thrown if a dependency is missing or is part of a circular
+    *           dependency chain.
+    *
+    * @see getDependencyLevel()
+    *
+    * @since 0.51.4
+    */
+   std::vector<RegistryEntryPtr>
+      getInstantiationOrder(const std::vector<std::string>& pluginTypeIDs);
+
+   /**
+    * Returns the resolved direct dependencies of the given entry.
+    *
+    * @pre \p entry is a member of this registry.
+    *
+    * @since 0.51.4
+    */
+   const std::vector<RegistryEntryPtr>&
+      getDependencies(RegistryEntryPtr entry);
+
+   /**
+    * Returns the dependency level of the given entry. Entries with no
+    * dependencies are at level 0. Otherwise, the level of an entry is one
+    * greater than the highest level of its direct dependencies.
+    *
+    * @pre \p entry is a member of this registry.
+    *
+    * @since 0.51.4
+    */
+   unsigned int getDependencyLevel(RegistryEntryPtr entry);
+   //@}
 
+private:
    RegistryEntryPtr findEntry(const std::string& moduleName) const;
 
    RegistryEntryPtr findNewestVersionEntry(const std::string& moduleName)
@@ -151,16 +224,93 @@ private:
    AbstractPluginPtr findNewestVersionInstance(const std::string& moduleName)
       const;
 
-   void satisfyDeps(RegistryEntryPtr entry);
+   /**
+    * Instantiates all the dependencies of the given entry that do not have
+    * an instance yet. This is done in the order determined by the dependency
+    * graph, so no recursion is involved.
+    *
+    * @param entry The entry whose dependencies will be satisfied.
+    * @param deps  Storage for the newly created dependency instances.
+    */
+   void satisfyDeps(RegistryEntryPtr entry,
+                    std::vector<AbstractPluginPtr>& deps);
+
+   /** @name Dependency Graph Management */
+   //@{
+   struct DepNode
+   {
+      enum VisitState
+      {
+         UNVISITED,
+         IN_PROGRESS,
+         DONE
+      };
+
+      DepNode()
+         : level(0)
+         , state(UNVISITED)
+      {
+         /* Do nothing. */ ;
+      }
+
+      RegistryEntryPtr              entry;
+      std::vector<RegistryEntryPtr> deps;   /**< Resolved dependencies */
+
+      /**
+       * Description of the problem with this node (a missing dependency or a
+       * dependency cycle). This is empty if the node can be instantiated.
+       */
+      std::string  error;
+      unsigned int level;
+      VisitState   state;
+   };
+
+   typedef std::map<std::string, DepNode> dep_graph_type;
+
+   /**
+    * Returns the dependency graph node for the given entry, rebuilding the
+    * graph first if it is out of date.
+    */
+   DepNode& getDepNode(RegistryEntryPtr entry);
+
+   /**
+    * (Re)builds \c mDepGraph from the current registry entries. All cycle
+    * detection and dependency resolution happens here.
+    */
+   void buildDependencyGraph();
+
+   void visitDepNode(DepNode& node, std::vector<std::string>& path);
+
+   void collectDeps(const DepNode& node, std::vector<const DepNode*>& order,
+                    std::map<std::string, bool>& visited);
+
+   dep_graph_type mDepGraph;
+   bool           mDepGraphDirty;
+   //@}
 
    /** @name The Registry */
    //@{
    typedef std::map<std::string, RegistryEntryPtr> registry_type;
    registry_type mRegistry;
 
+   /**
+    * Registry entries indexed by base name. Each list is sorted by
+    * increasing version.
+    */
+   typedef std::map<std::string, std::vector<RegistryEntryPtr> >
+      entry_index_type;
+   entry_index_type mEntryIndex;
+
    std::map<std::string, AbstractPluginPtr> mNamedInstances;
    std::multimap<std::string, AbstractPluginPtr> mInstantiated;
-   std::vector<std::string> mInProgress;
+
+   /**
+    * Plug-in instances indexed by base name. Each list is sorted by
+    * increasing version.
+    */
+   typedef std::map<std::string, std::vector<AbstractPluginPtr> >
+      instance_index_type;
+   instance_index_type mInstanceIndex;
    //@}
 
    /** @name Signals */
@@ -40,6 +40,11 @@ RegistryEntry::~RegistryEntry()
 {
 }
 
+void RegistryEntry::initialize(AbstractPluginPtr)
+{
+   /* Do nothing. */ ;
+}
+
 CreatorBase*
 RegistryEntry::getCreatorFunc(vpr::LibraryPtr module,
                               const std::string& getCreatorFuncName)
@@ -63,8 +63,34 @@ public:
       return mModule;
    }
 
+   /**
+    * Creates and initializes a new instance of the plug-in type associated
+    * with this entry.
+    */
    virtual AbstractPluginPtr create() = 0;
 
+   /**
+    * Creates a new instance of the plug-in type associated with this entry
+    * without performing any post-creation initialization. Together with
+    * initialize(), this splits create() into two steps so that the (usually
+    * expensive) initialization step can be scheduled separately.
+    *
+    * @see initialize()
+    *
+    * @since 0.51.5
+    */
+   virtual AbstractPluginPtr allocate() = 0;
+
+   /**
+    * Performs the post-creation initialization of a plug-in instance
+    * returned by allocate(). This implementation does nothing.
+    *
+    * @param plugin The plug-in instance to initialize.
+    *
+    * @since 0.51.5
+    */
+   virtual void initialize(AbstractPluginPtr plugin);
+
 protected:
    CreatorBase* getCreatorFunc(
       vpr::LibraryPtr module, const std::string& getCreatorFuncName
@@ -174,6 +174,19 @@ public:
       /* Do nothing. */ ;
    }
 
+   /**
+    * Invokes the post-creation initialization callable on the given plug-in
+    * instance.
+    *
+    * @pre \p plugin was returned by allocate().
+    *
+    * @since 0.51.5
+    */
+   virtual void initialize(AbstractPluginPtr plugin)
+   {
+      mInitFunc(boost::dynamic_pointer_cast<T>(plugin));
+   }
+
 private:
    virtual typename base_type::plugin_ptr_type doCreate()
    {
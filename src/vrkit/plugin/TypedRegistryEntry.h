@@ -168,6 +168,17 @@ public:
       return doCreate();
    }
 
+   /**
+    * Creates a new plug-in instance. Unlike create(), subclass
+    * customizations of the instantiation behavior are bypassed.
+    *
+    * @since 0.51.5
+    */
+   virtual AbstractPluginPtr allocate()
+   {
+      return TypedRegistryEntry<T>::doCreate();
+   }
+
 protected:
    Creator<T>* getCreator() const
    {
@@ -0,0 +1,119 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_PLUGIN_DATA_SLOT_H_
+#define _VRKIT_PLUGIN_DATA_SLOT_H_
+
+#include <vrkit/Config.h>
+
+#include <cstddef>
+
+
+namespace vrkit
+{
+
+namespace plugin
+{
+
+class Data;
+
+namespace data
+{
+
+class TypeDesc;
+
+/**
+ * A resolved, typed handle to a data member of a dynamically defined plug-in
+ * data type. A slot is obtained by name from vrkit::plugin::data::TypeDesc
+ * (or vrkit::plugin::Data) once, typically when a plug-in is initialized.
+ * The name lookup and type check happen at that time so that accessing the
+ * data member through the slot afterwards is a direct, constant-time
+ * operation.
+ *
+ * A slot is valid for every instance of the type description from which it
+ * was resolved. A default-constructed slot is invalid and must not be used
+ * for data member access.
+ *
+ * @see vrkit::plugin::data::TypeDesc::getSlot()
+ * @see vrkit::plugin::Data::get()
+ * @see vrkit::plugin::Data::set()
+ *
+ * @since 0.51.6
+ */
+template<typename T>
+class Slot
+{
+public:
+   Slot()
+      : mIndex(invalid_index)
+      , mOffset(0)
+   {
+      /* Do nothing. */ ;
+   }
+
+   /**
+    * Indicates whether this slot was resolved from a type description.
+    */
+   bool isValid() const
+   {
+      return mIndex != invalid_index;
+   }
+
+   /**
+    * Returns the position of the data member within its type description.
+    */
+   unsigned int getIndex() const
+   {
+      return mIndex;
+   }
+
+   /**
+    * Returns the location of the data member value within the storage of a
+    * vrkit::plugin::Data instance. For strings, this is an index into the
+    * string table. For all other types, it is a byte offset.
+    */
+   std::size_t getOffset() const
+   {
+      return mOffset;
+   }
+
+private:
+   Slot(const unsigned int index, const std::size_t offset)
+      : mIndex(index)
+      , mOffset(offset)
+   {
+      /* Do nothing. */ ;
+   }
+
+   friend class TypeDesc;
+   friend class vrkit::plugin::Data;
+
+   static const unsigned int invalid_index = ~0u;
+
+   unsigned int mIndex;
+   std::size_t  mOffset;
+};
+
+}
+
+}
+
+}
+
+
+#endif /* _VRKIT_PLUGIN_DATA_SLOT_H_ */
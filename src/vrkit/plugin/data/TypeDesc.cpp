@@ -19,7 +19,6 @@
 #include <vrkit/Config.h>
 
 #include <sstream>
-#include <algorithm>
 
 #include <vrkit/Exception.h>
 #include <vrkit/plugin/data/ValueDesc.h>
@@ -36,6 +35,8 @@ namespace data
 {
 
 TypeDesc::TypeDesc(cppdom::NodePtr decl)
+   : mStorageSize(0)
+   , mNumStrings(0)
 {
    cppdom::Attribute id_attr = decl->getAttribute(tokens::id_attr);
    mID = vpr::GUID(id_attr.getValue<std::string>());
@@ -132,27 +133,109 @@ TypeDesc::TypeDesc(cppdom::NodePtr decl)
                                          vpr::GUID(pointee_type)));
       }
    }
+
+   computeLayout();
 }
 
 const ValueDesc& TypeDesc::getValueDesc(const std::string& name) const
 {
-   typedef std::vector<ValueDesc>::const_iterator iter_type;
-   MemberNamePredicate pred(name);
-   iter_type i = std::find_if(mValueDescs.begin(), mValueDescs.end(), pred);
+   return mValueDescs[getSlotIndex(name)];
+}
+
+unsigned int TypeDesc::getSlotIndex(const std::string& name) const
+{
+   std::map<std::string, unsigned int>::const_iterator i =
+      mSlotIndex.find(name);
 
-   if ( i == mValueDescs.end() )
+   if ( i == mSlotIndex.end() )
    {
       std::ostringstream msg_stream;
       msg_stream << "No matching value named '" << name << "'";
       throw vrkit::Exception(msg_stream.str(), VRKIT_LOCATION);
    }
 
-   return *i;
+   return (*i).second;
+}
+
+namespace
+{
+
+/**
+ * Returns the number of bytes used by a non-string data member of the given
+ * type. Strings are not stored in the byte buffer, so their size is 0.
+ */
+std::size_t getValueSize(const ValueType type)
+{
+   switch ( type )
+   {
+      case BOOL_VALUE:
+         return sizeof(bool);
+      case UINT8_VALUE:
+      case INT8_VALUE:
+         return 1;
+      case UINT16_VALUE:
+      case INT16_VALUE:
+         return 2;
+      case UINT32_VALUE:
+      case INT32_VALUE:
+         return 4;
+      case UINT64_VALUE:
+      case INT64_VALUE:
+      case POINTER_VALUE:
+         return 8;
+      case FLOAT_VALUE:
+         return sizeof(float);
+      case DOUBLE_VALUE:
+         return sizeof(double);
+      default:
+         return 0;
+   }
+}
+
+}
+
+void TypeDesc::computeLayout()
+{
+   typedef std::vector<ValueDesc>::iterator iter_type;
+
+   mSlotIndex.clear();
+   mStorageSize = 0;
+   mNumStrings  = 0;
+
+   for ( iter_type v = mValueDescs.begin(); v != mValueDescs.end(); ++v )
+   {
+      mSlotIndex[(*v).getName()] = v - mValueDescs.begin();
+
+      if ( (*v).getType() == STRING_VALUE )
+      {
+         (*v).mOffset = mNumStrings++;
+      }
+   }
+
+   // Pack the largest values first. Every value size is a power of two no
+   // larger than 8, so this keeps every value naturally aligned without any
+   // padding (given that the buffer itself is 8-byte aligned).
+   for ( std::size_t size = 8; size > 0; size /= 2 )
+   {
+      for ( iter_type v = mValueDescs.begin(); v != mValueDescs.end(); ++v )
+      {
+         if ( (*v).getType() != STRING_VALUE &&
+              getValueSize((*v).getType()) == size )
+         {
+            (*v).mOffset  = mStorageSize;
+            mStorageSize += size;
+         }
+      }
+   }
 }
 
-bool TypeDesc::MemberNamePredicate::operator()(const ValueDesc& d)
+void TypeDesc::throwTypeMismatch(const ValueDesc& desc,
+                                 const std::type_info& accessType)
 {
-   return d.getName() == mName;
+   std::ostringstream msg_stream;
+   msg_stream << "Data member '" << desc.getName()
+              << "' cannot be accessed as type " << accessType.name();
+   throw vrkit::Exception(msg_stream.str(), VRKIT_LOCATION);
 }
 
 }
@@ -21,8 +21,11 @@
 
 #include <vrkit/Config.h>
 
+#include <cstddef>
 #include <string>
 #include <vector>
+#include <map>
+#include <typeinfo>
 #include <boost/algorithm/string/case_conv.hpp>
 
 #include <cppdom/cppdom.h>
@@ -30,7 +33,9 @@
 #include <vpr/vprTypes.h>
 #include <vpr/Util/GUID.h>
 
+#include <vrkit/plugin/data/ValueTraits.h>
 #include <vrkit/plugin/data/ValueDesc.h>
+#include <vrkit/plugin/data/Slot.h>
 
 
 namespace vrkit
@@ -75,6 +80,14 @@ const std::string string_value("string");
  * type. Once constructed, an instance of this type is composed of one or
  * more vrkit::plugin::data::ValueDesc objects.
  *
+ * Each data member is assigned a fixed slot in declaration order and a fixed
+ * location within the storage of vrkit::plugin::Data instances. Non-string
+ * members are packed into a single byte buffer (largest types first, so no
+ * padding is needed), and strings are kept in a separate table. Plug-ins
+ * that access data members frequently should resolve a
+ * vrkit::plugin::data::Slot once using getSlot() rather than naming the data
+ * member on every access.
+ *
  * @see vrkit::plugin::Data
  * @see vrkit::plugin::data::ValueDesc
  *
@@ -137,23 +150,100 @@ public:
     */
    const ValueDesc& getValueDesc(const std::string& name) const;
 
-private:
+   /** @name Slot Access */
+   //@{
+   /**
+    * Returns the number of data members (and thus slots) in this type.
+    *
+    * @since 0.51.6
+    */
+   unsigned int getNumValues() const
+   {
+      return mValueDescs.size();
+   }
+
+   /**
+    * Returns the value description for the data member in the given slot.
+    *
+    * @pre \p slot is less than getNumValues().
+    *
+    * @since 0.51.6
+    */
+   const ValueDesc& getValueDesc(const unsigned int slot) const
+   {
+      return mValueDescs[slot];
+   }
+
    /**
-    * Simple predicate for use with STL algorithms when it is necessary to
-    * find an instance of vrkit::plugin::data::ValueDesc based on its name.
+    * Returns the slot index of the named data member.
+    *
+    * @throw vrkit::Exception
+    *           Thrown if \p name does not match the name of any of the
+    *           value descriptions held by this type descrption.
+    *
+    * @since 0.51.6
+    */
+   unsigned int getSlotIndex(const std::string& name) const;
+
+   /**
+    * Resolves the named data member to a typed slot that can be used for
+    * repeated access to that data member in any instance of this type.
+    *
+    * @param name The name of the data member.
+    *
+    * @throw vrkit::Exception
+    *           Thrown if \p name does not match the name of any of the
+    *           value descriptions held by this type descrption.
+    *           Thrown if the named data member cannot be accessed as the C++
+    *           type \p T.
+    *
+    * @since 0.51.6
     */
-   struct MemberNamePredicate
+   template<typename T>
+   Slot<T> getSlot(const std::string& name) const
    {
-      MemberNamePredicate(const std::string& name)
-         : mName(name)
+      const unsigned int index = getSlotIndex(name);
+      const ValueDesc& desc    = mValueDescs[index];
+
+      if ( ! isAccessibleAs(desc.getType(), ValueTraits<T>::type) )
       {
-         /* Do nothing. */ ;
+         throwTypeMismatch(desc, typeid(T));
       }
 
-      bool operator()(const ValueDesc& d);
+      return Slot<T>(index, desc.getOffset());
+   }
+
+   /**
+    * Returns the number of bytes needed to store all the non-string data
+    * members of this type.
+    *
+    * @since 0.51.6
+    */
+   std::size_t getStorageSize() const
+   {
+      return mStorageSize;
+   }
+
+   /**
+    * Returns the number of string data members of this type.
+    *
+    * @since 0.51.6
+    */
+   unsigned int getNumStrings() const
+   {
+      return mNumStrings;
+   }
+   //@}
 
-      std::string mName;
-   };
+private:
+   /**
+    * Assigns the storage location of each data member and builds the
+    * by-name slot index.
+    */
+   void computeLayout();
+
+   static void throwTypeMismatch(const ValueDesc& desc,
+                                 const std::type_info& accessType);
 
    /**
     * Returns the initial value for a data member based on the given XML
@@ -180,6 +270,12 @@ private:
    vpr::GUID mID;
 
    std::vector<ValueDesc> mValueDescs;
+
+   /** Slot indices of the data members, keyed by data member name. */
+   std::map<std::string, unsigned int> mSlotIndex;
+
+   std::size_t  mStorageSize;   /**< Bytes of non-string storage */
+   unsigned int mNumStrings;    /**< Number of string data members */
 };
 
 /**
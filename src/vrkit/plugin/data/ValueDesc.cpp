@@ -18,9 +18,78 @@
 
 #include <vrkit/Config.h>
 
+#include <typeinfo>
+
 #include <vrkit/plugin/data/ValueDesc.h>
 
 
+namespace
+{
+
+template<typename T>
+bool holds(const boost::any& value)
+{
+   return value.type() == typeid(T);
+}
+
+vrkit::plugin::data::ValueType getValueType(const boost::any& value)
+{
+   using namespace vrkit::plugin::data;
+
+   if ( holds<bool>(value) )
+   {
+      return BOOL_VALUE;
+   }
+   else if ( holds<vpr::Uint8>(value) )
+   {
+      return UINT8_VALUE;
+   }
+   else if ( holds<vpr::Int8>(value) )
+   {
+      return INT8_VALUE;
+   }
+   else if ( holds<vpr::Uint16>(value) )
+   {
+      return UINT16_VALUE;
+   }
+   else if ( holds<vpr::Int16>(value) )
+   {
+      return INT16_VALUE;
+   }
+   else if ( holds<vpr::Uint32>(value) )
+   {
+      return UINT32_VALUE;
+   }
+   else if ( holds<vpr::Int32>(value) )
+   {
+      return INT32_VALUE;
+   }
+   else if ( holds<vpr::Uint64>(value) )
+   {
+      return UINT64_VALUE;
+   }
+   else if ( holds<vpr::Int64>(value) )
+   {
+      return INT64_VALUE;
+   }
+   else if ( holds<float>(value) )
+   {
+      return FLOAT_VALUE;
+   }
+   else if ( holds<double>(value) )
+   {
+      return DOUBLE_VALUE;
+   }
+   else if ( holds<std::string>(value) )
+   {
+      return STRING_VALUE;
+   }
+
+   return INVALID_VALUE;
+}
+
+}
+
 namespace vrkit
 {
 
@@ -33,6 +102,8 @@ namespace data
 ValueDesc::ValueDesc(const std::string& name, const boost::any& initValue)
    : mName(name)
    , mInitValue(initValue)
+   , mType(getValueType(initValue))
+   , mOffset(0)
 {
    /* Do nothing. */ ;
 }
@@ -42,6 +113,8 @@ ValueDesc::ValueDesc(const std::string& name, const boost::any& initValue,
    : mName(name)
    , mInitValue(initValue)
    , mPointeeType(pointeeType)
+   , mType(POINTER_VALUE)
+   , mOffset(0)
 {
    /* Do nothing. */ ;
 }
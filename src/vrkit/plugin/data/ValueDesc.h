@@ -21,11 +21,14 @@
 
 #include <vrkit/Config.h>
 
+#include <cstddef>
 #include <string>
 #include <boost/any.hpp>
 
 #include <vpr/Util/GUID.h>
 
+#include <vrkit/plugin/data/ValueTraits.h>
+
 
 namespace vrkit
 {
@@ -87,6 +90,32 @@ public:
       return mPointeeType;
    }
 
+   /**
+    * Returns the identifier for the C++ type of this data member. This is
+    * determined from the initial value or, for pointers, from the use of the
+    * pointer constructor.
+    *
+    * @since 0.51.6
+    */
+   ValueType getType() const
+   {
+      return mType;
+   }
+
+   /**
+    * Returns the location of this data member within the storage of a
+    * vrkit::plugin::Data instance. This is assigned by the owning type
+    * description.
+    *
+    * @see vrkit::plugin::data::Slot::getOffset()
+    *
+    * @since 0.51.6
+    */
+   std::size_t getOffset() const
+   {
+      return mOffset;
+   }
+
    /**
     * Determines if this data member accepts the given type identifier as a
     * pointee type. If this data member is not for a pointer, the "accepted"
@@ -98,6 +127,8 @@ public:
    }
 
 private:
+   friend class TypeDesc;
+
    std::string mName;           /**< The name of this data member */
    boost::any  mInitValue;      /**< The initial value of this data member */
 
@@ -107,6 +138,9 @@ private:
     * be a null GUID, which is not a valid type identifier.
     */
    vpr::GUID mPointeeType;
+
+   ValueType   mType;           /**< The C++ type of this data member */
+   std::size_t mOffset;         /**< Storage location (set by TypeDesc) */
 };
 
 }
@@ -0,0 +1,121 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_PLUGIN_DATA_VALUE_TRAITS_H_
+#define _VRKIT_PLUGIN_DATA_VALUE_TRAITS_H_
+
+#include <vrkit/Config.h>
+
+#include <string>
+
+#include <vpr/vprTypes.h>
+
+#include <vrkit/plugin/DataPtr.h>
+
+
+namespace vrkit
+{
+
+namespace plugin
+{
+
+namespace data
+{
+
+/**
+ * Identifiers for the C++ types that may be stored in a data member of a
+ * dynamically defined plug-in data type.
+ *
+ * @see vrkit::plugin::data::ValueTraits
+ *
+ * @since 0.51.6
+ */
+enum ValueType
+{
+   BOOL_VALUE,         /**< bool */
+   UINT8_VALUE,        /**< vpr::Uint8 */
+   INT8_VALUE,         /**< vpr::Int8 */
+   UINT16_VALUE,       /**< vpr::Uint16 */
+   INT16_VALUE,        /**< vpr::Int16 */
+   UINT32_VALUE,       /**< vpr::Uint32 */
+   INT32_VALUE,        /**< vpr::Int32 */
+   UINT64_VALUE,       /**< vpr::Uint64 */
+   INT64_VALUE,        /**< vpr::Int64 */
+   FLOAT_VALUE,        /**< float */
+   DOUBLE_VALUE,       /**< double */
+   STRING_VALUE,       /**< std::string */
+   POINTER_VALUE,      /**< vrkit::plugin::DataPtr */
+   INVALID_VALUE       /**< Not a type usable in a data member */
+};
+
+/**
+ * Maps a C++ type to its vrkit::plugin::data::ValueType identifier at compile
+ * time. Only the specializations of this template are usable; attempting to
+ * access a data member using any other C++ type results in a compile-time
+ * error.
+ *
+ * @since 0.51.6
+ */
+template<typename T>
+struct ValueTraits;
+
+#define VRKIT_PLUGIN_DATA_VALUE_TRAITS(CPP_TYPE, VALUE_TYPE)    \
+   template<>                                                  \
+   struct ValueTraits<CPP_TYPE>                                \
+   {                                                           \
+      static const ValueType type = VALUE_TYPE;                \
+   };
+
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(bool, BOOL_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Uint8, UINT8_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Int8, INT8_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Uint16, UINT16_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Int16, INT16_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Uint32, UINT32_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Int32, INT32_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Uint64, UINT64_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vpr::Int64, INT64_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(float, FLOAT_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(double, DOUBLE_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(std::string, STRING_VALUE)
+VRKIT_PLUGIN_DATA_VALUE_TRAITS(vrkit::plugin::DataPtr, POINTER_VALUE)
+
+#undef VRKIT_PLUGIN_DATA_VALUE_TRAITS
+
+/**
+ * Determines whether a data member declared with the type \p declared can be
+ * accessed using the C++ type identified by \p accessed. The types must
+ * match exactly except that a pointer data member may also be accessed as
+ * its raw pointer value (vrkit::plugin::data::TypeDesc::ptr_type).
+ *
+ * @since 0.51.6
+ */
+inline bool isAccessibleAs(const ValueType declared, const ValueType accessed)
+{
+   return declared == accessed ||
+          (declared == POINTER_VALUE && accessed == UINT64_VALUE);
+}
+
+}
+
+}
+
+}
+
+
+#endif /* _VRKIT_PLUGIN_DATA_VALUE_TRAITS_H_ */
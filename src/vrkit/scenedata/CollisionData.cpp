@@ -0,0 +1,220 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGTriangleIterator.h>
+#include <OpenSG/OSGDistanceLOD.h>
+#include <OpenSG/OSGSwitch.h>
+
+#include <vpr/Thread/Thread.h>
+#include <vpr/Sync/Guard.h>
+
+#include <vrkit/Scene.h>
+#include <vrkit/Status.h>
+#include <vrkit/scenedata/CollisionData.h>
+
+
+namespace
+{
+
+/**
+ * Appends the triangles of all the geometry below \p node, transformed by
+ * \p xform and the transformations below \p node, to \p vertices.
+ */
+void collectTriangles(OSG::NodePtr node, OSG::Matrix xform,
+                      std::vector<gmtl::Point3f>& vertices)
+{
+   if ( OSG::NullFC == node || node->getTravMask() == 0 )
+   {
+      return;
+   }
+
+   OSG::NodeCorePtr core = node->getCore();
+
+   if ( OSG::NullFC != core )
+   {
+      core->accumulateMatrix(xform);
+
+#if OSG_MAJOR_VERSION < 2
+      OSG::GeometryPtr geom = OSG::GeometryPtr::dcast(core);
+#else
+      OSG::GeometryPtr geom = OSG::cast_dynamic<OSG::GeometryPtr>(core);
+#endif
+
+      if ( OSG::NullFC != geom )
+      {
+         for ( OSG::TriangleIterator t = geom->beginTriangles();
+               t != geom->endTriangles();
+               ++t )
+         {
+            for ( OSG::Int32 v = 0; v < 3; ++v )
+            {
+               OSG::Pnt3f pos(t.getPosition(v));
+#if OSG_MAJOR_VERSION < 2
+               xform.multFullMatrixPnt(pos);
+#else
+               xform.multFull(pos, pos);
+#endif
+               vertices.push_back(gmtl::Point3f(pos[0], pos[1], pos[2]));
+            }
+         }
+      }
+   }
+
+   OSG::UInt32 num_children(node->getNChildren());
+
+   // Only the most detailed level of a distance LOD node is collided with.
+#if OSG_MAJOR_VERSION < 2
+   if ( OSG::NullFC != OSG::DistanceLODPtr::dcast(core) )
+#else
+   if ( OSG::NullFC != OSG::cast_dynamic<OSG::DistanceLODPtr>(core) )
+#endif
+   {
+      num_children = std::min(num_children, OSG::UInt32(1));
+   }
+
+   // Only the child chosen by a switch node is shown, so it is the only one
+   // that is collided with.
+#if OSG_MAJOR_VERSION < 2
+   OSG::SwitchPtr switch_core = OSG::SwitchPtr::dcast(core);
+#else
+   OSG::SwitchPtr switch_core = OSG::cast_dynamic<OSG::SwitchPtr>(core);
+#endif
+
+   if ( OSG::NullFC != switch_core &&
+        OSG::Switch::ALL != switch_core->getChoice() )
+   {
+      const OSG::Int32 choice(switch_core->getChoice());
+
+      if ( choice >= 0 && OSG::UInt32(choice) < num_children )
+      {
+         collectTriangles(node->getChild(choice), xform, vertices);
+      }
+
+      return;
+   }
+
+   for ( OSG::UInt32 c = 0; c < num_children; ++c )
+   {
+      collectTriangles(node->getChild(c), xform, vertices);
+   }
+}
+
+}
+
+namespace vrkit
+{
+
+const vpr::GUID
+CollisionData::type_guid("6b8e2a94-5c1d-4f37-9e0a-3d71c2b84f15");
+
+CollisionData::CollisionData()
+   : mBVH(new util::TriangleBVH())
+   , mValid(false)
+   , mBuilder(NULL)
+{
+   /* Do nothing. */ ;
+}
+
+CollisionData::~CollisionData()
+{
+   // A build in progress cannot be interrupted, so we have to wait for it.
+   if ( NULL != mBuilder )
+   {
+      mBuilder->join();
+      delete mBuilder;
+      mBuilder = NULL;
+   }
+}
+
+CollisionData::bvh_ptr_type CollisionData::getBVH(ScenePtr scene)
+{
+   if ( NULL != mBuilder )
+   {
+      boost::shared_ptr<util::TriangleBVH> built_bvh;
+
+      {
+         vpr::Guard<vpr::Mutex> guard(mBuildLock);
+         built_bvh.swap(mBuiltBVH);
+      }
+
+      if ( built_bvh )
+      {
+         mBuilder->join();
+         delete mBuilder;
+         mBuilder = NULL;
+
+         mBVH = built_bvh;
+
+         VRKIT_STATUS << "Built collision hierarchy over "
+                      << mBVH->getNumTriangles() << " triangle(s) in "
+                      << (vpr::Interval::now() - mBuildStart).msec() << " ms"
+                      << std::endl;
+      }
+   }
+
+   // If the scene changed while a build was running, another build is
+   // started once the running build completes.
+   if ( ! mValid && NULL == mBuilder )
+   {
+      startBuild(scene);
+   }
+
+   return mBVH;
+}
+
+void CollisionData::invalidate()
+{
+   mValid = false;
+}
+
+void CollisionData::startBuild(ScenePtr scene)
+{
+   mBuildStart = vpr::Interval::now();
+
+   // The scene graph may only be read from this thread, so the triangles are
+   // gathered here. The children of the transform root are in virtual world
+   // coordinates, so the transformation of the root itself is skipped.
+   OSG::NodePtr root = scene->getTransformRoot().node();
+   mVertices.clear();
+
+   const OSG::UInt32 num_children(root->getNChildren());
+   for ( OSG::UInt32 c = 0; c < num_children; ++c )
+   {
+      collectTriangles(root->getChild(c), OSG::Matrix(), mVertices);
+   }
+
+   mValid   = true;
+   mBuilder = new vpr::Thread(boost::bind(&CollisionData::build, this));
+}
+
+void CollisionData::build()
+{
+   boost::shared_ptr<util::TriangleBVH> bvh(new util::TriangleBVH());
+   bvh->build(mVertices);
+   std::vector<gmtl::Point3f>().swap(mVertices);
+
+   vpr::Guard<vpr::Mutex> guard(mBuildLock);
+   mBuiltBVH = bvh;
+}
+
+}
@@ -0,0 +1,146 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_COLLISION_DATA_H_
+#define _VRKIT_COLLISION_DATA_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include <gmtl/Point.h>
+
+#include <vpr/vpr.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrkit/ScenePtr.h>
+#include <vrkit/SceneData.h>
+#include <vrkit/util/TriangleBVH.h>
+#include <vrkit/scenedata/CollisionDataPtr.h>
+
+
+namespace vpr
+{
+   class Thread;
+}
+
+namespace vrkit
+{
+
+/** \class CollisionData CollisionData.h vrkit/scenedata/CollisionData.h
+ *
+ * Provides a single, shared bounding volume hierarchy over the geometry of
+ * the scene for navigation code that needs to keep the view platform from
+ * passing through the scene. The hierarchy is built the first time that it
+ * is requested and is reused until invalidate() is called. Geometry that
+ * moves after the hierarchy is built (such as a grabbed object) is
+ * collided with at its original position.
+ *
+ * Building the hierarchy over a large scene takes seconds, so it is done by
+ * a background thread. Only the triangles are gathered from the scene on the
+ * calling thread. Until the build completes, the previous hierarchy (or an
+ * empty one if there is none) continues to be returned.
+ *
+ * @see vrkit::nav::Collider
+ *
+ * @since 0.51.15
+ */
+class VRKIT_CLASS_API CollisionData : public SceneData
+{
+private:
+   CollisionData();
+
+public:
+   static const vpr::GUID type_guid;
+
+   typedef boost::shared_ptr<const util::TriangleBVH> bvh_ptr_type;
+
+   static CollisionDataPtr create()
+   {
+      return CollisionDataPtr(new CollisionData());
+   }
+
+   virtual ~CollisionData();
+
+   /**
+    * Returns the hierarchy over the geometry below the transform root of the
+    * given scene. The triangles are in virtual world coordinates. Nodes whose
+    * traversal mask is 0 are ignored, as are the children of switch nodes
+    * that are not shown. This must be invoked from the application thread.
+    *
+    * @post If the hierarchy had not been built or if it was invalidated, a
+    *       build of a new hierarchy is started in the background unless one
+    *       is already running. If a background build has completed, its
+    *       hierarchy replaces the current one.
+    *
+    * @return The most recently built hierarchy. This is never NULL, but it is
+    *         empty until the first build completes. The returned hierarchy is
+    *         not modified by later builds.
+    */
+   bvh_ptr_type getBVH(ScenePtr scene);
+
+   /**
+    * Marks the current hierarchy as out of date so that a new hierarchy is
+    * built from the scene the next time that getBVH() is called. The current
+    * hierarchy is used until the new one is ready. This should be called from
+    * the application thread when models are added to or removed from the
+    * scene.
+    */
+   void invalidate();
+
+   /**
+    * Indicates whether a new hierarchy is being built in the background.
+    */
+   bool isBuilding() const
+   {
+      return NULL != mBuilder;
+   }
+
+private:
+   /**
+    * Starts a background build of a new hierarchy over the current geometry
+    * of the given scene.
+    */
+   void startBuild(ScenePtr scene);
+
+   /**
+    * The body of the background build thread.
+    */
+   void build();
+
+   bvh_ptr_type mBVH;           /**< The hierarchy used for queries */
+   bool         mValid;
+
+   /** @name Background Build */
+   //@{
+   vpr::Thread*               mBuilder;
+   vpr::Interval              mBuildStart;
+   std::vector<gmtl::Point3f> mVertices;        /**< Input of the build */
+
+   vpr::Mutex                           mBuildLock;
+   boost::shared_ptr<util::TriangleBVH> mBuiltBVH;      /**< Build output */
+   //@}
+};
+
+}
+
+
+#endif /* _VRKIT_COLLISION_DATA_H_ */
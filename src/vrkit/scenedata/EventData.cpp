@@ -16,6 +16,8 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+
 #include <vrkit/scenedata/EventData.h>
 
 
@@ -25,6 +27,8 @@ namespace vrkit
 const vpr::GUID EventData::type_guid("b72a43c0-3001-4841-8bfb-5d775f01cc16");
 
 EventData::EventData()
+   : mQueued(false)
+   , mSuppressedMoves(0)
 {
    /* Do nothing. */ ;
 }
@@ -34,4 +38,345 @@ EventData::~EventData()
    /* Do nothing. */ ;
 }
 
+void EventData::setQueued(const bool queued)
+{
+   if ( mQueued && ! queued )
+   {
+      dispatchEvents();
+   }
+
+   mQueued = queued;
+}
+
+void EventData::postObjectsMoved(const moved_obj_list_t& objs)
+{
+   if ( ! mQueued )
+   {
+      objectsMoved(objs);
+      return;
+   }
+
+   EventQueue& q(mPendingEvents);
+
+   // Merge consecutive movement events. The moves of the last event are
+   // always at the end of the move list, so the merged list stays
+   // contiguous.
+   if ( ! q.events.empty() && q.events.back().type == OBJECTS_MOVED &&
+        ! q.events.back().cancelled )
+   {
+      QueuedEvent& last(q.events.back());
+
+      moved_obj_list_t::const_iterator o;
+      for ( o = objs.begin(); o != objs.end(); ++o )
+      {
+         const moved_obj_list_t::iterator begin = q.moves.begin() + last.first;
+         moved_obj_list_t::iterator m;
+         for ( m = begin; m != q.moves.end(); ++m )
+         {
+            if ( (*m).first == (*o).first )
+            {
+               (*m).second = (*o).second;
+               break;
+            }
+         }
+
+         if ( m == q.moves.end() )
+         {
+            q.moves.push_back(*o);
+            ++last.count;
+         }
+      }
+   }
+   else
+   {
+      QueuedEvent e;
+      e.type      = OBJECTS_MOVED;
+      e.cancelled = false;
+      e.first     = q.moves.size();
+      e.count     = objs.size();
+      q.events.push_back(e);
+      q.moves.insert(q.moves.end(), objs.begin(), objs.end());
+   }
+}
+
+void EventData::postObjectIntersected(SceneObjectPtr obj,
+                                      const gmtl::Point3f& pnt)
+{
+   if ( ! mQueued )
+   {
+      objectIntersected(obj, pnt);
+   }
+   else
+   {
+      postSingle(OBJECT_INTERSECTED, obj, pnt);
+   }
+}
+
+void EventData::postObjectDeintersected(SceneObjectPtr obj)
+{
+   if ( ! mQueued )
+   {
+      objectDeintersected(obj);
+   }
+   else if ( ! cancelPending(OBJECT_INTERSECTED, obj) )
+   {
+      postSingle(OBJECT_DEINTERSECTED, obj);
+   }
+}
+
+void EventData::postObjectsSelected(const std::vector<SceneObjectPtr>& objs)
+{
+   if ( ! mQueued )
+   {
+      objectsSelected(objs);
+   }
+   else
+   {
+      postMulti(OBJECTS_SELECTED, objs);
+   }
+}
+
+void EventData::postObjectsDeselected(const std::vector<SceneObjectPtr>& objs)
+{
+   if ( ! mQueued )
+   {
+      objectsDeselected(objs);
+   }
+   else
+   {
+      postMulti(OBJECTS_DESELECTED, objs);
+   }
+}
+
+void EventData::
+postSelectionListExpanded(const std::vector<SceneObjectPtr>& objs)
+{
+   if ( ! mQueued )
+   {
+      selectionListExpanded(objs);
+   }
+   else
+   {
+      postMulti(SELECTION_LIST_EXPANDED, objs);
+   }
+}
+
+void EventData::
+postSelectionListReduced(const std::vector<SceneObjectPtr>& objs)
+{
+   if ( ! mQueued )
+   {
+      selectionListReduced(objs);
+   }
+   else
+   {
+      postMulti(SELECTION_LIST_REDUCED, objs);
+   }
+}
+
+void EventData::postObjectPicked(SceneObjectPtr obj)
+{
+   if ( ! mQueued )
+   {
+      objectPicked(obj);
+   }
+   else
+   {
+      postSingle(OBJECT_PICKED, obj);
+   }
+}
+
+void EventData::postObjectUnpicked(SceneObjectPtr obj)
+{
+   if ( ! mQueued )
+   {
+      objectUnpicked(obj);
+   }
+   else if ( ! cancelPending(OBJECT_PICKED, obj) )
+   {
+      postSingle(OBJECT_UNPICKED, obj);
+   }
+}
+
+void EventData::dispatchEvents()
+{
+   if ( mPendingEvents.events.empty() )
+   {
+      return;
+   }
+
+   // Events posted by the slots go into the (now empty) pending queue.
+   mPendingEvents.swap(mDispatchEvents);
+   dispatch(mDispatchEvents);
+   mDispatchEvents.clear();
+}
+
+void EventData::EventQueue::swap(EventQueue& other)
+{
+   events.swap(other.events);
+   objs.swap(other.objs);
+   moves.swap(other.moves);
+}
+
+void EventData::EventQueue::clear()
+{
+   // clear() keeps the capacity of the vectors, so the storage is reused by
+   // the next frame.
+   events.clear();
+   objs.clear();
+   moves.clear();
+}
+
+void EventData::postSingle(const EventType type, SceneObjectPtr obj,
+                           const gmtl::Point3f& pnt)
+{
+   QueuedEvent e;
+   e.type      = type;
+   e.cancelled = false;
+   e.obj       = obj;
+   e.point     = pnt;
+   e.first     = 0;
+   e.count     = 0;
+   mPendingEvents.events.push_back(e);
+}
+
+void EventData::postMulti(const EventType type,
+                          const std::vector<SceneObjectPtr>& objs)
+{
+   EventQueue& q(mPendingEvents);
+
+   QueuedEvent e;
+   e.type      = type;
+   e.cancelled = false;
+   e.first     = q.objs.size();
+   e.count     = objs.size();
+   q.events.push_back(e);
+   q.objs.insert(q.objs.end(), objs.begin(), objs.end());
+}
+
+bool EventData::cancelPending(const EventType type, SceneObjectPtr obj)
+{
+   EventQueue& q(mPendingEvents);
+
+   typedef std::vector<QueuedEvent>::reverse_iterator iter_type;
+   for ( iter_type e = q.events.rbegin(); e != q.events.rend(); ++e )
+   {
+      if ( (*e).cancelled )
+      {
+         continue;
+      }
+
+      bool involves_obj(false);
+
+      if ( isSingleObjectEvent((*e).type) )
+      {
+         involves_obj = (*e).obj == obj;
+      }
+      else if ( (*e).type == OBJECTS_MOVED )
+      {
+         for ( std::size_t i = 0; i < (*e).count; ++i )
+         {
+            if ( q.moves[(*e).first + i].first == obj )
+            {
+               involves_obj = true;
+               break;
+            }
+         }
+      }
+      else
+      {
+         const std::vector<SceneObjectPtr>::iterator begin =
+            q.objs.begin() + (*e).first;
+         involves_obj =
+            std::find(begin, begin + (*e).count, obj) != begin + (*e).count;
+      }
+
+      // The most recent event involving obj decides. Only a matching event
+      // can be cancelled; anything else between the two events would be
+      // observed differently if they were removed.
+      if ( involves_obj )
+      {
+         if ( (*e).type == type )
+         {
+            (*e).cancelled = true;
+            return true;
+         }
+
+         return false;
+      }
+   }
+
+   return false;
+}
+
+void EventData::dispatch(const EventQueue& queue)
+{
+   typedef std::vector<QueuedEvent>::const_iterator iter_type;
+   for ( iter_type e = queue.events.begin(); e != queue.events.end(); ++e )
+   {
+      if ( (*e).cancelled )
+      {
+         continue;
+      }
+
+      switch ( (*e).type )
+      {
+         case OBJECTS_MOVED:
+            // The common case is a single, merged movement event per frame.
+            // That can be emitted without copying the move list.
+            if ( (*e).first == 0 && (*e).count == queue.moves.size() )
+            {
+               objectsMoved(queue.moves);
+            }
+            else
+            {
+               mDispatchMoves.assign(
+                  queue.moves.begin() + (*e).first,
+                  queue.moves.begin() + (*e).first + (*e).count
+               );
+               objectsMoved(mDispatchMoves);
+            }
+            break;
+         case OBJECT_INTERSECTED:
+            objectIntersected((*e).obj, (*e).point);
+            break;
+         case OBJECT_DEINTERSECTED:
+            objectDeintersected((*e).obj);
+            break;
+         case OBJECT_PICKED:
+            objectPicked((*e).obj);
+            break;
+         case OBJECT_UNPICKED:
+            objectUnpicked((*e).obj);
+            break;
+         default:
+            mDispatchObjs.assign(
+               queue.objs.begin() + (*e).first,
+               queue.objs.begin() + (*e).first + (*e).count
+            );
+
+            if ( (*e).type == OBJECTS_SELECTED )
+            {
+               objectsSelected(mDispatchObjs);
+            }
+            else if ( (*e).type == OBJECTS_DESELECTED )
+            {
+               objectsDeselected(mDispatchObjs);
+            }
+            else if ( (*e).type == SELECTION_LIST_EXPANDED )
+            {
+               selectionListExpanded(mDispatchObjs);
+            }
+            else
+            {
+               selectionListReduced(mDispatchObjs);
+            }
+            break;
+      }
+   }
+
+   mDispatchObjs.clear();
+   mDispatchMoves.clear();
+}
+
 }
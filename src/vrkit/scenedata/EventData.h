@@ -21,9 +21,9 @@
 
 #include <vrkit/Config.h>
 
+#include <cstddef>
 #include <vector>
 #include <utility>
-#include <boost/signal.hpp>
 
 #include <vpr/vpr.h>
 #include <vpr/Util/GUID.h>
@@ -33,6 +33,7 @@
 
 #include <vrkit/SceneData.h>
 #include <vrkit/SceneObjectPtr.h>
+#include <vrkit/signal/Signal.h>
 #include <vrkit/scenedata/Event.h>
 #include <vrkit/scenedata/EventDataPtr.h>
 
@@ -44,6 +45,24 @@ namespace vrkit
  *
  * Contains event signals that you can register with to recieve events
  * when they are activated.
+ *
+ * Code that generates events should use the post methods (such as
+ * postObjectsMoved()) rather than emitting the signals directly. By default,
+ * posting an event emits the corresponding signal immediately. When queued
+ * mode is enabled (see setQueued()), posted events are instead appended to a
+ * per-frame queue whose storage is reused from frame to frame, and
+ * dispatchEvents() emits them in the order in which they were posted.
+ * vrkit::Viewer calls dispatchEvents() once per frame after all plug-ins
+ * have been updated. Before dispatch, the queue is coalesced:
+ *
+ *  - An intersection of an object followed by its de-intersection cancels
+ *    both events.
+ *  - A pick of an object followed by its unpick cancels both events.
+ *  - Consecutive object movement events are merged into one, and only the
+ *    last transformation posted for each object is kept.
+ *
+ * The signals use vrkit::event::ResultOperator in both modes, so a slot can
+ * still consume a queued event by returning vrkit::event::DONE.
  */
 class VRKIT_CLASS_API EventData : public SceneData
 {
@@ -68,10 +87,10 @@ public:
     * The type for signals whose slots take a single argument of type
     * vrkit::SceneObjectPtr.
     */
-   typedef boost::signal<event::ResultType (SceneObjectPtr),
-                         event::ResultOperator> basic_action_t;
-   typedef boost::signal<event::ResultType (const std::vector<SceneObjectPtr>&),
-                         event::ResultOperator> multi_obj_action_t;
+   typedef signal::Signal<event::ResultType (SceneObjectPtr),
+                          event::ResultOperator> basic_action_t;
+   typedef signal::Signal<event::ResultType (const std::vector<SceneObjectPtr>&),
+                          event::ResultOperator> multi_obj_action_t;
 
    /** @name Object Movement Data Types */
    //@{
@@ -90,8 +109,8 @@ public:
     *
     * @since 0.29.0
     */
-   typedef boost::signal<event::ResultType (const moved_obj_list_t&),
-                         event::ResultOperator>
+   typedef signal::Signal<event::ResultType (const moved_obj_list_t&),
+                          event::ResultOperator>
       obj_move_action_t;
    //@}
 
@@ -104,7 +123,7 @@ public:
     */
    obj_move_action_t objectsMoved;
 
-   typedef boost::signal<
+   typedef signal::Signal<
       event::ResultType(SceneObjectPtr, const gmtl::Point3f&),
       event::ResultOperator
    > obj_isect_action_t;
@@ -174,6 +193,214 @@ public:
     */
    basic_action_t objectUnpicked;
    //@}
+
+   /** @name Event Posting */
+   //@{
+   /**
+    * Enables or disables queued mode. When queued mode is disabled, any
+    * events still in the queue are dispatched immediately.
+    *
+    * @since 0.51.9
+    */
+   void setQueued(const bool queued);
+
+   /**
+    * Indicates whether posted events are queued for dispatchEvents().
+    *
+    * @since 0.51.9
+    */
+   bool isQueued() const
+   {
+      return mQueued;
+   }
+
+   /**
+    * Posts an event for \c objectsMoved.
+    *
+    * @since 0.51.9
+    */
+   void postObjectsMoved(const moved_obj_list_t& objs);
+
+   /**
+    * Posts an event for \c objectIntersected.
+    *
+    * @since 0.51.9
+    */
+   void postObjectIntersected(SceneObjectPtr obj, const gmtl::Point3f& pnt);
+
+   /**
+    * Posts an event for \c objectDeintersected.
+    *
+    * @since 0.51.9
+    */
+   void postObjectDeintersected(SceneObjectPtr obj);
+
+   /**
+    * Posts an event for \c objectsSelected.
+    *
+    * @since 0.51.9
+    */
+   void postObjectsSelected(const std::vector<SceneObjectPtr>& objs);
+
+   /**
+    * Posts an event for \c objectsDeselected.
+    *
+    * @since 0.51.9
+    */
+   void postObjectsDeselected(const std::vector<SceneObjectPtr>& objs);
+
+   /**
+    * Posts an event for \c selectionListExpanded.
+    *
+    * @since 0.51.9
+    */
+   void postSelectionListExpanded(const std::vector<SceneObjectPtr>& objs);
+
+   /**
+    * Posts an event for \c selectionListReduced.
+    *
+    * @since 0.51.9
+    */
+   void postSelectionListReduced(const std::vector<SceneObjectPtr>& objs);
+
+   /**
+    * Posts an event for \c objectPicked.
+    *
+    * @since 0.51.9
+    */
+   void postObjectPicked(SceneObjectPtr obj);
+
+   /**
+    * Posts an event for \c objectUnpicked.
+    *
+    * @since 0.51.9
+    */
+   void postObjectUnpicked(SceneObjectPtr obj);
+
+   /**
+    * Emits the signals for all queued events. Events posted by slots while
+    * this is dispatching are queued for the next call. If queued mode is not
+    * enabled, this does nothing.
+    *
+    * @since 0.51.9
+    */
+   void dispatchEvents();
+   //@}
+
+   /** @name Move Suppression Monitoring */
+   //@{
+   /**
+    * Records that the moves of \p count objects were not posted because
+    * the new transformations were the same as the last ones posted. Code
+    * that posts object moves calls this so that the number of avoided
+    * updates can be monitored.
+    *
+    * @since 0.51.20
+    */
+   void addSuppressedMoves(const std::size_t count)
+   {
+      mSuppressedMoves += count;
+   }
+
+   /**
+    * Returns the total number of object moves recorded through
+    * addSuppressedMoves().
+    *
+    * @since 0.51.20
+    */
+   std::size_t getSuppressedMoveCount() const
+   {
+      return mSuppressedMoves;
+   }
+
+   /**
+    * @since 0.51.20
+    */
+   void resetSuppressedMoveCount()
+   {
+      mSuppressedMoves = 0;
+   }
+   //@}
+
+private:
+   /** Identifies the signal for a queued event. */
+   enum EventType
+   {
+      OBJECTS_MOVED,
+      OBJECT_INTERSECTED,
+      OBJECT_DEINTERSECTED,
+      OBJECTS_SELECTED,
+      OBJECTS_DESELECTED,
+      SELECTION_LIST_EXPANDED,
+      SELECTION_LIST_REDUCED,
+      OBJECT_PICKED,
+      OBJECT_UNPICKED
+   };
+
+   /**
+    * A queued event. Multi-object payloads are stored in the object or move
+    * list of the queue as the range [first, first + count).
+    */
+   struct QueuedEvent
+   {
+      EventType      type;
+      bool           cancelled;
+      SceneObjectPtr obj;
+      gmtl::Point3f  point;
+      std::size_t    first;
+      std::size_t    count;
+   };
+
+   /** The storage for one frame of queued events. */
+   struct EventQueue
+   {
+      void swap(EventQueue& other);
+
+      void clear();
+
+      std::vector<QueuedEvent>    events;
+      std::vector<SceneObjectPtr> objs;
+      moved_obj_list_t            moves;
+   };
+
+   static bool isSingleObjectEvent(const EventType type)
+   {
+      return type == OBJECT_INTERSECTED || type == OBJECT_DEINTERSECTED ||
+             type == OBJECT_PICKED || type == OBJECT_UNPICKED;
+   }
+
+   void postSingle(const EventType type, SceneObjectPtr obj,
+                   const gmtl::Point3f& pnt = gmtl::Point3f());
+
+   void postMulti(const EventType type,
+                  const std::vector<SceneObjectPtr>& objs);
+
+   /**
+    * Cancels the most recent queued, uncancelled event of the given type
+    * for \p obj if no other event for \p obj was posted after it.
+    *
+    * @return \c true is returned if an event was cancelled.
+    */
+   bool cancelPending(const EventType type, SceneObjectPtr obj);
+
+   void dispatch(const EventQueue& queue);
+
+   bool mQueued;
+
+   std::size_t mSuppressedMoves;
+
+   /** @name Dispatch Scratch Storage */
+   //@{
+   std::vector<SceneObjectPtr> mDispatchObjs;
+   moved_obj_list_t            mDispatchMoves;
+   //@}
+
+   /**
+    * The queue being filled and the one being dispatched. They are swapped
+    * by dispatchEvents() so that the storage of both is reused.
+    */
+   EventQueue mPendingEvents;
+   EventQueue mDispatchEvents;
 };
 
 }
@@ -0,0 +1,149 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/External/OpenSGConvert.h>
+
+#include <OpenSG/OSGMatrix.h>
+
+#include <gadget/Type/PositionProxy.h>
+
+#include <vrkit/Scene.h>
+#include <vrkit/Viewer.h>
+#include <vrkit/User.h>
+#include <vrkit/paging/ChunkFile.h>
+#include <vrkit/scenedata/CollisionData.h>
+#include <vrkit/scenedata/PagingData.h>
+
+
+namespace vrkit
+{
+
+const vpr::GUID
+PagingData::type_guid("57f9a90d-42ac-4d02-a708-bcd1fd54d350");
+
+PagingData::PagingData()
+{
+   /* Do nothing. */ ;
+}
+
+PagingData::~PagingData()
+{
+   /* Do nothing. */ ;
+}
+
+void PagingData::addModel(paging::PagedModelPtr model)
+{
+   mModels.push_back(model);
+}
+
+void PagingData::removeModel(paging::PagedModelPtr model)
+{
+   mModels.erase(std::remove(mModels.begin(), mModels.end(), model),
+                 mModels.end());
+}
+
+void PagingData::update(ViewerPtr viewer)
+{
+   if ( mModels.empty() )
+   {
+      return;
+   }
+
+   // The scene graph is rooted in the view platform frame, so the head
+   // transformation is taken to the frame of each model by the inverse of
+   // the transformation of its root.
+   const float scale(viewer->getDrawScaleFactor());
+   OSG::Matrix vp_M_head;
+   gmtl::set(vp_M_head, viewer->getUser()->getHeadProxy()->getData(scale));
+
+   bool changed(false);
+
+   typedef std::vector<paging::PagedModelPtr>::iterator iter_type;
+   for ( iter_type m = mModels.begin(); m != mModels.end(); ++m )
+   {
+      OSG::Matrix model_M_head;
+      (*m)->getRoot()->getToWorld(model_M_head);
+      model_M_head.invert();
+      model_M_head.mult(vp_M_head);
+
+      OSG::Pnt3f eye(0.0f, 0.0f, 0.0f);
+      OSG::Vec3f view_dir(0.0f, 0.0f, -1.0f);
+#if OSG_MAJOR_VERSION < 2
+      model_M_head.multFullMatrixPnt(eye);
+      model_M_head.multMatrixVec(view_dir);
+#else
+      model_M_head.multFull(eye, eye);
+      model_M_head.mult(view_dir, view_dir);
+#endif
+      view_dir.normalize();
+
+      if ( (*m)->update(gmtl::Point3f(eye[0], eye[1], eye[2]),
+                        gmtl::Vec3f(view_dir[0], view_dir[1], view_dir[2])) )
+      {
+         changed = true;
+      }
+   }
+
+   // Navigation has to collide with the chunks that are now in the scene.
+   if ( changed )
+   {
+      ScenePtr scene = viewer->getSceneObj();
+      scene->getSceneData<CollisionData>()->invalidate();
+   }
+}
+
+paging::PagedModel::Stats PagingData::getStats() const
+{
+   paging::PagedModel::Stats stats;
+
+   typedef std::vector<paging::PagedModelPtr>::const_iterator iter_type;
+   for ( iter_type m = mModels.begin(); m != mModels.end(); ++m )
+   {
+      stats.add((*m)->getStats());
+   }
+
+   return stats;
+}
+
+void PagingData::writeSelections(OSG::BinaryDataHandler& writer) const
+{
+   writer.putValue(OSG::UInt32(mModels.size()));
+
+   typedef std::vector<paging::PagedModelPtr>::const_iterator iter_type;
+   for ( iter_type m = mModels.begin(); m != mModels.end(); ++m )
+   {
+      writer.putValue((*m)->getName());
+      writer.putValue(
+         (*m)->getChunkFile()->getPath().native_file_string()
+      );
+
+      const std::vector<vpr::Uint32>& chunks((*m)->getSelectedChunks());
+      writer.putValue(OSG::UInt32(chunks.size()));
+
+      typedef std::vector<vpr::Uint32>::const_iterator chunk_iter_type;
+      for ( chunk_iter_type c = chunks.begin(); c != chunks.end(); ++c )
+      {
+         writer.putValue(OSG::UInt32(*c));
+      }
+   }
+}
+
+}
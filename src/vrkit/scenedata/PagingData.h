@@ -0,0 +1,107 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_PAGING_DATA_H_
+#define _VRKIT_PAGING_DATA_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+
+#include <OpenSG/OSGBinaryDataHandler.h>
+
+#include <vpr/vpr.h>
+#include <vpr/Util/GUID.h>
+
+#include <vrkit/ViewerPtr.h>
+#include <vrkit/SceneData.h>
+#include <vrkit/paging/PagedModel.h>
+#include <vrkit/scenedata/PagingDataPtr.h>
+
+
+namespace vrkit
+{
+
+/** \class PagingData PagingData.h vrkit/scenedata/PagingData.h
+ *
+ * Keeps track of the paged models in the scene. vrkit::Viewer updates the
+ * registered models once per frame from the head position of the user,
+ * and it sends their chunk selections to the cluster slaves.
+ *
+ * @see vrkit::paging::PagedModel
+ *
+ * @since 0.51.28
+ */
+class VRKIT_CLASS_API PagingData : public SceneData
+{
+private:
+   PagingData();
+
+public:
+   static const vpr::GUID type_guid;
+
+   static PagingDataPtr create()
+   {
+      return PagingDataPtr(new PagingData());
+   }
+
+   virtual ~PagingData();
+
+   /**
+    * Registers the given paged model. Its root should be in the scene.
+    */
+   void addModel(paging::PagedModelPtr model);
+
+   void removeModel(paging::PagedModelPtr model);
+
+   const std::vector<paging::PagedModelPtr>& getModels() const
+   {
+      return mModels;
+   }
+
+   /**
+    * Updates each registered model using the position and orientation of
+    * the head of the user of the given viewer. If chunks were added to or
+    * removed from the scene, the collision hierarchy of the scene is
+    * invalidated.
+    *
+    * @see vrkit::CollisionData::invalidate()
+    */
+   void update(ViewerPtr viewer);
+
+   /**
+    * Returns the combined statistics of all the registered models.
+    */
+   paging::PagedModel::Stats getStats() const;
+
+   /**
+    * Writes the name, chunk file, and chunk selection of each registered
+    * model for the cluster slaves.
+    *
+    * @see vrkit::SlaveViewer::readDataFromMaster()
+    */
+   void writeSelections(OSG::BinaryDataHandler& writer) const;
+
+private:
+   std::vector<paging::PagedModelPtr> mModels;
+};
+
+}
+
+
+#endif /* _VRKIT_PAGING_DATA_H_ */
@@ -23,12 +23,12 @@
 
 #include <vector>
 #include <string>
-#include <boost/signal.hpp>
 
 #include <vpr/vpr.h>
 #include <vpr/Util/GUID.h>
 
 #include <vrkit/SceneData.h>
+#include <vrkit/signal/Signal.h>
 #include <vrkit/scenedata/StatusPanelDataPtr.h>
 
 
@@ -50,17 +50,17 @@ public:
 
    virtual ~StatusPanelData();
 
-   typedef boost::signal<void (const std::string&)> set_string_t;
-   typedef boost::signal<
+   typedef signal::Signal<void (const std::string&)> set_string_t;
+   typedef signal::Signal<
       void (const std::string&, const std::string&)
    > set_cmd_string_t;
-   typedef boost::signal<
+   typedef signal::Signal<
       void (const std::string&, const std::string&, const unsigned int)
    > set_cmd_string_uint_t;
-   typedef boost::signal<
+   typedef signal::Signal<
       void (const float, const float, const float)
    > set_float3_t;
-   typedef boost::signal<void (const unsigned int)> set_uint_t;
+   typedef signal::Signal<void (const unsigned int)> set_uint_t;
 
    set_string_t setHeaderTitle;
    set_string_t setCenterTitle;
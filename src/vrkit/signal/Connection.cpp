@@ -0,0 +1,74 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <vrkit/signal/Connection.h>
+
+
+namespace vrkit
+{
+
+namespace signal
+{
+
+Connection::Connection()
+{
+   /* Do nothing. */ ;
+}
+
+Connection::Connection(const boost::shared_ptr<detail::ConnectionBody>& body)
+   : mBody(body)
+{
+   /* Do nothing. */ ;
+}
+
+void Connection::disconnect() const
+{
+   if ( mBody && mBody->connected )
+   {
+      mBody->connected = false;
+
+      // Tell the signal (if it still exists) that it has a slot to remove.
+      boost::shared_ptr<detail::SignalState> state(mBody->state.lock());
+      if ( state )
+      {
+         ++state->numDisconnected;
+      }
+   }
+}
+
+bool Connection::connected() const
+{
+   return mBody && mBody->connected;
+}
+
+void Connection::block(const bool shouldBlock)
+{
+   if ( mBody )
+   {
+      mBody->blocked = shouldBlock;
+   }
+}
+
+bool Connection::blocked() const
+{
+   return mBody && mBody->blocked;
+}
+
+}
+
+}
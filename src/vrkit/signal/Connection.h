@@ -0,0 +1,151 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_SIGNAL_CONNECTION_H_
+#define _VRKIT_SIGNAL_CONNECTION_H_
+
+#include <vrkit/Config.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+
+namespace vrkit
+{
+
+namespace signal
+{
+
+namespace detail
+{
+
+/**
+ * State shared by a vrkit::signal::Signal instance and all of its
+ * connections. It lets a connection tell its signal that a slot needs to be
+ * removed without the connection holding a pointer to the signal.
+ */
+struct SignalState
+{
+   SignalState()
+      : numDisconnected(0)
+   {
+      /* Do nothing. */ ;
+   }
+
+   /** The number of disconnected slots that have not been removed yet. */
+   unsigned int numDisconnected;
+};
+
+/**
+ * The state of a single connection between a signal and a slot.
+ */
+struct ConnectionBody
+{
+   ConnectionBody(const boost::shared_ptr<SignalState>& signalState)
+      : connected(true)
+      , blocked(false)
+      , state(signalState)
+   {
+      /* Do nothing. */ ;
+   }
+
+   bool connected;
+   bool blocked;
+   boost::weak_ptr<SignalState> state;
+};
+
+template<typename Signature, typename Combiner> class SignalBase;
+
+}
+
+/** \class Connection Connection.h vrkit/signal/Connection.h
+ *
+ * A connection between a vrkit::signal::Signal instance and one of its
+ * slots. This provides the subset of the \c boost::signals::connection
+ * interface used by vrkit: a connection can be disconnected, blocked, and
+ * unblocked. Copies of a connection refer to the same signal/slot
+ * connection. It is safe to use a connection after its signal has been
+ * destroyed.
+ *
+ * @see vrkit::signal::Signal
+ *
+ * @since 0.51.10
+ */
+class VRKIT_CLASS_API Connection
+{
+public:
+   /**
+    * Creates a connection object that is not connected to any signal.
+    */
+   Connection();
+
+   /**
+    * Disconnects the slot from the signal. Once disconnected, the slot is
+    * never invoked again. If the signal is being emitted, the slot is
+    * removed from the signal after emission completes.
+    */
+   void disconnect() const;
+
+   /**
+    * Indicates whether the slot is still connected to the signal.
+    */
+   bool connected() const;
+
+   /**
+    * Blocks or unblocks the slot. A blocked slot stays connected, but it is
+    * skipped when the signal is emitted.
+    */
+   void block(const bool shouldBlock = true);
+
+   void unblock()
+   {
+      block(false);
+   }
+
+   bool blocked() const;
+
+   bool operator==(const Connection& rhs) const
+   {
+      return mBody == rhs.mBody;
+   }
+
+   bool operator!=(const Connection& rhs) const
+   {
+      return mBody != rhs.mBody;
+   }
+
+   bool operator<(const Connection& rhs) const
+   {
+      return mBody < rhs.mBody;
+   }
+
+private:
+   template<typename Signature, typename Combiner>
+   friend class detail::SignalBase;
+
+   explicit Connection(const boost::shared_ptr<detail::ConnectionBody>& body);
+
+   boost::shared_ptr<detail::ConnectionBody> mBody;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_SIGNAL_CONNECTION_H_ */
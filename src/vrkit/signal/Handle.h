@@ -0,0 +1,121 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_SIGNAL_HANDLE_H_
+#define _VRKIT_SIGNAL_HANDLE_H_
+
+#include <vrkit/Config.h>
+
+#include <vpr/Util/Assert.h>
+
+#include <vrkit/signal/Container.h>
+
+
+namespace vrkit
+{
+
+namespace signal
+{
+
+class Repository;
+
+/** \class Handle Handle.h vrkit/signal/Handle.h
+ *
+ * A typed, cached reference to a signal held in vrkit::signal::Repository.
+ * The name lookup and the type check are performed once when the handle is
+ * retrieved from the repository. After that, the handle dereferences
+ * directly to the contained signal, so connecting slots to or emitting the
+ * signal through a handle costs no more than using the signal object
+ * itself. Code that uses a signal from the repository repeatedly (such as
+ * once per frame) should retrieve a handle once and hold on to it.
+ *
+ * A handle shares ownership of the signal container. If the signal is
+ * removed from the repository, the handle still refers to the original
+ * signal, but that signal is no longer reachable through the repository.
+ *
+ * @see vrkit::signal::Repository::getHandle()
+ * @see vrkit::signal::Repository::getOrAddSignal()
+ *
+ * @since 0.51.8
+ */
+template<typename SignalType>
+class Handle
+{
+public:
+   typedef Container<SignalType>              container_type;
+   typedef typename container_type::ptr_type  container_ptr_type;
+   typedef SignalType                         signal_type;
+
+   /**
+    * Creates an invalid handle. A valid handle can only be obtained from
+    * vrkit::signal::Repository.
+    */
+   Handle()
+   {
+      /* Do nothing. */ ;
+   }
+
+   /**
+    * Indicates whether this handle refers to a signal.
+    */
+   bool isValid() const
+   {
+      return mContainer.get() != NULL;
+   }
+
+   /**
+    * Returns the container of the referenced signal.
+    */
+   const container_ptr_type& getContainer() const
+   {
+      return mContainer;
+   }
+
+   //@{
+   /** @name Smart Pointer Interface */
+   signal_type* operator->() const
+   {
+      vprASSERT(isValid() && "Use of invalid signal handle");
+      return &**mContainer;
+   }
+
+   signal_type& operator*() const
+   {
+      vprASSERT(isValid() && "Use of invalid signal handle");
+      return **mContainer;
+   }
+   //@}
+
+private:
+   explicit Handle(const container_ptr_type& container)
+      : mContainer(container)
+   {
+      /* Do nothing. */ ;
+   }
+
+   friend class Repository;
+
+   container_ptr_type mContainer;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_SIGNAL_HANDLE_H_ */
@@ -21,6 +21,8 @@
 
 #include <boost/signals/connection.hpp>
 
+#include <vrkit/signal/Signal.h>
+
 
 namespace vrkit
 {
@@ -28,6 +30,27 @@ namespace vrkit
 namespace signal
 {
 
+namespace detail
+{
+
+/**
+ * Identifies the type returned when connecting a slot to a signal of type
+ * \p SignalT.
+ */
+template<typename SignalT>
+struct ConnectionType
+{
+   typedef boost::signals::connection type;
+};
+
+template<typename Signature, typename Combiner>
+struct ConnectionType< Signal<Signature, Combiner> >
+{
+   typedef Connection type;
+};
+
+}
+
 /** \class Proxy Proxy.h vrkit/signal/Proxy.h
  *
  * Simple proxy for \c boost::signal<> instances that exposes only the
@@ -53,6 +76,15 @@ class Proxy
 public:
    typedef SignalT signal_t;
 
+   /**
+    * The type of the connection returned by connect(). This is
+    * vrkit::signal::Connection when \p SignalT is an instantiation of
+    * vrkit::signal::Signal and \c boost::signals::connection otherwise.
+    *
+    * @since 0.51.10
+    */
+   typedef typename detail::ConnectionType<SignalT>::type connection_type;
+
    Proxy(signal_t& signal)
       : mSignal(signal)
    {
@@ -65,7 +97,7 @@ public:
       /* Do nothing. */ ;
    }
 
-   boost::signals::connection connect(typename signal_t::slot_type slot)
+   connection_type connect(typename signal_t::slot_type slot)
    {
       return mSignal.connect(slot);
    }
@@ -79,9 +111,8 @@ public:
     *
     * @since 0.26.1
     */
-   boost::signals::connection
-   connect(const typename signal_t::group_type& group,
-           typename signal_t::slot_type slot)
+   connection_type connect(const typename signal_t::group_type& group,
+                           typename signal_t::slot_type slot)
    {
       return mSignal.connect(group, slot);
    }
@@ -17,6 +17,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <sstream>
+#include <utility>
 
 #include <vrkit/Exception.h>
 #include <vrkit/signal/Repository.h>
@@ -42,34 +43,31 @@ Repository::~Repository()
 
 void Repository::addSignal(const std::string& id, ContainerBasePtr container)
 {
-   if ( hasSignal(id) )
+   if ( ! mSignals.insert(std::make_pair(id, container)).second )
    {
       std::ostringstream msg_stream;
       msg_stream << "Signal already registered under '" << id << "'";
       throw Exception(msg_stream.str(), VRKIT_LOCATION);
    }
-
-   mSignals[id] = container;
 }
 
 void Repository::removeSignal(const std::string& id)
 {
-   if ( hasSignal(id) )
-   {
-      mSignals.erase(id);
-   }
+   mSignals.erase(id);
 }
 
 ContainerBasePtr Repository::getBaseSignal(const std::string& id)
 {
-   if ( ! hasSignal(id) )
+   signal_map_t::iterator i = mSignals.find(id);
+
+   if ( i == mSignals.end() )
    {
       std::ostringstream msg_stream;
       msg_stream << "Unknown signal identifier " << id;
       throw std::invalid_argument(msg_stream.str());
    }
 
-   return mSignals[id];
+   return (*i).second;
 }
 
 }
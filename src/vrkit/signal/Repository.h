@@ -22,14 +22,23 @@
 #include <vrkit/Config.h>
 
 #include <stdexcept>
-#include <map>
+#include <string>
+#include <typeinfo>
+#include <boost/version.hpp>
 #include <boost/shared_ptr.hpp>
 
+#if BOOST_VERSION >= 103600
+#  include <boost/unordered_map.hpp>
+#else
+#  include <map>
+#endif
+
 #include <vpr/vpr.h>
 #include <vpr/Util/GUID.h>
 
 #include <vrkit/SceneData.h>
 #include <vrkit/signal/Container.h>
+#include <vrkit/signal/Handle.h>
 #include <vrkit/signal/RepositoryPtr.h>
 
 
@@ -95,6 +104,28 @@ namespace signal
  * }
  * \endcode
  *
+ * Code that uses a signal repeatedly should look it up by name only once and
+ * keep a handle to it:
+ *
+ * \code
+ * class Emitter
+ * {
+ * public:
+ *    void init(vrkit::signal::RepositoryPtr repos)
+ *    {
+ *       mSignal = repos->getOrAddSignal<sig_type>("My Signal");
+ *    }
+ *
+ *    void update(const int value)
+ *    {
+ *       (*mSignal)(value);
+ *    }
+ *
+ * private:
+ *    vrkit::signal::Handle<sig_type> mSignal;
+ * };
+ * \endcode
+ *
  * A more realistic usage would not have everything (registration, connection,
  * and emission) happen in one function (as is done in run() above). A more
  * likely sceanrio is that one plug-in would register a signal and another
@@ -132,6 +163,10 @@ namespace signal
  * uses getSignal() or getBaseSignal() to get the signal container so it can
  * then utilize the signal contained therein.
  *
+ * Signals are stored in a hash table keyed by name. For repeated use of a
+ * signal, getHandle() or getOrAddSignal() resolves the name once to a typed
+ * vrkit::signal::Handle that can be kept by the calling code.
+ *
  * @see vrkit::signal::ContainerBase
  *
  * @note This class was renamed from vrkit::SignalRepository in version 0.47.
@@ -190,7 +225,7 @@ public:
     */
    bool hasSignal(const std::string& id) const
    {
-      return mSignals.count(id) > 0;
+      return mSignals.find(id) != mSignals.end();
    }
 
    /**
@@ -240,20 +275,85 @@ public:
    template<typename SignalType>
    Container<SignalType>& getSignal(const std::string& id)
    {
-      typedef Container<SignalType> container_type;
-      typename container_type::ptr_type container =
-         boost::dynamic_pointer_cast<container_type>(getBaseSignal(id));
+      return *getHandle<SignalType>(id).getContainer();
+   }
+
+   /**
+    * Resolves the given identifier to a typed handle for the signal
+    * registered under that identifier. The handle may be kept and used
+    * without further lookups.
+    *
+    * @param id The identifier for the signal to be retrieved.
+    *
+    * @throw std::invalid_argument
+    *           Thrown if \p id is not a registered signal.
+    * @throw std::bad_cast
+    *           Thrown if the signal associated with the given identifier
+    *           cannot be cast dynamically to a container for the given signal
+    *           type.
+    *
+    * @since 0.51.8
+    */
+   template<typename SignalType>
+   Handle<SignalType> getHandle(const std::string& id)
+   {
+      return makeHandle<SignalType>(getBaseSignal(id));
+   }
+
+   /**
+    * Resolves the given identifier to a typed handle for the signal
+    * registered under that identifier. If no signal is registered under
+    * \p id, a new signal of type \p SignalType is registered first. This
+    * replaces the common sequence of hasSignal(), addSignal(), and
+    * getSignal() with a single lookup.
+    *
+    * @param id The identifier for the signal to be retrieved.
+    *
+    * @throw std::bad_cast
+    *           Thrown if a signal is already registered under \p id and it
+    *           cannot be cast dynamically to a container for the given signal
+    *           type.
+    *
+    * @since 0.51.8
+    */
+   template<typename SignalType>
+   Handle<SignalType> getOrAddSignal(const std::string& id)
+   {
+      ContainerBasePtr& container = mSignals[id];
 
       if ( ! container )
       {
-         throw std::bad_cast();
+         container = Container<SignalType>::create();
       }
 
-      return *container;
+      return makeHandle<SignalType>(container);
    }
 
 private:
-   std::map<std::string, ContainerBasePtr> mSignals;
+   template<typename SignalType>
+   static Handle<SignalType> makeHandle(const ContainerBasePtr& container)
+   {
+      typedef Handle<SignalType> handle_type;
+      typename handle_type::container_ptr_type typed_container =
+         boost::dynamic_pointer_cast<
+            typename handle_type::container_type
+         >(container);
+
+      if ( ! typed_container )
+      {
+         throw std::bad_cast();
+      }
+
+      return handle_type(typed_container);
+   }
+
+#if BOOST_VERSION >= 103600
+   typedef boost::unordered_map<std::string, ContainerBasePtr> signal_map_t;
+#else
+   typedef std::map<std::string, ContainerBasePtr> signal_map_t;
+#endif
+
+   signal_map_t mSignals;
 };
 
 }
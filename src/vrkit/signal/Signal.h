@@ -0,0 +1,669 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_SIGNAL_SIGNAL_H_
+#define _VRKIT_SIGNAL_SIGNAL_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/type_traits/function_traits.hpp>
+#include <boost/call_traits.hpp>
+
+#include <vrkit/signal/Connection.h>
+
+
+namespace vrkit
+{
+
+namespace signal
+{
+
+/** \struct LastValue Signal.h vrkit/signal/Signal.h
+ *
+ * The default combiner for vrkit::signal::Signal. It invokes every slot and
+ * returns the value returned by the last one. If no slots are invoked, a
+ * default constructed value is returned.
+ *
+ * @since 0.51.10
+ */
+template<typename T>
+struct LastValue
+{
+   typedef T result_type;
+
+   template<typename InputIterator>
+   result_type operator()(InputIterator first, InputIterator last) const
+   {
+      result_type value = result_type();
+      while ( first != last )
+      {
+         value = *first;
+         ++first;
+      }
+      return value;
+   }
+};
+
+template<>
+struct LastValue<void>
+{
+   typedef void result_type;
+
+   template<typename InputIterator>
+   void operator()(InputIterator first, InputIterator last) const
+   {
+      while ( first != last )
+      {
+         *first;
+         ++first;
+      }
+   }
+};
+
+namespace detail
+{
+
+/**
+ * Input iterator handed to the combiner during emission. Dereferencing it
+ * invokes the current slot using the arguments captured by \p Invoker.
+ * Blocked and disconnected slots are skipped.
+ */
+template<typename Entry, typename Invoker>
+class SlotIterator
+{
+public:
+   typedef typename Invoker::result_type result_type;
+
+   SlotIterator(const Entry* cur, const Entry* end, const Invoker* invoker)
+      : mCur(cur)
+      , mEnd(end)
+      , mInvoker(invoker)
+   {
+      skip();
+   }
+
+   result_type operator*() const
+   {
+      return (*mInvoker)(mCur->func);
+   }
+
+   SlotIterator& operator++()
+   {
+      ++mCur;
+      skip();
+      return *this;
+   }
+
+   SlotIterator operator++(int)
+   {
+      SlotIterator old(*this);
+      ++*this;
+      return old;
+   }
+
+   bool operator==(const SlotIterator& rhs) const
+   {
+      return mCur == rhs.mCur;
+   }
+
+   bool operator!=(const SlotIterator& rhs) const
+   {
+      return mCur != rhs.mCur;
+   }
+
+private:
+   void skip()
+   {
+      while ( mCur != mEnd &&
+              (! mCur->body->connected || mCur->body->blocked) )
+      {
+         ++mCur;
+      }
+   }
+
+   const Entry*   mCur;
+   const Entry*   mEnd;
+   const Invoker* mInvoker;
+};
+
+/**
+ * The arity-independent part of vrkit::signal::Signal. This owns the slot
+ * list and implements connection management and emission.
+ */
+template<typename Signature, typename Combiner>
+class SignalBase
+   : private boost::noncopyable
+{
+public:
+   typedef boost::function<Signature>       slot_function_type;
+   typedef slot_function_type               slot_type;
+   typedef int                              group_type;
+   typedef Combiner                         combiner_type;
+   typedef typename Combiner::result_type   result_type;
+   typedef typename boost::function_traits<Signature>::result_type
+      slot_result_type;
+
+   SignalBase()
+      : mState(new SignalState())
+      , mEmitDepth(0)
+   {
+      /* Do nothing. */ ;
+   }
+
+   ~SignalBase()
+   {
+      disconnect_all_slots();
+   }
+
+   /**
+    * Connects the given slot after all other slots, including all grouped
+    * slots.
+    */
+   Connection connect(const slot_type& slot)
+   {
+      return doConnect(Entry(slot, makeBody(), 0, false));
+   }
+
+   /**
+    * Connects the given slot in the identified group. Grouped slots are
+    * invoked in ascending group order ahead of all ungrouped slots. Slots
+    * in the same group are invoked in the order that they were connected.
+    */
+   Connection connect(const group_type& group, const slot_type& slot)
+   {
+      return doConnect(Entry(slot, makeBody(), group, true));
+   }
+
+   bool empty() const
+   {
+      return num_slots() == 0;
+   }
+
+   /**
+    * Returns the number of connected slots (including blocked slots).
+    */
+   std::size_t num_slots() const
+   {
+      std::size_t count(0);
+      typename entry_list_t::const_iterator e;
+      for ( e = mEntries.begin(); e != mEntries.end(); ++e )
+      {
+         if ( (*e).body->connected )
+         {
+            ++count;
+         }
+      }
+      for ( e = mPendingEntries.begin(); e != mPendingEntries.end(); ++e )
+      {
+         if ( (*e).body->connected )
+         {
+            ++count;
+         }
+      }
+      return count;
+   }
+
+   void disconnect_all_slots()
+   {
+      typename entry_list_t::iterator e;
+      for ( e = mEntries.begin(); e != mEntries.end(); ++e )
+      {
+         (*e).body->connected = false;
+      }
+      for ( e = mPendingEntries.begin(); e != mPendingEntries.end(); ++e )
+      {
+         (*e).body->connected = false;
+      }
+
+      mState->numDisconnected = mEntries.size() + mPendingEntries.size();
+
+      if ( 0 == mEmitDepth )
+      {
+         cleanup();
+      }
+   }
+
+protected:
+   struct Entry
+   {
+      Entry(const slot_type& f, const boost::shared_ptr<ConnectionBody>& b,
+            const group_type g, const bool isGrouped)
+         : func(f)
+         , body(b)
+         , group(g)
+         , grouped(isGrouped)
+      {
+         /* Do nothing. */ ;
+      }
+
+      slot_function_type                 func;
+      boost::shared_ptr<ConnectionBody> body;
+      group_type                         group;
+      bool                               grouped;
+   };
+
+   /**
+    * Invokes the combiner on the current slot list. Slots connected during
+    * emission are not invoked until the next emission, and the slot list is
+    * only compacted after the outermost emission completes. Thus, no memory
+    * is allocated here unless a slot connects or disconnects a slot.
+    */
+   template<typename Invoker>
+   result_type emit(const Invoker& invoker) const
+   {
+      typedef SlotIterator<Entry, Invoker> iter_type;
+
+      EmitGuard guard(*this);
+
+      const Entry* first = mEntries.empty() ? NULL : &mEntries[0];
+      const Entry* last  = first + mEntries.size();
+      return mCombiner(iter_type(first, last, &invoker),
+                       iter_type(last, last, &invoker));
+   }
+
+private:
+   typedef std::vector<Entry> entry_list_t;
+
+   /**
+    * Tracks the emission depth so that the slot list is not modified while
+    * the combiner is iterating over it.
+    */
+   struct EmitGuard
+   {
+      EmitGuard(const SignalBase& s)
+         : sig(s)
+      {
+         ++sig.mEmitDepth;
+      }
+
+      ~EmitGuard()
+      {
+         if ( --sig.mEmitDepth == 0 )
+         {
+            sig.cleanup();
+         }
+      }
+
+      const SignalBase& sig;
+   };
+
+   boost::shared_ptr<ConnectionBody> makeBody() const
+   {
+      return boost::shared_ptr<ConnectionBody>(new ConnectionBody(mState));
+   }
+
+   Connection doConnect(const Entry& entry)
+   {
+      if ( mEmitDepth > 0 )
+      {
+         mPendingEntries.push_back(entry);
+      }
+      else
+      {
+         cleanup();
+         insert(entry);
+      }
+
+      return Connection(entry.body);
+   }
+
+   void insert(const Entry& entry) const
+   {
+      if ( ! entry.grouped )
+      {
+         mEntries.push_back(entry);
+      }
+      else
+      {
+         // Find the first slot that has to be invoked after this one.
+         typename entry_list_t::iterator e;
+         for ( e = mEntries.begin(); e != mEntries.end(); ++e )
+         {
+            if ( ! (*e).grouped || entry.group < (*e).group )
+            {
+               break;
+            }
+         }
+         mEntries.insert(e, entry);
+      }
+   }
+
+   /**
+    * Removes disconnected slots and adds the slots that were connected
+    * during emission. This must not be invoked during emission.
+    */
+   void cleanup() const
+   {
+      if ( mState->numDisconnected > 0 )
+      {
+         typename entry_list_t::iterator out(mEntries.begin());
+         typename entry_list_t::iterator e;
+         for ( e = mEntries.begin(); e != mEntries.end(); ++e )
+         {
+            if ( (*e).body->connected )
+            {
+               if ( out != e )
+               {
+                  *out = *e;
+               }
+               ++out;
+            }
+         }
+         mEntries.erase(out, mEntries.end());
+         mState->numDisconnected = 0;
+      }
+
+      if ( ! mPendingEntries.empty() )
+      {
+         entry_list_t pending;
+         pending.swap(mPendingEntries);
+
+         typename entry_list_t::iterator e;
+         for ( e = pending.begin(); e != pending.end(); ++e )
+         {
+            if ( (*e).body->connected )
+            {
+               insert(*e);
+            }
+         }
+      }
+   }
+
+   boost::shared_ptr<SignalState> mState;
+
+   /** @name Slot Storage */
+   //@{
+   mutable entry_list_t mEntries;         /**< Contiguous slot list */
+   mutable entry_list_t mPendingEntries;  /**< Connected during emission */
+   mutable unsigned int mEmitDepth;
+   //@}
+
+   mutable combiner_type mCombiner;
+};
+
+/** @name Slot Invokers */
+//@{
+template<typename R>
+struct Invoker0
+{
+   typedef R result_type;
+
+   template<typename F>
+   R operator()(const F& f) const
+   {
+      return f();
+   }
+};
+
+template<typename R, typename A1>
+struct Invoker1
+{
+   typedef R result_type;
+
+   Invoker1(A1 a1) : mA1(a1)
+   {
+      /* Do nothing. */ ;
+   }
+
+   template<typename F>
+   R operator()(const F& f) const
+   {
+      return f(mA1);
+   }
+
+   A1 mA1;
+};
+
+template<typename R, typename A1, typename A2>
+struct Invoker2
+{
+   typedef R result_type;
+
+   Invoker2(A1 a1, A2 a2) : mA1(a1), mA2(a2)
+   {
+      /* Do nothing. */ ;
+   }
+
+   template<typename F>
+   R operator()(const F& f) const
+   {
+      return f(mA1, mA2);
+   }
+
+   A1 mA1;
+   A2 mA2;
+};
+
+template<typename R, typename A1, typename A2, typename A3>
+struct Invoker3
+{
+   typedef R result_type;
+
+   Invoker3(A1 a1, A2 a2, A3 a3) : mA1(a1), mA2(a2), mA3(a3)
+   {
+      /* Do nothing. */ ;
+   }
+
+   template<typename F>
+   R operator()(const F& f) const
+   {
+      return f(mA1, mA2, mA3);
+   }
+
+   A1 mA1;
+   A2 mA2;
+   A3 mA3;
+};
+
+template<typename R, typename A1, typename A2, typename A3, typename A4>
+struct Invoker4
+{
+   typedef R result_type;
+
+   Invoker4(A1 a1, A2 a2, A3 a3, A4 a4)
+      : mA1(a1), mA2(a2), mA3(a3), mA4(a4)
+   {
+      /* Do nothing. */ ;
+   }
+
+   template<typename F>
+   R operator()(const F& f) const
+   {
+      return f(mA1, mA2, mA3, mA4);
+   }
+
+   A1 mA1;
+   A2 mA2;
+   A3 mA3;
+   A4 mA4;
+};
+//@}
+
+/**
+ * Provides the emission operator for signals with the given number of
+ * arguments. The arguments are captured by reference (or by value for
+ * small types) according to \c boost::call_traits.
+ */
+template<unsigned int Arity, typename Signature, typename Combiner>
+class SignalImpl;
+
+template<typename Signature, typename Combiner>
+class SignalImpl<0, Signature, Combiner>
+   : public SignalBase<Signature, Combiner>
+{
+   typedef SignalBase<Signature, Combiner> base_type;
+
+public:
+   typename base_type::result_type operator()() const
+   {
+      typedef Invoker0<typename base_type::slot_result_type> invoker_type;
+      return this->emit(invoker_type());
+   }
+};
+
+template<typename Signature, typename Combiner>
+class SignalImpl<1, Signature, Combiner>
+   : public SignalBase<Signature, Combiner>
+{
+   typedef SignalBase<Signature, Combiner>         base_type;
+   typedef boost::function_traits<Signature>       traits_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg1_type
+   >::param_type a1_type;
+
+public:
+   typename base_type::result_type operator()(a1_type a1) const
+   {
+      typedef Invoker1<typename base_type::slot_result_type, a1_type>
+         invoker_type;
+      return this->emit(invoker_type(a1));
+   }
+};
+
+template<typename Signature, typename Combiner>
+class SignalImpl<2, Signature, Combiner>
+   : public SignalBase<Signature, Combiner>
+{
+   typedef SignalBase<Signature, Combiner>         base_type;
+   typedef boost::function_traits<Signature>       traits_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg1_type
+   >::param_type a1_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg2_type
+   >::param_type a2_type;
+
+public:
+   typename base_type::result_type operator()(a1_type a1, a2_type a2) const
+   {
+      typedef Invoker2<
+         typename base_type::slot_result_type, a1_type, a2_type
+      > invoker_type;
+      return this->emit(invoker_type(a1, a2));
+   }
+};
+
+template<typename Signature, typename Combiner>
+class SignalImpl<3, Signature, Combiner>
+   : public SignalBase<Signature, Combiner>
+{
+   typedef SignalBase<Signature, Combiner>         base_type;
+   typedef boost::function_traits<Signature>       traits_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg1_type
+   >::param_type a1_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg2_type
+   >::param_type a2_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg3_type
+   >::param_type a3_type;
+
+public:
+   typename base_type::result_type operator()(a1_type a1, a2_type a2,
+                                              a3_type a3) const
+   {
+      typedef Invoker3<
+         typename base_type::slot_result_type, a1_type, a2_type, a3_type
+      > invoker_type;
+      return this->emit(invoker_type(a1, a2, a3));
+   }
+};
+
+template<typename Signature, typename Combiner>
+class SignalImpl<4, Signature, Combiner>
+   : public SignalBase<Signature, Combiner>
+{
+   typedef SignalBase<Signature, Combiner>         base_type;
+   typedef boost::function_traits<Signature>       traits_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg1_type
+   >::param_type a1_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg2_type
+   >::param_type a2_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg3_type
+   >::param_type a3_type;
+   typedef typename boost::call_traits<
+      typename traits_type::arg4_type
+   >::param_type a4_type;
+
+public:
+   typename base_type::result_type operator()(a1_type a1, a2_type a2,
+                                              a3_type a3, a4_type a4) const
+   {
+      typedef Invoker4<
+         typename base_type::slot_result_type, a1_type, a2_type, a3_type,
+         a4_type
+      > invoker_type;
+      return this->emit(invoker_type(a1, a2, a3, a4));
+   }
+};
+
+}
+
+/** \class Signal Signal.h vrkit/signal/Signal.h
+ *
+ * A lightweight replacement for \c boost::signal<> intended for signals that
+ * are emitted frequently. The slots are stored in a single contiguous list,
+ * and emitting the signal does not allocate memory. The interface is the
+ * subset of the \c boost::signal<> interface used by vrkit: slots can be
+ * connected (optionally in a group), the signal can be emitted, and the
+ * combiner is given an input iterator range over the slot results. Thus,
+ * vrkit::event::ResultOperator can be used as the combiner. Signals with up
+ * to four arguments are supported.
+ *
+ * Slots may connect and disconnect slots (including themselves) while the
+ * signal is being emitted. Slots connected during emission are first invoked
+ * by the next emission. Unlike \c boost::signal<>, this class does not track
+ * the lifetime of objects bound into a slot, and it is not thread safe.
+ *
+ * This type can be used with vrkit::signal::Proxy and
+ * vrkit::signal::Container in the same way as \c boost::signal<>.
+ *
+ * @see vrkit::signal::Connection
+ *
+ * @since 0.51.10
+ */
+template<typename Signature
+       , typename Combiner = LastValue<
+            typename boost::function_traits<Signature>::result_type
+         >
+       >
+class Signal
+   : public detail::SignalImpl<boost::function_traits<Signature>::arity,
+                               Signature, Combiner>
+{
+public:
+   Signal()
+   {
+      /* Do nothing. */ ;
+   }
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_SIGNAL_SIGNAL_H_ */
@@ -18,8 +18,10 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <set>
 #include <boost/bind.hpp>
 #include <boost/ref.hpp>
+#include <boost/filesystem/path.hpp>
 
 #include <OpenSG/OSGAttachmentContainer.h>
 #include <OpenSG/OSGConnectionFactory.h>
@@ -38,8 +40,11 @@
 #include <gadget/Type/Position/PositionUnitConversion.h>
 
 #include <vrkit/ExitCodes.h>
+#include <vrkit/Exception.h>
 #include <vrkit/Status.h>
 #include <vrkit/Version.h>
+#include <vrkit/paging/ChunkFile.h>
+#include <vrkit/paging/PagedModel.h>
 #include <vrkit/slave/SlaveViewer.h>
 
 
@@ -73,6 +78,12 @@
  * send(userData), flush               recv(userData)
  * recv(userData) (for each)           send(userData), flush
  * </pre>
+ *
+ * The user data sent by the master includes the chunk selection of each
+ * paged model (see vrkit::paging::PagedModel). The chunks themselves are
+ * not part of the shared scene graph. Each slave loads them from the chunk
+ * file named by the master, so that file has to be available under the
+ * same path on every node.
  */
 
 
@@ -86,6 +97,39 @@ const vpr::DebugCategory vrkitSLAVE_APP(
 
 const int SLAVE_DBG_LVL(vprDBG_STATE_LVL);
 
+/** The number of threads that load the chunks of each paged model. */
+const unsigned int sPagingThreads(2);
+
+/**
+ * Returns the first node in the graph rooted at \p node that has the given
+ * name.
+ */
+OSG::NodePtr findNamedNode(OSG::NodePtr node, const std::string& name)
+{
+   if ( OSG::NullFC == node )
+   {
+      return OSG::NullFC;
+   }
+
+   const char* node_name = OSG::getName(node);
+   if ( NULL != node_name && name == node_name )
+   {
+      return node;
+   }
+
+   const OSG::UInt32 num_children(node->getNChildren());
+   for ( OSG::UInt32 c = 0; c < num_children; ++c )
+   {
+      OSG::NodePtr found = findNamedNode(node->getChild(c), name);
+      if ( OSG::NullFC != found )
+      {
+         return found;
+      }
+   }
+
+   return OSG::NullFC;
+}
+
 class TravState
 {
 public:
@@ -492,6 +536,102 @@ void SlaveViewer::readDataFromMaster(OSG::BinaryDataHandler& reader)
    reader.getValue(near_val);
    reader.getValue(far_val);
    vrj::Projection::setNearFar(near_val, far_val);
+
+   OSG::UInt32 num_paged_models;
+   reader.getValue(num_paged_models);
+
+   std::set<std::string> names;
+
+   for ( OSG::UInt32 m = 0; m < num_paged_models; ++m )
+   {
+      std::string name, chunk_file;
+      reader.getValue(name);
+      reader.getValue(chunk_file);
+      names.insert(name);
+
+      OSG::UInt32 num_chunks;
+      reader.getValue(num_chunks);
+
+      std::vector<vpr::Uint32> chunks(num_chunks);
+      for ( OSG::UInt32 c = 0; c < num_chunks; ++c )
+      {
+         OSG::UInt32 chunk;
+         reader.getValue(chunk);
+         chunks[c] = chunk;
+      }
+
+      selectChunks(name, chunk_file, chunks);
+   }
+
+   // Paged models that the master no longer has are released. This stops
+   // their threads and lets go of their roots.
+   typedef std::map<std::string, paging::PagedModelPtr>::iterator iter_type;
+   for ( iter_type m = mPagedModels.begin(); m != mPagedModels.end(); )
+   {
+      if ( names.count(m->first) == 0 )
+      {
+         VRKIT_STATUS << "Stopped paging the geometry of " << m->first
+                      << std::endl;
+         mPagedModels.erase(m++);
+      }
+      else
+      {
+         ++m;
+      }
+   }
+}
+
+void SlaveViewer::selectChunks(const std::string& name,
+                               const std::string& chunkFile,
+                               const std::vector<vpr::Uint32>& chunks)
+{
+   std::map<std::string, paging::PagedModelPtr>::iterator m =
+      mPagedModels.find(name);
+
+   // If the master changed the chunk file of the root, the local paged model
+   // is replaced.
+   if ( m != mPagedModels.end() && m->second &&
+        m->second->getChunkFile()->getPath().native_file_string() !=
+           chunkFile )
+   {
+      mPagedModels.erase(m);
+      m = mPagedModels.end();
+   }
+
+   if ( m == mPagedModels.end() )
+   {
+      OSG::NodePtr root = findNamedNode(mSceneRoot.node(), name);
+
+      // The root may not have been added to the scene yet.
+      if ( OSG::NullFC == root )
+      {
+         return;
+      }
+
+      paging::PagedModelPtr model;
+
+      try
+      {
+         model = paging::PagedModel::create(
+            paging::ChunkFile::open(
+               boost::filesystem::path(chunkFile, boost::filesystem::native)
+            ),
+            root, sPagingThreads
+         );
+      }
+      catch (vrkit::Exception& ex)
+      {
+         VRKIT_STATUS << "WARNING: Cannot page the geometry of " << name
+                      << ": " << ex.what() << std::endl;
+      }
+
+      m = mPagedModels.insert(std::make_pair(name, model)).first;
+   }
+
+   if ( m->second )
+   {
+      m->second->selectChunks(chunks);
+   }
 }
 
 void SlaveViewer::initGl()
@@ -698,6 +838,9 @@ bool SlaveViewer::destroyedFunction(field_container_ptr_type fcp,
 
 void SlaveViewer::shutdown()
 {
+   // Stop the threads that load paged geometry.
+   mPagedModels.clear();
+
    if ( NULL != mConnection )
    {
       mConnection->disconnect();
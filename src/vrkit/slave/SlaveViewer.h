@@ -20,6 +20,8 @@
 #define _VRKIT_SLAVE_VIEWER_H_
 
 #include <string>
+#include <map>
+#include <vector>
 
 #include <vrkit/Config.h>
 
@@ -32,6 +34,8 @@
 
 #include <vrj/vrjParam.h>
 
+#include <vrkit/paging/PagedModelPtr.h>
+
 #if __VJ_version >= 2003011
 #  include <vrj/Draw/OpenSG/App.h>
 #else
@@ -143,6 +147,19 @@ private:
 
    void shutdown();
 
+   /**
+    * Applies the chunk selection of a paged model on the master to the
+    * local paged model for the same root. The local paged model is created
+    * the first time that its root is named by the master, and it is
+    * replaced if the master names a different chunk file for the root.
+    * Local paged models whose roots are no longer named by the master are
+    * released by readDataFromMaster().
+    *
+    * @since 0.51.28
+    */
+   void selectChunks(const std::string& name, const std::string& chunkFile,
+                     const std::vector<vpr::Uint32>& chunks);
+
    float mDrawScaleFactor;
 
    std::string mMasterAddr;
@@ -160,6 +177,12 @@ private:
 
    std::vector<OSG::AttachmentContainerPtr> mMaybeNamedFcs;
 
+   /**
+    * The local paged models indexed by the name of their roots. A null
+    * pointer means that the chunk file could not be opened.
+    */
+   std::map<std::string, paging::PagedModelPtr> mPagedModels;
+
 #ifdef VRKIT_DEBUG
    unsigned int mNodes;
    unsigned int mTransforms;
@@ -83,7 +83,7 @@ BasicHighlighter::BasicHighlighter()
 BasicHighlighter::~BasicHighlighter()
 {
    std::for_each(mConnections.begin(), mConnections.end(),
-                 boost::bind(&boost::signals::connection::disconnect, _1));
+                 boost::bind(&signal::Connection::disconnect, _1));
 }
 
 BasicHighlighterPtr BasicHighlighter::init(ViewerPtr viewer)
@@ -25,7 +25,6 @@
 #include <vector>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/filesystem/path.hpp>
-#include <boost/signals/connection.hpp>
 
 #include <OpenSG/OSGColor.h>
 
@@ -33,6 +32,7 @@
 
 #include <vrkit/ViewerPtr.h>
 #include <vrkit/SceneObjectPtr.h>
+#include <vrkit/signal/Connection.h>
 #include <vrkit/scenedata/Event.h>
 #include <vrkit/util/GeometryHighlightTraverser.h>
 #include <vrkit/util/BasicHighlighterPtr.h>
@@ -208,7 +208,7 @@ private:
    unsigned int mGrabHighlightID;
    //@}
 
-   std::vector<boost::signals::connection> mConnections;
+   std::vector<signal::Connection> mConnections;
 
    std::vector<SceneObjectPtr> mIntersectedObjs;
    std::vector<SceneObjectPtr> mChosenObjs;
@@ -19,12 +19,13 @@
 #include <sstream>
 #include <algorithm>
 #include <iterator>
-#include <boost/function.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/spirit.hpp>
 #include <boost/spirit/tree/ast.hpp>
 
+#include <vpr/Util/Assert.h>
+
 #include <vrkit/Status.h>
 #include <vrkit/WandInterface.h>
 #include <vrkit/Exception.h>
@@ -153,100 +154,6 @@ struct CommandGrammar : public spirit::grammar<CommandGrammar>
    };
 };
 
-class ButtonQuery
-{
-public:
-   ButtonQuery(gadget::DigitalInterface& digitalIf,
-               const gadget::Digital::State testState)
-      : mButtonIf(digitalIf)
-      , mTestState(testState)
-   {
-   }
-
-   bool operator()() const
-   {
-      return mButtonIf->getData() == mTestState;
-   }
-
-private:
-   gadget::DigitalInterface& mButtonIf;
-   const gadget::Digital::State mTestState;
-};
-
-class and_
-{
-public:
-   and_(boost::function<bool()> lhs, boost::function<bool()> rhs)
-      : lhs(lhs)
-      , rhs(rhs)
-   {
-   }
-
-   bool operator()() const
-   {
-      return lhs() && rhs();
-   }
-
-private:
-   boost::function<bool ()> lhs;
-   boost::function<bool ()> rhs;
-};
-
-class xor_
-{
-public:
-   xor_(boost::function<bool()> lhs, boost::function<bool()> rhs)
-      : lhs(lhs)
-      , rhs(rhs)
-   {
-   }
-
-   bool operator()() const
-   {
-      return (lhs || rhs) && ! (lhs && rhs);
-   }
-
-private:
-   boost::function<bool ()> lhs;
-   boost::function<bool ()> rhs;
-};
-
-class or_
-{
-public:
-   or_(boost::function<bool()> lhs, boost::function<bool()> rhs)
-      : lhs(lhs)
-      , rhs(rhs)
-   {
-   }
-
-   bool operator()() const
-   {
-      return lhs() || rhs();
-   }
-
-private:
-   boost::function<bool ()> lhs;
-   boost::function<bool ()> rhs;
-};
-
-class not_
-{
-public:
-   not_(boost::function<bool ()> f)
-      : f(f)
-   {
-   }
-
-   bool operator()() const
-   {
-      return ! f();
-   }
-
-private:
-   boost::function<bool ()> f;
-};
-
 class indent
 {
 public:
@@ -350,61 +257,99 @@ void printTree(const iter_t& i, const unsigned int level = 0)
    }
 }
 
+typedef vrkit::util::DigitalCommand::Instruction instruction_t;
+
 /**
- * Composes functions to create a composite function that performs the test
- * for the state of the digital command based on the parse tree.
+ * Appends to \p program the postfix form of the boolean expression rooted at
+ * the given parse tree node. Tests of buttons that are not configured in
+ * \p wandIf are folded into constants since such buttons are always off.
+ *
+ * @return The maximum operand stack depth needed to evaluate the expression.
  */
-boost::function<bool ()> eval(const iter_t& i, vrkit::WandInterfacePtr wandIf)
+unsigned int compile(const iter_t& i, vrkit::WandInterfacePtr wandIf,
+                     std::vector<instruction_t>& program)
 {
-   boost::function<bool ()> f;
+   const spirit::parser_id id(i->value.id());
 
-   if ( i->value.id() == CommandGrammar::onActionID )
+   if ( id == CommandGrammar::onActionID ||
+        id == CommandGrammar::offActionID ||
+        id == CommandGrammar::toggleOnActionID ||
+        id == CommandGrammar::toggleOffActionID )
    {
-      f = ButtonQuery(wandIf->getButton(buttonIndex(i->children.begin())),
-                      gadget::Digital::ON);
-   }
-   else if ( i->value.id() == CommandGrammar::offActionID )
-   {
-      f = ButtonQuery(wandIf->getButton(buttonIndex(i->children.begin())),
-                      gadget::Digital::OFF);
-   }
-   else if ( i->value.id() == CommandGrammar::toggleOnActionID )
-   {
-      f = ButtonQuery(wandIf->getButton(buttonIndex(i->children.begin())),
-                      gadget::Digital::TOGGLE_ON);
-   }
-   else if ( i->value.id() == CommandGrammar::toggleOffActionID )
-   {
-      f = ButtonQuery(wandIf->getButton(buttonIndex(i->children.begin())),
-                      gadget::Digital::TOGGLE_OFF);
-   }
-   else if ( i->value.id() == CommandGrammar::andExpressionID )
-   {
-      f = and_(eval(i->children.begin(), wandIf),
-               eval(i->children.begin() + 1, wandIf));
-   }
-   else if ( i->value.id() == CommandGrammar::xorExpressionID )
-   {
-      f = xor_(eval(i->children.begin(), wandIf),
-               eval(i->children.begin() + 1, wandIf));
+      gadget::Digital::State state(gadget::Digital::OFF);
+
+      if ( id == CommandGrammar::onActionID )
+      {
+         state = gadget::Digital::ON;
+      }
+      else if ( id == CommandGrammar::toggleOnActionID )
+      {
+         state = gadget::Digital::TOGGLE_ON;
+      }
+      else if ( id == CommandGrammar::toggleOffActionID )
+      {
+         state = gadget::Digital::TOGGLE_OFF;
+      }
+
+      const unsigned int button(buttonIndex(i->children.begin()));
+
+      if ( button < wandIf->getNumButtons() )
+      {
+         program.push_back(
+            instruction_t(instruction_t::TEST,
+                          vrkit::WandSnapshot::getButtonStateBit(button,
+                                                                 state))
+         );
+      }
+      else if ( state == gadget::Digital::OFF )
+      {
+         program.push_back(instruction_t(instruction_t::PUSH_TRUE));
+      }
+      else
+      {
+         program.push_back(instruction_t(instruction_t::PUSH_FALSE));
+      }
+
+      return 1;
    }
-   else if ( i->value.id() == CommandGrammar::orExpressionID )
+   else if ( id == CommandGrammar::andExpressionID ||
+             id == CommandGrammar::xorExpressionID ||
+             id == CommandGrammar::orExpressionID )
    {
-      f = or_(eval(i->children.begin(), wandIf),
-              eval(i->children.begin() + 1, wandIf));
+      const unsigned int lhs_depth(compile(i->children.begin(), wandIf,
+                                           program));
+      const unsigned int rhs_depth(compile(i->children.begin() + 1, wandIf,
+                                           program));
+
+      if ( id == CommandGrammar::andExpressionID )
+      {
+         program.push_back(instruction_t(instruction_t::AND));
+      }
+      else if ( id == CommandGrammar::xorExpressionID )
+      {
+         program.push_back(instruction_t(instruction_t::XOR));
+      }
+      else
+      {
+         program.push_back(instruction_t(instruction_t::OR));
+      }
+
+      // The value of the left-hand side is on the stack while the right-hand
+      // side is evaluated.
+      return std::max(lhs_depth, rhs_depth + 1);
    }
-   else if ( i->value.id() == CommandGrammar::negationID )
+   else if ( id == CommandGrammar::negationID )
    {
-      f = not_(eval(i->children.begin(), wandIf));
+      const unsigned int depth(compile(i->children.begin(), wandIf, program));
+      program.push_back(instruction_t(instruction_t::NOT));
+      return depth;
    }
    else
    {
       vprASSERT(false && "Encountered unexpected tree node type");
-      // XXX: It might be worthwhile to throw an exception here for the
-      // non-debug case.
+      throw vrkit::Exception("Encountered unexpected tree node type",
+                             VRKIT_LOCATION);
    }
-
-   return f;
 }
 
 }
@@ -463,12 +408,12 @@ void DigitalCommand::configure(std::string buttonString,
                    << "deprecated.\n"
                  << "         Consider using an empty string instead."
                  << std::endl;
-      mTestFunc = &DigitalCommand::dummyTest;
+      mProgram.clear();
       return;
    }
    else if ( buttonString.empty() )
    {
-      mTestFunc = &DigitalCommand::dummyTest;
+      mProgram.clear();
       return;
    }
 
@@ -478,8 +423,20 @@ void DigitalCommand::configure(std::string buttonString,
 
    if ( info.full )
    {
+      std::vector<Instruction> program;
+      const unsigned int depth(compile(info.trees.begin(), wandIf, program));
+
+      // The operand stack used by test() is a single 64-bit integer.
+      if ( depth > 64 )
+      {
+         std::ostringstream msg_stream;
+         msg_stream << "Expression is nested too deeply: " << buttonString;
+         throw Exception(msg_stream.str(), VRKIT_LOCATION);
+      }
+
       mConfigString = buttonString;
-      mTestFunc     = eval(info.trees.begin(), wandIf);
+      mWandIf       = wandIf;
+      mProgram.swap(program);
    }
    else
    {
@@ -491,6 +448,51 @@ void DigitalCommand::configure(std::string buttonString,
    }
 }
 
+bool DigitalCommand::test() const
+{
+   if ( mProgram.empty() )
+   {
+      return false;
+   }
+
+   const std::vector<vpr::Uint64>& states(mWandIf->getSnapshot().getButtonStates());
+
+   // The operand stack. The top of the stack is the least significant bit.
+   vpr::Uint64 stack(0);
+
+   typedef std::vector<Instruction>::const_iterator iter_type;
+   for ( iter_type i = mProgram.begin(); i != mProgram.end(); ++i )
+   {
+      switch ( (*i).op )
+      {
+         case Instruction::PUSH_FALSE:
+            stack <<= 1;
+            break;
+         case Instruction::PUSH_TRUE:
+            stack = (stack << 1) | 1;
+            break;
+         case Instruction::TEST:
+            stack = (stack << 1) |
+                       ((states[(*i).bit / 64] >> ((*i).bit % 64)) & 1);
+            break;
+         case Instruction::NOT:
+            stack ^= 1;
+            break;
+         case Instruction::AND:
+            stack = (stack >> 1) & (stack | ~vpr::Uint64(1));
+            break;
+         case Instruction::OR:
+            stack = (stack >> 1) | (stack & 1);
+            break;
+         case Instruction::XOR:
+            stack = (stack >> 1) ^ (stack & 1);
+            break;
+      }
+   }
+
+   return (stack & 1) != 0;
+}
+
 bool DigitalCommand::operator==(const DigitalCommand& rhs) const
 {
    // XXX: This is not quite right. Two boolean expressions can be equivalent
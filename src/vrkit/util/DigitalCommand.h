@@ -22,8 +22,9 @@
 #include <vrkit/Config.h>
 
 #include <string>
-#include <boost/function.hpp>
+#include <vector>
 
+#include <vpr/vprTypes.h>
 #include <gadget/Type/Digital.h>
 #include <vrkit/WandInterfacePtr.h>
 
@@ -79,6 +80,11 @@ namespace util
  * is determined by querying the state of the each of the digital devices
  * associated with the command.
  *
+ * The boolean expression is compiled into a short postfix program that is
+ * evaluated against the button states in the wand snapshot captured once per
+ * frame by vrkit::WandInterface::update(). Thus, testing a digital command only
+ * requires a few integer operations per button in the expression.
+ *
  * @since 0.15.0
  *
  * @note This class was moved into the vrkit::util namespace in version 0.47.
@@ -111,7 +117,8 @@ public:
     *
     * @see vrkit::WandInterface
     *
-    * @throw vrkit::Exception Thrown if a parse error occurs.
+    * @throw vrkit::Exception Thrown if a parse error occurs or if the
+    *                         expression is nested too deeply.
     *
     * @since 0.41.0
     */
@@ -127,7 +134,7 @@ public:
     */
    bool isConfigured() const
    {
-      return ! mConfigString.empty() && ! mTestFunc.empty();
+      return ! mConfigString.empty() && ! mProgram.empty();
    }
    //@}
 
@@ -139,12 +146,12 @@ public:
     * @pre This digital command was configured successfully. If it was not,
     *      then false is always returned.
     *
+    * @note The button states tested are those of the snapshot captured by
+    *       the most recent call to vrkit::WandInterface::update().
+    *
     * @since 0.41.0
     */
-   bool test() const
-   {
-      return mTestFunc.empty() ? false : mTestFunc();
-   }
+   bool test() const;
 
    /**
     * A synonym for test().
@@ -194,20 +201,41 @@ public:
     */
    bool operator==(const DigitalCommand& rhs) const;
 
-private:
    /**
-    * Used for simple state tests such as the case of a disabled digital
-    * command. This always returns false.
+    * A single operation of a compiled boolean expression. Operands are kept
+    * on a stack of bits with the top of the stack in the least significant
+    * bit.
     *
-    * @since 0.41.0
+    * @since 0.51.11
     */
-   static bool dummyTest()
+   struct Instruction
    {
-      return false;
-   }
+      enum OpCode
+      {
+         PUSH_FALSE,    /**< Push false */
+         PUSH_TRUE,     /**< Push true */
+         TEST,          /**< Push the value of button state bit \c bit */
+         NOT,           /**< Negate the top of the stack */
+         AND,           /**< Replace the top two values with their and */
+         OR,            /**< Replace the top two values with their or */
+         XOR            /**< Replace the top two values with their xor */
+      };
+
+      Instruction(const OpCode o, const vpr::Uint32 b = 0)
+         : op(o)
+         , bit(b)
+      {
+         /* Do nothing. */ ;
+      }
+
+      OpCode      op;
+      vpr::Uint32 bit;
+   };
 
+private:
    std::string              mConfigString;
-   boost::function<bool ()> mTestFunc;
+   WandInterfacePtr         mWandIf;
+   std::vector<Instruction> mProgram;     /**< Compiled expression */
 };
 
 }
@@ -23,7 +23,6 @@
 
 #include <string>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/signals/connection.hpp>
 
 #include <snx/SoundHandle.h>
 
@@ -31,6 +30,7 @@
 
 #include <vrkit/SceneObjectPtr.h>
 #include <vrkit/ViewerPtr.h>
+#include <vrkit/signal/Connection.h>
 #include <vrkit/scenedata/Event.h>
 #include <vrkit/util/EventSoundPlayerPtr.h>
 
@@ -102,7 +102,7 @@ private:
 
    std::string                mIntersectSoundName;
    snx::SoundHandle           mIntersectSound;
-   boost::signals::connection mIntersectSlotConnection;
+   signal::Connection mIntersectSlotConnection;
    //@}
 
    /** @name Select */
@@ -116,7 +116,7 @@ private:
 
    std::string                mSelectSoundName;
    snx::SoundHandle           mSelectSound;
-   boost::signals::connection mSelectSlotConnection;
+   signal::Connection mSelectSlotConnection;
    //@}
 };
 
@@ -0,0 +1,415 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <sstream>
+
+#include <gmtl/Point.h>
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGDistanceLOD.h>
+#include <OpenSG/OSGTriangleIterator.h>
+#if OSG_MAJOR_VERSION >= 2
+#  include <OpenSG/OSGGeoProperties.h>
+#endif
+
+#include <vpr/vprTypes.h>
+
+#include <vrkit/util/MeshSimplifier.h>
+#include <vrkit/util/LODGenerator.h>
+
+
+namespace
+{
+
+/**
+ * The angle (in radians) subtended by the error of a level at the distance
+ * where that level is shown if no range is configured for it.
+ */
+const float sDefaultErrorAngle(0.001f);
+
+/**
+ * A level has to have no more than this fraction of the triangles of the
+ * level before it to be worth keeping.
+ */
+const float sMaxLevelRatio(0.75f);
+
+OSG::GeometryPtr getGeometry(OSG::NodePtr node)
+{
+#if OSG_MAJOR_VERSION < 2
+   return OSG::GeometryPtr::dcast(node->getCore());
+#else
+   return OSG::cast_dynamic<OSG::GeometryPtr>(node->getCore());
+#endif
+}
+
+bool isDistanceLOD(OSG::NodePtr node)
+{
+#if OSG_MAJOR_VERSION < 2
+   return OSG::NullFC != OSG::DistanceLODPtr::dcast(node->getCore());
+#else
+   return OSG::NullFC !=
+             OSG::cast_dynamic<OSG::DistanceLODPtr>(node->getCore());
+#endif
+}
+
+/**
+ * Collects the geometry leaf nodes below \p node that are not below a
+ * distance LOD node already and that are not excluded.
+ */
+void collectGeometry(OSG::NodePtr node,
+                     const vrkit::util::LODGenerator::predicate_t& exclude,
+                     std::vector<OSG::NodePtr>& nodes)
+{
+   if ( OSG::NullFC == node || isDistanceLOD(node) )
+   {
+      return;
+   }
+
+   const OSG::UInt32 num_children(node->getNChildren());
+
+   if ( num_children == 0 )
+   {
+      if ( OSG::NullFC != getGeometry(node) &&
+           (exclude.empty() || ! exclude(node)) )
+      {
+         nodes.push_back(node);
+      }
+   }
+   else
+   {
+      for ( OSG::UInt32 c = 0; c < num_children; ++c )
+      {
+         collectGeometry(node->getChild(c), exclude, nodes);
+      }
+   }
+}
+
+/**
+ * Creates a node for a level of detail of \p geom. The new geometry core
+ * shares the material and vertex properties of \p geom and draws the given
+ * triangles.
+ */
+OSG::NodePtr makeLevel(OSG::GeometryPtr geom,
+                       const std::vector<vpr::Uint32>& triangles)
+{
+   OSG::GeoPTypesUI8Ptr types     = OSG::GeoPTypesUI8::create();
+   OSG::GeoPLengthsUI32Ptr lens   = OSG::GeoPLengthsUI32::create();
+   OSG::GeoIndicesUI32Ptr indices = OSG::GeoIndicesUI32::create();
+
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor te(types);
+      OSG::CPEditor le(lens);
+      OSG::CPEditor ie(indices);
+
+      OSG::GeoPTypesUI8::StoredFieldType* type_field =
+         types->getFieldPtr();
+      OSG::GeoPLengthsUI32::StoredFieldType* len_field =
+         lens->getFieldPtr();
+      OSG::GeoIndicesUI32::StoredFieldType* index_field =
+         indices->getFieldPtr();
+#else
+      OSG::GeoPTypesUI8::StoredFieldType* type_field =
+         types->editFieldPtr();
+      OSG::GeoPLengthsUI32::StoredFieldType* len_field =
+         lens->editFieldPtr();
+      OSG::GeoIndicesUI32::StoredFieldType* index_field =
+         indices->editFieldPtr();
+#endif
+
+      type_field->push_back(GL_TRIANGLES);
+      len_field->push_back(triangles.size());
+
+      index_field->reserve(triangles.size());
+      for ( std::vector<vpr::Uint32>::const_iterator i = triangles.begin();
+            i != triangles.end();
+            ++i )
+      {
+         index_field->push_back(*i);
+      }
+   }
+
+   OSG::GeometryPtr level_geom = OSG::Geometry::create();
+
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor lge(level_geom);
+#endif
+      level_geom->setTypes(types);
+      level_geom->setLengths(lens);
+      level_geom->setIndices(indices);
+      level_geom->setPositions(geom->getPositions());
+      level_geom->setNormals(geom->getNormals());
+      level_geom->setColors(geom->getColors());
+      level_geom->setSecondaryColors(geom->getSecondaryColors());
+      level_geom->setTexCoords(geom->getTexCoords());
+      level_geom->setTexCoords1(geom->getTexCoords1());
+      level_geom->setTexCoords2(geom->getTexCoords2());
+      level_geom->setTexCoords3(geom->getTexCoords3());
+      level_geom->setTexCoords4(geom->getTexCoords4());
+      level_geom->setTexCoords5(geom->getTexCoords5());
+      level_geom->setTexCoords6(geom->getTexCoords6());
+      level_geom->setTexCoords7(geom->getTexCoords7());
+      level_geom->setMaterial(geom->getMaterial());
+   }
+
+   OSG::NodePtr level_node = OSG::Node::create();
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor lne(level_node, OSG::Node::CoreFieldMask);
+#endif
+   level_node->setCore(level_geom);
+
+   return level_node;
+}
+
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+const unsigned int LODGenerator::MAX_LEVELS;
+
+LODGenerator::LODGenerator()
+   : mMinTriangles(0)
+{
+   /* Do nothing. */ ;
+}
+
+void LODGenerator::setLevels(const std::vector<float>& errors,
+                             const std::vector<float>& ranges)
+{
+   mErrors.clear();
+   for ( std::vector<float>::const_iterator e = errors.begin();
+         e != errors.end();
+         ++e )
+   {
+      if ( *e > 0.0f )
+      {
+         mErrors.push_back(*e);
+      }
+   }
+
+   std::sort(mErrors.begin(), mErrors.end());
+
+   if ( mErrors.size() > MAX_LEVELS )
+   {
+      mErrors.resize(MAX_LEVELS);
+   }
+
+   // Fill in the missing ranges and make sure that each range is beyond
+   // the one before it.
+   mRanges.clear();
+   for ( std::vector<float>::size_type i = 0; i < mErrors.size(); ++i )
+   {
+      float range = i < ranges.size() ? ranges[i]
+                                      : mErrors[i] / sDefaultErrorAngle;
+
+      if ( ! mRanges.empty() )
+      {
+         range = std::max(range, mRanges.back());
+      }
+
+      mRanges.push_back(range);
+   }
+}
+
+std::string LODGenerator::getDescription() const
+{
+   std::ostringstream desc_stream;
+   desc_stream << "lod errors";
+   for ( std::vector<float>::size_type i = 0; i < mErrors.size(); ++i )
+   {
+      desc_stream << " " << mErrors[i];
+   }
+
+   desc_stream << " ranges";
+   for ( std::vector<float>::size_type i = 0; i < mRanges.size(); ++i )
+   {
+      desc_stream << " " << mRanges[i];
+   }
+
+   desc_stream << " min_triangles " << mMinTriangles;
+
+   return desc_stream.str();
+}
+
+unsigned int LODGenerator::generate(OSG::NodePtr root,
+                                    const predicate_t& exclude) const
+{
+   if ( ! isEnabled() )
+   {
+      return 0;
+   }
+
+   // The nodes are collected first because adding the levels changes the
+   // graph.
+   std::vector<OSG::NodePtr> nodes;
+   collectGeometry(root, exclude, nodes);
+
+   unsigned int count(0);
+   for ( std::vector<OSG::NodePtr>::iterator n = nodes.begin();
+         n != nodes.end();
+         ++n )
+   {
+      if ( addLevels(*n) )
+      {
+         ++count;
+      }
+   }
+
+   return count;
+}
+
+bool LODGenerator::addLevels(OSG::NodePtr node) const
+{
+   OSG::GeometryPtr geom = getGeometry(node);
+
+   // The levels share the vertex properties of the original geometry, and
+   // this is only possible if all of them use the same index.
+#if OSG_MAJOR_VERSION < 2
+   if ( geom->getIndexMapping().size() > 1 )
+#else
+   if ( ! geom->isSingleIndex() )
+#endif
+   {
+      return false;
+   }
+
+   std::vector<gmtl::Point3f> positions;
+   std::vector<vpr::Uint32> triangles;
+
+   for ( OSG::TriangleIterator t = geom->beginTriangles();
+         t != geom->endTriangles();
+         ++t )
+   {
+      for ( OSG::Int32 v = 0; v < 3; ++v )
+      {
+         const OSG::Int32 index(t.getPositionIndex(v));
+
+         if ( index < 0 )
+         {
+            return false;
+         }
+
+         if ( static_cast<vpr::Uint32>(index) >= positions.size() )
+         {
+            positions.resize(index + 1);
+         }
+
+         const OSG::Pnt3f pos(t.getPosition(v));
+         positions[index].set(pos[0], pos[1], pos[2]);
+         triangles.push_back(index);
+      }
+   }
+
+   if ( triangles.size() / 3 < mMinTriangles )
+   {
+      return false;
+   }
+
+   MeshSimplifier simplifier;
+   simplifier.init(positions, triangles);
+
+   std::vector<OSG::NodePtr> levels;
+   std::vector<float> ranges;
+   unsigned int prev_count(simplifier.getNumTriangles());
+
+   for ( std::vector<float>::size_type i = 0; i < mErrors.size(); ++i )
+   {
+      const unsigned int count(simplifier.simplify(mErrors[i]));
+
+      if ( count == 0 )
+      {
+         break;
+      }
+
+      if ( count <= sMaxLevelRatio * prev_count )
+      {
+         simplifier.getIndices(triangles);
+         levels.push_back(makeLevel(geom, triangles));
+         ranges.push_back(mRanges[i]);
+         prev_count = count;
+      }
+   }
+
+   if ( levels.empty() )
+   {
+      return false;
+   }
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::Pnt3f center;
+   node->getVolume(true).getCenter(center);
+#else
+   node->updateVolume();
+   OSG::Pnt3r center;
+   node->getVolume().getCenter(center);
+#endif
+
+   OSG::DistanceLODPtr lod = OSG::DistanceLOD::create();
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor le(lod);
+      OSG::MFReal32& lod_ranges(lod->getRange());
+#else
+      OSG::MFReal32& lod_ranges(*lod->editMFRange());
+#endif
+      lod->setCenter(center);
+
+      for ( std::vector<float>::iterator r = ranges.begin();
+            r != ranges.end();
+            ++r )
+      {
+         lod_ranges.push_back(*r);
+      }
+   }
+
+   // The original geometry moves to a new node that is the first child,
+   // which is the one shown closest to the viewer.
+   OSG::NodePtr full_node = OSG::Node::create();
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::CPEditor fne(full_node, OSG::Node::CoreFieldMask);
+#endif
+      full_node->setCore(geom);
+   }
+
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor ne(node,
+                    OSG::Node::CoreFieldMask | OSG::Node::ChildrenFieldMask);
+#endif
+   node->setCore(lod);
+   node->addChild(full_node);
+
+   for ( std::vector<OSG::NodePtr>::iterator l = levels.begin();
+         l != levels.end();
+         ++l )
+   {
+      node->addChild(*l);
+   }
+
+   return true;
+}
+
+}
+
+}
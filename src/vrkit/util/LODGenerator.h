@@ -0,0 +1,138 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_LOD_GENERATOR_H_
+#define _VRKIT_UTIL_LOD_GENERATOR_H_
+
+#include <vrkit/Config.h>
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+
+#include <OpenSG/OSGNode.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class LODGenerator LODGenerator.h vrkit/util/LODGenerator.h
+ *
+ * Adds simplified levels of detail to the geometry in a graph. Each
+ * geometry node is given an OSG::DistanceLOD core. Its first child holds the
+ * original geometry, and the other children hold copies of it that have
+ * been reduced by vrkit::util::MeshSimplifier with increasing error limits.
+ *
+ * The full resolution geometry is kept, so intersection tests that want
+ * exact results should only traverse the first child of a distance LOD
+ * node. The simplified geometry uses the same material and vertex data as
+ * the original. Only the triangle indices are new.
+ *
+ * Geometry that uses different indices for different vertex properties is
+ * left unchanged, as is geometry that cannot be reduced by a useful amount.
+ *
+ * @see vrkit::util::MeshSimplifier
+ *
+ * @since 0.51.26
+ */
+class VRKIT_CLASS_API LODGenerator
+{
+public:
+   /** The largest number of simplified levels made per geometry core. */
+   static const unsigned int MAX_LEVELS = 4;
+
+   typedef boost::function<bool (OSG::NodePtr)> predicate_t;
+
+   LODGenerator();
+
+   /**
+    * Sets the simplified levels to make.
+    *
+    * @param errors The largest distance (in the units of the model) that
+    *               simplification may move the surface for each level.
+    *               Only the smallest MAX_LEVELS values are used. If this is
+    *               empty, no levels are made.
+    * @param ranges The distances from the viewer (in world coordinates)
+    *               beyond which each level is shown, in the order of
+    *               increasing error. If fewer ranges than errors are given,
+    *               a level without a range is shown once its error is less
+    *               than a milliradian as seen from the viewer (about one
+    *               pixel on a typical display), assuming that the model is
+    *               not scaled.
+    */
+   void setLevels(const std::vector<float>& errors,
+                  const std::vector<float>& ranges = std::vector<float>());
+
+   /**
+    * Sets the number of triangles below which geometry is left unchanged.
+    */
+   void setMinTriangles(const unsigned int count)
+   {
+      mMinTriangles = count;
+   }
+
+   bool isEnabled() const
+   {
+      return ! mErrors.empty();
+   }
+
+   /**
+    * Returns a string that describes the settings of this object. This is
+    * meant to identify graphs processed by this object in
+    * vrkit::util::SceneCache.
+    */
+   std::string getDescription() const;
+
+   /**
+    * Adds levels of detail to the geometry in the graph rooted at the given
+    * node. Graphs that already have distance LOD nodes are not changed
+    * below those nodes.
+    *
+    * @param root    The root of the graph.
+    * @param exclude A predicate that identifies the geometry nodes that must
+    *                keep their cores, such as nodes that will be the roots
+    *                of scene objects. If it is empty, no nodes are
+    *                excluded.
+    *
+    * @return The number of geometry cores that were given levels of detail.
+    */
+   unsigned int generate(OSG::NodePtr root,
+                         const predicate_t& exclude = predicate_t()) const;
+
+private:
+   /**
+    * Gives the given geometry node levels of detail.
+    *
+    * @return false is returned if the node was not changed.
+    */
+   bool addLevels(OSG::NodePtr node) const;
+
+   std::vector<float> mErrors;
+   std::vector<float> mRanges;
+   unsigned int       mMinTriangles;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_LOD_GENERATOR_H_ */
@@ -0,0 +1,230 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <gmtl/MatrixOps.h>
+#include <gmtl/External/OpenSGConvert.h>
+
+#include <OpenSG/OSGMatrix.h>
+#include <OpenSG/OSGDistanceLOD.h>
+
+#include <vrkit/util/LODPrefetcher.h>
+
+
+namespace
+{
+
+OSG::DistanceLODPtr getDistanceLOD(OSG::NodePtr node)
+{
+#if OSG_MAJOR_VERSION < 2
+   return OSG::DistanceLODPtr::dcast(node->getCore());
+#else
+   return OSG::cast_dynamic<OSG::DistanceLODPtr>(node->getCore());
+#endif
+}
+
+void collectLODs(OSG::NodePtr node, std::vector<OSG::NodeRefPtr>& nodes)
+{
+   if ( OSG::NullFC == node )
+   {
+      return;
+   }
+
+   if ( OSG::NullFC != getDistanceLOD(node) )
+   {
+      nodes.push_back(OSG::NodeRefPtr(node));
+   }
+
+   const OSG::UInt32 num_children(node->getNChildren());
+   for ( OSG::UInt32 c = 0; c < num_children; ++c )
+   {
+      collectLODs(node->getChild(c), nodes);
+   }
+}
+
+/**
+ * Returns the index of the child that the given distance LOD node shows
+ * at the given distance from the viewer.
+ */
+unsigned int getLevel(const std::vector<float>& ranges,
+                      const unsigned int numChildren, const float distance)
+{
+   unsigned int level(0);
+   while ( level < ranges.size() && distance >= ranges[level] )
+   {
+      ++level;
+   }
+
+   return std::min(level, numChildren - 1);
+}
+
+std::vector<float> getRanges(OSG::DistanceLODPtr lod)
+{
+#if OSG_MAJOR_VERSION < 2
+   const OSG::MFReal32& lod_ranges(lod->getRange());
+#else
+   const OSG::MFReal32& lod_ranges(*lod->getMFRange());
+#endif
+
+   std::vector<float> ranges;
+   for ( OSG::UInt32 i = 0; i < lod_ranges.size(); ++i )
+   {
+      ranges.push_back(lod_ranges[i]);
+   }
+
+   return ranges;
+}
+
+void setRanges(OSG::DistanceLODPtr lod, const std::vector<float>& ranges)
+{
+#if OSG_MAJOR_VERSION < 2
+   OSG::CPEditor le(lod, OSG::DistanceLOD::RangeFieldMask);
+   OSG::MFReal32& lod_ranges(lod->getRange());
+#else
+   OSG::MFReal32& lod_ranges(*lod->editMFRange());
+#endif
+
+   lod_ranges.clear();
+   for ( std::vector<float>::const_iterator r = ranges.begin();
+         r != ranges.end();
+         ++r )
+   {
+      lod_ranges.push_back(*r);
+   }
+}
+
+float getDistance(const OSG::Pnt3f& pos, const gmtl::Point3f& headPos)
+{
+   const float dx(pos[0] - headPos[0]);
+   const float dy(pos[1] - headPos[1]);
+   const float dz(pos[2] - headPos[2]);
+   return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+LODPrefetcher::LODPrefetcher()
+{
+   /* Do nothing. */ ;
+}
+
+void LODPrefetcher::addGraph(OSG::NodePtr root)
+{
+   collectLODs(root, mLODNodes);
+}
+
+unsigned int LODPrefetcher::prefetch(const gmtl::Matrix44f& vw_M_vp,
+                                     const gmtl::Matrix44f& vw_M_vpDest,
+                                     const gmtl::Point3f& headPos)
+{
+   release();
+
+   // The scene graph is rooted in the view platform frame, so the center
+   // of a node at the destination is found by taking it from the current
+   // view platform frame to that of the destination.
+   gmtl::Matrix44f vpDest_M_vw;
+   gmtl::invert(vpDest_M_vw, vw_M_vpDest);
+   OSG::Matrix vpDest_M_vp;
+   gmtl::set(vpDest_M_vp, vpDest_M_vw * vw_M_vp);
+
+   typedef std::vector<OSG::NodeRefPtr>::iterator iter_type;
+   for ( iter_type n = mLODNodes.begin(); n != mLODNodes.end(); ++n )
+   {
+      OSG::DistanceLODPtr lod(getDistanceLOD(*n));
+      const OSG::UInt32 num_children((*n)->getNChildren());
+
+      if ( OSG::NullFC == lod || num_children < 2 )
+      {
+         continue;
+      }
+
+      OSG::Matrix vp_M_node;
+      (*n)->getToWorld(vp_M_node);
+
+      OSG::Pnt3f cur_pos(lod->getCenter()[0], lod->getCenter()[1],
+                         lod->getCenter()[2]);
+#if OSG_MAJOR_VERSION < 2
+      vp_M_node.multFullMatrixPnt(cur_pos);
+#else
+      vp_M_node.multFull(cur_pos, cur_pos);
+#endif
+
+      OSG::Pnt3f dest_pos(cur_pos);
+#if OSG_MAJOR_VERSION < 2
+      vpDest_M_vp.multFullMatrixPnt(dest_pos);
+#else
+      vpDest_M_vp.multFull(dest_pos, dest_pos);
+#endif
+
+      const std::vector<float> ranges(getRanges(lod));
+      const unsigned int cur_level =
+         getLevel(ranges, num_children, getDistance(cur_pos, headPos));
+      const unsigned int dest_level =
+         getLevel(ranges, num_children, getDistance(dest_pos, headPos));
+
+      if ( dest_level < cur_level )
+      {
+         // Zero ranges below the destination level and unreachable ranges
+         // from it on make the node show that level at any distance.
+         std::vector<float> pinned_ranges(ranges.size());
+         for ( unsigned int r = 0; r < pinned_ranges.size(); ++r )
+         {
+            pinned_ranges[r] = r < dest_level
+                                  ? 0.0f : std::numeric_limits<float>::max();
+         }
+
+         setRanges(lod, pinned_ranges);
+
+         PinnedLOD pinned;
+         pinned.node   = *n;
+         pinned.ranges = ranges;
+         mPinned.push_back(pinned);
+      }
+   }
+
+   return mPinned.size();
+}
+
+void LODPrefetcher::release()
+{
+   typedef std::vector<PinnedLOD>::iterator iter_type;
+   for ( iter_type p = mPinned.begin(); p != mPinned.end(); ++p )
+   {
+      OSG::DistanceLODPtr lod(getDistanceLOD((*p).node));
+
+      if ( OSG::NullFC != lod )
+      {
+         setRanges(lod, (*p).ranges);
+      }
+   }
+
+   mPinned.clear();
+}
+
+}
+
+}
@@ -0,0 +1,111 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_LOD_PREFETCHER_H_
+#define _VRKIT_UTIL_LOD_PREFETCHER_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/Point.h>
+
+#include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGRefPtr.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class LODPrefetcher LODPrefetcher.h vrkit/util/LODPrefetcher.h
+ *
+ * Shows the levels of detail needed at the destination of a view platform
+ * transition before the view platform gets there. When prefetch() is
+ * invoked, each distance LOD node that will show a finer level at the
+ * destination than it does now is pinned to that level. The finer levels
+ * are thus drawn (and their OpenGL objects are created) during the
+ * transition rather than all at once on arrival. release() restores the
+ * ranges of the pinned nodes.
+ *
+ * This is meant to be driven by vrkit::ViewPlatform::destinationSet(). All
+ * methods must be invoked by the application thread. The pinned ranges
+ * are ordinary field changes, so cluster slaves pin the same levels.
+ *
+ * @see vrkit::util::LODGenerator
+ *
+ * @since 0.51.28
+ */
+class VRKIT_CLASS_API LODPrefetcher
+{
+public:
+   LODPrefetcher();
+
+   /**
+    * Adds the distance LOD nodes in the graph rooted at the given node to
+    * the set of nodes handled by this object.
+    */
+   void addGraph(OSG::NodePtr root);
+
+   /**
+    * Pins the distance LOD nodes that will need a finer level at the
+    * destination. Nodes pinned by an earlier call are released first.
+    *
+    * @param vw_M_vp     The current view platform transformation.
+    * @param vw_M_vpDest The view platform transformation at the destination.
+    * @param headPos     The position of the head in view platform
+    *                    coordinates. It is assumed to stay the same
+    *                    relative to the view platform.
+    *
+    * @return The number of pinned nodes.
+    */
+   unsigned int prefetch(const gmtl::Matrix44f& vw_M_vp,
+                         const gmtl::Matrix44f& vw_M_vpDest,
+                         const gmtl::Point3f& headPos);
+
+   /**
+    * Restores the ranges of all pinned nodes.
+    */
+   void release();
+
+   bool hasPinnedNodes() const
+   {
+      return ! mPinned.empty();
+   }
+
+private:
+   /** A pinned node and its original ranges. */
+   struct PinnedLOD
+   {
+      OSG::NodeRefPtr    node;
+      std::vector<float> ranges;
+   };
+
+   std::vector<OSG::NodeRefPtr> mLODNodes;
+   std::vector<PinnedLOD>       mPinned;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_LOD_PREFETCHER_H_ */
@@ -0,0 +1,190 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#if defined(WIN32) || defined(WIN64)
+#  include <windows.h>
+#else
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <cerrno>
+#  include <cstring>
+#endif
+
+#include <sstream>
+
+#include <vrkit/Exception.h>
+#include <vrkit/util/MappedFile.h>
+
+
+namespace fs = boost::filesystem;
+
+namespace vrkit
+{
+
+namespace util
+{
+
+#if defined(WIN32) || defined(WIN64)
+
+MappedFile::MappedFile(const fs::path& file)
+   : mPath(file)
+   , mData(NULL)
+   , mSize(0)
+   , mFileHandle(INVALID_HANDLE_VALUE)
+   , mMappingHandle(NULL)
+{
+   const std::string name(file.native_file_string());
+
+   mFileHandle = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                             NULL);
+
+   if ( INVALID_HANDLE_VALUE == mFileHandle )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to open " << name << " (error "
+                 << GetLastError() << ")";
+      throw Exception(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   LARGE_INTEGER size;
+   if ( ! GetFileSizeEx(mFileHandle, &size) )
+   {
+      CloseHandle(mFileHandle);
+
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to get the size of " << name;
+      throw Exception(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   mSize = static_cast<std::size_t>(size.QuadPart);
+
+   // An empty file cannot be mapped.
+   if ( mSize > 0 )
+   {
+      mMappingHandle = CreateFileMappingA(mFileHandle, NULL, PAGE_READONLY,
+                                          0, 0, NULL);
+
+      if ( NULL != mMappingHandle )
+      {
+         mData = static_cast<const char*>(
+            MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0)
+         );
+      }
+
+      if ( NULL == mData )
+      {
+         const DWORD error(GetLastError());
+
+         if ( NULL != mMappingHandle )
+         {
+            CloseHandle(mMappingHandle);
+         }
+
+         CloseHandle(mFileHandle);
+
+         std::ostringstream msg_stream;
+         msg_stream << "Failed to map " << name << " (error " << error
+                    << ")";
+         throw Exception(msg_stream.str(), VRKIT_LOCATION);
+      }
+   }
+}
+
+MappedFile::~MappedFile()
+{
+   if ( NULL != mData )
+   {
+      UnmapViewOfFile(mData);
+      CloseHandle(mMappingHandle);
+   }
+
+   CloseHandle(mFileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const fs::path& file)
+   : mPath(file)
+   , mData(NULL)
+   , mSize(0)
+{
+   const std::string name(file.native_file_string());
+
+   const int fd = open(name.c_str(), O_RDONLY);
+
+   if ( fd < 0 )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to open " << name << ": " << std::strerror(errno);
+      throw Exception(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   struct stat file_stat;
+   if ( fstat(fd, &file_stat) != 0 )
+   {
+      const int error(errno);
+      close(fd);
+
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to get the size of " << name << ": "
+                 << std::strerror(error);
+      throw Exception(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   mSize = static_cast<std::size_t>(file_stat.st_size);
+
+   // An empty file cannot be mapped.
+   if ( mSize > 0 )
+   {
+      void* data = mmap(NULL, mSize, PROT_READ, MAP_SHARED, fd, 0);
+
+      if ( MAP_FAILED == data )
+      {
+         const int error(errno);
+         close(fd);
+
+         std::ostringstream msg_stream;
+         msg_stream << "Failed to map " << name << ": "
+                    << std::strerror(error);
+         throw Exception(msg_stream.str(), VRKIT_LOCATION);
+      }
+
+      mData = static_cast<const char*>(data);
+   }
+
+   // The mapping remains valid after the file descriptor is closed.
+   close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+   if ( NULL != mData )
+   {
+      munmap(const_cast<char*>(mData), mSize);
+   }
+}
+
+#endif
+
+}
+
+}
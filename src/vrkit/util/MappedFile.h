@@ -0,0 +1,92 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_MAPPED_FILE_H_
+#define _VRKIT_UTIL_MAPPED_FILE_H_
+
+#include <vrkit/Config.h>
+
+#include <cstddef>
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class MappedFile MappedFile.h vrkit/util/MappedFile.h
+ *
+ * A file that is mapped read-only into the address space of the process.
+ * Pages of the file are read by the operating system when they are first
+ * touched, and they can be dropped again when memory is needed, so the
+ * file may be much larger than the available memory. The mapping may be
+ * read concurrently by any number of threads.
+ *
+ * @note The whole file is mapped, so on a 32-bit system, the size of the
+ *       file is limited by the address space.
+ *
+ * @since 0.51.28
+ */
+class VRKIT_CLASS_API MappedFile : private boost::noncopyable
+{
+public:
+   /**
+    * Maps the given file.
+    *
+    * @throw vrkit::Exception Thrown if the file cannot be opened or mapped.
+    */
+   MappedFile(const boost::filesystem::path& file);
+
+   /** Unmaps the file. */
+   ~MappedFile();
+
+   const boost::filesystem::path& getPath() const
+   {
+      return mPath;
+   }
+
+   const char* getData() const
+   {
+      return mData;
+   }
+
+   std::size_t getSize() const
+   {
+      return mSize;
+   }
+
+private:
+   const boost::filesystem::path mPath;
+   const char*                   mData;
+   std::size_t                   mSize;
+
+#if defined(WIN32) || defined(WIN64)
+   void* mFileHandle;
+   void* mMappingHandle;
+#endif
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_MAPPED_FILE_H_ */
@@ -0,0 +1,186 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <set>
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGMaterialGroup.h>
+#include <OpenSG/OSGChunkMaterial.h>
+#include <OpenSG/OSGImage.h>
+#if OSG_MAJOR_VERSION < 2
+#  include <OpenSG/OSGTextureChunk.h>
+#else
+#  include <OpenSG/OSGTextureObjChunk.h>
+#endif
+
+#include <vrkit/util/MemoryUsage.h>
+
+
+namespace
+{
+
+class MemoryCounter
+{
+public:
+   MemoryCounter()
+      : mBytes(0)
+   {
+      /* Do nothing. */ ;
+   }
+
+   void countNode(OSG::NodePtr node)
+   {
+      if ( OSG::NullFC == node )
+      {
+         return;
+      }
+
+      OSG::NodeCorePtr core = node->getCore();
+
+#if OSG_MAJOR_VERSION < 2
+      OSG::GeometryPtr geom = OSG::GeometryPtr::dcast(core);
+      OSG::MaterialGroupPtr mat_group = OSG::MaterialGroupPtr::dcast(core);
+#else
+      OSG::GeometryPtr geom = OSG::cast_dynamic<OSG::GeometryPtr>(core);
+      OSG::MaterialGroupPtr mat_group =
+         OSG::cast_dynamic<OSG::MaterialGroupPtr>(core);
+#endif
+
+      if ( OSG::NullFC != geom && isNew(geom) )
+      {
+         countProperty(geom->getTypes());
+         countProperty(geom->getLengths());
+         countProperty(geom->getIndices());
+         countProperty(geom->getPositions());
+         countProperty(geom->getNormals());
+         countProperty(geom->getColors());
+         countProperty(geom->getSecondaryColors());
+         countProperty(geom->getTexCoords());
+         countProperty(geom->getTexCoords1());
+         countProperty(geom->getTexCoords2());
+         countProperty(geom->getTexCoords3());
+         countProperty(geom->getTexCoords4());
+         countProperty(geom->getTexCoords5());
+         countProperty(geom->getTexCoords6());
+         countProperty(geom->getTexCoords7());
+         countMaterial(geom->getMaterial());
+      }
+      else if ( OSG::NullFC != mat_group )
+      {
+         countMaterial(mat_group->getMaterial());
+      }
+
+      const OSG::UInt32 num_children(node->getNChildren());
+      for ( OSG::UInt32 c = 0; c < num_children; ++c )
+      {
+         countNode(node->getChild(c));
+      }
+   }
+
+   vpr::Uint64 getBytes() const
+   {
+      return mBytes;
+   }
+
+private:
+   bool isNew(OSG::FieldContainerPtr fc)
+   {
+      return mCounted.insert(fc).second;
+   }
+
+   template<typename PropPtr>
+   void countProperty(PropPtr prop)
+   {
+      if ( OSG::NullFC != prop && isNew(prop) )
+      {
+         mBytes += vpr::Uint64(
+#if OSG_MAJOR_VERSION < 2
+                      prop->getSize()
+#else
+                      prop->size()
+#endif
+                   ) * prop->getDimension() * prop->getFormatSize();
+      }
+   }
+
+   void countMaterial(OSG::MaterialPtr mat)
+   {
+#if OSG_MAJOR_VERSION < 2
+      OSG::ChunkMaterialPtr chunk_mat = OSG::ChunkMaterialPtr::dcast(mat);
+#else
+      OSG::ChunkMaterialPtr chunk_mat =
+         OSG::cast_dynamic<OSG::ChunkMaterialPtr>(mat);
+#endif
+
+      if ( OSG::NullFC == chunk_mat || ! isNew(chunk_mat) )
+      {
+         return;
+      }
+
+#if OSG_MAJOR_VERSION < 2
+      const OSG::UInt32 num_chunks(chunk_mat->getChunks().size());
+#else
+      const OSG::UInt32 num_chunks(chunk_mat->getMFChunks()->size());
+#endif
+
+      for ( OSG::UInt32 i = 0; i < num_chunks; ++i )
+      {
+#if OSG_MAJOR_VERSION < 2
+         OSG::TextureChunkPtr tex =
+            OSG::TextureChunkPtr::dcast(chunk_mat->getChunks(i));
+#else
+         OSG::TextureObjChunkPtr tex =
+            OSG::cast_dynamic<OSG::TextureObjChunkPtr>(
+               chunk_mat->getChunks(i)
+            );
+#endif
+
+         if ( OSG::NullFC != tex )
+         {
+            OSG::ImagePtr image = tex->getImage();
+
+            if ( OSG::NullFC != image && isNew(image) )
+            {
+               mBytes += image->getSize();
+            }
+         }
+      }
+   }
+
+   std::set<OSG::FieldContainerPtr> mCounted;
+   vpr::Uint64                      mBytes;
+};
+
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+vpr::Uint64 estimateMemoryUsage(OSG::NodePtr root)
+{
+   MemoryCounter counter;
+   counter.countNode(root);
+   return counter.getBytes();
+}
+
+}
+
+}
@@ -0,0 +1,51 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_MEMORY_USAGE_H_
+#define _VRKIT_UTIL_MEMORY_USAGE_H_
+
+#include <vrkit/Config.h>
+
+#include <vpr/vprTypes.h>
+
+#include <OpenSG/OSGNode.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/**
+ * Estimates the number of bytes used by the geometry and texture images in
+ * the graph rooted at the given node. Field containers that are shared
+ * within the graph are counted once. The overhead of nodes, cores, and
+ * OpenGL objects is not included, so the result is a lower bound that is
+ * meant for comparing graphs and for keeping to a memory budget.
+ *
+ * @since 0.51.27
+ */
+VRKIT_API(vpr::Uint64) estimateMemoryUsage(OSG::NodePtr root);
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_MEMORY_USAGE_H_ */
@@ -0,0 +1,486 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <vrkit/util/MeshSimplifier.h>
+
+
+namespace
+{
+
+/**
+ * The weight of the planes that hold vertices on open edges in place,
+ * relative to the planes of the triangles.
+ */
+const double sBoundaryWeight(10.0);
+
+/**
+ * The smallest cosine of the angle through which a collapse may turn a
+ * triangle. Larger turns are treated as fold-overs.
+ */
+const double sMinNormalCosine(0.2);
+
+inline void sub(double r[3], const gmtl::Point3f& a, const gmtl::Point3f& b)
+{
+   r[0] = a[0] - b[0];
+   r[1] = a[1] - b[1];
+   r[2] = a[2] - b[2];
+}
+
+inline void cross(double r[3], const double a[3], const double b[3])
+{
+   r[0] = a[1] * b[2] - a[2] * b[1];
+   r[1] = a[2] * b[0] - a[0] * b[2];
+   r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline double dot(const double a[3], const double b[3])
+{
+   return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/**
+ * Computes the unnormalized normal of the given triangle. Its length is
+ * twice the area of the triangle.
+ */
+inline void triangleNormal(double n[3], const gmtl::Point3f& p0,
+                           const gmtl::Point3f& p1, const gmtl::Point3f& p2)
+{
+   double e1[3], e2[3];
+   sub(e1, p1, p0);
+   sub(e2, p2, p0);
+   cross(n, e1, e2);
+}
+
+/** Scales \p v to unit length. Returns false if \p v has zero length. */
+inline bool normalize(double v[3])
+{
+   const double len(std::sqrt(dot(v, v)));
+
+   if ( len <= 0.0 )
+   {
+      return false;
+   }
+
+   v[0] /= len;
+   v[1] /= len;
+   v[2] /= len;
+   return true;
+}
+
+typedef std::pair<vpr::Uint32, vpr::Uint32> edge_type;
+
+inline edge_type makeEdge(const vpr::Uint32 a, const vpr::Uint32 b)
+{
+   return a < b ? edge_type(a, b) : edge_type(b, a);
+}
+
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+MeshSimplifier::Quadric::Quadric()
+{
+   std::fill(m, m + 10, 0.0);
+}
+
+void MeshSimplifier::Quadric::addPlane(const double n[3], const double d,
+                                       const double weight)
+{
+   m[0] += weight * n[0] * n[0];
+   m[1] += weight * n[0] * n[1];
+   m[2] += weight * n[0] * n[2];
+   m[3] += weight * n[0] * d;
+   m[4] += weight * n[1] * n[1];
+   m[5] += weight * n[1] * n[2];
+   m[6] += weight * n[1] * d;
+   m[7] += weight * n[2] * n[2];
+   m[8] += weight * n[2] * d;
+   m[9] += weight * d * d;
+}
+
+MeshSimplifier::Quadric&
+MeshSimplifier::Quadric::operator+=(const Quadric& q)
+{
+   for ( unsigned int i = 0; i < 10; ++i )
+   {
+      m[i] += q.m[i];
+   }
+
+   return *this;
+}
+
+double MeshSimplifier::Quadric::evaluate(const gmtl::Point3f& p) const
+{
+   const double x(p[0]), y(p[1]), z(p[2]);
+   const double result =
+      m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z +
+      2.0 * m[3] * x + m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +
+      m[7] * z * z + 2.0 * m[8] * z + m[9];
+
+   // Rounding can make the result slightly negative.
+   return std::max(result, 0.0);
+}
+
+MeshSimplifier::MeshSimplifier()
+   : mNumTriangles(0)
+{
+   /* Do nothing. */ ;
+}
+
+void MeshSimplifier::init(const std::vector<gmtl::Point3f>& positions,
+                          const std::vector<vpr::Uint32>& indices)
+{
+   const vpr::Uint32 num_verts(positions.size());
+
+   mPositions = positions;
+   mTriangles.clear();
+   mTriangles.reserve(indices.size());
+   mVertexTris.assign(num_verts, std::vector<vpr::Uint32>());
+   mQuadrics.assign(num_verts, Quadric());
+   mStamps.assign(num_verts, 0);
+   mCollapses = std::priority_queue<
+                   Collapse, std::vector<Collapse>, std::greater<Collapse>
+                >();
+
+   std::vector<edge_type> edges;
+   edges.reserve(indices.size());
+
+   for ( std::vector<vpr::Uint32>::size_type i = 0; i + 2 < indices.size();
+         i += 3 )
+   {
+      const vpr::Uint32 v[3] = { indices[i], indices[i + 1], indices[i + 2] };
+
+      if ( v[0] >= num_verts || v[1] >= num_verts || v[2] >= num_verts ||
+           v[0] == v[1] || v[1] == v[2] || v[2] == v[0] )
+      {
+         continue;
+      }
+
+      double n[3];
+      triangleNormal(n, mPositions[v[0]], mPositions[v[1]], mPositions[v[2]]);
+
+      if ( ! normalize(n) )
+      {
+         continue;
+      }
+
+      const double d(-(n[0] * mPositions[v[0]][0] +
+                       n[1] * mPositions[v[0]][1] +
+                       n[2] * mPositions[v[0]][2]));
+
+      const vpr::Uint32 tri(mTriangles.size() / 3);
+
+      for ( unsigned int c = 0; c < 3; ++c )
+      {
+         mTriangles.push_back(v[c]);
+         mVertexTris[v[c]].push_back(tri);
+         mQuadrics[v[c]].addPlane(n, d, 1.0);
+         edges.push_back(makeEdge(v[c], v[(c + 1) % 3]));
+      }
+   }
+
+   mNumTriangles = mTriangles.size() / 3;
+   mRemoved.assign(mNumTriangles, false);
+
+   // An edge used by only one triangle is open. Its end points get a plane
+   // through the edge perpendicular to the triangle so that they do not
+   // move away from the edge.
+   std::vector<edge_type> open_edges;
+   std::sort(edges.begin(), edges.end());
+
+   for ( std::vector<edge_type>::size_type i = 0; i < edges.size(); )
+   {
+      std::vector<edge_type>::size_type j(i + 1);
+      while ( j < edges.size() && edges[j] == edges[i] )
+      {
+         ++j;
+      }
+
+      if ( j - i == 1 )
+      {
+         open_edges.push_back(edges[i]);
+      }
+
+      i = j;
+   }
+
+   if ( ! open_edges.empty() )
+   {
+      for ( vpr::Uint32 tri = 0; tri < mNumTriangles; ++tri )
+      {
+         const vpr::Uint32* v = &mTriangles[tri * 3];
+
+         double n[3];
+         triangleNormal(n, mPositions[v[0]], mPositions[v[1]],
+                        mPositions[v[2]]);
+         normalize(n);
+
+         for ( unsigned int c = 0; c < 3; ++c )
+         {
+            const vpr::Uint32 a(v[c]), b(v[(c + 1) % 3]);
+
+            if ( std::binary_search(open_edges.begin(), open_edges.end(),
+                                    makeEdge(a, b)) )
+            {
+               double e[3], bn[3];
+               sub(e, mPositions[b], mPositions[a]);
+               cross(bn, e, n);
+
+               if ( normalize(bn) )
+               {
+                  const double d(-(bn[0] * mPositions[a][0] +
+                                   bn[1] * mPositions[a][1] +
+                                   bn[2] * mPositions[a][2]));
+                  mQuadrics[a].addPlane(bn, d, sBoundaryWeight);
+                  mQuadrics[b].addPlane(bn, d, sBoundaryWeight);
+               }
+            }
+         }
+      }
+   }
+
+   // Every edge can be collapsed in either direction. Each interior edge is
+   // visited once in each direction by its two triangles, but an open edge
+   // is visited only once.
+   for ( vpr::Uint32 tri = 0; tri < mNumTriangles; ++tri )
+   {
+      const vpr::Uint32* v = &mTriangles[tri * 3];
+
+      for ( unsigned int c = 0; c < 3; ++c )
+      {
+         const vpr::Uint32 a(v[c]), b(v[(c + 1) % 3]);
+         pushCollapse(a, b);
+
+         if ( std::binary_search(open_edges.begin(), open_edges.end(),
+                                 makeEdge(a, b)) )
+         {
+            pushCollapse(b, a);
+         }
+      }
+   }
+}
+
+unsigned int MeshSimplifier::simplify(const float maxError,
+                                      const unsigned int minTriangles)
+{
+   const double max_cost(double(maxError) * double(maxError));
+
+   while ( ! mCollapses.empty() && mNumTriangles > minTriangles )
+   {
+      const Collapse c(mCollapses.top());
+
+      // The queue is left intact so that a later call with a larger error
+      // limit can continue from here.
+      if ( c.cost > max_cost )
+      {
+         break;
+      }
+
+      mCollapses.pop();
+
+      if ( c.fromStamp == mStamps[c.from] && c.toStamp == mStamps[c.to] &&
+           isValid(c) )
+      {
+         apply(c);
+      }
+   }
+
+   return mNumTriangles;
+}
+
+void MeshSimplifier::getIndices(std::vector<vpr::Uint32>& indices) const
+{
+   indices.clear();
+   indices.reserve(mNumTriangles * 3);
+
+   for ( std::vector<bool>::size_type tri = 0; tri < mRemoved.size(); ++tri )
+   {
+      if ( ! mRemoved[tri] )
+      {
+         indices.insert(indices.end(), mTriangles.begin() + tri * 3,
+                        mTriangles.begin() + tri * 3 + 3);
+      }
+   }
+}
+
+void MeshSimplifier::pushCollapse(const vpr::Uint32 from, const vpr::Uint32 to)
+{
+   Quadric q(mQuadrics[from]);
+   q += mQuadrics[to];
+
+   Collapse c;
+   c.cost      = q.evaluate(mPositions[to]);
+   c.from      = from;
+   c.to        = to;
+   c.fromStamp = mStamps[from];
+   c.toStamp   = mStamps[to];
+   mCollapses.push(c);
+}
+
+void MeshSimplifier::getNeighbors(const vpr::Uint32 v,
+                                  std::vector<vpr::Uint32>& neighbors) const
+{
+   neighbors.clear();
+
+   const std::vector<vpr::Uint32>& tris(mVertexTris[v]);
+   for ( std::vector<vpr::Uint32>::const_iterator t = tris.begin();
+         t != tris.end();
+         ++t )
+   {
+      for ( unsigned int c = 0; c < 3; ++c )
+      {
+         const vpr::Uint32 w(mTriangles[*t * 3 + c]);
+         if ( w != v )
+         {
+            neighbors.push_back(w);
+         }
+      }
+   }
+
+   std::sort(neighbors.begin(), neighbors.end());
+   neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                   neighbors.end());
+}
+
+bool MeshSimplifier::isValid(const Collapse& c) const
+{
+   unsigned int shared_tris(0);
+
+   const std::vector<vpr::Uint32>& from_tris(mVertexTris[c.from]);
+   for ( std::vector<vpr::Uint32>::const_iterator t = from_tris.begin();
+         t != from_tris.end();
+         ++t )
+   {
+      const vpr::Uint32* v = &mTriangles[*t * 3];
+
+      if ( v[0] == c.to || v[1] == c.to || v[2] == c.to )
+      {
+         ++shared_tris;
+         continue;
+      }
+
+      // This triangle will remain, with c.from replaced by c.to.
+      gmtl::Point3f p[3];
+      for ( unsigned int i = 0; i < 3; ++i )
+      {
+         p[i] = mPositions[v[i] == c.from ? c.to : v[i]];
+      }
+
+      double old_n[3], new_n[3];
+      triangleNormal(old_n, mPositions[v[0]], mPositions[v[1]],
+                     mPositions[v[2]]);
+      triangleNormal(new_n, p[0], p[1], p[2]);
+
+      if ( ! normalize(old_n) || ! normalize(new_n) ||
+           dot(old_n, new_n) < sMinNormalCosine )
+      {
+         return false;
+      }
+   }
+
+   if ( shared_tris == 0 )
+   {
+      return false;
+   }
+
+   // The link condition: the end points may have no neighbors in common
+   // other than the opposite corners of the triangles that share the edge.
+   // Otherwise, the collapse would pinch the surface.
+   std::vector<vpr::Uint32> from_nbrs, to_nbrs, common;
+   getNeighbors(c.from, from_nbrs);
+   getNeighbors(c.to, to_nbrs);
+   std::set_intersection(from_nbrs.begin(), from_nbrs.end(),
+                         to_nbrs.begin(), to_nbrs.end(),
+                         std::back_inserter(common));
+
+   return common.size() == shared_tris;
+}
+
+void MeshSimplifier::apply(const Collapse& c)
+{
+   std::vector<vpr::Uint32>& to_tris(mVertexTris[c.to]);
+   std::vector<vpr::Uint32>& from_tris(mVertexTris[c.from]);
+
+   for ( std::vector<vpr::Uint32>::iterator t = from_tris.begin();
+         t != from_tris.end();
+         ++t )
+   {
+      vpr::Uint32* v = &mTriangles[*t * 3];
+
+      if ( v[0] == c.to || v[1] == c.to || v[2] == c.to )
+      {
+         mRemoved[*t] = true;
+         --mNumTriangles;
+
+         // Remove the triangle from its other vertices.
+         for ( unsigned int i = 0; i < 3; ++i )
+         {
+            if ( v[i] != c.from )
+            {
+               std::vector<vpr::Uint32>& tris(mVertexTris[v[i]]);
+               tris.erase(std::remove(tris.begin(), tris.end(), *t),
+                          tris.end());
+            }
+         }
+      }
+      else
+      {
+         for ( unsigned int i = 0; i < 3; ++i )
+         {
+            if ( v[i] == c.from )
+            {
+               v[i] = c.to;
+            }
+         }
+
+         to_tris.push_back(*t);
+      }
+   }
+
+   from_tris.clear();
+   mQuadrics[c.to] += mQuadrics[c.from];
+
+   // Invalidate the queued collapses of both vertices and queue new ones
+   // for the edges around the merged vertex.
+   ++mStamps[c.from];
+   ++mStamps[c.to];
+
+   std::vector<vpr::Uint32> neighbors;
+   getNeighbors(c.to, neighbors);
+
+   for ( std::vector<vpr::Uint32>::iterator n = neighbors.begin();
+         n != neighbors.end();
+         ++n )
+   {
+      pushCollapse(c.to, *n);
+      pushCollapse(*n, c.to);
+   }
+}
+
+}
+
+}
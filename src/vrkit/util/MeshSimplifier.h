@@ -0,0 +1,163 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_MESH_SIMPLIFIER_H_
+#define _VRKIT_UTIL_MESH_SIMPLIFIER_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+#include <queue>
+#include <functional>
+
+#include <vpr/vprTypes.h>
+#include <gmtl/Point.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class MeshSimplifier MeshSimplifier.h vrkit/util/MeshSimplifier.h
+ *
+ * Reduces the number of triangles in an indexed triangle mesh by repeatedly
+ * collapsing the edge whose removal changes the shape of the mesh the
+ * least. The change is measured using the quadric error metric of Garland
+ * and Heckbert: each vertex accumulates the planes of the triangles that
+ * used it, and the cost of moving a vertex is the sum of the squared
+ * distances from its new position to those planes.
+ *
+ * Edges are collapsed onto one of their end points rather than onto a new
+ * vertex. The vertices of the simplified mesh are thus a subset of the
+ * original ones, so the simplified triangles can index the original
+ * normals, colors, and texture coordinates. Vertices that are used by only
+ * one triangle along an edge (including the copies of a vertex along a
+ * texture or normal seam) are held in place by additional planes, which
+ * keeps holes and seams from opening.
+ *
+ * Simplification is incremental. Each call to simplify() continues from the
+ * result of the last one, so a series of levels of detail can be made by
+ * calling it with increasing error limits and reading the triangles after
+ * each call.
+ *
+ * @since 0.51.26
+ */
+class VRKIT_CLASS_API MeshSimplifier
+{
+public:
+   MeshSimplifier();
+
+   /**
+    * Sets the mesh to simplify, discarding any earlier simplification.
+    *
+    * @param positions The vertex positions.
+    * @param indices   Three indices into \p positions per triangle.
+    *                  Degenerate triangles are discarded.
+    */
+   void init(const std::vector<gmtl::Point3f>& positions,
+             const std::vector<vpr::Uint32>& indices);
+
+   /**
+    * Collapses edges until the next one would move a vertex further than
+    * \p maxError (in the units of the positions) from the planes of its
+    * original triangles or until no more than \p minTriangles are left.
+    *
+    * @return The number of triangles left.
+    */
+   unsigned int simplify(const float maxError,
+                         const unsigned int minTriangles = 0);
+
+   unsigned int getNumTriangles() const
+   {
+      return mNumTriangles;
+   }
+
+   /**
+    * Stores the remaining triangles as three indices into the positions
+    * given to init() per triangle.
+    */
+   void getIndices(std::vector<vpr::Uint32>& indices) const;
+
+private:
+   /** A symmetric 4x4 matrix stored as its upper triangle. */
+   struct Quadric
+   {
+      Quadric();
+
+      void addPlane(const double n[3], const double d, const double weight);
+
+      Quadric& operator+=(const Quadric& q);
+
+      /** Returns the sum of the squared distances from \p p to the planes. */
+      double evaluate(const gmtl::Point3f& p) const;
+
+      double m[10];
+   };
+
+   /** A collapse of the vertex \c from onto the vertex \c to. */
+   struct Collapse
+   {
+      bool operator>(const Collapse& c) const
+      {
+         return cost > c.cost;
+      }
+
+      double      cost;
+      vpr::Uint32 from;
+      vpr::Uint32 to;
+      vpr::Uint32 fromStamp;    /**< Stale if the stamps have changed */
+      vpr::Uint32 toStamp;
+   };
+
+   void pushCollapse(const vpr::Uint32 from, const vpr::Uint32 to);
+
+   /**
+    * Collects the vertices that share a remaining triangle with \p v.
+    */
+   void getNeighbors(const vpr::Uint32 v, std::vector<vpr::Uint32>& neighbors)
+      const;
+
+   /**
+    * Determines whether collapsing \p c keeps the mesh manifold and does
+    * not flip any triangle over.
+    */
+   bool isValid(const Collapse& c) const;
+
+   void apply(const Collapse& c);
+
+   std::vector<gmtl::Point3f>               mPositions;
+   std::vector<vpr::Uint32>                 mTriangles;
+   std::vector<bool>                        mRemoved;      /**< Per triangle */
+   std::vector< std::vector<vpr::Uint32> >  mVertexTris;
+   std::vector<Quadric>                     mQuadrics;
+   std::vector<vpr::Uint32>                 mStamps;       /**< Per vertex */
+   unsigned int                             mNumTriangles;
+
+   std::priority_queue<
+      Collapse, std::vector<Collapse>, std::greater<Collapse>
+   > mCollapses;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_MESH_SIMPLIFIER_H_ */
@@ -0,0 +1,135 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gmtl/Generate.h>
+#include <gmtl/QuatOps.h>
+#include <gmtl/VecOps.h>
+#include <gmtl/AxisAngle.h>
+
+#include <vrkit/util/PosePredictor.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+PosePredictor::PosePredictor()
+   : mSmoothing(0.5f)
+   , mMaxPredictionTime(0.1f)
+   , mNumSamples(0)
+{
+   /* Do nothing. */ ;
+}
+
+void PosePredictor::setSmoothing(const float smoothing)
+{
+   mSmoothing = smoothing < 0.0f ? 0.0f
+                                 : (smoothing > 0.99f ? 0.99f : smoothing);
+}
+
+void PosePredictor::setMaxPredictionTime(const float seconds)
+{
+   mMaxPredictionTime = seconds < 0.0f ? 0.0f : seconds;
+}
+
+void PosePredictor::reset()
+{
+   mNumSamples      = 0;
+   mLinearVelocity  = gmtl::Vec3f();
+   mAngularVelocity = gmtl::Vec3f();
+}
+
+void PosePredictor::addSample(const gmtl::Matrix44f& pose,
+                              const vpr::Interval& timeStamp)
+{
+   if ( mNumSamples > 0 && ! (timeStamp > mLastTime) )
+   {
+      return;
+   }
+
+   const gmtl::Vec3f pos(gmtl::makeTrans<gmtl::Vec3f>(pose));
+   gmtl::Quatf rot;
+   gmtl::set(rot, pose);
+
+   if ( mNumSamples > 0 )
+   {
+      const float dt((timeStamp - mLastTime).secf());
+
+      const gmtl::Vec3f lin_vel((pos - mLastPos) / dt);
+
+      // The rotation from the previous sample to this one (in world
+      // coordinates), taking the shorter way around.
+      gmtl::Quatf delta_rot(rot * gmtl::makeConj(mLastRot));
+      if ( delta_rot[gmtl::Welt] < 0.0f )
+      {
+         delta_rot = -delta_rot;
+      }
+      gmtl::normalize(delta_rot);
+
+      gmtl::AxisAnglef delta_aa;
+      gmtl::set(delta_aa, delta_rot);
+      const gmtl::Vec3f ang_vel(delta_aa.getAxis() *
+                                   (delta_aa.getAngle() / dt));
+
+      // The first velocity estimate is used as is.
+      const float s(mNumSamples > 1 ? mSmoothing : 0.0f);
+      mLinearVelocity  = mLinearVelocity * s + lin_vel * (1.0f - s);
+      mAngularVelocity = mAngularVelocity * s + ang_vel * (1.0f - s);
+   }
+
+   mLastPose = pose;
+   mLastPos  = pos;
+   mLastRot  = rot;
+   mLastTime = timeStamp;
+
+   if ( mNumSamples < 2 )
+   {
+      ++mNumSamples;
+   }
+}
+
+gmtl::Matrix44f PosePredictor::predict(const float seconds) const
+{
+   if ( mNumSamples < 2 || seconds <= 0.0f )
+   {
+      return mLastPose;
+   }
+
+   const float t(seconds < mMaxPredictionTime ? seconds : mMaxPredictionTime);
+
+   gmtl::Matrix44f result(mLastPose);
+
+   const float ang_speed(gmtl::length(mAngularVelocity));
+   if ( ang_speed > 1.0e-6f )
+   {
+      const gmtl::AxisAnglef delta_aa(ang_speed * t,
+                                      mAngularVelocity / ang_speed);
+      const gmtl::Quatf rot(gmtl::make<gmtl::Quatf>(delta_aa) * mLastRot);
+      gmtl::setRot(result, rot);
+   }
+
+   gmtl::setTrans(result, mLastPos + mLinearVelocity * t);
+
+   return result;
+}
+
+}
+
+}
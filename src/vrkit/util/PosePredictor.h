@@ -0,0 +1,136 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_POSE_PREDICTOR_H_
+#define _VRKIT_UTIL_POSE_PREDICTOR_H_
+
+#include <vrkit/Config.h>
+
+#include <vpr/Util/Interval.h>
+#include <gmtl/Matrix.h>
+#include <gmtl/Vec.h>
+#include <gmtl/Quat.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class PosePredictor PosePredictor.h vrkit/util/PosePredictor.h
+ *
+ * Extrapolates a tracked pose forward in time to compensate for the latency
+ * between sampling a tracker and displaying a frame that uses the sample.
+ * The linear and angular velocities are estimated from consecutive samples
+ * and smoothed with an exponential moving average, and the most recent pose
+ * is then extrapolated assuming constant velocity.
+ *
+ * This class does not query any device. Samples are supplied by the caller
+ * along with their time stamps, so a recorded tracker trace can be fed
+ * through it to evaluate the prediction offline.
+ *
+ * @note The rotation of each sample is assumed to be free of scaling.
+ *
+ * @see vrkit::WandInterface
+ *
+ * @since 0.51.13
+ */
+class VRKIT_CLASS_API PosePredictor
+{
+public:
+   PosePredictor();
+
+   /**
+    * Sets the weight given to the previous velocity estimate when a new
+    * sample is added. A value of 0 disables smoothing. Values are clamped
+    * to the range [0,0.99].
+    */
+   void setSmoothing(const float smoothing);
+
+   float getSmoothing() const
+   {
+      return mSmoothing;
+   }
+
+   /**
+    * Sets the longest time (in seconds) by which predict() will extrapolate
+    * the pose. Longer prediction times amplify tracker noise.
+    */
+   void setMaxPredictionTime(const float seconds);
+
+   float getMaxPredictionTime() const
+   {
+      return mMaxPredictionTime;
+   }
+
+   /**
+    * Discards all samples and velocity estimates.
+    */
+   void reset();
+
+   /**
+    * Adds a tracker sample. A sample whose time stamp is not later than that
+    * of the previous sample does not change the velocity estimates.
+    */
+   void addSample(const gmtl::Matrix44f& pose, const vpr::Interval& timeStamp);
+
+   /**
+    * Returns the pose extrapolated \p seconds past the time stamp of the most
+    * recent sample. Until two samples with distinct time stamps have been
+    * added, the most recent sample is returned unchanged.
+    */
+   gmtl::Matrix44f predict(const float seconds) const;
+
+   /**
+    * Returns the estimated linear velocity in units per second.
+    */
+   const gmtl::Vec3f& getLinearVelocity() const
+   {
+      return mLinearVelocity;
+   }
+
+   /**
+    * Returns the estimated angular velocity. The direction is the axis of
+    * rotation, and the length is the rate of rotation in radians per second.
+    */
+   const gmtl::Vec3f& getAngularVelocity() const
+   {
+      return mAngularVelocity;
+   }
+
+private:
+   float mSmoothing;
+   float mMaxPredictionTime;
+
+   unsigned int    mNumSamples;
+   gmtl::Matrix44f mLastPose;
+   gmtl::Vec3f     mLastPos;
+   gmtl::Quatf     mLastRot;
+   vpr::Interval   mLastTime;
+
+   gmtl::Vec3f mLinearVelocity;
+   gmtl::Vec3f mAngularVelocity;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_POSE_PREDICTOR_H_ */
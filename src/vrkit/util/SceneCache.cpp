@@ -0,0 +1,311 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#if defined(WIN32) || defined(WIN64)
+#  include <process.h>
+#else
+#  include <sys/types.h>
+#  include <unistd.h>
+#endif
+
+#include <iomanip>
+#include <sstream>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <OpenSG/OSGSceneFileHandler.h>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Sync/Guard.h>
+
+#include <vrkit/Status.h>
+#include <vrkit/Exception.h>
+#include <vrkit/util/SceneFileLock.h>
+#include <vrkit/util/SceneCache.h>
+
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+
+/**
+ * Computes the 64-bit FNV-1a hash of the contents of the given file. The
+ * hash is seeded with the version of the cache layout and of OpenSG and with
+ * the given variant (if any).
+ *
+ * @return false is returned if the file cannot be read.
+ */
+bool hashFile(const fs::path& file, const std::string& variant,
+              vpr::Uint64& hash)
+{
+   fs::ifstream stream(file, std::ios::in | std::ios::binary);
+
+   if ( ! stream )
+   {
+      return false;
+   }
+
+   const vpr::Uint64 fnv_prime(0x100000001b3ULL);
+   hash = 0xcbf29ce484222325ULL;
+
+   std::ostringstream seed_stream;
+   seed_stream << "vrkit scene cache 1 OpenSG " << OSG_MAJOR_VERSION;
+
+   if ( ! variant.empty() )
+   {
+      seed_stream << " variant " << variant;
+   }
+
+   const std::string seed(seed_stream.str());
+
+   for ( std::string::const_iterator c = seed.begin(); c != seed.end(); ++c )
+   {
+      hash = (hash ^ static_cast<unsigned char>(*c)) * fnv_prime;
+   }
+
+   char buffer[65536];
+   while ( stream )
+   {
+      stream.read(buffer, sizeof(buffer));
+      const std::streamsize count(stream.gcount());
+
+      for ( std::streamsize i = 0; i < count; ++i )
+      {
+         hash = (hash ^ static_cast<unsigned char>(buffer[i])) * fnv_prime;
+      }
+   }
+
+   return stream.eof();
+}
+
+OSG::NodeRefPtr readSceneFile(const fs::path& file)
+{
+   vpr::Guard<vpr::Mutex> guard(vrkit::util::getSceneFileLock());
+
+   return OSG::NodeRefPtr(
+#if OSG_MAJOR_VERSION < 2
+      OSG::SceneFileHandler::the().read(file.native_file_string().c_str())
+#else
+      OSG::SceneFileHandler::the()->read(file.native_file_string().c_str())
+#endif
+   );
+}
+
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+SceneCache::SceneCache(const fs::path& cacheDir)
+   : mCacheDir(cacheDir)
+   , mTempNameCount(0)
+{
+   /* Do nothing. */ ;
+}
+
+SceneCachePtr SceneCache::create(const fs::path& cacheDir)
+{
+   try
+   {
+      fs::create_directories(cacheDir);
+   }
+   catch (fs::filesystem_error& ex)
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to create scene cache directory "
+                 << cacheDir.native_directory_string() << ": " << ex.what();
+      throw Exception(msg_stream.str(), VRKIT_LOCATION);
+   }
+
+   return SceneCachePtr(new SceneCache(cacheDir));
+}
+
+OSG::NodeRefPtr SceneCache::read(const std::string& sourceFile)
+{
+   const fs::path entry(getEntryPath(sourceFile));
+
+   if ( ! entry.empty() && fs::exists(entry) )
+   {
+      OSG::NodeRefPtr root(readSceneFile(entry));
+
+      if ( OSG::NullFC != root )
+      {
+         return root;
+      }
+
+      VRKIT_STATUS << "WARNING: Replacing unreadable scene cache entry "
+                   << entry.native_file_string() << std::endl;
+   }
+
+   OSG::NodeRefPtr root(readSceneFile(fs::path(sourceFile, fs::native)));
+
+   if ( OSG::NullFC != root && ! entry.empty() )
+   {
+      writeEntry(root, entry);
+   }
+
+   return root;
+}
+
+OSG::NodeRefPtr SceneCache::read(const std::string& sourceFile,
+                                 const std::string& variant,
+                                 const process_func_t& process)
+{
+   const fs::path entry(getEntryPath(sourceFile, variant));
+
+   if ( ! entry.empty() && fs::exists(entry) )
+   {
+      OSG::NodeRefPtr root(readSceneFile(entry));
+
+      if ( OSG::NullFC != root )
+      {
+         return root;
+      }
+
+      VRKIT_STATUS << "WARNING: Replacing unreadable scene cache entry "
+                   << entry.native_file_string() << std::endl;
+   }
+
+   // The unprocessed graph comes from the cache as well, so that changing
+   // the processing does not mean parsing the scene file again.
+   OSG::NodeRefPtr root(read(sourceFile));
+
+   if ( OSG::NullFC != root )
+   {
+      process(root);
+
+      if ( ! entry.empty() )
+      {
+         writeEntry(root, entry);
+      }
+   }
+
+   return root;
+}
+
+bool SceneCache::prewarm(const std::string& sourceFile, const bool force)
+{
+   const fs::path entry(getEntryPath(sourceFile));
+
+   if ( entry.empty() )
+   {
+      return false;
+   }
+
+   if ( ! force && fs::exists(entry) )
+   {
+      return true;
+   }
+
+   OSG::NodeRefPtr root(readSceneFile(fs::path(sourceFile, fs::native)));
+
+   return OSG::NullFC != root && writeEntry(root, entry);
+}
+
+fs::path SceneCache::getEntryPath(const std::string& sourceFile,
+                                  const std::string& variant) const
+{
+   vpr::Uint64 hash;
+
+   if ( ! hashFile(fs::path(sourceFile, fs::native), variant, hash) )
+   {
+      return fs::path();
+   }
+
+   std::ostringstream name_stream;
+   name_stream << std::hex << std::setw(16) << std::setfill('0') << hash
+               << ".osb";
+
+   return mCacheDir / name_stream.str();
+}
+
+bool SceneCache::writeEntry(OSG::NodePtr root, const fs::path& entry)
+{
+   // The temporary file has to have the .osb extension so that OpenSG
+   // writes it in the binary format.
+   std::ostringstream temp_stream;
+   temp_stream << entry.leaf() << ".";
+#if defined(WIN32) || defined(WIN64)
+   temp_stream << _getpid();
+#else
+   temp_stream << getpid();
+#endif
+
+   {
+      vpr::Guard<vpr::Mutex> guard(mTempNameLock);
+      temp_stream << "." << mTempNameCount++;
+   }
+
+   temp_stream << ".osb";
+
+   const fs::path temp_file(mCacheDir / temp_stream.str());
+
+   bool written(false);
+   {
+      vpr::Guard<vpr::Mutex> guard(getSceneFileLock());
+      written =
+#if OSG_MAJOR_VERSION < 2
+         OSG::SceneFileHandler::the().write(
+#else
+         OSG::SceneFileHandler::the()->write(
+#endif
+            root, temp_file.native_file_string().c_str()
+         );
+   }
+
+   try
+   {
+      if ( written )
+      {
+         // Another thread or process may have written the same entry in
+         // the meantime. Both have the same contents.
+         if ( fs::exists(entry) )
+         {
+            fs::remove(entry);
+         }
+
+         fs::rename(temp_file, entry);
+         return true;
+      }
+   }
+   catch (fs::filesystem_error& ex)
+   {
+      VRKIT_STATUS << "WARNING: Failed to write scene cache entry "
+                   << entry.native_file_string() << ": " << ex.what()
+                   << std::endl;
+   }
+
+   try
+   {
+      fs::remove(temp_file);
+   }
+   catch (fs::filesystem_error&)
+   {
+      /* Nothing else can be done. */ ;
+   }
+
+   return false;
+}
+
+}
+
+}
@@ -0,0 +1,178 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_SCENE_CACHE_H_
+#define _VRKIT_UTIL_SCENE_CACHE_H_
+
+#include <vrkit/Config.h>
+
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <OpenSG/OSGNode.h>
+#include <OpenSG/OSGRefPtr.h>
+
+#include <vpr/Sync/Mutex.h>
+
+#include <vrkit/util/SceneCachePtr.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class SceneCache SceneCache.h vrkit/util/SceneCache.h
+ *
+ * An on-disk cache of scene files converted to the OpenSG binary format.
+ * Text formats such as VRML and OBJ are slow to parse, so the first time a
+ * scene file is read through the cache, the loaded graph is written to the
+ * cache directory as an .osb file. Later reads of the same file load that
+ * instead.
+ *
+ * Cache entries are named by a hash of the contents of the scene file (and
+ * the major version of OpenSG). Editing the scene file therefore results in
+ * a new entry rather than a stale one, and copies of the same file share an
+ * entry. Computing the hash requires reading the scene file, but this is
+ * much cheaper than parsing it. Old entries are not removed.
+ *
+ * A graph that is processed after it is read, for example by generating
+ * levels of detail, can be cached as a variant of the scene file. Variants
+ * are named by a string that describes the processing, and that string is
+ * included in the hash of the entry.
+ *
+ * Entries are written to a temporary file that is then renamed, so it is
+ * safe for several threads or processes to use the same cache directory.
+ * Scene files and entries are read and written while holding the lock
+ * returned by vrkit::util::getSceneFileLock(), but the processing of a
+ * variant is done without it.
+ *
+ * @see vrkit::Viewer::getSceneCache()
+ *
+ * @since 0.51.24
+ */
+class VRKIT_CLASS_API SceneCache : private boost::noncopyable
+{
+protected:
+   SceneCache(const boost::filesystem::path& cacheDir);
+
+public:
+   typedef boost::function<void (OSG::NodePtr)> process_func_t;
+
+   /**
+    * Creates a cache that uses the given directory. The directory is
+    * created if it does not exist.
+    *
+    * @throw vrkit::Exception Thrown if the directory cannot be created.
+    */
+   static SceneCachePtr create(const boost::filesystem::path& cacheDir);
+
+   const boost::filesystem::path& getCacheDir() const
+   {
+      return mCacheDir;
+   }
+
+   /**
+    * Reads the given scene file through the cache. If the cache has an
+    * entry for the file, the entry is loaded. Otherwise, the file is read
+    * using OSG::SceneFileHandler and a new entry is written for it. An entry
+    * that cannot be loaded is replaced.
+    *
+    * This may be invoked concurrently from threads that are known to
+    * OpenSG.
+    *
+    * @return The root of the loaded graph or OSG::NullFC if \p sourceFile
+    *         could not be read.
+    */
+   OSG::NodeRefPtr read(const std::string& sourceFile);
+
+   /**
+    * Reads a processed variant of the given scene file through the cache.
+    * If the cache has an entry for the variant, the entry is loaded.
+    * Otherwise, the scene file is read using read(), the given function is
+    * applied to the loaded graph, and a new entry is written for the
+    * result.
+    *
+    * This may be invoked concurrently from threads that are known to
+    * OpenSG.
+    *
+    * @param sourceFile The scene file to read.
+    * @param variant    A description of the processing done by \p process.
+    *                   Different processing must have different
+    *                   descriptions.
+    * @param process    The function that processes the graph.
+    *
+    * @return The root of the processed graph or OSG::NullFC if
+    *         \p sourceFile could not be read.
+    *
+    * @since 0.51.26
+    */
+   OSG::NodeRefPtr read(const std::string& sourceFile,
+                        const std::string& variant,
+                        const process_func_t& process);
+
+   /**
+    * Makes sure that the cache has an entry for the given scene file.
+    *
+    * @param sourceFile The scene file to convert.
+    * @param force      Replace the entry if there already is one.
+    *
+    * @return true is returned if the cache has an entry for \p sourceFile
+    *         when this returns.
+    */
+   bool prewarm(const std::string& sourceFile, const bool force = false);
+
+   /**
+    * Returns the path of the cache entry for the given scene file or for
+    * the given variant of it. The entry does not necessarily exist.
+    *
+    * @param sourceFile The scene file.
+    * @param variant    The description of the processing done to the graph
+    *                   before it was cached. This is empty for the scene
+    *                   file as it was read. This parameter was added in
+    *                   version 0.51.26.
+    *
+    * @return An empty path is returned if \p sourceFile cannot be read.
+    */
+   boost::filesystem::path
+      getEntryPath(const std::string& sourceFile,
+                   const std::string& variant = std::string()) const;
+
+private:
+   /**
+    * Writes the given graph to the given cache entry.
+    *
+    * @return true is returned if the entry was written.
+    */
+   bool writeEntry(OSG::NodePtr root, const boost::filesystem::path& entry);
+
+   const boost::filesystem::path mCacheDir;
+
+   vpr::Mutex   mTempNameLock;
+   unsigned int mTempNameCount; /**< Makes temporary file names unique */
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_SCENE_CACHE_H_ */
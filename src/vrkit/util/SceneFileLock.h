@@ -0,0 +1,51 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_SCENE_FILE_LOCK_H_
+#define _VRKIT_UTIL_SCENE_FILE_LOCK_H_
+
+#include <vrkit/Config.h>
+
+#include <vpr/Sync/Mutex.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/**
+ * Returns the lock that serializes the use of OSG::SceneFileHandler.
+ * OSG::SceneFileHandler is a process-wide singleton whose read and write
+ * methods change shared state (such as the path handler used to resolve
+ * textures), and some of the scene file loaders are not reentrant. Any
+ * thread that reads or writes a scene file must hold this lock while doing
+ * so. Processing the graph that was read should be done after releasing
+ * it.
+ *
+ * @since 0.51.28
+ */
+VRKIT_API(vpr::Mutex&) getSceneFileLock();
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_SCENE_FILE_LOCK_H_ */
@@ -0,0 +1,191 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <OpenSG/OSGAction.h>
+#include <OpenSG/OSGGraphOp.h>
+#include <OpenSG/OSGSharePtrGraphOp.h>
+#include <OpenSG/OSGMaterialMergeGraphOp.h>
+#include <OpenSG/OSGMergeGraphOp.h>
+#include <OpenSG/OSGStripeGraphOp.h>
+
+#include <vrkit/Exception.h>
+#include <vrkit/util/SceneOptimizer.h>
+
+
+namespace
+{
+
+#if OSG_MAJOR_VERSION < 2
+typedef OSG::NodePtr& traverse_node_type;
+typedef std::auto_ptr<OSG::GraphOp> graph_op_ptr;
+#else
+typedef OSG::NodePtrConstArg traverse_node_type;
+typedef OSG::GraphOpRefPtr graph_op_ptr;
+#endif
+
+/** Collects the nodes that must be excluded from the graph operations. */
+class KeepFinder
+{
+public:
+   KeepFinder(const vrkit::util::SceneOptimizer::predicate_t& keep)
+      : mKeep(keep)
+   {
+      /* Do nothing. */ ;
+   }
+
+   void traverse(OSG::NodePtr root)
+   {
+      mNodes.clear();
+      mNodes.push_back(root);
+
+      if ( ! mKeep.empty() )
+      {
+         OSG::traverse(root,
+#if OSG_MAJOR_VERSION < 2
+                       OSG::osgTypedMethodFunctor1ObjPtrCPtrRef<
+                          OSG::Action::ResultE, KeepFinder, OSG::NodePtr
+                       >(this, &KeepFinder::enter)
+#else
+                       boost::bind(&KeepFinder::enter, this, _1)
+#endif
+         );
+      }
+   }
+
+   std::vector<OSG::NodePtr> mNodes;
+
+private:
+   OSG::Action::ResultE enter(traverse_node_type node)
+   {
+      if ( node != mNodes.front() && mKeep(node) )
+      {
+         mNodes.push_back(node);
+      }
+
+      return OSG::Action::Continue;
+   }
+
+   vrkit::util::SceneOptimizer::predicate_t mKeep;
+};
+
+template<typename T>
+graph_op_ptr makeGraphOp()
+{
+#if OSG_MAJOR_VERSION < 2
+   return graph_op_ptr(new T());
+#else
+   return graph_op_ptr(T::create());
+#endif
+}
+
+void runGraphOp(graph_op_ptr op, OSG::NodePtr root,
+                const std::vector<OSG::NodePtr>& exclude)
+{
+   typedef std::vector<OSG::NodePtr>::const_iterator iter_type;
+   for ( iter_type n = exclude.begin(); n != exclude.end(); ++n )
+   {
+      OSG::NodePtr node(*n);
+      op->addToExcludeList(node);
+   }
+
+   op->traverse(root);
+}
+
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+SceneOptimizer::SceneOptimizer(const unsigned int operations)
+   : mOperations(operations)
+{
+   /* Do nothing. */ ;
+}
+
+SceneOptimizer::Operation SceneOptimizer::getOperation(const std::string& name)
+{
+   if ( name == "share" )
+   {
+      return SHARE_CONTAINERS;
+   }
+   else if ( name == "merge_materials" )
+   {
+      return MERGE_MATERIALS;
+   }
+   else if ( name == "merge" )
+   {
+      return MERGE_GEOMETRY;
+   }
+   else if ( name == "stripe" )
+   {
+      return STRIPE;
+   }
+
+   std::ostringstream msg_stream;
+   msg_stream << "Unknown scene optimization '" << name << "'";
+   throw Exception(msg_stream.str(), VRKIT_LOCATION);
+}
+
+void SceneOptimizer::optimize(OSG::NodePtr root, const predicate_t& keep)
+   const
+{
+   if ( mOperations == 0 )
+   {
+      return;
+   }
+
+   // The graph operations do not know about scene objects, so every node
+   // that has to survive is put in the exclude list of each operation.
+   KeepFinder finder(keep);
+   finder.traverse(root);
+
+   // Sharing equal containers first lets the later operations recognize
+   // more geometry as having the same material.
+   if ( mOperations & SHARE_CONTAINERS )
+   {
+      runGraphOp(makeGraphOp<OSG::SharePtrGraphOp>(), root, finder.mNodes);
+   }
+
+   if ( mOperations & MERGE_MATERIALS )
+   {
+      runGraphOp(makeGraphOp<OSG::MaterialMergeGraphOp>(), root,
+                 finder.mNodes);
+   }
+
+   if ( mOperations & MERGE_GEOMETRY )
+   {
+      runGraphOp(makeGraphOp<OSG::MergeGraphOp>(), root, finder.mNodes);
+   }
+
+   if ( mOperations & STRIPE )
+   {
+      runGraphOp(makeGraphOp<OSG::StripeGraphOp>(), root, finder.mNodes);
+   }
+}
+
+}
+
+}
@@ -0,0 +1,117 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_SCENE_OPTIMIZER_H_
+#define _VRKIT_UTIL_SCENE_OPTIMIZER_H_
+
+#include <vrkit/Config.h>
+
+#include <string>
+#include <boost/function.hpp>
+
+#include <OpenSG/OSGNode.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class SceneOptimizer SceneOptimizer.h vrkit/util/SceneOptimizer.h
+ *
+ * Reduces the number of nodes, cores, and primitives in a loaded model
+ * using the OpenSG graph operations. Models exported from modeling tools
+ * tend to have many small geometry cores with duplicated materials and
+ * non-indexed primitives, which increases both the number of draw calls
+ * and the cost of intersection testing.
+ *
+ * Nodes that must survive the optimization, such as the roots of scene
+ * objects, are identified by a predicate. They are excluded from
+ * transformation flattening and geometry merging.
+ *
+ * @since 0.51.25
+ */
+class VRKIT_CLASS_API SceneOptimizer
+{
+public:
+   /** The operations performed by optimize(), in the order listed. */
+   enum Operation
+   {
+      /** Share identical field containers such as textures and chunks. */
+      SHARE_CONTAINERS = 0x1,
+
+      /** Replace equal materials with a single instance. */
+      MERGE_MATERIALS  = 0x2,
+
+      /**
+       * Flatten static transformations and merge geometry that uses the
+       * same material.
+       */
+      MERGE_GEOMETRY   = 0x4,
+
+      /** Convert geometry to indexed triangle strips. */
+      STRIPE           = 0x8,
+
+      ALL_OPERATIONS   = 0xf
+   };
+
+   typedef boost::function<bool (OSG::NodePtr)> predicate_t;
+
+   SceneOptimizer(const unsigned int operations = ALL_OPERATIONS);
+
+   /**
+    * Returns the operation with the given name. The names are "share",
+    * "merge_materials", "merge", and "stripe".
+    *
+    * @throw vrkit::Exception Thrown if \p name is not known.
+    */
+   static Operation getOperation(const std::string& name);
+
+   void setOperations(const unsigned int operations)
+   {
+      mOperations = operations;
+   }
+
+   unsigned int getOperations() const
+   {
+      return mOperations;
+   }
+
+   /**
+    * Optimizes the graph rooted at the given node. \p root itself is never
+    * removed.
+    *
+    * @param root The root of the graph to optimize.
+    * @param keep A predicate that identifies the nodes that must not be
+    *             removed or merged with other nodes. If it is empty, only
+    *             \p root is preserved.
+    */
+   void optimize(OSG::NodePtr root, const predicate_t& keep = predicate_t())
+      const;
+
+private:
+   unsigned int mOperations;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_SCENE_OPTIMIZER_H_ */
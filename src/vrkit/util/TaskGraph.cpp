@@ -0,0 +1,309 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Assert.h>
+
+#include <vrkit/util/TaskGraph.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+TaskGraph::TaskGraph(const unsigned int numWorkers,
+                     const worker_func_type& enterFunc,
+                     const worker_func_type& exitFunc)
+   : mNumWorkers(numWorkers)
+   , mEnterFunc(enterFunc)
+   , mExitFunc(exitFunc)
+   , mOutstanding(0)
+   , mShutdown(false)
+{
+   /* Do nothing. */ ;
+}
+
+TaskGraph::~TaskGraph()
+{
+   vprASSERT(mWorkers.empty() && "Worker threads are still running");
+}
+
+TaskGraph::task_id_type
+TaskGraph::addTask(const std::string& name, const task_func_type& func,
+                   const std::vector<task_id_type>& deps,
+                   const bool mainThread, const task_func_type& completeFunc)
+{
+   const task_id_type id(mTasks.size());
+
+   mTasks.push_back(Task());
+   Task& task(mTasks.back());
+   task.name         = name;
+   task.func         = func;
+   task.completeFunc = completeFunc;
+   task.mainThread   = mainThread || mNumWorkers == 0;
+   task.pendingDeps  = deps.size();
+
+   typedef std::vector<task_id_type>::const_iterator iter_type;
+   for ( iter_type d = deps.begin(); d != deps.end(); ++d )
+   {
+      vprASSERT(*d < id && "Dependencies must be added first");
+      mTasks[*d].dependents.push_back(id);
+   }
+
+   return id;
+}
+
+void TaskGraph::execute()
+{
+   mCond.acquire();
+   {
+      mShutdown    = false;
+      mOutstanding = mTasks.size();
+
+      for ( task_id_type id = 0; id < mTasks.size(); ++id )
+      {
+         if ( mTasks[id].pendingDeps == 0 )
+         {
+            makeReady(id);
+         }
+      }
+   }
+   mCond.release();
+
+   for ( unsigned int w = 0; w < mNumWorkers; ++w )
+   {
+      mWorkers.push_back(
+         new vpr::Thread(boost::bind(&TaskGraph::workerLoop, this, w))
+      );
+   }
+
+   mCond.acquire();
+   {
+      while ( mOutstanding > 0 )
+      {
+         if ( ! mMainQueue.empty() )
+         {
+            const task_id_type id(*mMainQueue.begin());
+            mMainQueue.erase(mMainQueue.begin());
+
+            mCond.release();
+            runTask(id);
+            completeTask(id);
+            mCond.acquire();
+
+            finishTask(id);
+         }
+         else if ( ! mCompleted.empty() )
+         {
+            // Take everything that has completed so far and run the
+            // completion functions without holding the lock so that worker
+            // threads can keep going.
+            std::vector<task_id_type> completed;
+            completed.swap(mCompleted);
+
+            mCond.release();
+            std::for_each(completed.begin(), completed.end(),
+                          boost::bind(&TaskGraph::completeTask, this, _1));
+            mCond.acquire();
+
+            std::for_each(completed.begin(), completed.end(),
+                          boost::bind(&TaskGraph::finishTask, this, _1));
+         }
+         else
+         {
+            mCond.wait();
+         }
+      }
+
+      mShutdown = true;
+      mCond.broadcast();
+   }
+   mCond.release();
+
+   typedef std::vector<vpr::Thread*>::iterator iter_type;
+   for ( iter_type w = mWorkers.begin(); w != mWorkers.end(); ++w )
+   {
+      (*w)->join();
+      delete *w;
+   }
+
+   mWorkers.clear();
+}
+
+void TaskGraph::makeReady(const task_id_type id)
+{
+   if ( mTasks[id].mainThread )
+   {
+      mMainQueue.insert(id);
+   }
+   else
+   {
+      mWorkerQueue.push_back(id);
+   }
+
+   mCond.broadcast();
+}
+
+void TaskGraph::finishTask(const task_id_type id)
+{
+   Task& task(mTasks[id]);
+   --mOutstanding;
+
+   if ( task.result.status == Result::SUCCEEDED )
+   {
+      typedef std::vector<task_id_type>::iterator iter_type;
+      for ( iter_type d = task.dependents.begin();
+            d != task.dependents.end();
+            ++d )
+      {
+         Task& dep(mTasks[*d]);
+
+         if ( --dep.pendingDeps == 0 &&
+              dep.result.status == Result::PENDING )
+         {
+            makeReady(*d);
+         }
+      }
+   }
+   else
+   {
+      skipDependents(id);
+   }
+}
+
+void TaskGraph::skipDependents(const task_id_type id)
+{
+   const Task& task(mTasks[id]);
+
+   typedef std::vector<task_id_type>::const_iterator iter_type;
+   for ( iter_type d = task.dependents.begin(); d != task.dependents.end();
+         ++d )
+   {
+      Task& dep(mTasks[*d]);
+
+      // A task with more than one failed dependency is only skipped once.
+      if ( dep.result.status == Result::PENDING )
+      {
+         std::ostringstream msg_stream;
+         msg_stream << "Dependency " << task.name << " failed";
+         dep.result.status = Result::SKIPPED;
+         dep.result.error  = msg_stream.str();
+         --mOutstanding;
+
+         skipDependents(*d);
+      }
+   }
+}
+
+void TaskGraph::runTask(const task_id_type id)
+{
+   Task& task(mTasks[id]);
+   const vpr::Interval start(vpr::Interval::now());
+
+   try
+   {
+      task.func();
+      task.result.status = Result::SUCCEEDED;
+   }
+   catch (std::exception& ex)
+   {
+      task.result.status = Result::FAILED;
+      task.result.error  = ex.what();
+   }
+   catch (...)
+   {
+      task.result.status = Result::FAILED;
+      task.result.error  = "Unknown exception";
+   }
+
+   task.result.elapsed = vpr::Interval::now() - start;
+}
+
+void TaskGraph::completeTask(const task_id_type id)
+{
+   Task& task(mTasks[id]);
+
+   if ( task.result.status == Result::SUCCEEDED && ! task.completeFunc.empty() )
+   {
+      try
+      {
+         task.completeFunc();
+      }
+      catch (std::exception& ex)
+      {
+         task.result.status = Result::FAILED;
+         task.result.error  = ex.what();
+      }
+      catch (...)
+      {
+         task.result.status = Result::FAILED;
+         task.result.error  = "Unknown exception";
+      }
+   }
+}
+
+void TaskGraph::workerLoop(const unsigned int index)
+{
+   if ( ! mEnterFunc.empty() )
+   {
+      mEnterFunc(index);
+   }
+
+   mCond.acquire();
+   {
+      while ( true )
+      {
+         while ( mWorkerQueue.empty() && ! mShutdown )
+         {
+            mCond.wait();
+         }
+
+         if ( mWorkerQueue.empty() )
+         {
+            break;
+         }
+
+         const task_id_type id(mWorkerQueue.front());
+         mWorkerQueue.pop_front();
+
+         mCond.release();
+         runTask(id);
+         mCond.acquire();
+
+         mCompleted.push_back(id);
+         mCond.broadcast();
+      }
+   }
+   mCond.release();
+
+   if ( ! mExitFunc.empty() )
+   {
+      mExitFunc(index);
+   }
+}
+
+}
+
+}
@@ -0,0 +1,232 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_TASK_GRAPH_H_
+#define _VRKIT_UTIL_TASK_GRAPH_H_
+
+#include <vrkit/Config.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+
+#include <vpr/Sync/CondVar.h>
+#include <vpr/Util/Interval.h>
+
+
+namespace vpr
+{
+   class Thread;
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class TaskGraph TaskGraph.h vrkit/util/TaskGraph.h
+ *
+ * Executes a set of tasks with dependencies between them using a pool of
+ * worker threads. A task is not started until all of its dependencies have
+ * completed successfully. If a task fails (by throwing an exception), all of
+ * the tasks that depend on it, directly or indirectly, are skipped.
+ *
+ * Tasks may be bound to the thread that invokes execute() (the "main"
+ * thread). Each task may also have a completion function. Completion
+ * functions are always invoked in the main thread after the task completes
+ * and before any of its dependents are started. This provides a point at
+ * which the results of work done in a worker thread can be handed off to
+ * code that is not thread safe.
+ *
+ * @since 0.51.5
+ */
+class VRKIT_CLASS_API TaskGraph : private boost::noncopyable
+{
+public:
+   typedef unsigned int task_id_type;
+   typedef boost::function<void ()> task_func_type;
+
+   /**
+    * The type of the functions invoked by each worker thread when it starts
+    * and before it exits. The argument is the index of the worker thread.
+    */
+   typedef boost::function<void (const unsigned int)> worker_func_type;
+
+   /** The result of executing a single task. */
+   struct Result
+   {
+      enum Status
+      {
+         PENDING,       /**< The task has not run (yet). */
+         SUCCEEDED,     /**< The task completed successfully. */
+         FAILED,        /**< The task threw an exception. */
+         SKIPPED        /**< One of the dependencies of the task failed. */
+      };
+
+      Result()
+         : status(PENDING)
+      {
+         /* Do nothing. */ ;
+      }
+
+      Status        status;
+      std::string   error;      /**< Description of a failure */
+      vpr::Interval elapsed;    /**< Time spent executing the task */
+   };
+
+   /**
+    * Constructor.
+    *
+    * @param numWorkers The number of worker threads to use. If this is 0,
+    *                   all tasks are executed in the thread that invokes
+    *                   execute() in the order in which they were added.
+    * @param enterFunc  An optional function invoked by each worker thread
+    *                   before it executes any tasks.
+    * @param exitFunc   An optional function invoked by each worker thread
+    *                   after all tasks have been executed.
+    */
+   TaskGraph(const unsigned int numWorkers,
+             const worker_func_type& enterFunc = worker_func_type(),
+             const worker_func_type& exitFunc = worker_func_type());
+
+   ~TaskGraph();
+
+   /**
+    * Adds a new task to this graph.
+    *
+    * @pre execute() is not running. Every element of \p deps was returned
+    *      by a previous call to this method.
+    *
+    * @param name         A name for the task used in error messages.
+    * @param func         The work to be performed by the task.
+    * @param deps         The tasks that must complete successfully before
+    *                     this task can be started.
+    * @param mainThread   Indicates whether this task must be executed in the
+    *                     thread that invokes execute().
+    * @param completeFunc An optional function to invoke in the thread that
+    *                     invokes execute() after \p func completes
+    *                     successfully. If it throws an exception, the task
+    *                     is treated as having failed.
+    *
+    * @return The identifier for the new task is returned.
+    */
+   task_id_type addTask(const std::string& name, const task_func_type& func,
+                        const std::vector<task_id_type>& deps =
+                           std::vector<task_id_type>(),
+                        const bool mainThread = false,
+                        const task_func_type& completeFunc =
+                           task_func_type());
+
+   /**
+    * Executes all the tasks in this graph and blocks until they have
+    * completed, failed, or been skipped. Exceptions thrown by tasks are
+    * caught and recorded in the result for the task.
+    *
+    * @post All worker threads have exited.
+    */
+   void execute();
+
+   unsigned int getNumTasks() const
+   {
+      return mTasks.size();
+   }
+
+   const std::string& getName(const task_id_type id) const
+   {
+      return mTasks[id].name;
+   }
+
+   const Result& getResult(const task_id_type id) const
+   {
+      return mTasks[id].result;
+   }
+
+private:
+   struct Task
+   {
+      Task()
+         : mainThread(false)
+         , pendingDeps(0)
+      {
+         /* Do nothing. */ ;
+      }
+
+      std::string    name;
+      task_func_type func;
+      task_func_type completeFunc;
+      bool           mainThread;
+
+      std::vector<task_id_type> dependents;
+      unsigned int              pendingDeps;
+
+      Result result;
+   };
+
+   /** @name Helpers Invoked with mCond Acquired */
+   //@{
+   void makeReady(const task_id_type id);
+
+   void finishTask(const task_id_type id);
+
+   void skipDependents(const task_id_type id);
+   //@}
+
+   /** Runs the work function of the identified task and times it. */
+   void runTask(const task_id_type id);
+
+   /** Runs the completion function of the identified task. */
+   void completeTask(const task_id_type id);
+
+   void workerLoop(const unsigned int index);
+
+   const unsigned int mNumWorkers;
+   worker_func_type   mEnterFunc;
+   worker_func_type   mExitFunc;
+
+   std::vector<Task> mTasks;
+
+   /** @name State Shared with Worker Threads (Protected by mCond) */
+   //@{
+   vpr::CondVar              mCond;
+   std::deque<task_id_type>  mWorkerQueue;  /**< Ready worker tasks */
+
+   /**
+    * Ready main thread tasks. These are run in order of their identifiers,
+    * which makes execution without worker threads follow the order in which
+    * tasks were added.
+    */
+   std::set<task_id_type>    mMainQueue;
+
+   std::vector<task_id_type> mCompleted;    /**< Finished worker tasks */
+   unsigned int              mOutstanding;
+   bool                      mShutdown;
+   //@}
+
+   std::vector<vpr::Thread*> mWorkers;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_TASK_GRAPH_H_ */
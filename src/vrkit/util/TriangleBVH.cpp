@@ -0,0 +1,769 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <vrkit/util/TriangleBVH.h>
+
+
+namespace
+{
+
+const unsigned int sMaxLeafSize(4);
+const unsigned int sNumBins(16);
+
+// Below this depth, nodes are split at the median so that the depth of the
+// hierarchy (and therefore the traversal stack) is bounded.
+const unsigned int sMaxSahDepth(32);
+const unsigned int sStackSize(128);
+
+inline void sub(float r[3], const float a[3], const float b[3])
+{
+   r[0] = a[0] - b[0];
+   r[1] = a[1] - b[1];
+   r[2] = a[2] - b[2];
+}
+
+inline float dot(const float a[3], const float b[3])
+{
+   return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline void cross(float r[3], const float a[3], const float b[3])
+{
+   r[0] = a[1] * b[2] - a[2] * b[1];
+   r[1] = a[2] * b[0] - a[0] * b[2];
+   r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/** Axis-aligned box used while building the hierarchy. */
+struct Box
+{
+   Box()
+   {
+      lo[0] = lo[1] = lo[2] = std::numeric_limits<float>::max();
+      hi[0] = hi[1] = hi[2] = -std::numeric_limits<float>::max();
+   }
+
+   void extend(const float p[3])
+   {
+      for ( unsigned int i = 0; i < 3; ++i )
+      {
+         lo[i] = std::min(lo[i], p[i]);
+         hi[i] = std::max(hi[i], p[i]);
+      }
+   }
+
+   void extend(const Box& b)
+   {
+      extend(b.lo);
+      extend(b.hi);
+   }
+
+   float area() const
+   {
+      if ( lo[0] > hi[0] )
+      {
+         return 0.0f;
+      }
+
+      const float dx(hi[0] - lo[0]), dy(hi[1] - lo[1]), dz(hi[2] - lo[2]);
+      return dx * dy + dy * dz + dz * dx;
+   }
+
+   float lo[3];
+   float hi[3];
+};
+
+/** Per-triangle data used while building the hierarchy. */
+struct BuildRef
+{
+   Box         bounds;
+   float       centroid[3];
+   vpr::Uint32 index;
+};
+
+/** A node whose contents have yet to be split. */
+struct BuildTask
+{
+   vpr::Uint32  node;
+   vpr::Uint32  begin;
+   vpr::Uint32  end;
+   unsigned int depth;
+};
+
+struct InBin
+{
+   InBin(const unsigned int axis, const float lo, const float scale,
+         const unsigned int bin)
+      : axis(axis), lo(lo), scale(scale), bin(bin)
+   {
+   }
+
+   bool operator()(const BuildRef& ref) const
+   {
+      const unsigned int b(
+         std::min(static_cast<unsigned int>((ref.centroid[axis] - lo) * scale),
+                  sNumBins - 1)
+      );
+      return b < bin;
+   }
+
+   unsigned int axis;
+   float        lo;
+   float        scale;
+   unsigned int bin;
+};
+
+struct CentroidLess
+{
+   CentroidLess(const unsigned int axis)
+      : axis(axis)
+   {
+   }
+
+   bool operator()(const BuildRef& a, const BuildRef& b) const
+   {
+      return a.centroid[axis] < b.centroid[axis];
+   }
+
+   unsigned int axis;
+};
+
+/**
+ * Determines the parameter range over which the segment \p origin +
+ * t * \p motion, with t in [0,\p tMax], lies inside the given box.
+ */
+inline bool segmentHitsBox(const float lo[3], const float hi[3],
+                           const float origin[3], const float invMotion[3],
+                           const float tMax, float& tEnter)
+{
+   float t0(0.0f), t1(tMax);
+
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      float near_t = (lo[i] - origin[i]) * invMotion[i];
+      float far_t  = (hi[i] - origin[i]) * invMotion[i];
+
+      if ( near_t > far_t )
+      {
+         std::swap(near_t, far_t);
+      }
+
+      // NaN (0 * inf) compares false, which leaves the range unchanged.
+      if ( near_t > t0 )
+      {
+         t0 = near_t;
+      }
+      if ( far_t < t1 )
+      {
+         t1 = far_t;
+      }
+
+      if ( t0 > t1 )
+      {
+         return false;
+      }
+   }
+
+   tEnter = t0;
+   return true;
+}
+
+inline void inverse(float r[3], const float v[3])
+{
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      r[i] = v[i] != 0.0f ? 1.0f / v[i]
+                          : std::numeric_limits<float>::infinity();
+   }
+}
+
+/**
+ * Returns the first time in [0,\p tMax) at which the point \p w +
+ * t * \p d is at distance \p r from the origin, considering only the
+ * components of \p w and \p d passed in. Returns false if there is none. A
+ * point already within \p r that is moving inwards is reported at time 0.
+ */
+inline bool solveSphere(const float a, const float b, const float c,
+                        const float tMax, float& t)
+{
+   if ( c < 0.0f )
+   {
+      if ( b < 0.0f )
+      {
+         t = 0.0f;
+         return true;
+      }
+
+      return false;
+   }
+
+   if ( a <= 0.0f )
+   {
+      return false;
+   }
+
+   const float disc(b * b - 4.0f * a * c);
+   if ( disc < 0.0f )
+   {
+      return false;
+   }
+
+   const float root((-b - std::sqrt(disc)) / (2.0f * a));
+   if ( root >= 0.0f && root < tMax )
+   {
+      t = root;
+      return true;
+   }
+
+   return false;
+}
+
+}
+
+namespace vrkit
+{
+
+namespace util
+{
+
+TriangleBVH::TriangleBVH()
+{
+   /* Do nothing. */ ;
+}
+
+void TriangleBVH::build(const std::vector<gmtl::Point3f>& vertices)
+{
+   clear();
+
+   const unsigned int num_tris(vertices.size() / 3);
+
+   std::vector<Triangle> tris;
+   std::vector<BuildRef> refs;
+   tris.reserve(num_tris);
+   refs.reserve(num_tris);
+
+   Box scene_box;
+
+   for ( unsigned int i = 0; i < num_tris; ++i )
+   {
+      const float* v0(vertices[i * 3].getData());
+      const float* v1(vertices[i * 3 + 1].getData());
+      const float* v2(vertices[i * 3 + 2].getData());
+
+      Triangle tri;
+      std::copy(v0, v0 + 3, tri.v0);
+      sub(tri.e1, v1, v0);
+      sub(tri.e2, v2, v0);
+
+      float n[3];
+      cross(n, tri.e1, tri.e2);
+      if ( dot(n, n) == 0.0f )
+      {
+         continue;
+      }
+
+      BuildRef ref;
+      ref.bounds.extend(v0);
+      ref.bounds.extend(v1);
+      ref.bounds.extend(v2);
+      for ( unsigned int a = 0; a < 3; ++a )
+      {
+         ref.centroid[a] = (v0[a] + v1[a] + v2[a]) / 3.0f;
+      }
+      ref.index = tris.size();
+
+      scene_box.extend(ref.bounds);
+      tris.push_back(tri);
+      refs.push_back(ref);
+   }
+
+   if ( refs.empty() )
+   {
+      return;
+   }
+
+   mBounds.setMin(gmtl::Point3f(scene_box.lo[0], scene_box.lo[1],
+                                scene_box.lo[2]));
+   mBounds.setMax(gmtl::Point3f(scene_box.hi[0], scene_box.hi[1],
+                                scene_box.hi[2]));
+   mBounds.setEmpty(false);
+
+   mNodes.reserve(2 * refs.size() / sMaxLeafSize + 1);
+   mNodes.resize(1);
+
+   std::vector<BuildTask> tasks;
+   BuildTask root = { 0, 0, static_cast<vpr::Uint32>(refs.size()), 0 };
+   tasks.push_back(root);
+
+   while ( ! tasks.empty() )
+   {
+      const BuildTask task(tasks.back());
+      tasks.pop_back();
+
+      Box node_box, centroid_box;
+      for ( vpr::Uint32 i = task.begin; i < task.end; ++i )
+      {
+         node_box.extend(refs[i].bounds);
+         centroid_box.extend(refs[i].centroid);
+      }
+
+      Node& node(mNodes[task.node]);
+      std::copy(node_box.lo, node_box.lo + 3, node.lo);
+      std::copy(node_box.hi, node_box.hi + 3, node.hi);
+      node.offset = task.begin;
+      node.count  = task.end - task.begin;
+
+      if ( node.count <= sMaxLeafSize )
+      {
+         continue;
+      }
+
+      unsigned int axis(0);
+      for ( unsigned int a = 1; a < 3; ++a )
+      {
+         if ( centroid_box.hi[a] - centroid_box.lo[a] >
+                 centroid_box.hi[axis] - centroid_box.lo[axis] )
+         {
+            axis = a;
+         }
+      }
+
+      const float extent(centroid_box.hi[axis] - centroid_box.lo[axis]);
+      vpr::Uint32 mid(task.begin);
+
+      if ( extent > 0.0f && task.depth < sMaxSahDepth )
+      {
+         // Bin the centroids along the chosen axis and pick the split with
+         // the lowest surface area cost.
+         const float scale(sNumBins / extent);
+         Box bin_box[sNumBins];
+         vpr::Uint32 bin_count[sNumBins] = { 0 };
+
+         for ( vpr::Uint32 i = task.begin; i < task.end; ++i )
+         {
+            const unsigned int b(
+               std::min(
+                  static_cast<unsigned int>(
+                     (refs[i].centroid[axis] - centroid_box.lo[axis]) * scale
+                  ),
+                  sNumBins - 1
+               )
+            );
+            bin_box[b].extend(refs[i].bounds);
+            ++bin_count[b];
+         }
+
+         float left_area[sNumBins];
+         vpr::Uint32 left_count[sNumBins];
+         Box acc;
+         vpr::Uint32 count(0);
+         for ( unsigned int b = 0; b < sNumBins; ++b )
+         {
+            acc.extend(bin_box[b]);
+            count += bin_count[b];
+            left_area[b]  = acc.area();
+            left_count[b] = count;
+         }
+
+         float best_cost(std::numeric_limits<float>::max());
+         unsigned int best_split(0);
+         acc = Box();
+         count = 0;
+         for ( unsigned int b = sNumBins - 1; b > 0; --b )
+         {
+            acc.extend(bin_box[b]);
+            count += bin_count[b];
+            const float cost(left_area[b - 1] * left_count[b - 1] +
+                             acc.area() * count);
+            if ( cost < best_cost )
+            {
+               best_cost  = cost;
+               best_split = b;
+            }
+         }
+
+         mid = std::partition(refs.begin() + task.begin,
+                              refs.begin() + task.end,
+                              InBin(axis, centroid_box.lo[axis], scale,
+                                    best_split)) - refs.begin();
+      }
+
+      // Fall back on a median split if binning could not separate the
+      // triangles.
+      if ( mid == task.begin || mid == task.end )
+      {
+         mid = task.begin + (task.end - task.begin) / 2;
+         std::nth_element(refs.begin() + task.begin, refs.begin() + mid,
+                          refs.begin() + task.end, CentroidLess(axis));
+      }
+
+      const vpr::Uint32 left(mNodes.size());
+      mNodes[task.node].offset = left;
+      mNodes[task.node].count  = 0;
+      mNodes.resize(mNodes.size() + 2);
+
+      const BuildTask left_task  = { left, task.begin, mid, task.depth + 1 };
+      const BuildTask right_task = { left + 1, mid, task.end,
+                                     task.depth + 1 };
+      tasks.push_back(right_task);
+      tasks.push_back(left_task);
+   }
+
+   // Store the triangles in leaf order.
+   mTriangles.resize(refs.size());
+   for ( unsigned int i = 0; i < refs.size(); ++i )
+   {
+      mTriangles[i] = tris[refs[i].index];
+   }
+}
+
+void TriangleBVH::clear()
+{
+   std::vector<Node>().swap(mNodes);
+   std::vector<Triangle>().swap(mTriangles);
+   mBounds = gmtl::AABoxf();
+}
+
+bool TriangleBVH::sweepSphere(const gmtl::Point3f& center,
+                              const float radius, const gmtl::Vec3f& motion,
+                              float& fraction, gmtl::Vec3f& normal) const
+{
+   if ( mNodes.empty() )
+   {
+      return false;
+   }
+
+   const float* c(center.getData());
+   const float* d(motion.getData());
+   float inv_d[3];
+   inverse(inv_d, d);
+
+   float best_t(1.0f);
+   float best_n[3] = { 0.0f, 0.0f, 0.0f };
+   bool hit(false);
+
+   vpr::Uint32 stack[sStackSize];
+   unsigned int top(0);
+   stack[top++] = 0;
+
+   while ( top > 0 )
+   {
+      const Node& node(mNodes[stack[--top]]);
+
+      // Test the segment against the box grown by the sphere radius.
+      const float lo[3] =
+         { node.lo[0] - radius, node.lo[1] - radius, node.lo[2] - radius };
+      const float hi[3] =
+         { node.hi[0] + radius, node.hi[1] + radius, node.hi[2] + radius };
+      float t_enter;
+      if ( ! segmentHitsBox(lo, hi, c, inv_d, best_t, t_enter) )
+      {
+         continue;
+      }
+
+      if ( node.count > 0 )
+      {
+         for ( vpr::Uint32 i = node.offset; i < node.offset + node.count;
+               ++i )
+         {
+            if ( sweepTriangle(mTriangles[i], c, d, radius, best_t, best_n) )
+            {
+               hit = true;
+            }
+         }
+      }
+      else if ( top + 2 <= sStackSize )
+      {
+         stack[top++] = node.offset + 1;
+         stack[top++] = node.offset;
+      }
+   }
+
+   if ( hit )
+   {
+      fraction = best_t;
+      normal.set(best_n[0], best_n[1], best_n[2]);
+   }
+
+   return hit;
+}
+
+bool TriangleBVH::intersectRay(const gmtl::Point3f& origin,
+                               const gmtl::Vec3f& direction,
+                               const float maxDistance, float& distance,
+                               gmtl::Vec3f& normal) const
+{
+   if ( mNodes.empty() )
+   {
+      return false;
+   }
+
+   const float* o(origin.getData());
+   const float* d(direction.getData());
+   float inv_d[3];
+   inverse(inv_d, d);
+
+   float best_t(maxDistance);
+   const Triangle* best_tri(NULL);
+
+   vpr::Uint32 stack[sStackSize];
+   unsigned int top(0);
+   stack[top++] = 0;
+
+   while ( top > 0 )
+   {
+      const Node& node(mNodes[stack[--top]]);
+
+      float t_enter;
+      if ( ! segmentHitsBox(node.lo, node.hi, o, inv_d, best_t, t_enter) )
+      {
+         continue;
+      }
+
+      if ( node.count > 0 )
+      {
+         for ( vpr::Uint32 i = node.offset; i < node.offset + node.count;
+               ++i )
+         {
+            // Moller-Trumbore ray/triangle test (two-sided).
+            const Triangle& tri(mTriangles[i]);
+            float p[3];
+            cross(p, d, tri.e2);
+            const float det(dot(tri.e1, p));
+            if ( std::fabs(det) < 1e-12f )
+            {
+               continue;
+            }
+
+            const float inv_det(1.0f / det);
+            float s[3];
+            sub(s, o, tri.v0);
+            const float u(dot(s, p) * inv_det);
+            if ( u < 0.0f || u > 1.0f )
+            {
+               continue;
+            }
+
+            float q[3];
+            cross(q, s, tri.e1);
+            const float v(dot(d, q) * inv_det);
+            if ( v < 0.0f || u + v > 1.0f )
+            {
+               continue;
+            }
+
+            const float t(dot(tri.e2, q) * inv_det);
+            if ( t >= 0.0f && t < best_t )
+            {
+               best_t   = t;
+               best_tri = &tri;
+            }
+         }
+      }
+      else if ( top + 2 <= sStackSize )
+      {
+         stack[top++] = node.offset + 1;
+         stack[top++] = node.offset;
+      }
+   }
+
+   if ( best_tri != NULL )
+   {
+      float n[3];
+      cross(n, best_tri->e1, best_tri->e2);
+      const float len(std::sqrt(dot(n, n)));
+      const float sign(dot(n, d) > 0.0f ? -1.0f : 1.0f);
+
+      distance = best_t;
+      normal.set(sign * n[0] / len, sign * n[1] / len, sign * n[2] / len);
+      return true;
+   }
+
+   return false;
+}
+
+bool TriangleBVH::sweepTriangle(const Triangle& tri, const float center[3],
+                                const float motion[3], const float radius,
+                                float& fraction, float normal[3]) const
+{
+   float n[3];
+   cross(n, tri.e1, tri.e2);
+   const float inv_len(1.0f / std::sqrt(dot(n, n)));
+   n[0] *= inv_len;
+   n[1] *= inv_len;
+   n[2] *= inv_len;
+
+   float rel[3];
+   sub(rel, center, tri.v0);
+   float dist(dot(n, rel));
+   float side(1.0f);
+   if ( dist < 0.0f )
+   {
+      dist = -dist;
+      side = -1.0f;
+   }
+
+   const float normal_speed(side * dot(n, motion));
+
+   float t_plane(0.0f);
+   if ( dist >= radius )
+   {
+      if ( normal_speed >= 0.0f )
+      {
+         // Moving parallel to or away from the plane, so the triangle can
+         // never be reached.
+         return false;
+      }
+
+      t_plane = (dist - radius) / -normal_speed;
+      if ( t_plane >= fraction )
+      {
+         return false;
+      }
+   }
+
+   // Find the point (relative to v0) where the sphere first touches the
+   // plane. If the sphere already overlaps the plane, use the point in the
+   // plane nearest the center.
+   float p[3];
+   const float offset(dist >= radius ? radius : dist);
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      p[i] = rel[i] + motion[i] * t_plane - side * n[i] * offset;
+   }
+
+   const float* e1(tri.e1);
+   const float* e2(tri.e2);
+   const float ee11(dot(e1, e1)), ee12(dot(e1, e2)), ee22(dot(e2, e2));
+   const float pe1(dot(p, e1)), pe2(dot(p, e2));
+   const float inv_denom(1.0f / (ee11 * ee22 - ee12 * ee12));
+   const float u((ee22 * pe1 - ee12 * pe2) * inv_denom);
+   const float v((ee11 * pe2 - ee12 * pe1) * inv_denom);
+
+   if ( u >= 0.0f && v >= 0.0f && u + v <= 1.0f )
+   {
+      // The sphere touches the face first. If it already overlaps the face,
+      // it only collides if it is moving further into it.
+      if ( dist < radius && normal_speed >= 0.0f )
+      {
+         return false;
+      }
+
+      fraction = t_plane;
+      normal[0] = side * n[0];
+      normal[1] = side * n[1];
+      normal[2] = side * n[2];
+      return true;
+   }
+
+   // The sphere does not touch the face first, so check the edges and the
+   // vertices.
+   bool hit(false);
+   float t_hit(fraction);
+   float contact[3] = { 0.0f, 0.0f, 0.0f };
+
+   const float motion_sq(dot(motion, motion));
+   float verts[3][3];
+   for ( unsigned int i = 0; i < 3; ++i )
+   {
+      verts[0][i] = 0.0f;
+      verts[1][i] = e1[i];
+      verts[2][i] = e2[i];
+   }
+
+   for ( unsigned int k = 0; k < 3; ++k )
+   {
+      float w[3];
+      sub(w, rel, verts[k]);
+      float t;
+      if ( solveSphere(motion_sq, 2.0f * dot(w, motion),
+                       dot(w, w) - radius * radius, t_hit, t) )
+      {
+         t_hit = t;
+         std::copy(verts[k], verts[k] + 3, contact);
+         hit = true;
+      }
+   }
+
+   for ( unsigned int k = 0; k < 3; ++k )
+   {
+      const float* a(verts[k]);
+      const float* b(verts[(k + 1) % 3]);
+      float edge[3], w[3];
+      sub(edge, b, a);
+      sub(w, rel, a);
+
+      // Work in the plane perpendicular to the edge.
+      const float edge_sq(dot(edge, edge));
+      const float we(dot(w, edge) / edge_sq), de(dot(motion, edge) / edge_sq);
+      float wp[3], dp[3];
+      for ( unsigned int i = 0; i < 3; ++i )
+      {
+         wp[i] = w[i] - edge[i] * we;
+         dp[i] = motion[i] - edge[i] * de;
+      }
+
+      float t;
+      if ( solveSphere(dot(dp, dp), 2.0f * dot(wp, dp),
+                       dot(wp, wp) - radius * radius, t_hit, t) )
+      {
+         const float f(we + de * t);
+         if ( f >= 0.0f && f <= 1.0f )
+         {
+            t_hit = t;
+            for ( unsigned int i = 0; i < 3; ++i )
+            {
+               contact[i] = a[i] + edge[i] * f;
+            }
+            hit = true;
+         }
+      }
+   }
+
+   if ( hit )
+   {
+      float dir[3];
+      for ( unsigned int i = 0; i < 3; ++i )
+      {
+         dir[i] = rel[i] + motion[i] * t_hit - contact[i];
+      }
+
+      const float len(std::sqrt(dot(dir, dir)));
+      if ( len > 0.0f )
+      {
+         fraction = t_hit;
+         normal[0] = dir[0] / len;
+         normal[1] = dir[1] / len;
+         normal[2] = dir[2] / len;
+      }
+      else
+      {
+         hit = false;
+      }
+   }
+
+   return hit;
+}
+
+}
+
+}
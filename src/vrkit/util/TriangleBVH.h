@@ -0,0 +1,172 @@
+// vrkit is (C) Copyright 2005-2011
+//    by Allen Bierbaum, Aron Bierbuam, Patrick Hartling, and Daniel Shipton
+//
+// This file is part of vrkit.
+//
+// vrkit is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// vrkit is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+// more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _VRKIT_UTIL_TRIANGLE_BVH_H_
+#define _VRKIT_UTIL_TRIANGLE_BVH_H_
+
+#include <vrkit/Config.h>
+
+#include <vector>
+
+#include <vpr/vprTypes.h>
+#include <gmtl/Point.h>
+#include <gmtl/Vec.h>
+#include <gmtl/AABox.h>
+
+
+namespace vrkit
+{
+
+namespace util
+{
+
+/** \class TriangleBVH TriangleBVH.h vrkit/util/TriangleBVH.h
+ *
+ * A static bounding volume hierarchy over a triangle soup. The hierarchy is
+ * built once using a binned surface area heuristic and then supports
+ * swept sphere and ray queries. These are the queries needed to keep a
+ * moving viewer from passing through geometry and to follow the ground
+ * beneath it. Both queries treat triangles as two-sided.
+ *
+ * The triangles are copied into the hierarchy, so changes to the geometry
+ * from which they came are not reflected until build() is called again.
+ *
+ * @see vrkit::CollisionData
+ * @see vrkit::nav::Collider
+ *
+ * @since 0.51.15
+ */
+class VRKIT_CLASS_API TriangleBVH
+{
+public:
+   TriangleBVH();
+
+   /**
+    * Builds the hierarchy from the given triangles, replacing any existing
+    * hierarchy.
+    *
+    * @param vertices Three vertices per triangle. Degenerate triangles are
+    *                 discarded.
+    */
+   void build(const std::vector<gmtl::Point3f>& vertices);
+
+   /**
+    * Removes all triangles.
+    */
+   void clear();
+
+   bool empty() const
+   {
+      return mTriangles.empty();
+   }
+
+   unsigned int getNumTriangles() const
+   {
+      return mTriangles.size();
+   }
+
+   unsigned int getNumNodes() const
+   {
+      return mNodes.size();
+   }
+
+   /**
+    * Returns the bounding box of all the triangles. The box is empty if
+    * there are no triangles.
+    */
+   const gmtl::AABoxf& getBounds() const
+   {
+      return mBounds;
+   }
+
+   /**
+    * Sweeps a sphere from \p center along \p motion and finds the first
+    * triangle that it touches.
+    *
+    * @param center   The center of the sphere at the start of the sweep.
+    * @param radius   The radius of the sphere.
+    * @param motion   The displacement of the sphere over the sweep.
+    * @param fraction Storage for the fraction of \p motion (in the range
+    *                 [0,1]) covered before the first contact.
+    * @param normal   Storage for the unit contact normal. This points away
+    *                 from the surface towards the center of the sphere.
+    *
+    * @return true is returned if the sphere touches a triangle during the
+    *         sweep. A sphere that already overlaps a triangle and is moving
+    *         towards it is reported as touching it at a fraction of 0.
+    *         Otherwise, false is returned, and \p fraction and \p normal are
+    *         not modified.
+    */
+   bool sweepSphere(const gmtl::Point3f& center, const float radius,
+                    const gmtl::Vec3f& motion, float& fraction,
+                    gmtl::Vec3f& normal) const;
+
+   /**
+    * Finds the nearest triangle hit by the given ray.
+    *
+    * @param origin      The origin of the ray.
+    * @param direction   The unit direction of the ray.
+    * @param maxDistance The length of the ray.
+    * @param distance    Storage for the distance along the ray to the hit.
+    * @param normal      Storage for the unit normal of the triangle that was
+    *                    hit. This faces the origin of the ray.
+    *
+    * @return true is returned if a triangle was hit within \p maxDistance.
+    *         Otherwise, false is returned, and \p distance and \p normal are
+    *         not modified.
+    */
+   bool intersectRay(const gmtl::Point3f& origin,
+                     const gmtl::Vec3f& direction, const float maxDistance,
+                     float& distance, gmtl::Vec3f& normal) const;
+
+private:
+   struct Triangle
+   {
+      float v0[3];
+      float e1[3];      /**< v1 - v0 */
+      float e2[3];      /**< v2 - v0 */
+   };
+
+   /**
+    * A node of the hierarchy. If \c count is 0, this is an interior node
+    * whose children are at indices \c offset and \c offset + 1. Otherwise,
+    * it is a leaf holding the triangles [\c offset, \c offset + \c count).
+    */
+   struct Node
+   {
+      float       lo[3];
+      float       hi[3];
+      vpr::Uint32 offset;
+      vpr::Uint32 count;
+   };
+
+   bool sweepTriangle(const Triangle& tri, const float center[3],
+                      const float motion[3], const float radius,
+                      float& fraction, float normal[3]) const;
+
+   std::vector<Node>     mNodes;
+   std::vector<Triangle> mTriangles;
+   gmtl::AABoxf          mBounds;
+};
+
+}
+
+}
+
+
+#endif /* _VRKIT_UTIL_TRIANGLE_BVH_H_ */
@@ -24,12 +24,12 @@
 #include <map>
 #include <vector>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/signal.hpp>
 
 #include <OpenSG/OSGImage.h>
 #include <OpenSG/OSGTransform.h>
 #include <OpenSG/OSGWindow.h>
 
+#include <vrkit/signal/Signal.h>
 #include <vrkit/signal/Proxy.h>
 #include <vrkit/video/CameraPtr.h>
 #include <vrkit/video/RecorderPtr.h>
@@ -265,7 +265,7 @@ public:
 
    /** @name Signal Accessors */
    //@{
-   typedef boost::signal<void ()> basic_signal_t;
+   typedef signal::Signal<void ()> basic_signal_t;
 
    /**
     * Signal emitted when recording starts.
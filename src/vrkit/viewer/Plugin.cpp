@@ -80,6 +80,11 @@ bool Plugin::validatePluginLib(vpr::LibraryPtr pluginLib)
    return true;
 }
 
+bool Plugin::canInitConcurrently() const
+{
+   return false;
+}
+
 void Plugin::contextInit(ViewerPtr)
 {
    /* Do nothing. */ ;
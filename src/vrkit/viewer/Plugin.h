@@ -29,8 +29,8 @@
 #include <vrkit/ViewerPtr.h>
 #include <vrkit/viewer/PluginPtr.h>
 
-#define VRKIT_PLUGIN_API_MAJOR  2
-#define VRKIT_PLUGIN_API_MINOR  1
+#define VRKIT_PLUGIN_API_MAJOR  3
+#define VRKIT_PLUGIN_API_MINOR  0
 
 
 namespace vrkit
@@ -105,6 +105,24 @@ public:
     */
    virtual PluginPtr init(ViewerPtr viewer) = 0;
 
+   /**
+    * Indicates whether init() may be invoked in a thread other than the
+    * application thread, concurrently with the initialization of other
+    * plug-ins. A plug-in that returns true must not modify the scene graph
+    * that is reachable from the vrkit::Scene object, register scene objects,
+    * or use the plug-in registry from within init(). Such changes must be
+    * handed to vrkit::Viewer::callOnMainThread() instead. Reading the
+    * configuration and creating new, unattached OpenSG nodes is allowed.
+    *
+    * This implementation returns false.
+    *
+    * @note The plug-in API changed from 2.1 to 3.0 when this method was
+    *       added.
+    *
+    * @since 0.51.5
+    */
+   virtual bool canInitConcurrently() const;
+
    /**
     * Perform context-specific activities when a context is opened. This
     * implementation does nothing.